@@ -205,5 +205,420 @@ void fpconv_init()
     fpconv_update_locale();
 }
 #endif
+
+/* Shortest round-trip formatting of doubles using Grisu2, after
+ * Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+ * with Integers" (PLDI 2010).
+ *
+ * The libc %g conversion on this platform works digit by digit in software
+ * floating point, which dominates the cost of encoding numeric JSON.
+ * Grisu2 needs only 64 bit integer arithmetic and a table of 87 cached
+ * powers of ten (kept in flash), and always produces digits that read
+ * back to the same double.  When those digits fit within the requested
+ * precision they are exactly what %.<precision>g would print, so the
+ * output is unchanged; the rare values needing more digits fall back to
+ * c_sprintf(). */
+
+#include "c_types.h"
+#include "user_config.h"
+
+typedef struct {
+    uint64 f;
+    int e;
+} diy_fp_t;
+
+typedef struct {
+    uint32 hi, lo;
+    int32 e;
+} cached_power_t;
+
+#define DIY_SIGNIFICAND_SIZE    64
+#define DP_SIGNIFICAND_SIZE     52
+#define DP_EXPONENT_BIAS        (0x3ff + DP_SIGNIFICAND_SIZE)
+#define DP_HIDDEN_BIT           ((uint64)1 << DP_SIGNIFICAND_SIZE)
+#define DP_SIGNIFICAND_MASK     (DP_HIDDEN_BIT - 1)
+#define DP_EXPONENT_MASK        0x7ff
+
+#define CACHED_POWERS_MIN_K     -348
+#define CACHED_POWERS_STEP      8
+#define GRISU_ALPHA             -59
+#define GRISU_GAMMA             -32
+
+/* Normalised 64 bit approximations of 10^k for k = -348, -340, ..., 340 */
+static const cached_power_t cached_powers[] ICACHE_STORE_ATTR ICACHE_RODATA_ATTR = {
+    { 0xfa8fd5a0, 0x081c0288, -1220 },
+    { 0xbaaee17f, 0xa23ebf76, -1193 },
+    { 0x8b16fb20, 0x3055ac76, -1166 },
+    { 0xcf42894a, 0x5dce35ea, -1140 },
+    { 0x9a6bb0aa, 0x55653b2d, -1113 },
+    { 0xe61acf03, 0x3d1a45df, -1087 },
+    { 0xab70fe17, 0xc79ac6ca, -1060 },
+    { 0xff77b1fc, 0xbebcdc4f, -1034 },
+    { 0xbe5691ef, 0x416bd60c, -1007 },
+    { 0x8dd01fad, 0x907ffc3c,  -980 },
+    { 0xd3515c28, 0x31559a83,  -954 },
+    { 0x9d71ac8f, 0xada6c9b5,  -927 },
+    { 0xea9c2277, 0x23ee8bcb,  -901 },
+    { 0xaecc4991, 0x4078536d,  -874 },
+    { 0x823c1279, 0x5db6ce57,  -847 },
+    { 0xc2109436, 0x4dfb5637,  -821 },
+    { 0x9096ea6f, 0x3848984f,  -794 },
+    { 0xd77485cb, 0x25823ac7,  -768 },
+    { 0xa086cfcd, 0x97bf97f4,  -741 },
+    { 0xef340a98, 0x172aace5,  -715 },
+    { 0xb23867fb, 0x2a35b28e,  -688 },
+    { 0x84c8d4df, 0xd2c63f3b,  -661 },
+    { 0xc5dd4427, 0x1ad3cdba,  -635 },
+    { 0x936b9fce, 0xbb25c996,  -608 },
+    { 0xdbac6c24, 0x7d62a584,  -582 },
+    { 0xa3ab6658, 0x0d5fdaf6,  -555 },
+    { 0xf3e2f893, 0xdec3f126,  -529 },
+    { 0xb5b5ada8, 0xaaff80b8,  -502 },
+    { 0x87625f05, 0x6c7c4a8b,  -475 },
+    { 0xc9bcff60, 0x34c13053,  -449 },
+    { 0x964e858c, 0x91ba2655,  -422 },
+    { 0xdff97724, 0x70297ebd,  -396 },
+    { 0xa6dfbd9f, 0xb8e5b88f,  -369 },
+    { 0xf8a95fcf, 0x88747d94,  -343 },
+    { 0xb9447093, 0x8fa89bcf,  -316 },
+    { 0x8a08f0f8, 0xbf0f156b,  -289 },
+    { 0xcdb02555, 0x653131b6,  -263 },
+    { 0x993fe2c6, 0xd07b7fac,  -236 },
+    { 0xe45c10c4, 0x2a2b3b06,  -210 },
+    { 0xaa242499, 0x697392d3,  -183 },
+    { 0xfd87b5f2, 0x8300ca0e,  -157 },
+    { 0xbce50864, 0x92111aeb,  -130 },
+    { 0x8cbccc09, 0x6f5088cc,  -103 },
+    { 0xd1b71758, 0xe219652c,   -77 },
+    { 0x9c400000, 0x00000000,   -50 },
+    { 0xe8d4a510, 0x00000000,   -24 },
+    { 0xad78ebc5, 0xac620000,     3 },
+    { 0x813f3978, 0xf8940984,    30 },
+    { 0xc097ce7b, 0xc90715b3,    56 },
+    { 0x8f7e32ce, 0x7bea5c70,    83 },
+    { 0xd5d238a4, 0xabe98068,   109 },
+    { 0x9f4f2726, 0x179a2245,   136 },
+    { 0xed63a231, 0xd4c4fb27,   162 },
+    { 0xb0de6538, 0x8cc8ada8,   189 },
+    { 0x83c7088e, 0x1aab65db,   216 },
+    { 0xc45d1df9, 0x42711d9a,   242 },
+    { 0x924d692c, 0xa61be758,   269 },
+    { 0xda01ee64, 0x1a708dea,   295 },
+    { 0xa26da399, 0x9aef774a,   322 },
+    { 0xf209787b, 0xb47d6b85,   348 },
+    { 0xb454e4a1, 0x79dd1877,   375 },
+    { 0x865b8692, 0x5b9bc5c2,   402 },
+    { 0xc83553c5, 0xc8965d3d,   428 },
+    { 0x952ab45c, 0xfa97a0b3,   455 },
+    { 0xde469fbd, 0x99a05fe3,   481 },
+    { 0xa59bc234, 0xdb398c25,   508 },
+    { 0xf6c69a72, 0xa3989f5c,   534 },
+    { 0xb7dcbf53, 0x54e9bece,   561 },
+    { 0x88fcf317, 0xf22241e2,   588 },
+    { 0xcc20ce9b, 0xd35c78a5,   614 },
+    { 0x98165af3, 0x7b2153df,   641 },
+    { 0xe2a0b5dc, 0x971f303a,   667 },
+    { 0xa8d9d153, 0x5ce3b396,   694 },
+    { 0xfb9b7cd9, 0xa4a7443c,   720 },
+    { 0xbb764c4c, 0xa7a44410,   747 },
+    { 0x8bab8eef, 0xb6409c1a,   774 },
+    { 0xd01fef10, 0xa657842c,   800 },
+    { 0x9b10a4e5, 0xe9913129,   827 },
+    { 0xe7109bfb, 0xa19c0c9d,   853 },
+    { 0xac2820d9, 0x623bf429,   880 },
+    { 0x80444b5e, 0x7aa7cf85,   907 },
+    { 0xbf21e440, 0x03acdd2d,   933 },
+    { 0x8e679c2f, 0x5e44ff8f,   960 },
+    { 0xd433179d, 0x9c8cb841,   986 },
+    { 0x9e19db92, 0xb4e31ba9,  1013 },
+    { 0xeb96bf6e, 0xbadf77d9,  1039 },
+    { 0xaf87023b, 0x9bf0ee6b,  1066 },
+};
+
+static const uint32 pow10_32[] ICACHE_STORE_ATTR ICACHE_RODATA_ATTR = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+};
+
+static uint64 double_bits(double d)
+{
+    union {
+        double d;
+        uint64 u;
+    } v;
+
+    v.d = d;
+    return v.u;
+}
+
+static diy_fp_t diy_fp_multiply(diy_fp_t a, diy_fp_t b)
+{
+    const uint64 m32 = 0xffffffff;
+    uint64 ah = a.f >> 32, al = a.f & m32;
+    uint64 bh = b.f >> 32, bl = b.f & m32;
+    uint64 ah_bl = ah * bl;
+    uint64 al_bh = al * bh;
+    uint64 al_bl = al * bl;
+    uint64 tmp = (ah_bl & m32) + (al_bh & m32) + (al_bl >> 32);
+    diy_fp_t r;
+
+    tmp += (uint64)1 << 31;     /* round */
+    r.f = ah * bh + (ah_bl >> 32) + (al_bh >> 32) + (tmp >> 32);
+    r.e = a.e + b.e + DIY_SIGNIFICAND_SIZE;
+    return r;
+}
+
+/* Return the cached power c with ALPHA <= e + c.e + 64 <= GAMMA, and the
+ * negated decimal exponent of c in *mk. */
+static diy_fp_t cached_power(int e, int *mk)
+{
+    /* ceil((ALPHA - e - 1) * log10(2)), with log10(2) ~ 78913 / 2^18 */
+    int k = ((GRISU_ALPHA - e - 1) * 78913 + (1 << 18) - 1) >> 18;
+    int i = (k - CACHED_POWERS_MIN_K + CACHED_POWERS_STEP - 1) / CACHED_POWERS_STEP;
+    diy_fp_t c;
+
+    for (;;) {
+        int t = e + cached_powers[i].e + DIY_SIGNIFICAND_SIZE;
+        if (t < GRISU_ALPHA)
+            i++;
+        else if (t > GRISU_GAMMA)
+            i--;
+        else
+            break;
+    }
+    c.f = ((uint64)cached_powers[i].hi << 32) | cached_powers[i].lo;
+    c.e = cached_powers[i].e;
+    *mk = -(CACHED_POWERS_MIN_K + i * CACHED_POWERS_STEP);
+    return c;
+}
+
+/* Move the last digit towards w while staying inside the rounding
+ * interval, so the closest of the shortest candidates is produced. */
+static void grisu_round(char *buf, int len, uint64 delta, uint64 rest,
+                        uint64 ten_kappa, uint64 wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w ||
+            wp_w - rest > rest + ten_kappa - wp_w)) {
+        buf[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/* Generate the shortest digits of a positive, finite, non-zero double.
+ * The value is buf[0..len-1] * 10^*k10; returns len (at most 17). */
+static int grisu2(double v, char *buf, int *k10)
+{
+    uint64 bits = double_bits(v);
+    uint64 f = bits & DP_SIGNIFICAND_MASK;
+    int be = (int)((bits >> DP_SIGNIFICAND_SIZE) & DP_EXPONENT_MASK);
+    diy_fp_t w, wp, wm, c, one;
+    uint64 delta, wp_w, p2;
+    uint32 p1, d;
+    int e, mk, kappa, len = 0;
+
+    if (be) {
+        f += DP_HIDDEN_BIT;
+        e = be - DP_EXPONENT_BIAS;
+    } else {
+        e = 1 - DP_EXPONENT_BIAS;
+    }
+
+    /* Boundaries m+ and m- of the rounding interval, on a common exponent */
+    wp.f = (f << 1) + 1;
+    wp.e = e - 1;
+    while (!(wp.f & (DP_HIDDEN_BIT << 1))) {
+        wp.f <<= 1;
+        wp.e--;
+    }
+    wp.f <<= DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 2;
+    wp.e -= DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 2;
+    if (f == DP_HIDDEN_BIT && be > 1) {
+        wm.f = (f << 2) - 1;
+        wm.e = e - 2;
+    } else {
+        wm.f = (f << 1) - 1;
+        wm.e = e - 1;
+    }
+    wm.f <<= wm.e - wp.e;
+    wm.e = wp.e;
+
+    w.f = f;
+    w.e = e;
+    while (!(w.f & DP_HIDDEN_BIT)) {
+        w.f <<= 1;
+        w.e--;
+    }
+    w.f <<= DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 1;
+    w.e -= DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 1;
+
+    c = cached_power(wp.e, &mk);
+    w = diy_fp_multiply(w, c);
+    wp = diy_fp_multiply(wp, c);
+    wm = diy_fp_multiply(wm, c);
+    wm.f++;
+    wp.f--;
+
+    *k10 = mk;
+    delta = wp.f - wm.f;
+    wp_w = wp.f - w.f;
+    one.e = wp.e;
+    one.f = (uint64)1 << -one.e;
+    p1 = (uint32)(wp.f >> -one.e);
+    p2 = wp.f & (one.f - 1);
+
+    /* Integral part: p1 < 2^32, so at most 10 digits */
+    for (kappa = 10; kappa > 0; ) {
+        uint32 div = pow10_32[--kappa];
+        uint64 rest;
+
+        d = p1 / div;
+        if (d || len)
+            buf[len++] = '0' + d;
+        p1 %= div;
+        rest = ((uint64)p1 << -one.e) + p2;
+        if (rest <= delta) {
+            *k10 += kappa;
+            grisu_round(buf, len, delta, rest, (uint64)div << -one.e, wp_w);
+            return len;
+        }
+    }
+
+    /* Fractional part */
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        wp_w *= 10;
+        kappa--;
+        d = (uint32)(p2 >> -one.e);
+        if (d || len)
+            buf[len++] = '0' + d;
+        p2 &= one.f - 1;
+        if (p2 < delta) {
+            *k10 += kappa;
+            grisu_round(buf, len, delta, p2, one.f, wp_w);
+            return len;
+        }
+    }
+}
+
+static char *fmt_uint(char *str, uint64 u)
+{
+    char tmp[20];
+    int n = 0;
+
+    /* 32 bit division is considerably cheaper on this CPU */
+    while (u > 0xffffffff) {
+        tmp[n++] = '0' + (int)(u % 10);
+        u /= 10;
+    }
+    {
+        uint32 u32 = (uint32)u;
+        do {
+            tmp[n++] = '0' + u32 % 10;
+            u32 /= 10;
+        } while (u32);
+    }
+    while (n)
+        *str++ = tmp[--n];
+    return str;
+}
+
+/* Format num like c_sprintf("%.<precision>g") into str, which must hold
+ * FPCONV_G_FMT_BUFSIZE characters. Returns the length written. */
+int fpconv_g_fmt(char *str, double num, int precision)
+{
+    char digits[18];
+    char *p = str;
+    double v = num;
+    int len, k = 0, exp10, i;
+
+    if (!(1 <= precision && precision <= 14))
+        precision = 14;
+
+    if (double_bits(num) >> 63) {
+        *p++ = '-';
+        num = -num;
+    }
+
+    /* Integers are by far the most common numbers in JSON payloads. Those
+     * with no more than "precision" digits print as plain digits. */
+    if (num < 1e14) {
+        char *end = NULL;
+
+        if (num < 4294967296.0) {
+            uint32 u32 = (uint32)num;
+            if ((double)u32 == num)
+                end = fmt_uint(p, u32);
+        } else {
+            uint64 u64 = (uint64)num;
+            if ((double)u64 == num)
+                end = fmt_uint(p, u64);
+        }
+        if (end && end - p <= precision) {
+            *end = 0;
+            return end - str;
+        }
+    }
+
+    /* NaN, Infinity and subnormals go to c_sprintf(). The shortest digits
+     * of a subnormal can be fewer than %g prints, as its spacing is wider
+     * than the requested precision. */
+    if (num != num || num - num != 0 || num < 2.2250738585072014e-308)
+        len = precision + 1;
+    else
+        len = grisu2(num, digits, &k);
+    while (len > 1 && len <= precision && digits[len - 1] == '0') {
+        len--;
+        k++;
+    }
+    if (len > precision) {
+        char fmt[6] = "%.14g";
+
+        fmt[2] = '0' + precision / 10;
+        fmt[3] = '0' + precision % 10;
+        c_sprintf(str, fmt, v);
+        return c_strlen(str);
+    }
+
+    exp10 = len + k - 1;
+    if (exp10 < -4 || exp10 >= precision) {
+        /* d.ddde[+-]xx */
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            for (i = 1; i < len; i++)
+                *p++ = digits[i];
+        }
+        *p++ = 'e';
+        if (exp10 < 0) {
+            *p++ = '-';
+            exp10 = -exp10;
+        } else {
+            *p++ = '+';
+        }
+        if (exp10 < 10)
+            *p++ = '0';
+        p = fmt_uint(p, exp10);
+    } else if (exp10 < 0) {
+        /* 0.000ddd */
+        *p++ = '0';
+        *p++ = '.';
+        for (i = -1; i > exp10; i--)
+            *p++ = '0';
+        for (i = 0; i < len; i++)
+            *p++ = digits[i];
+    } else {
+        /* ddd.ddd or ddd000 */
+        for (i = 0; i < len || i <= exp10; i++) {
+            if (i == exp10 + 1)
+                *p++ = '.';
+            *p++ = i < len ? digits[i] : '0';
+        }
+    }
+    *p = 0;
+    return p - str;
+}
+
 /* vi:ai et sw=4 ts=4:
  */
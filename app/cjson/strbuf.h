@@ -22,6 +22,9 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#ifndef _STRBUF_H_
+#define _STRBUF_H_
+
 #include "c_stdlib.h"
 #include "c_stdarg.h"
 #include "user_config.h"
@@ -151,5 +154,7 @@ static inline char *strbuf_string(strbuf_t *s, int *len)
     return s->buf;
 }
 
+#endif
+
 /* vi:ai et sw=4 ts=4:
  */
@@ -0,0 +1,270 @@
+/* Host runner for the firmware's cjson, cbor and net modules
+ *
+ * Builds app/modules/cjson.c, cbor.c and net.c, the last over the SDK
+ * stand-in in sdk.c, against the NodeMCU Lua VM compiled
+ * for the host, so the conformance and benchmark scripts exercise exactly
+ * the code that ships, rotables and all. Every heap allocation made by the VM and
+ * by cjson's strbufs goes through the wrappers below, which keep the live
+ * and peak byte counts and can refuse allocations past a limit to
+ * simulate the device's small heap.
+ *
+ * Extra globals for scripts:
+ *   clock()          CPU time in seconds
+ *   readfile(name)   whole file as a string
+ *   writefile(name, data)
+ *                    replace a file with the given string
+ *   heap()           live bytes, peak bytes
+ *   heap_reset()     restart the peak at the live count
+ *   heap_limit(n)    fail allocations beyond n live bytes (0: no limit)
+ *   lazyload([mode]) node.lazyload(): set the lazy undump mode, return
+ *                    the previous one
+ *   sink             a cjson.encode_to() sink whose __sink returns the
+ *                    payload as a string, then its other arguments
+ *   sdk              the SDK's side of net connections, see sdk.c
+ *   arg              script arguments
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <time.h>
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lrotable.h"
+#include "legc.h"
+#include "lstate.h"
+#include "lundump.h"
+
+/* cjson_map, cbor_map and net_map are static, so the modules are compiled
+ * as part of this file */
+#include "../../../modules/cjson.c"
+#include "../../../modules/cbor.c"
+#include "../../../modules/net.c"
+
+extern int luaopen_base(lua_State *L);
+extern int luaopen_string(lua_State *L);
+extern int luaopen_table(lua_State *L);
+extern int luaopen_debug(lua_State *L);
+extern int host_sdk_open(lua_State *L);
+extern const luaR_entry strlib[], tab_funcs[], math_map[], dblib[],
+                        co_funcs[];
+
+const luaL_Reg lua_libs[] = {
+  { "",       luaopen_base },
+  { "string", luaopen_string },
+  { "table",  luaopen_table },
+  { "debug",  luaopen_debug },
+  { "cjson",  luaopen_cjson },
+  { "cbor",   luaopen_cbor },
+  { "net",    luaopen_net },
+  { NULL, NULL }
+};
+
+const luaR_table lua_rotable[] = {
+  { "string", strlib },
+  { "table",  tab_funcs },
+  { "math",   math_map },
+  { "debug",  dblib },
+  { "coroutine", co_funcs },
+  { "cjson",  cjson_map },
+  { "cbor",   cbor_map },
+  { "net",    net_map },
+  { NULL, NULL }
+};
+
+/* ===== HEAP ACCOUNTING ===== */
+
+static size_t heap_live, heap_peak, heap_max;
+
+extern void *__real_malloc(size_t size);
+extern void *__real_realloc(void *ptr, size_t size);
+extern void *__real_calloc(size_t n, size_t size);
+extern void __real_free(void *ptr);
+
+static int heap_admit(size_t grow)
+{
+  if (heap_max && heap_live + grow > heap_max)
+    return 0;
+  return 1;
+}
+
+static void *heap_account(void *p)
+{
+  if (p) {
+    heap_live += malloc_usable_size(p);
+    if (heap_live > heap_peak)
+      heap_peak = heap_live;
+  }
+  return p;
+}
+
+void *__wrap_malloc(size_t size)
+{
+  return heap_admit(size) ? heap_account(__real_malloc(size)) : NULL;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+  return heap_admit(n * size) ? heap_account(__real_calloc(n, size)) : NULL;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  size_t old = ptr ? malloc_usable_size(ptr) : 0;
+  void *p;
+
+  if (size > old && !heap_admit(size - old))
+    return NULL;
+  p = __real_realloc(ptr, size);
+  if (p || size == 0)
+    heap_live -= old;
+  return size ? heap_account(p) : p;
+}
+
+void __wrap_free(void *ptr)
+{
+  if (ptr)
+    heap_live -= malloc_usable_size(ptr);
+  __real_free(ptr);
+}
+
+/* ===== SCRIPT GLOBALS ===== */
+
+static int host_clock(lua_State *L)
+{
+  lua_pushnumber(L, (lua_Number)clock() / CLOCKS_PER_SEC);
+  return 1;
+}
+
+static int host_readfile(lua_State *L)
+{
+  const char *name = luaL_checkstring(L, 1);
+  luaL_Buffer b;
+  size_t n;
+  FILE *f = fopen(name, "rb");
+
+  if (!f)
+    return luaL_error(L, "Unable to read '%s'", name);
+  luaL_buffinit(L, &b);
+  do {
+    char *p = luaL_prepbuffer(&b);
+    n = fread(p, 1, LUAL_BUFFERSIZE, f);
+    luaL_addsize(&b, n);
+  } while (n == LUAL_BUFFERSIZE);
+  fclose(f);
+  luaL_pushresult(&b);
+  return 1;
+}
+
+static int host_writefile(lua_State *L)
+{
+  const char *name = luaL_checkstring(L, 1);
+  size_t len;
+  const char *data = luaL_checklstring(L, 2, &len);
+  FILE *f = fopen(name, "wb");
+
+  if (!f || fwrite(data, 1, len, f) != len) {
+    if (f)
+      fclose(f);
+    return luaL_error(L, "Unable to write '%s'", name);
+  }
+  fclose(f);
+  return 0;
+}
+
+static int host_heap(lua_State *L)
+{
+  lua_pushnumber(L, heap_live);
+  lua_pushnumber(L, heap_peak);
+  return 2;
+}
+
+static int host_heap_reset(lua_State *L)
+{
+  heap_peak = heap_live;
+  return 0;
+}
+
+static int host_heap_limit(lua_State *L)
+{
+  heap_max = (size_t)luaL_checknumber(L, 1);
+  return 0;
+}
+
+/* Same as node.lazyload() in app/modules/node.c */
+static int host_lazyload(lua_State *L)
+{
+  global_State *g = G(L);
+  int prev = g->lazymode;
+
+  if (lua_gettop(L) >= 1) {
+    int mode = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, mode >= LUA_LAZY_OFF && mode <= LUA_LAZY_DROP, 1, "invalid mode");
+    g->lazymode = mode;
+  }
+  lua_pushinteger(L, prev);
+  return 1;
+}
+
+/* Takes the payload through luaL_checkpayload(), as the firmware's sinks do */
+static int host_sink(lua_State *L)
+{
+  size_t len;
+  const char *p = luaL_checkpayload(L, 2, &len);
+
+  lua_pushlstring(L, p, len);
+  lua_replace(L, 2);
+  return lua_gettop(L) - 1;
+}
+
+int main(int argc, char **argv)
+{
+  const luaL_Reg *lib;
+  lua_State *L;
+  int i, status;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s script.lua [args]\n", argv[0]);
+    return 2;
+  }
+
+  L = luaL_newstate();
+  /* The firmware runs a full collection before every allocation; only do
+   * it when an allocation fails, so timings stay meaningful while a heap
+   * limit still behaves like the device */
+  legc_set_mode(L, EGC_ON_ALLOC_FAILURE, 0);
+  for (lib = lua_libs; lib->func; lib++) {
+    lua_pushcfunction(L, lib->func);
+    lua_pushstring(L, lib->name);
+    lua_call(L, 1, 0);
+  }
+
+  lua_register(L, "clock", host_clock);
+  lua_register(L, "readfile", host_readfile);
+  lua_register(L, "writefile", host_writefile);
+  lua_register(L, "heap", host_heap);
+  lua_register(L, "heap_reset", host_heap_reset);
+  lua_register(L, "heap_limit", host_heap_limit);
+  lua_register(L, "lazyload", host_lazyload);
+  lua_newtable(L);
+  lua_pushcfunction(L, host_sink);
+  lua_setfield(L, -2, "__sink");
+  lua_setglobal(L, "sink");
+  host_sdk_open(L);
+  lua_newtable(L);
+  for (i = 2; i < argc; i++) {
+    lua_pushstring(L, argv[i]);
+    lua_rawseti(L, -2, i - 1);
+  }
+  lua_setglobal(L, "arg");
+
+  status = luaL_loadfile(L, argv[1]) || lua_pcall(L, 0, 1, 0);
+  if (status) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+    return 1;
+  }
+  status = lua_isnumber(L, -1) ? (int)lua_tonumber(L, -1) : 0;
+  lua_close(L);
+  return status;
+}
@@ -0,0 +1 @@
+#include <math.h>
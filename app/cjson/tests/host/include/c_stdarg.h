@@ -0,0 +1 @@
+#include <stdarg.h>
@@ -0,0 +1,5 @@
+#include <stdio.h>
+#define c_printf printf
+#define c_sprintf sprintf
+#define c_snprintf snprintf
+#define c_vsprintf vsprintf
@@ -0,0 +1,8 @@
+#include <stdlib.h>
+#define c_malloc malloc
+#define c_zalloc(n) calloc(1, n)
+#define c_realloc realloc
+#define c_free free
+#define c_abs abs
+#define c_strtod strtod
+#define c_strtol strtol
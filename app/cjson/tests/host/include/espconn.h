@@ -0,0 +1,103 @@
+/* Host stand-in for the SDK's espconn.h, with the types and calls net.c
+ * uses. sdk.c implements the calls */
+#ifndef __ESPCONN_H__
+#define __ESPCONN_H__
+
+#include "lwip/ip_addr.h"
+
+typedef void (* espconn_connect_callback)(void *arg);
+typedef void (* espconn_reconnect_callback)(void *arg, sint8 err);
+
+#define ESPCONN_OK          0
+#define ESPCONN_MEM        -1
+#define ESPCONN_TIMEOUT    -3
+#define ESPCONN_RTE        -4
+#define ESPCONN_INPROGRESS -5
+#define ESPCONN_MAXNUM     -7
+#define ESPCONN_ABRT       -8
+#define ESPCONN_RST        -9
+#define ESPCONN_CLSD       -10
+#define ESPCONN_CONN       -11
+#define ESPCONN_ARG        -12
+#define ESPCONN_IF         -14
+#define ESPCONN_ISCONN     -15
+
+enum espconn_type {
+  ESPCONN_INVALID = 0,
+  ESPCONN_TCP     = 0x10,
+  ESPCONN_UDP     = 0x20,
+};
+
+enum espconn_state {
+  ESPCONN_NONE,
+  ESPCONN_WAIT,
+  ESPCONN_LISTEN,
+  ESPCONN_CONNECT,
+  ESPCONN_WRITE,
+  ESPCONN_READ,
+  ESPCONN_CLOSE
+};
+
+typedef struct _esp_tcp {
+  int remote_port;
+  int local_port;
+  uint8 local_ip[4];
+  uint8 remote_ip[4];
+  espconn_connect_callback connect_callback;
+  espconn_reconnect_callback reconnect_callback;
+  espconn_connect_callback disconnect_callback;
+  espconn_connect_callback write_finish_fn;
+} esp_tcp;
+
+typedef struct _esp_udp {
+  int remote_port;
+  int local_port;
+  uint8 local_ip[4];
+  uint8 remote_ip[4];
+} esp_udp;
+
+typedef struct _remot_info {
+  enum espconn_state state;
+  int remote_port;
+  uint8 remote_ip[4];
+} remot_info;
+
+typedef void (* espconn_recv_callback)(void *arg, char *pdata, unsigned short len);
+typedef void (* espconn_sent_callback)(void *arg);
+
+struct espconn {
+  enum espconn_type type;
+  enum espconn_state state;
+  union {
+    esp_tcp *tcp;
+    esp_udp *udp;
+  } proto;
+  espconn_recv_callback recv_callback;
+  espconn_sent_callback sent_callback;
+  uint8 link_cnt;
+  void *reverse;
+};
+
+typedef void (*dns_found_callback)(const char *name, ip_addr_t *ipaddr, void *callback_arg);
+
+sint8 espconn_connect(struct espconn *espconn);
+sint8 espconn_disconnect(struct espconn *espconn);
+sint8 espconn_delete(struct espconn *espconn);
+sint8 espconn_accept(struct espconn *espconn);
+sint8 espconn_create(struct espconn *espconn);
+sint8 espconn_sent(struct espconn *espconn, uint8 *psent, uint16 length);
+sint8 espconn_regist_time(struct espconn *espconn, uint32 interval, uint8 type_flag);
+sint8 espconn_regist_sentcb(struct espconn *espconn, espconn_sent_callback sent_cb);
+sint8 espconn_regist_recvcb(struct espconn *espconn, espconn_recv_callback recv_cb);
+sint8 espconn_regist_connectcb(struct espconn *espconn, espconn_connect_callback connect_cb);
+sint8 espconn_regist_reconcb(struct espconn *espconn, espconn_reconnect_callback recon_cb);
+sint8 espconn_regist_disconcb(struct espconn *espconn, espconn_connect_callback discon_cb);
+uint32 espconn_port(void);
+sint8 espconn_get_connection_info(struct espconn *pespconn, remot_info **pcon_info, uint8 typeflags);
+sint8 espconn_recv_hold(struct espconn *pespconn);
+sint8 espconn_recv_unhold(struct espconn *pespconn);
+err_t espconn_gethostbyname(struct espconn *pespconn, const char *hostname, ip_addr_t *addr, dns_found_callback found);
+sint8 espconn_igmp_join(ip_addr_t *host_ip, ip_addr_t *multicast_ip);
+sint8 espconn_igmp_leave(ip_addr_t *host_ip, ip_addr_t *multicast_ip);
+
+#endif
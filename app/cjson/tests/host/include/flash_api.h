@@ -0,0 +1,7 @@
+/* Host stand-in for app/platform/flash_api.h */
+#include "c_types.h"
+
+static inline uint8_t byte_of_aligned_array(const uint8_t *aligned_array, uint32_t index)
+{
+  return aligned_array[index];
+}
@@ -0,0 +1,7 @@
+/* Host stand-in for lwip/dns.h */
+#include "lwip/ip_addr.h"
+
+#define DNS_MAX_SERVERS 2
+
+void dns_setserver(uint8 numdns, ip_addr_t *dnsserver);
+ip_addr_t dns_getserver(uint8 numdns);
@@ -0,0 +1,25 @@
+/* Host stand-in for lwip/ip_addr.h */
+#ifndef __LWIP_IP_ADDR_H__
+#define __LWIP_IP_ADDR_H__
+
+#include "c_types.h"
+
+typedef sint8 err_t;
+typedef uint32 u32_t;
+
+typedef struct ip_addr {
+  uint32 addr;
+} ip_addr_t;
+
+#define IPADDR_NONE         ((uint32)0xffffffffUL)
+#define IPADDR_ANY          ((uint32)0x00000000UL)
+#define ip_addr_isany(a)    ((a) == NULL || (a)->addr == IPADDR_ANY)
+#define ip4_addr_set_u32(a, u) ((a)->addr = (u))
+
+#define IP2STR(ipaddr) ((uint8 *)(ipaddr))[0], ((uint8 *)(ipaddr))[1], \
+                       ((uint8 *)(ipaddr))[2], ((uint8 *)(ipaddr))[3]
+#define IPSTR "%d.%d.%d.%d"
+
+uint32 ipaddr_addr(const char *cp);
+
+#endif
@@ -0,0 +1,5 @@
+/* Host stand-in for the SDK's mem.h */
+#include <stdlib.h>
+#define os_malloc malloc
+#define os_zalloc(n) calloc(1, n)
+#define os_free free
@@ -0,0 +1,27 @@
+/* Host stand-in for app/platform/platform.h: the SDK timer and os_* calls
+ * net.c reaches through it. sdk.c implements the timers */
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+#include <string.h>
+#include <strings.h>
+#include "c_types.h"
+#include "c_stdio.h"
+
+typedef void (*os_timer_func_t)(void *arg);
+
+typedef struct os_timer {
+  os_timer_func_t func;
+  void *arg;
+} os_timer_t;
+
+void os_timer_setfn(os_timer_t *t, os_timer_func_t func, void *arg);
+void os_timer_arm(os_timer_t *t, uint32_t ms, bool repeat);
+void os_timer_disarm(os_timer_t *t);
+
+#define os_memmove memmove
+
+/* the SDK's libc provides stricmp() */
+#define stricmp strcasecmp
+
+#endif
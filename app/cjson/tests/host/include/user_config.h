@@ -0,0 +1,16 @@
+/* Host stand-in for app/include/user_config.h */
+#ifndef __USER_CONFIG_H__
+#define __USER_CONFIG_H__
+
+#include "c_types.h"
+
+#define ICACHE_STORE_TYPEDEF_ATTR __attribute__((aligned(4),packed))
+#define ICACHE_STORE_ATTR __attribute__((aligned(4)))
+
+#define NODE_ERR printf
+#define NODE_DBG(...)
+
+#define LUA_OPTIMIZE_MEMORY 2
+#define MIN_OPT_LEVEL 2
+
+#endif
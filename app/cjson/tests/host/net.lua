@@ -0,0 +1,328 @@
+-- Tests for the net module over the SDK stand-in in sdk.c, run by the host
+-- runner (see Makefile):
+--
+--   cjson_host net.lua
+--
+-- The script plays the remote end and the SDK's event loop through the
+-- sdk global; nothing goes over a network.
+
+local tests = {}
+
+-- espconn error codes
+local ESPCONN_MEM = -1
+local ESPCONN_CONN = -11
+local ESPCONN_ARG = -12
+
+-- ===== HELPERS =====
+
+local function serialise(t)
+  local out = { }
+  for i = 1, #t do out[i] = tostring(t[i]) end
+  return "{ " .. table.concat(out, ", ") .. " }"
+end
+
+local function same(a, b)
+  if #a ~= #b then return false end
+  for i = 1, #a do
+    if a[i] ~= b[i] then return false end
+  end
+  return true
+end
+
+-- A TCP socket whose connection is pending, until sdk.connect()
+local function open()
+  local s = net.createConnection(net.TCP)
+  s:connect(80, "127.0.0.1")
+  return s
+end
+
+-- A sent() callback for s that logs "tag err"
+local function logger(s, log, tag)
+  return function(c, err)
+    log[#log + 1] = (c == s and "" or "wrong socket ") .. tag .. " " .. tostring(err)
+  end
+end
+
+-- Takes what espconn accepted since the last call and appends it to log as
+-- "#len" per segment; returns the segments joined
+local function take(log)
+  local segs = sdk.segments()
+  for i = 1, #segs do log[#log + 1] = "#" .. #segs[i] end
+  return table.concat(segs)
+end
+
+-- Fires the armed timers, then appends "timers n" to log, after whatever
+-- their callbacks logged
+local function tick(log)
+  local n = sdk.timers()
+  log[#log + 1] = "timers " .. n
+end
+
+-- ===== TESTS =====
+
+-- espconn refuses data until the connection is up, so a payload sent
+-- before it waits for it instead of failing
+local function send_before_connect()
+  local log = {}
+  local s = open()
+  s:send("hello", logger(s, log, "sent"))
+  take(log)
+  log[#log + 1] = "connect"
+  sdk.connect()
+  local data = take(log)
+  log[#log + 1] = data
+  sdk.sent()
+  sdk.disconnect()
+  return unpack(log)
+end
+tests[#tests + 1] = { "Send before the connection is up",
+  send_before_connect, { }, true,
+  { "connect", "#5", "hello", "sent nil" } }
+
+-- A segment refused for lack of buffers goes again from the timer
+local function send_mem_retry()
+  local log = {}
+  local s = open()
+  sdk.connect()
+  sdk.refuse(ESPCONN_MEM, 2)
+  s:send("abc", logger(s, log, "sent"))
+  for i = 1, 3 do
+    take(log)
+    tick(log)
+  end
+  sdk.sent()
+  sdk.disconnect()
+  return unpack(log)
+end
+tests[#tests + 1] = { "Retry after ESPCONN_MEM",
+  send_mem_retry, { }, true,
+  { "timers 1", "timers 1", "#3", "timers 0", "sent nil" } }
+
+-- ...but not forever
+local function send_mem_give_up()
+  local log = {}
+  local s = open()
+  sdk.connect()
+  sdk.refuse(ESPCONN_MEM, 1000)
+  s:send("abc", logger(s, log, "sent"))
+  local fired = 0
+  while sdk.timers() > 0 do fired = fired + 1 end
+  sdk.refuse(0, 0)
+  take(log)
+  sdk.disconnect()
+  return fired, unpack(log)
+end
+tests[#tests + 1] = { "Give up after ESPCONN_MEM persists",
+  send_mem_give_up, { }, true, { 50, "sent -1" } }
+
+-- Any other refusal fails the payload at once, and the next one goes on
+local function send_arg_give_up()
+  local log = {}
+  local s = open()
+  sdk.connect()
+  sdk.refuse(ESPCONN_ARG)
+  s:send("lost", logger(s, log, "lost"))
+  s:send("next", logger(s, log, "next"))
+  take(log)
+  tick(log)
+  take(log)
+  sdk.sent()
+  tick(log)
+  sdk.disconnect()
+  return unpack(log)
+end
+tests[#tests + 1] = { "Give up after ESPCONN_ARG",
+  send_arg_give_up, { }, true,
+  { "lost -12", "timers 1", "#4", "next nil", "timers 0" } }
+
+-- A payload longer than a segment goes out in pieces, each acknowledged
+-- before the next, with one callback per payload once all of it is out
+local function send_two_queued()
+  local log = {}
+  local s = open()
+  sdk.connect()
+  local big = string.rep("0123456789", 300)
+  s:send(big, logger(s, log, "big"))
+  s:send("tail", logger(s, log, "tail"))
+  local out = {}
+  for i = 1, 4 do
+    out[i] = take(log)
+    sdk.sent()
+  end
+  sdk.disconnect()
+  return table.concat(out) == big .. "tail", unpack(log)
+end
+tests[#tests + 1] = { "Two queued sends, each with its callback",
+  send_two_queued, { }, true,
+  { true, "#1460", "#1460", "#80", "big nil", "#4", "tail nil" } }
+
+-- An empty payload still gets its callback, though not from inside send(),
+-- and in its turn
+local function send_empty()
+  local log = {}
+  local s = open()
+  sdk.connect()
+  s:send("", logger(s, log, "empty"))
+  s:send("x", logger(s, log, "x"))
+  log[#log + 1] = "sent"
+  take(log)
+  tick(log)
+  take(log)
+  sdk.sent()
+  sdk.disconnect()
+  return unpack(log)
+end
+tests[#tests + 1] = { "Empty send",
+  send_empty, { }, true,
+  { "sent", "empty nil", "timers 1", "#1", "x nil" } }
+
+-- Without a callback of its own, a payload reports to on("sent")
+local function send_on_sent()
+  local log = {}
+  local s = open()
+  sdk.connect()
+  s:on("sent", logger(s, log, "on"))
+  s:send("a")
+  s:send("b", logger(s, log, "own"))
+  for i = 1, 2 do
+    take(log)
+    sdk.sent()
+  end
+  sdk.disconnect()
+  return unpack(log)
+end
+tests[#tests + 1] = { "on(\"sent\") for payloads without a callback",
+  send_on_sent, { }, true,
+  { "#1", "on nil", "#1", "own nil" } }
+
+-- connect() on a connected socket starts a new connection, which sends
+-- wait for again
+local function send_after_reconnect()
+  local log = {}
+  local s = open()
+  sdk.connect()
+  s:connect(80, "127.0.0.1")
+  s:send("again", logger(s, log, "sent"))
+  take(log)
+  tick(log)
+  sdk.connect()
+  take(log)
+  sdk.sent()
+  sdk.disconnect()
+  return unpack(log)
+end
+tests[#tests + 1] = { "Send while connecting again",
+  send_after_reconnect, { }, true,
+  { "timers 0", "#5", "sent nil" } }
+
+-- Sends still queued when the connection fails are dropped quietly
+local function send_connect_failed()
+  local log = {}
+  local s = open()
+  s:send("never", logger(s, log, "sent"))
+  sdk.reconnect(ESPCONN_CONN)
+  take(log)
+  tick(log)
+  return unpack(log)
+end
+tests[#tests + 1] = { "Connection failure drops the queue",
+  send_connect_failed, { }, true, { "timers 0" } }
+
+-- A net.buffer answers as the string functions do on the received data;
+-- returns a line for each call where they differ
+local BUFFER_DATA = "GET /index.html HTTP/1.1\r\n\r\n"
+local BUFFER_CALLS = {
+  { "sub", 1 }, { "sub", 5 }, { "sub", -4 }, { "sub", 0 }, { "sub", 5, 9 },
+  { "sub", 5, -1 }, { "sub", -100, 3 }, { "sub", 3, 100 }, { "sub", 10, 5 },
+  { "sub", -3, -2 }, { "sub", 100 },
+  { "byte" }, { "byte", 1 }, { "byte", -1 }, { "byte", 0 }, { "byte", 3, 7 },
+  { "byte", -3, -1 }, { "byte", 100 }, { "byte", 10, 5 }, { "byte", -100, 2 },
+  { "find", "HTTP" }, { "find", "HTTP", 10 }, { "find", "HTTP", 20 },
+  { "find", "\r\n\r\n" }, { "find", "", 1 }, { "find", "", 100 },
+  { "find", "x", 100 }, { "find", "GET", -100 }, { "find", "1", -5 },
+  { "find", "1.1", -3 }, { "find", "missing" }, { "find", "." },
+}
+local function buffer_methods(data)
+  local bad = {}
+  local function check(what, got, want)
+    local g, w = serialise(got), serialise(want)
+    if g ~= w then bad[#bad + 1] = what .. ": " .. g .. " ~= " .. w end
+  end
+  local s = open()
+  s:on("receive", function(c, buf)
+    for _, call in ipairs(BUFFER_CALLS) do
+      local name, args = call[1], { unpack(call, 2) }
+      local want = name == "find" and { data:find(args[1], args[2], true) } or
+                   { data[name](data, unpack(args)) }
+      check(name .. serialise(args), { buf[name](buf, unpack(args)) }, want)
+    end
+    check("#", { #buf }, { #data })
+    check("tostring", { tostring(buf), buf:tostring() }, { data, data })
+    for _, i in ipairs({ 1, 4, -1, 0, #data + 1, -#data - 1 }) do
+      check("[" .. i .. "]", { buf[i] }, { data:byte(i) })
+    end
+  end, "buffer")
+  sdk.connect()
+  sdk.receive(data)
+  sdk.disconnect()
+  return unpack(bad)
+end
+tests[#tests + 1] = { "net.buffer methods",
+  buffer_methods, { BUFFER_DATA }, true, { } }
+tests[#tests + 1] = { "net.buffer methods, nothing received",
+  buffer_methods, { "" }, true, { } }
+
+-- The SDK's data is gone once the receive callback returns, so a buffer
+-- kept past it must refuse to read
+local function buffer_after_callback()
+  local kept
+  local s = open()
+  s:on("receive", function(c, buf) kept = buf end, "buffer")
+  sdk.connect()
+  sdk.receive(BUFFER_DATA)
+  sdk.disconnect()
+  local out = {}
+  for _, f in ipairs({
+    function() return kept:sub(1) end,
+    function() return kept:byte(1) end,
+    function() return kept:find("GET") end,
+    function() return #kept end,
+    function() return kept[1] end,
+    function() return tostring(kept) end,
+  }) do
+    local ok, err = pcall(f)
+    out[#out + 1] = ok and "read" or (err:gsub("^[^:]*:%d+: ", ""))
+  end
+  return unpack(out)
+end
+local OUTSIDE = "buffer used outside its receive callback"
+tests[#tests + 1] = { "net.buffer kept past its callback",
+  buffer_after_callback, { }, true,
+  { OUTSIDE, OUTSIDE, OUTSIDE, OUTSIDE, OUTSIDE, OUTSIDE } }
+
+-- ===== RUNNER =====
+
+local pass = 0
+for i, t in ipairs(tests) do
+  local name, func, args, want_ok, want = t[1], t[2], t[3], t[4], t[5]
+  local result = { pcall(func, unpack(args)) }
+  local ok = table.remove(result, 1)
+  if not ok then
+    result[1] = tostring(result[1]):gsub("^[^:]*:%d+: ", "")
+  end
+  if ok == want_ok and same(result, want) then
+    pass = pass + 1
+    print(("==> Test [%d] %s: PASS"):format(i, name))
+  else
+    print(("==> Test [%d] %s: FAIL"):format(i, name))
+    print("    Expected: " .. serialise(want))
+    print("    Got:      " .. serialise(result))
+  end
+end
+
+if pass == #tests then
+  print("==> Summary: all net tests succeeded")
+  return 0
+end
+print(("==> Summary: %d/%d net tests failed"):format(#tests - pass, #tests))
+return 1
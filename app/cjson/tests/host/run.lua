@@ -0,0 +1,623 @@
+-- Conformance tests and benchmarks for the firmware cjson module, run by
+-- the host runner (see Makefile):
+--
+--   cjson_host run.lua check [fixture.json ...]
+--   cjson_host run.lua bench [--heap=bytes] [fixture.json ...]
+--
+-- The conformance cases are those of ../test.lua that apply to the
+-- firmware build, which has no configuration functions and runs with
+-- cjson's defaults.
+
+local json = cjson
+-- The firmware build has no cjson.null field; nulls decode as a NULL
+-- lightuserdata
+local null = json.decode("null")
+local TESTDIR = "../"
+
+local mode = arg[1] or "check"
+local fixtures = {}
+local heap_max = 0
+for i = 2, #arg do
+  local n = arg[i]:match("^%-%-heap=(%d+)$")
+  if n then heap_max = tonumber(n) else fixtures[#fixtures + 1] = arg[i] end
+end
+
+-- ===== HELPERS =====
+
+local function compare_values(a, b)
+  if type(a) ~= type(b) then return false end
+  if type(a) == "number" then return a == b or (a ~= a and b ~= b) end
+  if type(a) ~= "table" then return a == b end
+  for k, v in pairs(a) do
+    if not compare_values(v, b[k]) then return false end
+  end
+  for k, v in pairs(b) do
+    if a[k] == nil then return false end
+  end
+  return true
+end
+
+local function serialise(v)
+  if v == null then return "null" end
+  if type(v) == "string" then
+    if #v > 40 then return ("%q"):format(v:sub(1, 40)) .. "..." end
+    return ("%q"):format(v)
+  end
+  if type(v) ~= "table" then return tostring(v) end
+  local parts = {}
+  for k, x in pairs(v) do
+    parts[#parts + 1] = "[" .. serialise(k) .. "] = " .. serialise(x)
+  end
+  return "{ " .. table.concat(parts, ", ") .. " }"
+end
+
+-- Encode each code point as UTF-8, to check \uXXXX decoding
+local function utf8_char(c)
+  if c < 0x80 then return string.char(c) end
+  if c < 0x800 then
+    return string.char(0xc0 + math.floor(c / 0x40), 0x80 + c % 0x40)
+  end
+  if c < 0x10000 then
+    return string.char(0xe0 + math.floor(c / 0x1000),
+                       0x80 + math.floor(c / 0x40) % 0x40, 0x80 + c % 0x40)
+  end
+  return string.char(0xf0 + math.floor(c / 0x40000),
+                     0x80 + math.floor(c / 0x1000) % 0x40,
+                     0x80 + math.floor(c / 0x40) % 0x40, 0x80 + c % 0x40)
+end
+
+local function gen_utf16()
+  local esc, raw = {}, {}
+  local function add(c, ...)
+    for _, e in ipairs({...}) do esc[#esc + 1] = ("\\u%04X"):format(e) end
+    raw[#raw + 1] = utf8_char(c)
+  end
+  for c = 0, 0xd7ff do add(c, c) end
+  for c = 0xe000, 0xffff do add(c, c) end
+  for c = 0x10000, 0x10ffff, 0x3ff do
+    local v = c - 0x10000
+    add(c, 0xd800 + math.floor(v / 0x400), 0xdc00 + v % 0x400)
+  end
+  return '"' .. table.concat(esc) .. '"', table.concat(raw)
+end
+
+-- Small deterministic generator for chunk sizes
+local seed = 12345
+local function rand(n)
+  seed = (seed * 1103515245 + 12345) % 2147483648
+  return seed % n + 1
+end
+
+-- ===== CONFORMANCE =====
+
+local function conformance()
+  local Inf = math.huge
+  local NaN = math.huge * 0
+
+  local octets = {}
+  for i = 0, 255 do octets[i + 1] = string.char(i) end
+  octets = table.concat(octets)
+  local octets_escaped = readfile(TESTDIR .. "octets-escaped.dat")
+  local utf16_escaped, utf8_raw = gen_utf16()
+
+  local cycle = {}
+  cycle[1] = cycle
+  local big = {}
+  for i = 1, 1100 do big = { { 10, false, true, null }, "string", a = big } end
+
+  local tests = {
+    { "Decode string", json.decode, { '"test string"' }, true, { "test string" } },
+    { "Decode numbers", json.decode, { '[ 0.0, -5e3, -1, 0.3e-3, 1023.2, 0e10 ]' },
+      true, { { 0.0, -5000, -1, 0.0003, 1023.2, 0 } } },
+    { "Decode null", json.decode, { 'null' }, true, { null } },
+    { "Decode true", json.decode, { 'true' }, true, { true } },
+    { "Decode false", json.decode, { 'false' }, true, { false } },
+    { "Decode object with numeric keys", json.decode, { '{ "1": "one", "3": "three" }' },
+      true, { { ["1"] = "one", ["3"] = "three" } } },
+    { "Decode object with string keys", json.decode, { '{ "a": "a", "b": "b" }' },
+      true, { { a = "a", b = "b" } } },
+    { "Decode array", json.decode, { '[ "one", null, "three" ]' },
+      true, { { "one", null, "three" } } },
+
+    { "Decode UTF-16BE [throw error]", json.decode, { '\0"\0"' },
+      false, { "JSON parser does not support UTF-16 or UTF-32" } },
+    { "Decode UTF-16LE [throw error]", json.decode, { '"\0"\0' },
+      false, { "JSON parser does not support UTF-16 or UTF-32" } },
+    { "Decode UTF-32BE [throw error]", json.decode, { '\0\0\0"' },
+      false, { "JSON parser does not support UTF-16 or UTF-32" } },
+    { "Decode UTF-32LE [throw error]", json.decode, { '"\0\0\0' },
+      false, { "JSON parser does not support UTF-16 or UTF-32" } },
+    { "Decode partial JSON [throw error]", json.decode, { '{ "unexpected eof": ' },
+      false, { "Expected value but found T_END at character 21" } },
+    { "Decode with extra comma [throw error]", json.decode, { '{ "extra data": true }, false' },
+      false, { "Expected the end but found T_COMMA at character 23" } },
+    { "Decode invalid escape code [throw error]", json.decode, { [[ { "bad escape \q code" } ]] },
+      false, { "Expected object key string but found invalid escape code at character 16" } },
+    { "Decode invalid unicode escape [throw error]", json.decode, { [[ { "bad unicode \u0f6 escape" } ]] },
+      false, { "Expected object key string but found invalid unicode escape code at character 17" } },
+    { "Decode invalid keyword [throw error]", json.decode, { ' [ "bad barewood", test ] ' },
+      false, { "Expected value but found invalid token at character 20" } },
+    { "Decode invalid number #1 [throw error]", json.decode, { '[ -+12 ]' },
+      false, { "Expected value but found invalid number at character 3" } },
+    { "Decode invalid number #2 [throw error]", json.decode, { '-v' },
+      false, { "Expected value but found invalid number at character 1" } },
+    { "Decode invalid number exponent [throw error]", json.decode, { '[ 0.4eg10 ]' },
+      false, { "Expected comma or array end but found invalid token at character 6" } },
+
+    { "Decode deeply nested array [throw error]",
+      json.decode, { string.rep("[", 1100) .. '1100' .. string.rep("]", 1100) },
+      false, { "Found too many nested data structures (1001) at character 1001" } },
+    { "Encode table with cycle [throw error]", json.encode, { cycle },
+      false, { "Cannot serialise, excessive nesting (1001)" } },
+    { "Encode deeply nested data [throw error]", json.encode, { big },
+      false, { "Cannot serialise, excessive nesting (1001)" } },
+
+    { "Encode null", json.encode, { null }, true, { 'null' } },
+    { "Encode true", json.encode, { true }, true, { 'true' } },
+    { "Encode false", json.encode, { false }, true, { 'false' } },
+    { "Encode empty object", json.encode, { { } }, true, { '{}' } },
+    { "Encode integer", json.encode, { 10 }, true, { '10' } },
+    { "Encode string", json.encode, { "hello" }, true, { '"hello"' } },
+    { "Encode number", json.encode, { 1/3 }, true, { '0.33333333333333' } },
+    { "Encode large integer", json.encode, { 2^53 }, true, { '9.007199254741e+15' } },
+    { "Encode small number", json.encode, { -1.5e-7 }, true, { '-1.5e-07' } },
+    { "Encode Lua function [throw error]", json.encode, { function () end },
+      false, { "Cannot serialise function: type not supported" } },
+
+    { "Decode hexadecimal", json.decode, { '0x6.ffp1' }, true, { 13.9921875 } },
+    { "Decode numbers with leading zero", json.decode, { '[ 0123, 00.33 ]' },
+      true, { { 123, 0.33 } } },
+    { "Decode +-Inf", json.decode, { '[ +Inf, Inf, -Inf ]' }, true, { { Inf, Inf, -Inf } } },
+    { "Decode +-Infinity", json.decode, { '[ +Infinity, Infinity, -Infinity ]' },
+      true, { { Inf, Inf, -Inf } } },
+    { "Decode +-NaN", json.decode, { '[ +NaN, NaN, -NaN ]' }, true, { { NaN, NaN, NaN } } },
+    { "Decode Infrared (not infinity) [throw error]", json.decode, { 'Infrared' },
+      false, { "Expected the end but found invalid token at character 4" } },
+    { "Decode Noodle (not NaN) [throw error]", json.decode, { 'Noodle' },
+      false, { "Expected value but found invalid token at character 1" } },
+
+    { "Encode NaN [throw error]", json.encode, { NaN },
+      false, { "Cannot serialise number: must not be NaN or Infinity" } },
+    { "Encode Infinity [throw error]", json.encode, { Inf },
+      false, { "Cannot serialise number: must not be NaN or Infinity" } },
+
+    { "Encode sparse array [throw error]", json.encode, { { [1] = "one", [50] = "sparse test" } },
+      false, { "Cannot serialise table: excessively sparse array" } },
+    { "Encode table with numeric string key as object",
+      json.encode, { { ["2"] = "numeric string key test" } },
+      true, { '{"2":"numeric string key test"}' } },
+    { "Encode table with incompatible key [throw error]", json.encode, { { [false] = "wrong" } },
+      false, { "Cannot serialise boolean: table key must be a number or string" } },
+
+    { "Encode all octets (8-bit clean)", json.encode, { octets }, true, { octets_escaped } },
+    { "Decode all escaped octets", json.decode, { octets_escaped }, true, { octets } },
+    { "Decode single UTF-16 escape", json.decode, { [[""]] }, true, { "\239\160\128" } },
+    { "Decode all UTF-16 escapes (including surrogate combinations)",
+      json.decode, { utf16_escaped }, true, { utf8_raw } },
+    { "Decode swapped surrogate pair [throw error]", json.decode, { [["\uDC00\uD800"]] },
+      false, { "Expected value but found invalid unicode escape code at character 2" } },
+    { "Decode duplicate high surrogate [throw error]", json.decode, { [["\uDB00\uDB00"]] },
+      false, { "Expected value but found invalid unicode escape code at character 2" } },
+    { "Decode missing low surrogate [throw error]", json.decode, { [["\uDB00"]] },
+      false, { "Expected value but found invalid unicode escape code at character 2" } },
+    { "Decode invalid low surrogate [throw error]", json.decode, { [["\uDB00\uD"]] },
+      false, { "Expected value but found invalid unicode escape code at character 2" } },
+
+    { "Encode argument validation [throw error]", json.encode, { "arg1", "arg2" },
+      false, { "bad argument #1 to '?' (expected 1 argument)" } },
+  }
+
+  -- decoder:finish() resets the decoder also when it raises an error, so
+  -- the same decoder takes the next document
+  local function decoder_error(chunks)
+    local d = json.decoder()
+    for _, c in ipairs(chunks) do
+      local ok, err = pcall(d.write, d, c)
+      if not ok then return "write: " .. err:gsub("^[^:]*:%d+: ", "") end
+    end
+    local ok, err = pcall(d.finish, d)
+    if ok then return "finish: " .. serialise(err) end
+    return "finish: " .. err:gsub("^[^:]*:%d+: ", "")
+  end
+  local function decoder_reuse(chunks)
+    local d = json.decoder()
+    for _, c in ipairs(chunks) do
+      if not pcall(d.write, d, c) then break end
+    end
+    local first = { pcall(d.finish, d) }
+    d:write('{ "next": [ 1, "two" ] }')
+    return first[1], d:finish()
+  end
+  local function decoder_write_failed()
+    local d = json.decoder()
+    pcall(d.write, d, "[ 1 2 ]")
+    return d:write("3")
+  end
+  for _, t in ipairs({
+    { "Decoder finish with nothing written [throw error]", { },
+      "finish: Expected value but found T_END at character 1" },
+    { "Decoder finish in an array [throw error]", { '{ "a": [ 1, 2' },
+      "finish: Expected comma or array end but found T_END at character 14" },
+    { "Decoder finish in a string [throw error]", { '[ "abc' },
+      "finish: Expected value but found unexpected end of string at character 7" },
+    { "Decoder finish after an invalid literal [throw error]", { '[ 1, nul' },
+      "finish: Expected value but found invalid token at character 6" },
+    { "Decoder invalid token in a chunk [throw error]", { '[ 1', ' 2 ]' },
+      "write: Expected comma or array end but found T_NUMBER at character 5" },
+  }) do
+    tests[#tests + 1] = { t[1], decoder_error, { t[2] }, true, { t[3] } }
+  end
+  local next_doc = { next = { 1, "two" } }
+  tests[#tests + 1] = { "Decoder reused after an incomplete document",
+    decoder_reuse, { { '{ "a": [ 1, 2' } }, true, { false, next_doc } }
+  tests[#tests + 1] = { "Decoder reused after an invalid literal",
+    decoder_reuse, { { '[ 1, nul' } }, true, { false, next_doc } }
+  tests[#tests + 1] = { "Decoder reused after a failed write",
+    decoder_reuse, { { '[ 1', ' 2 ]' } }, true, { true, next_doc } }
+  tests[#tests + 1] = { "Decoder write after a failed write [throw error]",
+    decoder_write_failed, { }, false, { "decoder failed, call finish() to reset it" } }
+
+  -- cjson.extract() walks the document once for all the paths; wildcard
+  -- paths collect all their matches in an array
+  local doc = '{ "a": { "b": [ 10, { "c": "x" }, 30 ], "d": true }, ' ..
+              '"e": [ { "n": 1 }, { "n": 2 } ], "f": null }'
+  local too_many = {}
+  for i = 1, 33 do too_many[i] = "a" end
+  for _, t in ipairs({
+    { "Extract object keys and array indices",
+      { doc, { "a.b[2].c", "a.b[3]", "a.d", "f", "e[1]" } },
+      true, { { ["a.b[2].c"] = "x", ["a.b[3]"] = 30, ["a.d"] = true,
+                f = null, ["e[1]"] = { n = 1 } } } },
+    { "Extract missing paths", { doc, { "a.b[9]", "x.y", "a.d.z", "e.n" } },
+      true, { { } } },
+    { "Extract no paths", { doc, { } }, true, { { } } },
+    { "Extract wildcard array elements", { doc, { "e[*].n", "a.b[*]" } },
+      true, { { ["e[*].n"] = { 1, 2 }, ["a.b[*]"] = { 10, { c = "x" }, 30 } } } },
+    { "Extract wildcard object members", { doc, { "a.*" } },
+      true, { { ["a.*"] = { { 10, { c = "x" }, 30 }, true } } } },
+    { "Extract wildcard at the top level", { doc, { "*" } },
+      true, { { ["*"] = { { b = { 10, { c = "x" }, 30 }, d = true },
+                          { { n = 1 }, { n = 2 } }, null } } } },
+    { "Extract wildcard without matches", { doc, { "a.b[*].z", "f[*]" } },
+      true, { { ["a.b[*].z"] = { }, ["f[*]"] = { } } } },
+    { "Extract nested wildcards", { '[ [ 1, 2 ], [ 3, 4 ] ]', { "[*][2]", "[2][1]" } },
+      true, { { ["[*][2]"] = { 2, 4 }, ["[2][1]"] = 3 } } },
+    { "Extract overlapping paths", { doc, { "a", "a.b[1]" } },
+      true, { { a = { b = { 10, { c = "x" }, 30 }, d = true }, ["a.b[1]"] = 10 } } },
+    { "Extract empty path [throw error]", { doc, { "" } },
+      false, { "invalid path ''" } },
+    { "Extract empty key [throw error]", { doc, { "a..b" } },
+      false, { "invalid path 'a..b'" } },
+    { "Extract leading dot [throw error]", { doc, { ".a" } },
+      false, { "invalid path '.a'" } },
+    { "Extract zero index [throw error]", { doc, { "a.b[0]" } },
+      false, { "invalid path 'a.b[0]'" } },
+    { "Extract non-numeric index [throw error]", { doc, { "a.b[x]" } },
+      false, { "invalid path 'a.b[x]'" } },
+    { "Extract unterminated index [throw error]", { doc, { "a.b[1" } },
+      false, { "invalid path 'a.b[1'" } },
+    { "Extract too many paths [throw error]", { doc, too_many },
+      false, { "too many paths" } },
+    { "Extract malformed array [throw error]", { '{ "a": [ 1 2 ] }', { "a" } },
+      false, { "Expected comma or array end but found T_NUMBER at character 12" } },
+    { "Extract truncated document [throw error]", { '{ "a": 1, "b": [ 1, ', { "a" } },
+      false, { "Expected value but found T_END at character 21" } },
+    { "Extract invalid literal outside the paths [throw error]",
+      { '{ "b": [ 1 ], "a": tru }', { "b" } },
+      false, { "Expected value but found invalid token at character 20" } },
+    { "Extract trailing data [throw error]", { '{ "a": 1 } x', { "a" } },
+      false, { "Expected the end but found invalid token at character 12" } },
+    { "Extract UTF-16 [throw error]", { '\0{\0}', { "a" } },
+      false, { "JSON parser does not support UTF-16 or UTF-32" } },
+  }) do
+    tests[#tests + 1] = { t[1], json.extract, t[2], t[3], t[4] }
+  end
+
+  -- cjson.encode_to() hands its buffer to __sink as a token that only
+  -- luaL_checkpayload() accepts, and only while the sink runs
+  local stash
+  local stash_sink = { __sink = function(s, p, ...)
+    stash = p
+    return sink.__sink(sink, p, ...)
+  end }
+  local failing_sink = { __sink = function(s, p)
+    stash = p
+    error("sink failed", 0)
+  end }
+  local nested_sink = { __sink = function(s, p)
+    local inner = json.encode_to(sink, "inner")
+    return inner, sink.__sink(sink, p)
+  end }
+  local function stale_token(s, value)
+    stash = nil
+    pcall(json.encode_to, s, value)
+    return sink.__sink(sink, stash)
+  end
+  for _, t in ipairs({
+    { "Encode to sink", json.encode_to, { sink, { 1, "two", true } },
+      true, { '[1,"two",true]' } },
+    { "Encode to sink with extra arguments", json.encode_to, { sink, { a = 1 }, "topic", 1 },
+      true, { '{"a":1}', "topic", 1 } },
+    { "Encode to sink through a Lua sink", json.encode_to, { stash_sink, "text" },
+      true, { '"text"' } },
+    { "Encode to sink from inside a sink", json.encode_to, { nested_sink, "outer" },
+      true, { '"inner"', '"outer"' } },
+    { "Encode to sink that raises [throw error]", json.encode_to, { failing_sink, { 1 } },
+      false, { "sink failed" } },
+    { "Encode to sink without __sink [throw error]", json.encode_to, { { }, 1 },
+      false, { "bad argument #1 to '?' (sink expected)" } },
+    { "Encode to sink without a value [throw error]", json.encode_to, { sink },
+      false, { "bad argument #2 to '?' (value expected)" } },
+    { "Encode to sink with an unencodable value [throw error]", json.encode_to,
+      { sink, { f = stale_token } }, false, { "Cannot serialise function: type not supported" } },
+    { "Sink takes a string", sink.__sink, { sink, "abc" }, true, { "abc" } },
+    { "Sink rejects a light userdata [throw error]", sink.__sink, { sink, null, 100000 },
+      false, { "bad argument #2 to '?' (string expected, got userdata)" } },
+    { "Sink rejects a token after the call [throw error]", stale_token, { stash_sink, 1 },
+      false, { "bad argument #2 to '__sink' (string expected, got userdata)" } },
+    { "Sink rejects a token after an error [throw error]", stale_token, { failing_sink, 1 },
+      false, { "bad argument #2 to '__sink' (string expected, got userdata)" } },
+  }) do
+    tests[#tests + 1] = t
+  end
+
+  -- cjson.compile() keys come out in table order, so the encoded
+  -- records are compared after decoding them again
+  local function template_encode(template, record)
+    local encoder = json.compile(template)
+    return json.decode(encoder:encode(record))
+  end
+  local function template_encode_raw(template, record)
+    return json.compile(template):encode(record)
+  end
+  local function template_reuse()
+    local encoder = json.compile({ a = 0 })
+    pcall(encoder.encode, encoder, { a = print })
+    return encoder:encode({ a = "ok" })
+  end
+  local record_tpl = { id = 0, pos = { x = 0, y = 0 }, tags = { 1 }, name = "" }
+  local deep_tpl = {}
+  for i = 1, 1100 do deep_tpl = { a = deep_tpl } end
+  local cyclic = {}
+  cyclic.a = cyclic
+  for _, t in ipairs({
+    { "Template encode", template_encode,
+      { record_tpl, { id = 5, pos = { x = 1, y = 2 }, tags = { "a", "b" }, name = "n" } },
+      true, { { id = 5, pos = { x = 1, y = 2 }, tags = { "a", "b" }, name = "n" } } },
+    { "Template encode missing fields", template_encode, { record_tpl, { id = 1 } },
+      true, { { id = 1, pos = null, tags = null, name = null } } },
+    { "Template encode extra fields", template_encode, { { id = 0 }, { id = 1, x = 2 } },
+      true, { { id = 1 } } },
+    { "Template encode nested missing fields", template_encode,
+      { record_tpl, { pos = { x = 1 } } },
+      true, { { id = null, pos = { x = 1, y = null }, tags = null, name = null } } },
+    { "Template encode non-table nested field", template_encode,
+      { { pos = { x = 0 } }, { pos = 7 } }, true, { { pos = null } } },
+    { "Template encode values by their run time type", template_encode,
+      { { a = { b = 0 } }, { a = { b = { 1, { c = true } } } } },
+      true, { { a = { b = { 1, { c = true } } } } } },
+    { "Template encode non-string keys in a field", template_encode,
+      { { v = { [1] = 1, [2] = 2 } }, { v = { "x", "y" } } },
+      true, { { v = { "x", "y" } } } },
+    { "Template encode escaped keys", template_encode_raw,
+      { { ['a"b'] = 0 }, { ['a"b'] = "q\n" } }, true, { '{"a\\"b":"q\\n"}' } },
+    { "Template encode empty template", template_encode_raw, { { }, { a = 1 } },
+      true, { "{}" } },
+    { "Template reused after an encode error", template_reuse, { },
+      true, { '{"a":"ok"}' } },
+    { "Template encode function [throw error]", template_encode_raw,
+      { { a = 0 }, { a = template_reuse } },
+      false, { "Cannot serialise function: type not supported" } },
+    { "Template encode NaN [throw error]", template_encode_raw, { { a = 0 }, { a = NaN } },
+      false, { "Cannot serialise number: must not be NaN or Infinity" } },
+    { "Template encode boolean table key [throw error]", template_encode_raw,
+      { { a = 0 }, { a = { [true] = 1 } } },
+      false, { "Cannot serialise boolean: table key must be a number or string" } },
+    { "Template encode cycle [throw error]", template_encode_raw, { { a = 0 }, { a = cyclic } },
+      false, { "Cannot serialise, excessive nesting (1001)" } },
+    { "Template encode non-table record [throw error]", template_encode_raw, { { a = 0 }, 5 },
+      false, { "bad argument #1 to 'encode' (table expected, got number)" } },
+    { "Template compile array [throw error]", json.compile, { { 1, 2 } },
+      false, { "Cannot compile template: keys must be strings" } },
+    { "Template compile mixed keys [throw error]", json.compile, { { a = 1, [1] = 2 } },
+      false, { "Cannot compile template: keys must be strings" } },
+    { "Template compile deep nesting [throw error]", json.compile, { deep_tpl },
+      false, { "Cannot compile template: excessive nesting" } },
+    { "Template compile non-table [throw error]", json.compile, { "x" },
+      false, { "bad argument #1 to '?' (table expected, got string)" } },
+  }) do
+    tests[#tests + 1] = t
+  end
+
+  -- cbor.decoder() follows the item structure as chunks arrive; tags are
+  -- skipped in a loop, so long runs of them need no stack
+  local function cbor_chunked(data, size)
+    local d, first = cbor.decoder(), nil
+    for i = 1, #data, size do
+      if d:write(data:sub(i, i + size - 1)) and not first then
+        first = math.min(i + size - 1, #data)
+      end
+    end
+    return first, d:finish()
+  end
+  local function cbor_write_error(chunks)
+    local d = cbor.decoder()
+    for _, c in ipairs(chunks) do
+      local ok, err = pcall(d.write, d, c)
+      if not ok then
+        d:write("\130\1\2")
+        return err, d:finish()
+      end
+    end
+    return d:finish()
+  end
+  local cbor_record = { id = 7, pos = { 1.5, -2, 65536 }, name = "n\0", ok = true }
+  local cbor_nested = string.rep("\129", 1000) .. "\1"
+  local cbor_tags = string.rep("\192", 200000) .. "\1"
+  for _, t in ipairs({
+    { "CBOR round trip", function(v) return cbor.decode(cbor.encode(v)) end,
+      { cbor_record }, true, { cbor_record } },
+    { "CBOR decode tags", cbor.decode, { "\216\1\130\193\1\2" }, true, { { 1, 2 } } },
+    { "CBOR decode a long run of tags", cbor.decode, { cbor_tags }, true, { 1 } },
+    { "CBOR decode nested 1000 deep", function(s) return type(cbor.decode(s)) end,
+      { cbor_nested }, true, { "table" } },
+    { "CBOR decode nested 1001 deep [throw error]", cbor.decode, { "\129" .. cbor_nested },
+      false, { "Found too many nested data structures (1001) at byte 1001" } },
+    { "CBOR decode truncated [throw error]", cbor.decode, { "\130\1" },
+      false, { "Expected more data at byte 2" } },
+    { "CBOR decode trailing data [throw error]", cbor.decode, { "\1\2" },
+      false, { "Expected the end of input at byte 2" } },
+    { "CBOR decode tag without an item [throw error]", cbor.decode, { "\192" },
+      false, { "Expected more data at byte 2" } },
+    { "CBOR decoder byte by byte", cbor_chunked, { cbor.encode(cbor_record), 1 },
+      true, { #cbor.encode(cbor_record), cbor_record } },
+    { "CBOR decoder indefinite lengths", cbor_chunked,
+      { "\159\1\191\97k\127\97a\98bc\255\255\255", 1 },
+      true, { 14, { 1, { k = "abc" } } } },
+    { "CBOR decoder a long run of tags", cbor_chunked, { cbor_tags, 4096 },
+      true, { #cbor_tags, 1 } },
+    { "CBOR decoder nested 1000 deep",
+      function(s) local n, v = cbor_chunked(s, 7) return n, type(v) end,
+      { cbor_nested, 7 }, true, { 1001, "table" } },
+    { "CBOR decoder nested 1001 deep [throw error]", cbor_write_error,
+      { { "\129" .. cbor_nested } }, true, { "Expected valid CBOR", { 1, 2 } } },
+    { "CBOR decoder stray break [throw error]", cbor_write_error, { { "\130\1", "\255" } },
+      true, { "Expected valid CBOR", { 1, 2 } } },
+    { "CBOR decoder wrong string chunk [throw error]", cbor_write_error, { { "\95", "\97a" } },
+      true, { "Expected valid CBOR", { 1, 2 } } },
+    { "CBOR decoder reserved length [throw error]", cbor_write_error, { { "\130\28" } },
+      true, { "Expected valid CBOR", { 1, 2 } } },
+    { "CBOR decoder trailing data [throw error]", cbor_write_error, { { "\1", "\2" } },
+      false, { "Expected the end of input at byte 2" } },
+    { "CBOR decoder incomplete value [throw error]", cbor_write_error, { { "\131\1" } },
+      false, { "Expected more data at byte 2" } },
+  }) do
+    tests[#tests + 1] = t
+  end
+
+  local function decode_cycle(name)
+    local obj1 = json.decode(readfile(name))
+    local obj2 = json.decode(json.encode(obj1))
+    return compare_values(obj1, obj2)
+  end
+
+  -- The streaming decoder must agree with decode() for any chunking
+  local function decode_chunked(name)
+    local text = readfile(name)
+    local expect = json.decode(text)
+    for round = 1, 20 do
+      local d, pos = json.decoder(), 1
+      while pos <= #text do
+        local n = rand(round < 10 and 4 or 64)
+        d:write(text:sub(pos, pos + n - 1))
+        pos = pos + n
+      end
+      if not compare_values(d:finish(), expect) then return false end
+    end
+    return true
+  end
+
+  for _, name in ipairs(fixtures) do
+    tests[#tests + 1] = { "Decode cycle " .. name, decode_cycle, { name }, true, { true } }
+    tests[#tests + 1] = { "Decode chunked " .. name, decode_chunked, { name }, true, { true } }
+  end
+
+  local pass = 0
+  for i, t in ipairs(tests) do
+    local name, func, args, want_ok, want = t[1], t[2], t[3], t[4], t[5]
+    local result = { pcall(func, unpack(args)) }
+    local ok = table.remove(result, 1)
+    if not ok then
+      result[1] = tostring(result[1]):gsub("^[^:]*:%d+: ", "")
+    end
+    if ok == want_ok and compare_values(result, want) then
+      pass = pass + 1
+      print(("==> Test [%d] %s: PASS"):format(i, name))
+    else
+      print(("==> Test [%d] %s: FAIL"):format(i, name))
+      print("    Expected: " .. serialise(want))
+      print("    Got:      " .. serialise(result))
+    end
+  end
+
+  if pass == #tests then
+    print("==> Summary: all tests succeeded")
+    return 0
+  end
+  print(("==> Summary: %d/%d tests failed"):format(#tests - pass, #tests))
+  return 1
+end
+
+-- ===== BENCHMARK =====
+
+-- Telemetry-style documents of increasing size
+local function synthetic(records)
+  local t = { device = "node-01", fw = "1.4.0", interval = 30, readings = {} }
+  for i = 1, records do
+    t.readings[i] = { ts = 1700000000 + i * 30, temp = 20 + (i % 50) / 8,
+                      hum = 40.25 + i % 7, ok = i % 3 ~= 0, tag = "sensor " .. i }
+  end
+  return json.encode(t)
+end
+
+-- Average seconds per call, running for at least 0.2 s
+local function timeit(func, arg)
+  local n, t0 = 0, clock()
+  repeat
+    for i = 1, 10 do func(arg) end
+    n = n + 10
+  until clock() - t0 >= 0.2
+  return (clock() - t0) / n
+end
+
+-- Peak heap above the baseline while running func once, or nil if it
+-- needs more than heap_max bytes
+local function peak(func, arg)
+  collectgarbage()
+  local base = heap()
+  if heap_max > 0 then heap_limit(base + heap_max) end
+  heap_reset()
+  local ok = pcall(func, arg)
+  local _, top = heap()
+  heap_limit(0)
+  return ok and top - base or nil
+end
+
+local function benchmark()
+  local docs = {}
+  for _, name in ipairs(fixtures) do
+    docs[#docs + 1] = { name:match("[^/]*$"), readfile(name) }
+  end
+  for _, n in ipairs({ 8, 32, 128 }) do
+    docs[#docs + 1] = { "synthetic-" .. n, synthetic(n) }
+  end
+
+  if heap_max > 0 then
+    print(("==> Each call limited to %d bytes of heap"):format(heap_max))
+  end
+
+  print(("%-20s %7s %10s %10s %10s %10s"):format(
+    "document", "bytes", "decode us", "encode us", "dec peak", "enc peak"))
+  for _, d in ipairs(docs) do
+    local name, text = d[1], d[2]
+    local dec_peak = peak(json.decode, text)
+    local value = json.decode(text)
+    local enc_peak = peak(json.encode, value)
+    if dec_peak and enc_peak then
+      print(("%-20s %7d %10.1f %10.1f %10d %10d"):format(name, #text,
+        timeit(json.decode, text) * 1e6, timeit(json.encode, value) * 1e6,
+        dec_peak, enc_peak))
+    else
+      print(("%-20s %7d %10s %10s %10s %10s"):format(name, #text, "-", "-",
+        dec_peak or "no mem", enc_peak or "no mem"))
+    end
+    value = nil
+    collectgarbage()
+  end
+  return 0
+end
+
+if mode == "bench" then
+  return benchmark()
+end
+return conformance()
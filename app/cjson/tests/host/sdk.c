@@ -0,0 +1,357 @@
+/* Host stand-in for the parts of the SDK that app/modules/net.c calls
+ *
+ * Nothing touches a network: espconn_connect() only remembers the
+ * connection, and a script plays the remote end and the SDK's event loop
+ * through the sdk global:
+ *
+ *   sdk.connect()        the pending connection comes up
+ *   sdk.disconnect()     the remote end closes it
+ *   sdk.reconnect(err)   it fails with err
+ *   sdk.receive(data)    data arrives
+ *   sdk.sent()           the segment in flight is acknowledged
+ *   sdk.refuse(err [, n])
+ *                        the next n espconn_sent() calls (1 by default)
+ *                        fail with err
+ *   sdk.segments()       the segments espconn_sent() took since the last
+ *                        call, in order
+ *   sdk.timers()         fire every armed timer once, return how many
+ *
+ * espconn_sent() fails with ESPCONN_ARG while the connection is not up,
+ * as the SDK does.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "platform.h"
+#include "espconn.h"
+#include "lwip/dns.h"
+
+#define SDK_TIMERS   8
+#define SDK_SEGMENTS 64
+
+static struct espconn *sdk_conn;    /* the connection being played */
+static int sdk_up;                  /* sdk_conn takes data */
+static sint8 sdk_refuse_err;
+static int sdk_refuse_n;
+
+static struct {
+  char *data;
+  uint16 len;
+} sdk_segment[SDK_SEGMENTS];
+static int sdk_nsegments;
+
+static os_timer_t *sdk_timer[SDK_TIMERS];
+static os_timer_t *sdk_due[SDK_TIMERS];  /* being fired by sdk.timers() */
+static ip_addr_t sdk_dns[DNS_MAX_SERVERS];
+
+/* ===== TIMERS ===== */
+
+void os_timer_setfn(os_timer_t *t, os_timer_func_t func, void *arg)
+{
+  t->func = func;
+  t->arg = arg;
+}
+
+void os_timer_disarm(os_timer_t *t)
+{
+  int i;
+
+  for (i = 0; i < SDK_TIMERS; i++) {
+    if (sdk_timer[i] == t)
+      sdk_timer[i] = NULL;
+    if (sdk_due[i] == t)
+      sdk_due[i] = NULL;
+  }
+}
+
+/* Every timer fires at the next sdk.timers(), whatever its period */
+void os_timer_arm(os_timer_t *t, uint32_t ms, bool repeat)
+{
+  int i, free = -1;
+
+  for (i = 0; i < SDK_TIMERS; i++) {
+    if (sdk_timer[i] == t)
+      return;
+    if (!sdk_timer[i] && free < 0)
+      free = i;
+  }
+  if (free < 0)
+    abort();
+  sdk_timer[free] = t;
+}
+
+/* ===== ESPCONN ===== */
+
+sint8 espconn_connect(struct espconn *espconn)
+{
+  sdk_conn = espconn;
+  sdk_up = 0;
+  return ESPCONN_OK;
+}
+
+sint8 espconn_disconnect(struct espconn *espconn)
+{
+  if (espconn == sdk_conn)
+    sdk_up = 0;
+  return ESPCONN_OK;
+}
+
+sint8 espconn_delete(struct espconn *espconn)
+{
+  return espconn_disconnect(espconn);
+}
+
+sint8 espconn_accept(struct espconn *espconn)
+{
+  return ESPCONN_OK;
+}
+
+sint8 espconn_create(struct espconn *espconn)
+{
+  return ESPCONN_OK;
+}
+
+sint8 espconn_sent(struct espconn *espconn, uint8 *psent, uint16 length)
+{
+  char *copy;
+
+  if (espconn != sdk_conn || !sdk_up)
+    return ESPCONN_ARG;
+  if (sdk_refuse_n > 0) {
+    sdk_refuse_n--;
+    return sdk_refuse_err;
+  }
+  if (sdk_nsegments == SDK_SEGMENTS || !(copy = malloc(length)))
+    return ESPCONN_MEM;
+  memcpy(copy, psent, length);
+  sdk_segment[sdk_nsegments].data = copy;
+  sdk_segment[sdk_nsegments].len = length;
+  sdk_nsegments++;
+  return ESPCONN_OK;
+}
+
+sint8 espconn_regist_time(struct espconn *espconn, uint32 interval, uint8 type_flag)
+{
+  return ESPCONN_OK;
+}
+
+sint8 espconn_regist_sentcb(struct espconn *espconn, espconn_sent_callback sent_cb)
+{
+  espconn->sent_callback = sent_cb;
+  return ESPCONN_OK;
+}
+
+sint8 espconn_regist_recvcb(struct espconn *espconn, espconn_recv_callback recv_cb)
+{
+  espconn->recv_callback = recv_cb;
+  return ESPCONN_OK;
+}
+
+sint8 espconn_regist_connectcb(struct espconn *espconn, espconn_connect_callback connect_cb)
+{
+  espconn->proto.tcp->connect_callback = connect_cb;
+  return ESPCONN_OK;
+}
+
+sint8 espconn_regist_reconcb(struct espconn *espconn, espconn_reconnect_callback recon_cb)
+{
+  espconn->proto.tcp->reconnect_callback = recon_cb;
+  return ESPCONN_OK;
+}
+
+sint8 espconn_regist_disconcb(struct espconn *espconn, espconn_connect_callback discon_cb)
+{
+  espconn->proto.tcp->disconnect_callback = discon_cb;
+  return ESPCONN_OK;
+}
+
+uint32 espconn_port(void)
+{
+  return 49152;
+}
+
+sint8 espconn_get_connection_info(struct espconn *pespconn, remot_info **pcon_info, uint8 typeflags)
+{
+  return ESPCONN_ARG;
+}
+
+sint8 espconn_recv_hold(struct espconn *pespconn)
+{
+  return ESPCONN_OK;
+}
+
+sint8 espconn_recv_unhold(struct espconn *pespconn)
+{
+  return ESPCONN_OK;
+}
+
+/* Names never resolve */
+err_t espconn_gethostbyname(struct espconn *pespconn, const char *hostname, ip_addr_t *addr, dns_found_callback found)
+{
+  return ESPCONN_INPROGRESS;
+}
+
+sint8 espconn_igmp_join(ip_addr_t *host_ip, ip_addr_t *multicast_ip)
+{
+  return ESPCONN_OK;
+}
+
+sint8 espconn_igmp_leave(ip_addr_t *host_ip, ip_addr_t *multicast_ip)
+{
+  return ESPCONN_OK;
+}
+
+/* ===== LWIP ===== */
+
+uint32 ipaddr_addr(const char *cp)
+{
+  return inet_addr(cp);
+}
+
+void dns_setserver(uint8 numdns, ip_addr_t *dnsserver)
+{
+  if (numdns < DNS_MAX_SERVERS)
+    sdk_dns[numdns] = *dnsserver;
+}
+
+ip_addr_t dns_getserver(uint8 numdns)
+{
+  ip_addr_t none = { IPADDR_ANY };
+
+  return numdns < DNS_MAX_SERVERS ? sdk_dns[numdns] : none;
+}
+
+/* ===== SCRIPT INTERFACE ===== */
+
+static struct espconn *sdk_check_conn(lua_State *L)
+{
+  if (!sdk_conn)
+    luaL_error(L, "no connection");
+  return sdk_conn;
+}
+
+static int sdk_connect(lua_State *L)
+{
+  struct espconn *c = sdk_check_conn(L);
+
+  sdk_up = 1;
+  if (c->proto.tcp->connect_callback)
+    c->proto.tcp->connect_callback(c);
+  return 0;
+}
+
+/* net.c frees the espconn in its disconnect callbacks, so it is forgotten
+ * first */
+static int sdk_disconnect(lua_State *L)
+{
+  struct espconn *c = sdk_check_conn(L);
+
+  sdk_conn = NULL;
+  sdk_up = 0;
+  if (c->proto.tcp->disconnect_callback)
+    c->proto.tcp->disconnect_callback(c);
+  return 0;
+}
+
+static int sdk_reconnect(lua_State *L)
+{
+  struct espconn *c = sdk_check_conn(L);
+  sint8 err = (sint8)luaL_checkinteger(L, 1);
+
+  sdk_conn = NULL;
+  sdk_up = 0;
+  if (c->proto.tcp->reconnect_callback)
+    c->proto.tcp->reconnect_callback(c, err);
+  return 0;
+}
+
+/* The data is handed over in a heap copy that is freed on return, so a
+ * callback that keeps a pointer into it shows up under a sanitizer */
+static int sdk_receive(lua_State *L)
+{
+  struct espconn *c = sdk_check_conn(L);
+  size_t len;
+  const char *data = luaL_checklstring(L, 1, &len);
+  char *copy = malloc(len ? len : 1);
+
+  if (!copy)
+    return luaL_error(L, "not enough memory");
+  memcpy(copy, data, len);
+  if (c->recv_callback)
+    c->recv_callback(c, copy, (unsigned short)len);
+  free(copy);
+  return 0;
+}
+
+static int sdk_sent(lua_State *L)
+{
+  struct espconn *c = sdk_check_conn(L);
+
+  if (c->sent_callback)
+    c->sent_callback(c);
+  return 0;
+}
+
+static int sdk_refuse(lua_State *L)
+{
+  sdk_refuse_err = (sint8)luaL_checkinteger(L, 1);
+  sdk_refuse_n = luaL_optinteger(L, 2, 1);
+  return 0;
+}
+
+static int sdk_segments(lua_State *L)
+{
+  int i;
+
+  lua_createtable(L, sdk_nsegments, 0);
+  for (i = 0; i < sdk_nsegments; i++) {
+    lua_pushlstring(L, sdk_segment[i].data, sdk_segment[i].len);
+    lua_rawseti(L, -2, i + 1);
+    free(sdk_segment[i].data);
+  }
+  sdk_nsegments = 0;
+  return 1;
+}
+
+/* A callback may arm timers again, which then wait for the next call, or
+ * disarm ones that have not fired yet */
+static int sdk_timers(lua_State *L)
+{
+  os_timer_t *t;
+  int i, n = 0;
+
+  memcpy(sdk_due, sdk_timer, sizeof(sdk_due));
+  memset(sdk_timer, 0, sizeof(sdk_timer));
+  for (i = 0; i < SDK_TIMERS; i++) {
+    if ((t = sdk_due[i]) == NULL)
+      continue;
+    sdk_due[i] = NULL;
+    t->func(t->arg);
+    n++;
+  }
+  lua_pushinteger(L, n);
+  return 1;
+}
+
+static const luaL_Reg sdk_funcs[] = {
+  { "connect",    sdk_connect },
+  { "disconnect", sdk_disconnect },
+  { "reconnect",  sdk_reconnect },
+  { "receive",    sdk_receive },
+  { "sent",       sdk_sent },
+  { "refuse",     sdk_refuse },
+  { "segments",   sdk_segments },
+  { "timers",     sdk_timers },
+  { NULL, NULL }
+};
+
+int host_sdk_open(lua_State *L)
+{
+  luaL_register(L, "sdk", sdk_funcs);
+  lua_pop(L, 1);
+  return 0;
+}
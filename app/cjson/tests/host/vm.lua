@@ -0,0 +1,176 @@
+-- Regression tests for the Lua VM itself, run by the host runner (see
+-- Makefile):
+--
+--   cjson_host vm.lua
+--
+-- These cover code paths of app/lua that the cjson conformance cases in
+-- run.lua only reach by accident.
+
+local tests = {}
+
+-- ===== HELPERS =====
+
+local function serialise(t)
+  local out = { }
+  for i = 1, #t do out[i] = tostring(t[i]) end
+  return "{ " .. table.concat(out, ", ") .. " }"
+end
+
+local function same(a, b)
+  if #a ~= #b then return false end
+  for i = 1, #a do
+    if a[i] ~= b[i] then return false end
+  end
+  return true
+end
+
+-- ===== TESTS =====
+
+-- string.len is fetched with GETGFIELD through the rotable fallback of the
+-- globals table; each level of recursion needs a new frame, so some of
+-- those lookups run just as the stack is reallocated
+local function gfield_stack_growth()
+  local function deep(n)
+    if n == 0 then return 0 end
+    local a, b, c, d, e, f, g, h = 1, 2, 3, 4, 5, 6, 7, 8
+    return string.len("x") + deep(n - 1)
+  end
+  for n = 1, 300 do
+    if deep(n) ~= n then return false end
+  end
+  return true
+end
+tests[#tests + 1] = { "Global field lookup while the stack grows",
+  gfield_stack_growth, { }, true, { true } }
+
+-- A binary chunk loaded lazily leaves its nested functions as stubs that
+-- are read back from the file by OP_CLOSURE; they must behave, and report
+-- the same lines in their errors, as when the chunk is loaded at once
+local LAZY_CHUNK = "vm_lazy.lc"
+local LAZY_SOURCE = [[
+local function outer(a)
+  local function middle(b)
+    local function inner(c)
+      return a * 100 + b * 10 + c
+    end
+    return inner
+  end
+  return middle
+end
+local function fail(n)
+  local t = { }
+  for i = 1, n do t[i] = i end
+  error("failed at " .. #t)
+end
+return function(x)
+  local ok, err = pcall(fail, x)
+  return outer(x)(2)(3), err, outer(x + 1)(4)(5)
+end
+]]
+
+local function load_chunk()
+  collectgarbage()
+  local before = heap()
+  local f = assert(loadfile(LAZY_CHUNK))
+  return f, heap() - before
+end
+
+-- a failed allocation makes the emergency collection run under memory
+-- pressure, when mode 2 unloads the functions no closure uses
+local function memory_pressure()
+  collectgarbage()
+  heap_limit(heap() + 64)
+  pcall(string.rep, "x", 1024)
+  heap_limit(0)
+end
+
+local function lazy_undump(mode)
+  writefile(LAZY_CHUNK, string.dump(assert(loadstring(LAZY_SOURCE, "=lazy"))))
+  local prev = lazyload(0)
+  local eager, eager_bytes = load_chunk()
+  local want = { eager()(1) }
+  lazyload(mode)
+  local lazy, lazy_bytes = load_chunk()
+  local err
+  if lazy_bytes >= eager_bytes then err = "chunk loaded eagerly" end
+  -- the later rounds run the closures again once they are loaded, or
+  -- after the collector unloaded them
+  for round = 1, 3 do
+    if err then break end
+    local got = { lazy()(1) }
+    if not same(got, want) then err = serialise(got) end
+    memory_pressure()
+  end
+  lazyload(prev)
+  if err then return err end
+  return unpack(want)
+end
+tests[#tests + 1] = { "Lazy undump matches an eager load",
+  lazy_undump, { 1 }, true, { 123, "lazy:13: failed at 1", 245 } }
+tests[#tests + 1] = { "Lazy undump with unloading matches an eager load",
+  lazy_undump, { 2 }, true, { 123, "lazy:13: failed at 1", 245 } }
+
+-- debug.profreport() counts calls of each function; an error inside a
+-- coroutine leaves frames that never return, which must not keep the
+-- profiler from adding up the time of later calls
+-- the report names functions by chunk and line: leaf is prof:1, work prof:2
+local PROF_SOURCE = [[
+local function leaf() return 1 end
+local function work(n, fail)
+  local s = 0
+  for i = 1, n do s = s + i end
+  if fail then error("stop") end
+  return s
+end
+return leaf, work
+]]
+
+local function profiler()
+  local leaf, work = assert(loadstring(PROF_SOURCE, "=prof"))()
+  local report = { }
+  debug.profile(16)
+  for i = 1, 5 do leaf() end
+  coroutine.resume(coroutine.create(work), 10, true)
+  work(3000000)
+  debug.profreport(function(line) report[#report + 1] = line end)
+  debug.profile(0)
+  local function entry(line_defined)
+    for _, line in ipairs(report) do
+      local calls, time = line:match("^%s*(%d+)%s+(%d+)%s+%d+%s+prof:" ..
+                                     line_defined .. " ")
+      if calls then return tonumber(calls), tonumber(time) end
+    end
+  end
+  local leaf_calls = entry(1)
+  local work_calls, work_time = entry(2)
+  return leaf_calls, work_calls, work_time > 0
+end
+tests[#tests + 1] = { "Profiler counts calls and time past coroutine errors",
+  profiler, { }, true, { 5, 2, true } }
+
+-- ===== RUNNER =====
+
+local pass = 0
+for i, t in ipairs(tests) do
+  local name, func, args, want_ok, want = t[1], t[2], t[3], t[4], t[5]
+  local result = { pcall(func, unpack(args)) }
+  local ok = table.remove(result, 1)
+  if not ok then
+    result[1] = tostring(result[1]):gsub("^[^:]*:%d+: ", "")
+  end
+  if ok == want_ok and same(result, want) then
+    pass = pass + 1
+    print(("==> Test [%d] %s: PASS"):format(i, name))
+  else
+    print(("==> Test [%d] %s: FAIL"):format(i, name))
+    print("    Expected: " .. serialise(want))
+    print("    Got:      " .. serialise(result))
+  end
+end
+
+if pass == #tests then
+  print("==> Summary: all VM tests succeeded")
+  return 0
+end
+print(("==> Summary: %d/%d VM tests failed"):format(#tests - pass, #tests))
+return 1
@@ -54,6 +54,21 @@
 #define BUILD_SPIFFS	1
 
 #define SPIFFS_CACHE 1
+// Pages of 256 bytes in the SPIFFS read/write cache, about 270 bytes of RAM
+// each; file.cachesize() changes it at run time
+#define SPIFFS_CACHE_PAGES 4
+// Files whose index pages are kept in RAM so opening them needs no scan of
+// the whole file system, 8 bytes of RAM each
+#define SPIFFS_LU_INDEX_ENTRIES 32
+// Bytes read ahead for each file being read with small reads, getc or
+// readline; taken from the heap while the file is open
+#define SPIFFS_READAHEAD 128
+
+// Reserve flash directly after the firmware for executing precompiled .lc
+// files in place (see node.flashimage()). Must be a multiple of 16KB and the
+// area must lie within the first megabyte of flash. Enabling it moves the
+// start of SPIFFS, so the file system has to be formatted afterwards.
+// #define LUA_XIP_AREA_SIZE 0x10000
 
 // #define LUA_NUMBER_INTEGRAL
 
@@ -67,7 +82,13 @@
 #define READLINE_INTERVAL 80
 #define LUA_TASK_PRIO USER_TASK_PRIO_0
 #define LUA_PROCESS_LINE_SIG 2
+#define LUA_FS_GC_SIG 3
 #define LUA_OPTIMIZE_DEBUG      2
+// Allow .lc files to be loaded one function at a time (see node.lazyload())
+#define LUA_LAZY_UNDUMP
+// Count calls, time and sampled opcodes per Lua function (see
+// debug.profile()); costs a little on every VM instruction when built in
+// #define LUA_PROFILER
 
 #ifdef DEVKIT_VERSION_0_9
 #define KEYLED_INTERVAL	80
@@ -16,6 +16,7 @@
 #define LUA_USE_MODULES_ADC
 #define LUA_USE_MODULES_BIT
 //#define LUA_USE_MODULES_BMP085
+//#define LUA_USE_MODULES_CBOR
 #define LUA_USE_MODULES_CJSON
 #define LUA_USE_MODULES_COAP
 #define LUA_USE_MODULES_CRYPTO
@@ -32,6 +32,7 @@
 #include "lobject.h"
 #include "lstate.h"
 #include "legc.h"
+#include "lundump.h"
 
 #define FREELIST_REF	0	/* free list of references */
 
@@ -199,6 +200,60 @@ LUALIB_API const char *luaL_checklstring (lua_State *L, int narg, size_t *len) {
 }
 
 
+/*
+** Buffers handed to __sink functions by luaL_pcallsink(). Lua only sees
+** the address of one of these, as a light userdata, and it is accepted
+** by luaL_checkpayload() only while that call is running.
+*/
+typedef struct luaL_Payload {
+  const char *p;
+  size_t len;
+  struct luaL_Payload *prev;
+} luaL_Payload;
+
+static luaL_Payload *live_payloads = NULL;
+
+/*
+** Call the function at index -(nargs+1) with the nargs arguments above it
+** in protected mode, passing a payload token for buf/len after the first
+** argument. Returns the lua_pcall() status with the results or the error
+** on the stack.
+*/
+LUALIB_API int luaL_pcallsink (lua_State *L, int nargs, const char *buf,
+                               size_t len) {
+  luaL_Payload pl;
+  int status;
+  pl.p = buf;
+  pl.len = len;
+  pl.prev = live_payloads;
+  live_payloads = &pl;
+  lua_pushlightuserdata(L, &pl);
+  if (nargs > 1)
+    lua_insert(L, -nargs);
+  status = lua_pcall(L, nargs + 1, LUA_MULTRET, 0);
+  live_payloads = pl.prev;
+  return status;
+}
+
+
+/*
+** Accept either a string or a payload token passed by luaL_pcallsink()
+** whose call is still running. Any other light userdata is rejected.
+*/
+LUALIB_API const char *luaL_checkpayload (lua_State *L, int narg, size_t *len) {
+  if (lua_type(L, narg) == LUA_TLIGHTUSERDATA) {
+    luaL_Payload *pl;
+    for (pl = live_payloads; pl != NULL; pl = pl->prev) {
+      if (pl == (luaL_Payload *)lua_touserdata(L, narg)) {
+        if (len) *len = pl->len;
+        return pl->p;
+      }
+    }
+  }
+  return luaL_checklstring(L, narg, len);
+}
+
+
 LUALIB_API const char *luaL_optlstring (lua_State *L, int narg,
                                         const char *def, size_t *len) {
   if (lua_isnoneornil(L, narg)) {
@@ -632,7 +687,7 @@ LUALIB_API int luaL_loadfile (lua_State *L, const char *filename) {
     lf.f = c_freopen(filename, "rb", lf.f);  /* reopen in binary mode */
     if (lf.f == NULL) return errfile(L, "reopen", fnameindex);
     /* skip eventual `#!...' */
-   while ((c = c_getc(lf.f)) != EOF && c != LUA_SIGNATURE[0]) ;
+    while ((c = c_getc(lf.f)) != EOF && c != LUA_SIGNATURE[0]) ;
     lf.extraline = 0;
   }
   c_ungetc(c, lf.f);
@@ -678,6 +733,28 @@ static const char *getFSF (lua_State *L, void *ud, size_t *size) {
 }
 
 
+#ifdef LUA_XIP_AREA_SIZE
+typedef struct LoadXIP {
+  const char *base;
+  size_t size;
+} LoadXIP;
+
+
+/* reader for chunks copied to the execute-in-place area by fs_xip_add() */
+static const char *getXIP (lua_State *L, void *ud, size_t *size) {
+  LoadXIP *lx = (LoadXIP *)ud;
+
+  if (L == NULL && size == NULL) // Direct mode check
+    return lx->base;
+
+  if (lx->size == 0) return NULL;
+  *size = lx->size;
+  lx->size = 0;
+  return lx->base;
+}
+#endif
+
+
 static int errfsfile (lua_State *L, const char *what, int fnameindex) {
   const char *filename = lua_tostring(L, fnameindex) + 1;
   lua_pushfstring(L, "cannot %s %s", what, filename);
@@ -690,6 +767,9 @@ LUALIB_API int luaL_loadfsfile (lua_State *L, const char *filename) {
   LoadFSF lf;
   int status, readstatus;
   int c;
+#ifdef LUA_XIP_AREA_SIZE
+  LoadXIP lx;
+#endif
   int fnameindex = lua_gettop(L) + 1;  /* index of filename on the stack */
   lf.extraline = 0;
   if (filename == NULL) {
@@ -709,6 +789,16 @@ LUALIB_API int luaL_loadfsfile (lua_State *L, const char *filename) {
     if (c == '\n') c = fs_getc(lf.f);
   }
   if (c == LUA_SIGNATURE[0] && filename) {  /* binary file? */
+#ifdef LUA_XIP_AREA_SIZE
+    lx.size = fs_size(lf.f);
+    if (!lf.extraline && (lx.base = fs_xip_map(filename, lf.f, lx.size)) != NULL) {
+      /* execute the copy in flash instead of loading the file into RAM */
+      fs_close(lf.f);
+      status = lua_load(L, getXIP, &lx, lua_tostring(L, -1));
+      lua_remove(L, fnameindex);
+      return status;
+    }
+#endif
     fs_close(lf.f);
     lf.f = fs_open(filename, FS_RDONLY);  /* reopen in binary mode */
     if (lf.f < FS_OPEN_OK) return errfsfile(L, "reopen", fnameindex);
@@ -762,6 +852,16 @@ LUALIB_API int (luaL_loadstring) (lua_State *L, const char *s) {
 /* }====================================================== */
 
 
+#ifdef LUA_LAZY_UNDUMP
+/* collections forced by memory pressure may also unload unused functions */
+#define begin_pressure_gc(L) \
+  { if (G(L)->lazymode == LUA_LAZY_DROP) set_drop_protos_gc(L); }
+#define end_pressure_gc(L) unset_drop_protos_gc(L)
+#else
+#define begin_pressure_gc(L)
+#define end_pressure_gc(L)
+#endif
+
 static int l_check_memlimit(lua_State *L, size_t needbytes) {
   global_State *g = G(L);
   int cycle_count = 0;
@@ -770,11 +870,13 @@ static int l_check_memlimit(lua_State *L, size_t needbytes) {
   if (needbytes > g->memlimit) return 1;
   /* make sure the GC is not disabled. */
   if (!is_block_gc(L)) {
+    begin_pressure_gc(L);
     while (g->totalbytes >= limit) {
       /* only allow the GC to finished atleast 1 full cycle. */
       if (g->gcstate == GCSpause && ++cycle_count > 1) break;
       luaC_step(L);
     }
+    end_pressure_gc(L);
   }
   return (g->totalbytes >= limit) ? 1 : 0;
 }
@@ -800,7 +902,9 @@ static void *l_alloc (void *ud, void *ptr, size_t osize, size_t nsize) {
   }
   nptr = (void *)c_realloc(ptr, nsize);
   if (nptr == NULL && L != NULL && (mode & EGC_ON_ALLOC_FAILURE)) {
+    begin_pressure_gc(L);
     luaC_fullgc(L); /* emergency full collection. */
+    end_pressure_gc(L);
     nptr = (void *)c_realloc(ptr, nsize); /* try allocation again */
   }
   return nptr;
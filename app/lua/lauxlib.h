@@ -54,6 +54,10 @@ LUALIB_API int (luaL_typerror) (lua_State *L, int narg, const char *tname);
 LUALIB_API int (luaL_argerror) (lua_State *L, int numarg, const char *extramsg);
 LUALIB_API const char *(luaL_checklstring) (lua_State *L, int numArg,
                                                           size_t *l);
+LUALIB_API const char *(luaL_checkpayload) (lua_State *L, int numArg,
+                                                          size_t *l);
+LUALIB_API int (luaL_pcallsink) (lua_State *L, int nargs, const char *buf,
+                                size_t len);
 LUALIB_API const char *(luaL_optlstring) (lua_State *L, int numArg,
                                           const char *def, size_t *l);
 LUALIB_API lua_Number (luaL_checknumber) (lua_State *L, int numArg);
@@ -301,6 +301,24 @@ void luaK_setoneret (FuncState *fs, expdesc *e) {
 }
 
 
+/*
+** `t[k]' with a constant `k', where `t' is a temporary that the previous
+** instruction loaded from a global: rewrite that GETGLOBAL into a
+** GETGFIELD, saving one dispatch per `module.function' access.
+*/
+static int fusegfield (FuncState *fs, int t, int k) {
+  Instruction *prev;
+  if (fs->pc == 0 || fs->pc <= fs->lasttarget || fs->jpc != NO_JUMP)
+    return -1;  /* some jump may land between the two instructions */
+  prev = &fs->f->code[fs->pc-1];
+  if (GET_OPCODE(*prev) != OP_GETGLOBAL || GETARG_A(*prev) != t ||
+      t < fs->nactvar || !ISK(k) || GETARG_Bx(*prev) > MAXARG_B)
+    return -1;
+  *prev = CREATE_ABC(OP_GETGFIELD, 0, GETARG_Bx(*prev), INDEXK(k));
+  return fs->pc - 1;
+}
+
+
 void luaK_dischargevars (FuncState *fs, expdesc *e) {
   switch (e->k) {
     case VLOCAL: {
@@ -318,9 +336,13 @@ void luaK_dischargevars (FuncState *fs, expdesc *e) {
       break;
     }
     case VINDEXED: {
+      int pc;
       freereg(fs, e->u.s.aux);
       freereg(fs, e->u.s.info);
-      e->u.s.info = luaK_codeABC(fs, OP_GETTABLE, 0, e->u.s.info, e->u.s.aux);
+      pc = fusegfield(fs, e->u.s.info, e->u.s.aux);
+      if (pc < 0)
+        pc = luaK_codeABC(fs, OP_GETTABLE, 0, e->u.s.info, e->u.s.aux);
+      e->u.s.info = pc;
       e->k = VRELOCABLE;
       break;
     }
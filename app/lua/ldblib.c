@@ -18,6 +18,9 @@
 #include "lualib.h"
 #include "lrotable.h"
 #include "user_modules.h"
+#ifdef LUA_PROFILER
+#include "lprof.h"
+#endif
 
 
 
@@ -26,6 +29,41 @@ static int db_getregistry (lua_State *L) {
   return 1;
 }
 
+#ifdef LUA_PROFILER
+/* debug.profile(nfuncs [, period]) starts, debug.profile(0) stops */
+static int db_profile (lua_State *L) {
+  int nfuncs = luaL_checkint(L, 1);
+  int period = luaL_optint(L, 2, 1);
+  if (nfuncs > 0)
+    luaI_profstart(L, nfuncs, period);
+  else
+    luaI_profstop(L);
+  return 0;
+}
+
+
+static void profwrite (lua_State *L, const char *line, void *ud) {
+  if (ud) {
+    lua_pushvalue(L, 1);
+    lua_pushstring(L, line);
+    lua_call(L, 1, 0);
+  }
+  else
+    c_printf("%s", line);
+}
+
+
+/* debug.profreport([writer [, top]]) */
+static int db_profreport (lua_State *L) {
+  int haswriter = !lua_isnoneornil(L, 1);
+  int top = luaL_optint(L, 2, 20);
+  if (haswriter)
+    luaL_checkanyfunction(L, 1);
+  luaI_profreport(L, top, profwrite, haswriter ? L : NULL);
+  return 0;
+}
+#endif
+
 #ifndef LUA_USE_BUILTIN_DEBUG_MINIMAL
 
 static int db_getmetatable (lua_State *L) {
@@ -395,6 +433,10 @@ const LUA_REG_TYPE dblib[] = {
   {LSTRKEY("getlocal"), LFUNCVAL(db_getlocal)},
 #endif
   {LSTRKEY("getregistry"), LFUNCVAL(db_getregistry)},
+#ifdef LUA_PROFILER
+  {LSTRKEY("profile"), LFUNCVAL(db_profile)},
+  {LSTRKEY("profreport"), LFUNCVAL(db_profreport)},
+#endif
 #ifndef LUA_USE_BUILTIN_DEBUG_MINIMAL
   {LSTRKEY("getmetatable"), LFUNCVAL(db_getmetatable)},
   {LSTRKEY("getupvalue"), LFUNCVAL(db_getupvalue)},
@@ -497,6 +497,11 @@ static Instruction symbexec (const Proto *pt, int lastpc, int reg) {
         check(ttisstring(&pt->k[b]));
         break;
       }
+      case OP_GETGFIELD: {
+        check(b < pt->sizek && ttisstring(&pt->k[b]));
+        check(c < pt->sizek);
+        break;
+      }
       case OP_SELF: {
         checkreg(pt, a+1);
         if (reg == a+1) last = pc;
@@ -606,6 +611,12 @@ static const char *getobjname (lua_State *L, CallInfo *ci, int stackpos,
     *name = luaF_getlocalname(p, stackpos+1, pc);
     if (*name)  /* is a local? */
       return "local";
+    i = p->code[pc];
+    if (GET_OPCODE(i) == OP_GETGFIELD && GETARG_A(i) == stackpos) {
+      /* failed to index the global it has just loaded into R(A) */
+      *name = svalue(&p->k[GETARG_B(i)]);
+      return "global";
+    }
     i = symbexec(p, pc, stackpos);  /* try symbolic execution */
     lua_assert(pc != -1);
     switch (GET_OPCODE(i)) {
@@ -627,6 +638,11 @@ static const char *getobjname (lua_State *L, CallInfo *ci, int stackpos,
         *name = kname(p, k);
         return "field";
       }
+      case OP_GETGFIELD: {
+        int k = GETARG_C(i);  /* key index */
+        *name = ttisstring(&p->k[k]) ? svalue(&p->k[k]) : "?";
+        return "field";
+      }
       case OP_GETUPVAL: {
         int u = GETARG_B(i);  /* upvalue index */
         *name = p->upvalues ? getstr(p->upvalues[u]) : "?";
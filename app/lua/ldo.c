@@ -21,6 +21,7 @@
 #include "lobject.h"
 #include "lopcodes.h"
 #include "lparser.h"
+#include "lprof.h"
 #include "lstate.h"
 #include "lstring.h"
 #include "ltable.h"
@@ -95,6 +96,9 @@ static void resetstack (lua_State *L, int status) {
 void luaD_throw (lua_State *L, int errcode) {
   unfixedstack(L); /* make sure the fixedstack & block_gc flags get reset. */
   unset_block_gc(L);
+#ifdef LUA_LAZY_UNDUMP
+  unset_drop_protos_gc(L);
+#endif
   if (L->errorJmp) {
     L->errorJmp->status = errcode;
     LUAI_THROW(L, L->errorJmp);
@@ -309,6 +313,9 @@ int luaD_precall (lua_State *L, StkId func, int nresults) {
     for (st = L->top; st < ci->top; st++)
       setnilvalue(st);
     L->top = ci->top;
+#ifdef LUA_PROFILER
+    if (G(L)->prof) luaI_profcall(L, ci, p);
+#endif
     if (L->hookmask & LUA_MASKCALL) {
       L->savedpc++;  /* hooks assume 'pc' is already incremented */
       luaD_callhook(L, LUA_HOOKCALL, -1);
@@ -361,6 +368,9 @@ int luaD_poscall (lua_State *L, StkId firstResult) {
   CallInfo *ci;
   if (L->hookmask & LUA_MASKRET)
     firstResult = callrethooks(L, firstResult);
+#ifdef LUA_PROFILER
+  if (G(L)->prof) luaI_profreturn(L, L->ci);
+#endif
   ci = L->ci--;
   res = ci->func;  /* res == final position of 1st result */
   wanted = ci->nresults;
@@ -443,6 +453,10 @@ LUA_API int lua_resume (lua_State *L, int nargs) {
   status = luaD_rawrunprotected(L, resume, L->top - nargs);
   if (status != 0) {  /* error? */
     L->status = cast_byte(status);  /* mark thread as `dead' */
+#ifdef LUA_PROFILER
+    /* the frames of a dead coroutine never return */
+    if (G(L)->prof) luaI_profunwind(L, L->base_ci);
+#endif
     luaD_seterrorobj(L, status, L->top);
     L->ci->top = L->top;
   }
@@ -482,6 +496,9 @@ int luaD_pcall (lua_State *L, Pfunc func, void *u,
     luaF_close(L, oldtop);  /* close eventual pending closures */
     luaD_seterrorobj(L, status, oldtop);
     L->nCcalls = oldnCcalls;
+#ifdef LUA_PROFILER
+    if (G(L)->prof) luaI_profunwind(L, restoreci(L, old_ci));
+#endif
     L->ci = restoreci(L, old_ci);
     L->base = L->ci->base;
     L->savedpc = L->ci->savedpc;
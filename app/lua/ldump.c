@@ -11,6 +11,7 @@
 #include "lua.h"
 #include C_HEADER_STRING
 
+#include "lfunc.h"
 #include "lobject.h"
 #include "lstate.h"
 #include "lundump.h"
@@ -270,6 +271,9 @@ static void DumpFunction(const Proto* f, const TString* p, DumpState* D)
  DumpChar(f->numparams,D);
  DumpChar(f->is_vararg,D);
  DumpChar(f->maxstacksize,D);
+#ifdef LUA_LAZY_UNDUMP
+ if (proto_isstub(f)) luaU_loadstub(D->L,cast(Proto*,f));	/* dump needs the body */
+#endif
  DumpCode(f,D);
  DumpConstants(f,D);
  DumpDebug(f,D);
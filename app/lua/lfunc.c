@@ -15,6 +15,7 @@
 #include "lgc.h"
 #include "lmem.h"
 #include "lobject.h"
+#include "lprof.h"
 #include "lstate.h"
 
 
@@ -137,11 +138,15 @@ Proto *luaF_newproto (lua_State *L) {
   f->linedefined = 0;
   f->lastlinedefined = 0;
   f->source = NULL;
+#ifdef LUA_LAZY_UNDUMP
+  f->chunkname = NULL;
+  f->bodyoffset = 0;
+#endif
   return f;
 }
 
 
-void luaF_freeproto (lua_State *L, Proto *f) {
+static void freebody (lua_State *L, Proto *f) {
   luaM_freearray(L, f->p, f->sizep, Proto *);
   luaM_freearray(L, f->k, f->sizek, TValue);
   luaM_freearray(L, f->locvars, f->sizelocvars, struct LocVar);
@@ -156,10 +161,46 @@ void luaF_freeproto (lua_State *L, Proto *f) {
     luaM_freearray(L, f->lineinfo, f->sizelineinfo, int);
 #endif
   }
+}
+
+
+void luaF_freeproto (lua_State *L, Proto *f) {
+#ifdef LUA_PROFILER
+  if (G(L)->prof) luaI_profforget(G(L)->prof, f);
+#endif
+  freebody(L, f);
   luaM_free(L, f);
 }
 
 
+#ifdef LUA_LAZY_UNDUMP
+/*
+** Turn a lazily loaded function back into a stub: everything but the
+** header is freed and will be read again from `chunkname' when needed.
+*/
+void luaF_unloadproto (lua_State *L, Proto *f) {
+  lua_assert(f->chunkname != NULL && !proto_is_readonly(f));
+  freebody(L, f);
+  f->k = NULL;
+  f->sizek = 0;
+  f->p = NULL;
+  f->sizep = 0;
+  f->code = NULL;
+  f->sizecode = 0;
+  f->upvalues = NULL;
+  f->sizeupvalues = 0;
+#ifdef LUA_OPTIMIZE_DEBUG
+  f->packedlineinfo = NULL;
+#else
+  f->lineinfo = NULL;
+  f->sizelineinfo = 0;
+#endif
+  f->locvars = NULL;
+  f->sizelocvars = 0;
+}
+#endif
+
+
 void luaF_freeclosure (lua_State *L, Closure *c) {
   int size = (c->c.isC) ? sizeCclosure(c->c.nupvalues) :
                           sizeLclosure(c->l.nupvalues);
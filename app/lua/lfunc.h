@@ -21,6 +21,14 @@
 #define proto_readonly(p) l_setbit((p)->marked, READONLYBIT)
 #define proto_is_readonly(p) testbit((p)->marked, READONLYBIT)
 
+#ifdef LUA_LAZY_UNDUMP
+/* function whose body has not been loaded yet (see luaU_loadstub) */
+#define proto_isstub(p) ((p)->chunkname != NULL && (p)->code == NULL)
+/* function whose body can be dropped and loaded again later */
+#define proto_canunload(p) ((p)->chunkname != NULL && (p)->code != NULL && \
+                            !proto_is_readonly(p))
+#endif
+
 LUAI_FUNC Proto *luaF_newproto (lua_State *L);
 LUAI_FUNC Closure *luaF_newCclosure (lua_State *L, int nelems, Table *e);
 LUAI_FUNC Closure *luaF_newLclosure (lua_State *L, int nelems, Table *e);
@@ -28,6 +36,9 @@ LUAI_FUNC UpVal *luaF_newupval (lua_State *L);
 LUAI_FUNC UpVal *luaF_findupval (lua_State *L, StkId level);
 LUAI_FUNC void luaF_close (lua_State *L, StkId level);
 LUAI_FUNC void luaF_freeproto (lua_State *L, Proto *f);
+#ifdef LUA_LAZY_UNDUMP
+LUAI_FUNC void luaF_unloadproto (lua_State *L, Proto *f);
+#endif
 LUAI_FUNC void luaF_freeclosure (lua_State *L, Closure *c);
 LUAI_FUNC void luaF_freeupval (lua_State *L, UpVal *uv);
 LUAI_FUNC const char *luaF_getlocalname (const Proto *func, int local_number,
@@ -37,7 +37,8 @@
 #define white2gray(x)	reset2bits((x)->gch.marked, WHITE0BIT, WHITE1BIT)
 #define black2gray(x)	resetbit((x)->gch.marked, BLACKBIT)
 
-#define stringmark(s)	reset2bits((s)->tsv.marked, WHITE0BIT, WHITE1BIT)
+#define stringmark(s)	{ if (!luaS_isrostr(s)) \
+                          reset2bits((s)->tsv.marked, WHITE0BIT, WHITE1BIT); }
 
 
 #define isfinalized(u)		testbit((u)->marked, FINALIZEDBIT)
@@ -209,6 +210,24 @@ static void traverseproto (global_State *g, Proto *f) {
     if (f->upvalues[i])
       stringmark(f->upvalues[i]);
   }
+#ifdef LUA_LAZY_UNDUMP
+  if (f->chunkname) stringmark(f->chunkname);
+  if (testbit(g->gcflags, GCDropProtosBit)) {
+    /* leave reloadable children white; `unloadcoldprotos' decides later */
+    int cold = 0;
+    for (i=0; i<f->sizep; i++) {
+      if (f->p[i] && proto_canunload(f->p[i]))
+        cold = 1;
+      else if (f->p[i])
+        markobject(g, f->p[i]);
+    }
+    if (cold) {
+      f->gclist = g->coldprotos;
+      g->coldprotos = obj2gco(f);
+    }
+  }
+  else
+#endif
   for (i=0; i<f->sizep; i++) {  /* mark nested protos */
     if (f->p[i])
       markobject(g, f->p[i]);
@@ -514,6 +533,9 @@ static void markroot (lua_State *L) {
   g->gray = NULL;
   g->grayagain = NULL;
   g->weak = NULL;
+#ifdef LUA_LAZY_UNDUMP
+  g->coldprotos = NULL;
+#endif
   markobject(g, g->mainthread);
   /* make global table be traversed before main stack */
   markvalue(g, gt(g->mainthread));
@@ -533,6 +555,31 @@ static void remarkupvals (global_State *g) {
 }
 
 
+#ifdef LUA_LAZY_UNDUMP
+/*
+** Children of the protos in `coldprotos' that are still white are not used
+** by any closure: drop their bodies (they will be loaded again from their
+** chunk by the next OP_CLOSURE) and keep the stubs alive.
+*/
+static void unloadcoldprotos (lua_State *L) {
+  global_State *g = G(L);
+  while (g->coldprotos) {
+    Proto *f = gco2p(g->coldprotos);
+    int i;
+    g->coldprotos = f->gclist;
+    for (i=0; i<f->sizep; i++) {
+      Proto *c = f->p[i];
+      if (c == NULL) continue;
+      if (iswhite(obj2gco(c)) && proto_canunload(c))
+        luaF_unloadproto(L, c);
+      markobject(g, c);
+    }
+    propagateall(g);  /* may add more protos to the list */
+  }
+}
+#endif
+
+
 static void atomic (lua_State *L) {
   global_State *g = G(L);
   size_t udsize;  /* total size of userdata to be finalized */
@@ -554,6 +601,9 @@ static void atomic (lua_State *L) {
   udsize = luaC_separateudata(L, 0);  /* separate userdata to be finalized */
   marktmu(g);  /* mark `preserved' userdata */
   udsize += propagateall(g);  /* remark, to propagate `preserveness' */
+#ifdef LUA_LAZY_UNDUMP
+  unloadcoldprotos(L);
+#endif
   cleartable(g->weak);  /* remove collected objects from weak tables */
   /* flip current white */
   g->currentwhite = cast_byte(otherwhite(g));
@@ -42,10 +42,12 @@
 ** Layout for bit use in 'gsflags' field in global_State structure.
 ** bit 0 - Protect GC from recursive calls.
 ** bit 1 - Don't try to shrink string table if EGC was called during a string table resize.
+** bit 2 - Unload the bodies of lazily loaded functions that have no closures.
 */
 #define GCFlagsNone          0
 #define GCBlockGCBit         0
 #define GCResizingStringsBit 1
+#define GCDropProtosBit      2
 
 
 #define is_block_gc(L)    testbit(G(L)->gcflags, GCBlockGCBit)
@@ -54,6 +56,9 @@
 #define is_resizing_strings_gc(L)    testbit(G(L)->gcflags, GCResizingStringsBit)
 #define set_resizing_strings_gc(L)   l_setbit(G(L)->gcflags, GCResizingStringsBit)
 #define unset_resizing_strings_gc(L) resetbit(G(L)->gcflags, GCResizingStringsBit)
+#define is_drop_protos_gc(L)    testbit(G(L)->gcflags, GCDropProtosBit)
+#define set_drop_protos_gc(L)   l_setbit(G(L)->gcflags, GCDropProtosBit)
+#define unset_drop_protos_gc(L) resetbit(G(L)->gcflags, GCDropProtosBit)
 
 /*
 ** Layout for bit use in `marked' field:
@@ -417,6 +417,10 @@ typedef struct Proto {
   lu_byte numparams;
   lu_byte is_vararg;
   lu_byte maxstacksize;
+#ifdef LUA_LAZY_UNDUMP
+  TString *chunkname;  /* file to reload the body from (lazy undump) */
+  lu_int32 bodyoffset;  /* offset of the body in that chunk */
+#endif
 } Proto;
 
 
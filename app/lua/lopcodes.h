@@ -204,11 +204,14 @@ OP_SETLIST,/*	A B C	R(A)[(C-1)*FPF+i] := R(A+i), 1 <= i <= B	*/
 OP_CLOSE,/*	A 	close all variables in the stack up to (>=) R(A)*/
 OP_CLOSURE,/*	A Bx	R(A) := closure(KPROTO[Bx], R(A), ... ,R(A+n))	*/
 
-OP_VARARG/*	A B	R(A), R(A+1), ..., R(A+B-1) = vararg		*/
+OP_VARARG,/*	A B	R(A), R(A+1), ..., R(A+B-1) = vararg		*/
+
+/* fused opcodes, only ever added at the end to keep old chunks valid */
+OP_GETGFIELD/*	A B C	R(A) := Gbl[Kst(B)][Kst(C)]			*/
 } OpCode;
 
 
-#define NUM_OPCODES	(cast(int, OP_VARARG) + 1)
+#define NUM_OPCODES	(cast(int, OP_GETGFIELD) + 1)
 
 
 
@@ -230,6 +233,10 @@ OP_VARARG/*	A B	R(A), R(A+1), ..., R(A+B-1) = vararg		*/
       (true or false).
 
   (*) All `skips' (pc++) assume that next instruction is a jump
+
+  (*) OP_GETGFIELD replaces a GETGLOBAL into a temporary followed by a
+      GETTABLE of a constant key from it (`module.function'); B and C are
+      plain constant indices, not RK operands.
 ===========================================================================*/
 
 
@@ -0,0 +1,244 @@
+/*
+** Function level profiler for the Lua VM
+** See Copyright Notice in lua.h
+*/
+
+#define lprof_c
+#define LUA_CORE
+#define LUAC_CROSS_FILE
+
+#include "lua.h"
+#include C_HEADER_STDIO
+#include C_HEADER_STRING
+
+#include "lgc.h"
+#include "lmem.h"
+#include "lobject.h"
+#include "lopcodes.h"
+#include "lprof.h"
+#include "lstate.h"
+
+#ifdef LUA_PROFILER
+
+#ifdef LUA_CROSS_COMPILER
+#include <time.h>
+#define prof_now()	((lu_int32)clock())
+#define PROF_UNIT	"ms"
+#define PROF_SCALE	(CLOCKS_PER_SEC/1000)
+#else
+#include "rom.h"
+#define prof_now()	((lu_int32)xthal_get_ccount())
+#define PROF_UNIT	"kcycles"
+#define PROF_SCALE	1000
+#endif
+
+/* number of opcodes listed for each function in a report */
+#define PROF_HOTOPS	3
+
+
+static ProfEntry *findentry (Profiler *pr, const Proto *p, int claim) {
+  lu_int32 h = cast(lu_int32, cast(size_t, p) >> 3);
+  int i;
+  for (i = 0; i < pr->size; i++) {
+    ProfEntry *e = &pr->e[(h + i) & (pr->size - 1)];
+    if (e->p == p)
+      return e;
+    if (!e->used) {  /* end of the probe sequence */
+      if (!claim)
+        return NULL;
+      e->used = 1;
+      e->p = p;
+      e->linedefined = p->linedefined;
+      if (p->source)
+        luaO_chunkid(e->source, getstr(p->source), PROF_SRCLEN);
+      else
+        c_strcpy(e->source, "?");
+      return e;
+    }
+  }
+  return claim ? &pr->other : NULL;
+}
+
+
+static ProfEntry *getentry (Profiler *pr, const Proto *p) {
+  if (p != pr->lastp) {
+    pr->laste = findentry(pr, p, 1);
+    pr->lastp = p;
+  }
+  return pr->laste;
+}
+
+
+/*
+** only the outermost of recursive calls counts, and only calls that
+** started while profiling
+*/
+static void closecall (ProfEntry *e, lu_int32 start) {
+  if (e->depth > 0 && --e->depth == 0)
+    e->time += cast(lu_int32, prof_now() - start);
+}
+
+
+void luaI_profcall (lua_State *L, CallInfo *ci, const Proto *p) {
+  ProfEntry *e = getentry(G(L)->prof, p);
+  e->calls++;
+  e->depth++;
+  ci->profstart = prof_now();
+  ci->proftail = NULL;
+}
+
+
+void luaI_profreturn (lua_State *L, CallInfo *ci) {
+  if (isLua(ci)) {
+    closecall(getentry(G(L)->prof, ci_func(ci)->l.p), ci->profstart);
+    if (ci->proftail != NULL) {
+      closecall(ci->proftail, ci->proftailstart);
+      ci->proftail = NULL;
+    }
+  }
+}
+
+
+/*
+** `ci' is handing its frame over to the Lua function just entered at
+** `ci+1'. The caller's time goes on until the frame returns, as its
+** result is the callee's. Only the first caller of a chain of tail calls
+** is kept open; the ones in between are closed here.
+*/
+void luaI_proftailcall (lua_State *L, CallInfo *ci) {
+  if (ci->proftail == NULL) {
+    ci->proftail = getentry(G(L)->prof, ci_func(ci)->l.p);
+    ci->proftailstart = ci->profstart;
+  }
+  else
+    closecall(getentry(G(L)->prof, ci_func(ci)->l.p), ci->profstart);
+  ci->profstart = (ci+1)->profstart;
+}
+
+
+/*
+** an error is unwinding the frames above `ci'
+*/
+void luaI_profunwind (lua_State *L, CallInfo *ci) {
+  CallInfo *c;
+  for (c = L->ci; c > ci; c--)
+    luaI_profreturn(L, c);
+}
+
+
+void luaI_profop (Profiler *pr, const Proto *p, OpCode op) {
+  ProfEntry *e = getentry(pr, p);
+  pr->countdown = pr->period;
+  e->samples++;
+  e->ops[op]++;
+}
+
+
+/*
+** called when `p' is collected: keep its numbers, but a new function may
+** now be allocated at the same address
+*/
+void luaI_profforget (Profiler *pr, const Proto *p) {
+  ProfEntry *e = findentry(pr, p, 0);
+  if (e != NULL)
+    e->p = NULL;
+  if (pr->lastp == p)
+    pr->lastp = NULL;
+}
+
+
+void luaI_profstart (lua_State *L, int nfuncs, int period) {
+  global_State *g = G(L);
+  Profiler *pr;
+  GCObject *o;
+  int size = 1;
+  luaI_profstop(L);
+  while (size < nfuncs) size <<= 1;
+  pr = cast(Profiler *, luaM_malloc(L, sizeprofiler(size)));
+  c_memset(pr, 0, sizeprofiler(size));
+  pr->size = size;
+  pr->period = pr->countdown = (period > 0) ? period : 1;
+  c_strcpy(pr->other.source, "(other)");
+  pr->other.used = 1;
+  /* frames entered before now have no valid start time */
+  for (o = g->rootgc; o != NULL; o = o->gch.next) {
+    if (o->gch.tt == LUA_TTHREAD) {
+      lua_State *th = gco2th(o);
+      CallInfo *ci;
+      for (ci = th->base_ci; ci <= th->ci; ci++) {
+        ci->profstart = prof_now();
+        ci->proftail = NULL;
+      }
+    }
+  }
+  g->prof = pr;
+}
+
+
+void luaI_profstop (lua_State *L) {
+  global_State *g = G(L);
+  if (g->prof) {
+    luaM_freemem(L, g->prof, sizeprofiler(g->prof->size));
+    g->prof = NULL;
+  }
+}
+
+
+static void reportentry (lua_State *L, ProfEntry *e, lua_ProfWriter w,
+                         void *ud) {
+  char line[PROF_SRCLEN + 48 + PROF_HOTOPS * 24];
+  char *s = line;
+  lu_int32 shown = ~cast(lu_int32, 0);
+  int i, j;
+  c_sprintf(s, "%8u %10u %8u  %s:%d", cast(unsigned, e->calls),
+            cast(unsigned, e->time / PROF_SCALE),
+            cast(unsigned, e->samples), e->source, e->linedefined);
+  s += c_strlen(s);
+  for (j = 0; j < PROF_HOTOPS; j++) {  /* most frequent opcodes */
+    int best = -1;
+    for (i = 0; i < NUM_OPCODES; i++) {
+      if (e->ops[i] > 0 && e->ops[i] < shown &&
+          (best < 0 || e->ops[i] > e->ops[best]))
+        best = i;
+    }
+    if (best < 0) break;
+    c_sprintf(s, " %s=%u", luaP_opnames[best], cast(unsigned, e->ops[best]));
+    s += c_strlen(s);
+    shown = e->ops[best];
+  }
+  c_strcpy(s, "\n");
+  w(L, line, ud);
+}
+
+
+/*
+** write the `top' functions with the most inclusive time, one line each
+*/
+void luaI_profreport (lua_State *L, int top, lua_ProfWriter w, void *ud) {
+  Profiler *pr = G(L)->prof;
+  uint64_t lasttime = ~cast(uint64_t, 0);
+  int lastidx = -1;
+  int n;
+  if (pr == NULL) return;
+  w(L, "   calls " PROF_UNIT "(incl)  samples  function  hot opcodes\n", ud);
+  for (n = 0; n < top; n++) {
+    /* next entry in (time, index) order after the last one written */
+    int i, best = -1;
+    for (i = 0; i < pr->size; i++) {
+      ProfEntry *e = &pr->e[i];
+      if (!e->used) continue;
+      if (e->time > lasttime || (e->time == lasttime && i <= lastidx))
+        continue;
+      if (best < 0 || e->time > pr->e[best].time)
+        best = i;
+    }
+    if (best < 0) break;
+    reportentry(L, &pr->e[best], w, ud);
+    lasttime = pr->e[best].time;
+    lastidx = best;
+  }
+  if (pr->other.calls > 0 || pr->other.samples > 0)
+    reportentry(L, &pr->other, w, ud);
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+** Function level profiler for the Lua VM
+** See Copyright Notice in lua.h
+*/
+
+#ifndef lprof_h
+#define lprof_h
+
+#ifdef LUA_CROSS_COMPILER
+#include <stdint.h>
+#else
+#include "c_stdint.h"
+#endif
+
+#include "lobject.h"
+#include "lopcodes.h"
+#include "lstate.h"
+
+#ifdef LUA_PROFILER
+
+#define PROF_SRCLEN	24
+
+typedef struct ProfEntry {
+  const Proto *p;  /* NULL once the function has been collected */
+  lu_byte used;
+  int linedefined;
+  lu_int32 calls;
+  lu_int32 depth;  /* active calls, time is added when the last returns */
+  lu_int32 samples;  /* number of sampled opcodes */
+  uint64_t time;  /* inclusive, see PROF_UNIT */
+  lu_int32 ops[NUM_OPCODES];  /* sampled opcode histogram */
+  char source[PROF_SRCLEN];
+} ProfEntry;
+
+typedef struct Profiler {
+  int size;  /* number of entries, a power of 2 */
+  lu_int32 period;  /* sample one opcode out of `period' */
+  lu_int32 countdown;
+  const Proto *lastp;  /* one entry lookup cache */
+  ProfEntry *laste;
+  ProfEntry other;  /* functions that found no free entry */
+  ProfEntry e[1];
+} Profiler;
+
+#define sizeprofiler(n)	(sizeof(Profiler) + ((n)-1)*sizeof(ProfEntry))
+
+/* hooks for the VM; only called while G(L)->prof is set */
+#define luaI_profsample(L,p,op) \
+  { Profiler *pr_ = G(L)->prof; \
+    if (pr_ && --pr_->countdown == 0) luaI_profop(pr_, p, op); }
+
+LUAI_FUNC void luaI_profcall (lua_State *L, CallInfo *ci, const Proto *p);
+LUAI_FUNC void luaI_profreturn (lua_State *L, CallInfo *ci);
+LUAI_FUNC void luaI_proftailcall (lua_State *L, CallInfo *ci);
+LUAI_FUNC void luaI_profunwind (lua_State *L, CallInfo *ci);
+LUAI_FUNC void luaI_profop (Profiler *pr, const Proto *p, OpCode op);
+LUAI_FUNC void luaI_profforget (Profiler *pr, const Proto *p);
+
+typedef void (*lua_ProfWriter) (lua_State *L, const char *line, void *ud);
+
+LUAI_FUNC void luaI_profstart (lua_State *L, int nfuncs, int period);
+LUAI_FUNC void luaI_profstop (lua_State *L);
+LUAI_FUNC void luaI_profreport (lua_State *L, int top, lua_ProfWriter w,
+                                void *ud);
+
+#endif
+
+#endif
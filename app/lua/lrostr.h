@@ -0,0 +1,1570 @@
+/*
+** Flash-resident table of build-time strings
+** Generated by tools/make_rostr.py -- DO NOT EDIT
+*/
+
+#ifndef lrostr_h
+#define lrostr_h
+
+#define LUAS_NROSTR       518
+#define LUAS_ROSTRTSIZE   1024
+
+#endif
+
+/* the tables themselves are only expanded by lstring.c */
+#if defined(ROSTR) && !defined(lrostr_data)
+#define lrostr_data
+
+#define ROS(n)  cast(GCObject *, &luaS_rostr[n])
+
+const ROTString luaS_rostr[LUAS_NROSTR] = {
+  ROSTR(NULL, 0x00000f81u, 2, "=?"),
+  ROSTR(ROS(299), 0x4642198eu, 6, "=stdin"),
+  ROSTR(ROS(273), 0x0000005eu, 1, "?"),
+  ROSTR(NULL, 0xc88a6dfdu, 13, "ADDRESS_FLOAT"),
+  ROSTR(NULL, 0x4eadae1cu, 11, "ADDRESS_GND"),
+  ROSTR(ROS(175), 0x671056fau, 11, "ADDRESS_VDD"),
+  ROSTR(NULL, 0x92bb1cf6u, 10, "ALARM_AUTO"),
+  ROSTR(NULL, 0x2603e841u, 10, "ALARM_SEMI"),
+  ROSTR(NULL, 0x29b29024u, 12, "ALARM_SINGLE"),
+  ROSTR(NULL, 0x0002ca67u, 3, "CON"),
+  ROSTR(NULL, 0x985b4eaeu, 9, "CPHA_HIGH"),
+  ROSTR(ROS(49), 0x466a057au, 8, "CPHA_LOW"),
+  ROSTR(ROS(319), 0x742cffb8u, 9, "CPOL_HIGH"),
+  ROSTR(NULL, 0x479ce02cu, 8, "CPOL_LOW"),
+  ROSTR(ROS(228), 0x6be35b57u, 9, "CPU160MHZ"),
+  ROSTR(NULL, 0xbc586e80u, 8, "CPU80MHZ"),
+  ROSTR(ROS(83), 0x9214004du, 6, "Client"),
+  ROSTR(NULL, 0xae5e5998u, 10, "DATABITS_8"),
+  ROSTR(ROS(479), 0xce5d9927u, 8, "DRAW_ALL"),
+  ROSTR(ROS(298), 0x699b1b3cu, 15, "DRAW_LOWER_LEFT"),
+  ROSTR(NULL, 0x46ff3c62u, 16, "DRAW_LOWER_RIGHT"),
+  ROSTR(ROS(269), 0x820d3806u, 15, "DRAW_UPPER_LEFT"),
+  ROSTR(NULL, 0x4c7857bcu, 16, "DRAW_UPPER_RIGHT"),
+  ROSTR(ROS(69), 0x6d8db8aau, 14, "ERROR_CHECKSUM"),
+  ROSTR(NULL, 0xdbe44f02u, 13, "ERROR_TIMEOUT"),
+  ROSTR(ROS(266), 0x00699ea8u, 4, "FAST"),
+  ROSTR(NULL, 0x0f1af06du, 5, "FLOAT"),
+  ROSTR(ROS(35), 0x1a2a6028u, 15, "FONT_MODE_SOLID"),
+  ROSTR(ROS(200), 0xe7cf6600u, 21, "FONT_MODE_TRANSPARENT"),
+  ROSTR(NULL, 0x034b5d87u, 10, "FULLDUPLEX"),
+  ROSTR(ROS(515), 0x37739dd8u, 8, "GAIN_16X"),
+  ROSTR(ROS(418), 0x87a2431cu, 7, "GAIN_1X"),
+  ROSTR(ROS(375), 0x00604c51u, 10, "HALFDUPLEX"),
+  ROSTR(ROS(295), 0x00733b23u, 4, "HIGH"),
+  ROSTR(NULL, 0x0f362560u, 5, "INPUT"),
+  ROSTR(NULL, 0x00031428u, 3, "INT"),
+  ROSTR(ROS(412), 0x43a5696cu, 21, "INTEGRATIONTIME_101MS"),
+  ROSTR(NULL, 0xbeecac71u, 20, "INTEGRATIONTIME_13MS"),
+  ROSTR(ROS(347), 0xbadde6b4u, 21, "INTEGRATIONTIME_402MS"),
+  ROSTR(NULL, 0xb883f687u, 11, "LIGHT_SLEEP"),
+  ROSTR(ROS(325), 0x0002d896u, 3, "LOW"),
+  ROSTR(ROS(262), 0x3738797bu, 6, "MASTER"),
+  ROSTR(NULL, 0xdebfaa68u, 11, "MODEM_SLEEP"),
+  ROSTR(NULL, 0xf4786566u, 7, "MODE_BW"),
+  ROSTR(NULL, 0x32123dc7u, 13, "MODE_GRAY2BIT"),
+  ROSTR(NULL, 0x0002ca6cu, 3, "NON"),
+  ROSTR(ROS(117), 0x7bf1e7e8u, 10, "NONE_SLEEP"),
+  ROSTR(NULL, 0x9d2fc250u, 8, "NULLMODE"),
+  ROSTR(ROS(464), 0x00001118u, 2, "OK"),
+  ROSTR(NULL, 0x00641d7au, 4, "OPEN"),
+  ROSTR(NULL, 0x4fd29c44u, 6, "OUTPUT"),
+  ROSTR(NULL, 0xd281c5ecu, 10, "PACKAGE_CS"),
+  ROSTR(NULL, 0x56f03686u, 15, "PACKAGE_T_FN_CL"),
+  ROSTR(NULL, 0x7bba72b7u, 11, "PARITY_EVEN"),
+  ROSTR(ROS(328), 0x42679aefu, 11, "PARITY_NONE"),
+  ROSTR(NULL, 0x09845f38u, 10, "PARITY_ODD"),
+  ROSTR(ROS(455), 0x420080dcu, 9, "PHYMODE_B"),
+  ROSTR(NULL, 0x16f09328u, 9, "PHYMODE_G"),
+  ROSTR(ROS(236), 0xbbc8ec8du, 9, "PHYMODE_N"),
+  ROSTR(ROS(310), 0x3623b0efu, 6, "PULLUP"),
+  ROSTR(NULL, 0x887439ceu, 8, "RECEIVER"),
+  ROSTR(NULL, 0x0e6ed989u, 5, "SLAVE"),
+  ROSTR(NULL, 0x007b0cc1u, 4, "SLOW"),
+  ROSTR(NULL, 0x377a72d8u, 6, "SOFTAP"),
+  ROSTR(ROS(141), 0x27de731fu, 7, "STATION"),
+  ROSTR(NULL, 0x84764190u, 9, "STATIONAP"),
+  ROSTR(NULL, 0x5dbf9373u, 14, "STA_APNOTFOUND"),
+  ROSTR(ROS(361), 0xadfb6d3du, 14, "STA_CONNECTING"),
+  ROSTR(NULL, 0xcd911889u, 8, "STA_FAIL"),
+  ROSTR(NULL, 0xa6c834aau, 9, "STA_GOTIP"),
+  ROSTR(ROS(304), 0xc27bfc64u, 8, "STA_IDLE"),
+  ROSTR(NULL, 0x65b928a0u, 12, "STA_WRONGPWD"),
+  ROSTR(ROS(441), 0x12047032u, 10, "STOPBITS_1"),
+  ROSTR(NULL, 0xe5ef3fbfu, 12, "STOPBITS_1_5"),
+  ROSTR(NULL, 0x883388bcu, 10, "STOPBITS_2"),
+  ROSTR(NULL, 0x0002c30fu, 3, "TCP"),
+  ROSTR(NULL, 0x2af49867u, 11, "TRANSMITTER"),
+  ROSTR(NULL, 0x658db253u, 21, "TSL2561_ERROR_I2CBUSY"),
+  ROSTR(NULL, 0xf61e7badu, 21, "TSL2561_ERROR_I2CINIT"),
+  ROSTR(NULL, 0x5e479408u, 18, "TSL2561_ERROR_LAST"),
+  ROSTR(NULL, 0x0b4cace6u, 20, "TSL2561_ERROR_NOINIT"),
+  ROSTR(NULL, 0x2be9fd57u, 10, "TSL2561_OK"),
+  ROSTR(ROS(357), 0x0002c42eu, 3, "UDP"),
+  ROSTR(NULL, 0x0002c44du, 3, "WEP"),
+  ROSTR(NULL, 0x91ae351du, 8, "WPA2_PSK"),
+  ROSTR(ROS(277), 0xc6422bf2u, 7, "WPA_PSK"),
+  ROSTR(NULL, 0x89a4cc79u, 12, "WPA_WPA2_PSK"),
+  ROSTR(NULL, 0x000011a5u, 2, "_G"),
+  ROSTR(ROS(174), 0xbcc9fb24u, 7, "_LOADED"),
+  ROSTR(NULL, 0x781dacc6u, 8, "_VERSION"),
+  ROSTR(ROS(132), 0x10b7dcf8u, 5, "__add"),
+  ROSTR(ROS(206), 0x6a0ab7efu, 6, "__call"),
+  ROSTR(NULL, 0xfb441fb4u, 8, "__concat"),
+  ROSTR(NULL, 0x12fbb899u, 5, "__div"),
+  ROSTR(ROS(111), 0x007e46e3u, 4, "__eq"),
+  ROSTR(NULL, 0x0071cc66u, 4, "__gc"),
+  ROSTR(NULL, 0x761df46eu, 7, "__index"),
+  ROSTR(ROS(463), 0x0070fe0eu, 4, "__le"),
+  ROSTR(NULL, 0x105e60d4u, 5, "__len"),
+  ROSTR(NULL, 0x0078ca18u, 4, "__lt"),
+  ROSTR(NULL, 0xbdd03a15u, 11, "__metatable"),
+  ROSTR(ROS(134), 0x10be4bd0u, 5, "__mod"),
+  ROSTR(NULL, 0x4f2d73e3u, 6, "__mode"),
+  ROSTR(NULL, 0x104153c6u, 5, "__mul"),
+  ROSTR(ROS(411), 0x1a304bceu, 10, "__newindex"),
+  ROSTR(NULL, 0x1385e2cbu, 5, "__pow"),
+  ROSTR(NULL, 0x42c98aeau, 6, "__sink"),
+  ROSTR(ROS(374), 0x101f8c3eu, 5, "__sub"),
+  ROSTR(NULL, 0xd7d66906u, 10, "__tostring"),
+  ROSTR(ROS(476), 0x12820091u, 5, "__unm"),
+  ROSTR(ROS(173), 0x000355f4u, 3, "abs"),
+  ROSTR(NULL, 0x00795ee3u, 4, "acos"),
+  ROSTR(NULL, 0x000308a2u, 3, "adc"),
+  ROSTR(NULL, 0x9bbdaf9bu, 7, "address"),
+  ROSTR(ROS(317), 0x11782794u, 5, "alarm"),
+  ROSTR(NULL, 0x00036aa0u, 3, "alt"),
+  ROSTR(ROS(484), 0x0000167fu, 2, "ap"),
+  ROSTR(NULL, 0x17588be8u, 7, "arshift"),
+  ROSTR(ROS(217), 0x00838c37u, 4, "asin"),
+  ROSTR(ROS(459), 0x92ea3d15u, 6, "assert"),
+  ROSTR(NULL, 0x00743623u, 4, "atan"),
+  ROSTR(ROS(311), 0x0d9ad47cu, 5, "atan2"),
+  ROSTR(NULL, 0x41e17faeu, 11, "autoconnect"),
+  ROSTR(ROS(207), 0x74ee5969u, 6, "autogc"),
+  ROSTR(NULL, 0x00716270u, 4, "band"),
+  ROSTR(NULL, 0x10570798u, 5, "begin"),
+  ROSTR(NULL, 0x000367c5u, 3, "bit"),
+  ROSTR(NULL, 0xe7a69edbu, 6, "bmp085"),
+  ROSTR(NULL, 0x0078c465u, 4, "bnot"),
+  ROSTR(ROS(380), 0x314b9e3eu, 7, "boolean"),
+  ROSTR(NULL, 0x542713ebu, 10, "bootreason"),
+  ROSTR(NULL, 0x00035334u, 3, "bor"),
+  ROSTR(NULL, 0x007dfcf8u, 4, "bxor"),
+  ROSTR(NULL, 0x00701edcu, 4, "byte"),
+  ROSTR(ROS(252), 0x12e88bd0u, 9, "cachesize"),
+  ROSTR(NULL, 0xa5600a21u, 10, "cachestats"),
+  ROSTR(NULL, 0x007dfd22u, 4, "cbor"),
+  ROSTR(ROS(251), 0x007494b1u, 4, "ceil"),
+  ROSTR(NULL, 0x007e3098u, 4, "char"),
+  ROSTR(ROS(350), 0x1049269cu, 5, "check"),
+  ROSTR(ROS(360), 0x486f65bau, 11, "check_crc16"),
+  ROSTR(ROS(180), 0x71121b1fu, 6, "chipid"),
+  ROSTR(ROS(211), 0x106270e8u, 5, "cjson"),
+  ROSTR(NULL, 0x11117db0u, 5, "clear"),
+  ROSTR(NULL, 0xcf0396fcu, 11, "clearScreen"),
+  ROSTR(NULL, 0x10f23d83u, 5, "close"),
+  ROSTR(NULL, 0x0080d72fu, 4, "coap"),
+  ROSTR(NULL, 0x7631f05cu, 14, "collectgarbage"),
+  ROSTR(NULL, 0xaef45395u, 7, "compile"),
+  ROSTR(ROS(213), 0x854bec1au, 6, "concat"),
+  ROSTR(NULL, 0x81fd6cb9u, 6, "config"),
+  ROSTR(ROS(235), 0x363c4ee7u, 7, "connect"),
+  ROSTR(NULL, 0x1502c32eu, 9, "coroutine"),
+  ROSTR(ROS(382), 0x00034f2cu, 3, "cos"),
+  ROSTR(NULL, 0x007a894cu, 4, "cosh"),
+  ROSTR(NULL, 0x11badd1au, 5, "count"),
+  ROSTR(NULL, 0x1290dbf4u, 5, "cpath"),
+  ROSTR(ROS(330), 0x0d22fe2bu, 5, "crc16"),
+  ROSTR(NULL, 0x0063df1bu, 4, "crc8"),
+  ROSTR(ROS(338), 0x480eb176u, 6, "create"),
+  ROSTR(NULL, 0x258b6f12u, 16, "createConnection"),
+  ROSTR(ROS(426), 0x013817acu, 12, "createServer"),
+  ROSTR(NULL, 0x7c1c9da4u, 6, "crypto"),
+  ROSTR(ROS(231), 0x129d1212u, 5, "debug"),
+  ROSTR(NULL, 0x4f2c9cceu, 6, "decode"),
+  ROSTR(NULL, 0xd49e37d7u, 22, "decode_invalid_numbers"),
+  ROSTR(NULL, 0x58b2f5c0u, 18, "decode_keep_buffer"),
+  ROSTR(NULL, 0xf534bf05u, 16, "decode_max_depth"),
+  ROSTR(ROS(288), 0xa5ea15fcu, 7, "decoder"),
+  ROSTR(ROS(362), 0x000358cau, 3, "deg"),
+  ROSTR(ROS(448), 0x12aeafbeu, 5, "delay"),
+  ROSTR(NULL, 0x48301931u, 6, "delete"),
+  ROSTR(NULL, 0x9a8fb1c1u, 7, "depower"),
+  ROSTR(NULL, 0x007ec1f4u, 4, "dhcp"),
+  ROSTR(NULL, 0x00036724u, 3, "dht"),
+  ROSTR(ROS(255), 0xc90e9efau, 10, "disconnect"),
+  ROSTR(NULL, 0x00034f32u, 3, "dns"),
+  ROSTR(ROS(280), 0x4dce0dfbu, 6, "dofile"),
+  ROSTR(NULL, 0x55880bb5u, 10, "draw90Line"),
+  ROSTR(NULL, 0x5944fb4bu, 10, "drawBitmap"),
+  ROSTR(NULL, 0x3e15431fu, 7, "drawBox"),
+  ROSTR(ROS(367), 0xe72e25e5u, 10, "drawCircle"),
+  ROSTR(NULL, 0x18e79985u, 8, "drawDisc"),
+  ROSTR(NULL, 0x9504b29du, 11, "drawEllipse"),
+  ROSTR(NULL, 0xf0b89420u, 17, "drawFilledEllipse"),
+  ROSTR(ROS(210), 0xa86c7efdu, 9, "drawFrame"),
+  ROSTR(NULL, 0x5cf88639u, 9, "drawGlyph"),
+  ROSTR(NULL, 0x24365152u, 15, "drawGradientBox"),
+  ROSTR(NULL, 0x20d1467cu, 16, "drawGradientLine"),
+  ROSTR(NULL, 0x16c88dacu, 9, "drawHLine"),
+  ROSTR(NULL, 0xaa02cd72u, 8, "drawLine"),
+  ROSTR(NULL, 0x6b4c4980u, 9, "drawPixel"),
+  ROSTR(NULL, 0xa05df03fu, 8, "drawRBox"),
+  ROSTR(NULL, 0x23f479c9u, 10, "drawRFrame"),
+  ROSTR(NULL, 0xd084cd2eu, 7, "drawStr"),
+  ROSTR(NULL, 0x55c5ea41u, 10, "drawStr180"),
+  ROSTR(NULL, 0x45946f46u, 10, "drawStr270"),
+  ROSTR(NULL, 0x8d1d7d46u, 9, "drawStr90"),
+  ROSTR(NULL, 0xc839b752u, 10, "drawString"),
+  ROSTR(NULL, 0x1cb34a93u, 12, "drawTetragon"),
+  ROSTR(NULL, 0x6606f600u, 12, "drawTriangle"),
+  ROSTR(NULL, 0xed8c07dfu, 9, "drawVLine"),
+  ROSTR(ROS(340), 0x92356737u, 7, "drawXBM"),
+  ROSTR(ROS(443), 0x007f1fabu, 4, "drop"),
+  ROSTR(ROS(232), 0x8591bf75u, 6, "dsleep"),
+  ROSTR(NULL, 0xc70a86c2u, 14, "dsleep_aligned"),
+  ROSTR(ROS(212), 0xda6867efu, 19, "dsleep_until_sample"),
+  ROSTR(NULL, 0x6db9b169u, 15, "dsleepsetoption"),
+  ROSTR(ROS(496), 0x00811839u, 4, "dump"),
+  ROSTR(NULL, 0x4f2c9e24u, 6, "encode"),
+  ROSTR(NULL, 0xd49e36fdu, 22, "encode_invalid_numbers"),
+  ROSTR(NULL, 0x58b2f4e8u, 18, "encode_keep_buffer"),
+  ROSTR(NULL, 0xf534bfefu, 16, "encode_max_depth"),
+  ROSTR(NULL, 0xc0b6641au, 23, "encode_number_precision"),
+  ROSTR(NULL, 0x39ffbf7fu, 19, "encode_sparse_array"),
+  ROSTR(ROS(433), 0x58798f01u, 9, "encode_to"),
+  ROSTR(NULL, 0xb4eb5d63u, 13, "enduser_setup"),
+  ROSTR(ROS(422), 0x61402c37u, 7, "entries"),
+  ROSTR(NULL, 0x1227ebfeu, 5, "error"),
+  ROSTR(NULL, 0x33590bd8u, 11, "eventMonReg"),
+  ROSTR(ROS(279), 0xfb2d6090u, 13, "eventMonStart"),
+  ROSTR(NULL, 0x394947d2u, 12, "eventMonStop"),
+  ROSTR(NULL, 0x000398e3u, 3, "exp"),
+  ROSTR(NULL, 0x3be80d32u, 7, "extract"),
+  ROSTR(ROS(415), 0x0070feddu, 4, "file"),
+  ROSTR(NULL, 0x00716356u, 4, "find"),
+  ROSTR(NULL, 0x9fe690ffu, 6, "finish"),
+  ROSTR(ROS(402), 0x13563f55u, 9, "firstPage"),
+  ROSTR(ROS(283), 0xb222eb57u, 7, "flashid"),
+  ROSTR(NULL, 0xa27893bbu, 10, "flashimage"),
+  ROSTR(ROS(377), 0x131a91afu, 9, "flashsize"),
+  ROSTR(NULL, 0x1227ae12u, 5, "floor"),
+  ROSTR(NULL, 0x12902f75u, 5, "flush"),
+  ROSTR(NULL, 0x0071767au, 4, "fmod"),
+  ROSTR(NULL, 0xf02a92a9u, 7, "foreach"),
+  ROSTR(ROS(315), 0x7388aee7u, 8, "foreachi"),
+  ROSTR(NULL, 0x8548d48du, 6, "format"),
+  ROSTR(NULL, 0x11f6fb10u, 5, "frexp"),
+  ROSTR(ROS(408), 0x74a6ba9bu, 6, "fsinfo"),
+  ROSTR(NULL, 0x7c9f9568u, 8, "function"),
+  ROSTR(NULL, 0x0000140eu, 2, "gc"),
+  ROSTR(NULL, 0x74a6b886u, 6, "gcinfo"),
+  ROSTR(NULL, 0x0003675fu, 3, "get"),
+  ROSTR(NULL, 0xd5283591u, 13, "getColorIndex"),
+  ROSTR(NULL, 0x3dfd98d1u, 13, "getFontAscent"),
+  ROSTR(ROS(356), 0x1fbd3358u, 14, "getFontDescent"),
+  ROSTR(NULL, 0xae667f45u, 18, "getFontLineSpacing"),
+  ROSTR(NULL, 0x7c4abeb9u, 9, "getHeight"),
+  ROSTR(ROS(413), 0x5326783cu, 7, "getMode"),
+  ROSTR(NULL, 0xf798c13eu, 11, "getStrWidth"),
+  ROSTR(NULL, 0x3a22e6eeu, 8, "getWidth"),
+  ROSTR(NULL, 0xd7cd28b1u, 8, "get_miso"),
+  ROSTR(NULL, 0x11fd3fd0u, 5, "getap"),
+  ROSTR(NULL, 0xaa7017dbu, 12, "getbroadcast"),
+  ROSTR(NULL, 0xb4946e7du, 10, "getchannel"),
+  ROSTR(NULL, 0x905242fau, 9, "getclient"),
+  ROSTR(NULL, 0x48ec20a8u, 8, "getclock"),
+  ROSTR(NULL, 0xe7753144u, 9, "getconfig"),
+  ROSTR(NULL, 0x68f4f5b7u, 12, "getdnsserver"),
+  ROSTR(NULL, 0x638baf0du, 7, "getduty"),
+  ROSTR(NULL, 0x9ee7928fu, 7, "getfenv"),
+  ROSTR(ROS(355), 0x716c5a46u, 7, "gethook"),
+  ROSTR(ROS(437), 0x6c944d7bu, 7, "getinfo"),
+  ROSTR(ROS(303), 0x110d891eu, 5, "getip"),
+  ROSTR(NULL, 0xea6af56fu, 8, "getlocal"),
+  ROSTR(NULL, 0xb638421fu, 6, "getlux"),
+  ROSTR(NULL, 0x7b498ea8u, 6, "getmac"),
+  ROSTR(NULL, 0x48bed5deu, 12, "getmetatable"),
+  ROSTR(NULL, 0x5337cc69u, 7, "getmode"),
+  ROSTR(NULL, 0x0083b006u, 4, "getn"),
+  ROSTR(NULL, 0xa159eb51u, 7, "getpeer"),
+  ROSTR(NULL, 0xfe9d1a5du, 10, "getphymode"),
+  ROSTR(NULL, 0xda52f4f1u, 14, "getrawchannels"),
+  ROSTR(NULL, 0x5f18d85eu, 11, "getregistry"),
+  ROSTR(ROS(349), 0x4a552950u, 10, "getupvalue"),
+  ROSTR(NULL, 0x10beb674u, 5, "gfind"),
+  ROSTR(NULL, 0x6aec6388u, 6, "gmatch"),
+  ROSTR(ROS(417), 0x0080abf2u, 4, "gpio"),
+  ROSTR(NULL, 0x0075b2ccu, 4, "gsub"),
+  ROSTR(NULL, 0x007a8890u, 4, "hash"),
+  ROSTR(NULL, 0x0080c9fbu, 4, "heap"),
+  ROSTR(NULL, 0x0071b78eu, 4, "hmac"),
+  ROSTR(NULL, 0x00717c2au, 4, "hold"),
+  ROSTR(NULL, 0x0070db57u, 4, "huge"),
+  ROSTR(NULL, 0x0d8b6052u, 5, "hx711"),
+  ROSTR(ROS(386), 0x00030273u, 3, "i2c"),
+  ROSTR(ROS(334), 0x0080869au, 4, "info"),
+  ROSTR(NULL, 0x00792e13u, 4, "init"),
+  ROSTR(NULL, 0x11bc99fcu, 5, "input"),
+  ROSTR(NULL, 0x92ea3d93u, 6, "insert"),
+  ROSTR(NULL, 0xa8ce778cu, 8, "interval"),
+  ROSTR(NULL, 0x00001699u, 2, "io"),
+  ROSTR(ROS(504), 0xb2cdffaau, 7, "isclear"),
+  ROSTR(NULL, 0x12db8f1eu, 5, "isset"),
+  ROSTR(NULL, 0x00037c4au, 3, "key"),
+  ROSTR(NULL, 0x8e8a1f23u, 8, "lazyload"),
+  ROSTR(ROS(474), 0x11f6f8c5u, 5, "ldexp"),
+  ROSTR(NULL, 0x00032549u, 3, "led"),
+  ROSTR(NULL, 0x00037f3cu, 3, "len"),
+  ROSTR(NULL, 0x6adb4d8eu, 13, "lightfunction"),
+  ROSTR(NULL, 0x12e7e8e1u, 5, "lines"),
+  ROSTR(NULL, 0x0078f40bu, 4, "list"),
+  ROSTR(NULL, 0x411d42c7u, 6, "listen"),
+  ROSTR(NULL, 0x0071311eu, 4, "load"),
+  ROSTR(NULL, 0x76ee0464u, 6, "loaded"),
+  ROSTR(ROS(477), 0x9a4baf6bu, 7, "loaders"),
+  ROSTR(NULL, 0x7378897fu, 8, "loadfile"),
+  ROSTR(NULL, 0xd5c88138u, 10, "loadstring"),
+  ROSTR(NULL, 0x00035a81u, 3, "log"),
+  ROSTR(NULL, 0x0d5e8331u, 5, "log10"),
+  ROSTR(NULL, 0x1231d4efu, 5, "lower"),
+  ROSTR(NULL, 0x92fab47cu, 6, "lshift"),
+  ROSTR(NULL, 0x000369f9u, 3, "lwt"),
+  ROSTR(NULL, 0x2a7db6abu, 10, "main chunk"),
+  ROSTR(NULL, 0x00752385u, 4, "mask"),
+  ROSTR(NULL, 0x128cdae7u, 5, "match"),
+  ROSTR(NULL, 0x007a8c6cu, 4, "math"),
+  ROSTR(NULL, 0x00037794u, 3, "max"),
+  ROSTR(ROS(503), 0x0083ce58u, 4, "maxn"),
+  ROSTR(NULL, 0x00037fb8u, 3, "min"),
+  ROSTR(NULL, 0x000336d9u, 3, "mod"),
+  ROSTR(NULL, 0x0070d62du, 4, "mode"),
+  ROSTR(ROS(454), 0x00705816u, 4, "modf"),
+  ROSTR(NULL, 0x0078e9c3u, 4, "mqtt"),
+  ROSTR(NULL, 0x087a3c53u, 13, "multicastJoin"),
+  ROSTR(NULL, 0x4c7c5896u, 14, "multicastLeave"),
+  ROSTR(NULL, 0x0000008fu, 1, "n"),
+  ROSTR(NULL, 0x00036754u, 3, "net"),
+  ROSTR(NULL, 0x00039aefu, 3, "new"),
+  ROSTR(NULL, 0x007898d3u, 4, "next"),
+  ROSTR(NULL, 0x14434e2bu, 8, "nextPage"),
+  ROSTR(ROS(395), 0x000347c9u, 3, "nil"),
+  ROSTR(NULL, 0x0070d62eu, 4, "node"),
+  ROSTR(NULL, 0x7c728eafu, 17, "not enough memory"),
+  ROSTR(NULL, 0x00039e9au, 3, "now"),
+  ROSTR(NULL, 0x00754efeu, 4, "null"),
+  ROSTR(NULL, 0x77db8760u, 6, "number"),
+  ROSTR(NULL, 0x000016b6u, 2, "on"),
+  ROSTR(NULL, 0x00746576u, 4, "open"),
+  ROSTR(NULL, 0x0000160au, 2, "os"),
+  ROSTR(NULL, 0x92914b37u, 6, "output"),
+  ROSTR(NULL, 0x00001789u, 2, "ow"),
+  ROSTR(NULL, 0x1bac26c4u, 7, "package"),
+  ROSTR(NULL, 0x007a8c61u, 4, "path"),
+  ROSTR(NULL, 0x114da26eu, 5, "pcall"),
+  ROSTR(NULL, 0x0075cdd0u, 4, "peek"),
+  ROSTR(NULL, 0x00001551u, 2, "pi"),
+  ROSTR(NULL, 0x00039ab4u, 3, "pop"),
+  ROSTR(NULL, 0x105e5431u, 5, "popen"),
+  ROSTR(NULL, 0x0078f550u, 4, "post"),
+  ROSTR(NULL, 0x00039e9cu, 3, "pow"),
+  ROSTR(NULL, 0x00c84c68u, 7, "preload"),
+  ROSTR(NULL, 0x4b3c06b5u, 7, "prepare"),
+  ROSTR(ROS(384), 0xe0636819u, 8, "pressure"),
+  ROSTR(NULL, 0xd16b6cedu, 12, "pressure_raw"),
+  ROSTR(NULL, 0x11baae46u, 5, "print"),
+  ROSTR(NULL, 0xaef92f58u, 7, "profile"),
+  ROSTR(NULL, 0xa7db382eu, 10, "profreport"),
+  ROSTR(NULL, 0x1100e1d1u, 5, "proto"),
+  ROSTR(NULL, 0x5105242bu, 7, "publish"),
+  ROSTR(ROS(396), 0x000369bau, 3, "put"),
+  ROSTR(NULL, 0x0003413du, 3, "pwm"),
+  ROSTR(NULL, 0x000324cau, 3, "rad"),
+  ROSTR(NULL, 0x7e4db74eu, 6, "random"),
+  ROSTR(NULL, 0x5e6d5790u, 10, "randomseed"),
+  ROSTR(ROS(392), 0x59b412dau, 8, "rawequal"),
+  ROSTR(NULL, 0x7b5f69f7u, 6, "rawget"),
+  ROSTR(ROS(424), 0x7b26d5e5u, 6, "rawset"),
+  ROSTR(NULL, 0x0000141bu, 2, "rc"),
+  ROSTR(NULL, 0x00712679u, 4, "read"),
+  ROSTR(NULL, 0xe092b9efu, 6, "read11"),
+  ROSTR(NULL, 0x095c7697u, 6, "read32"),
+  ROSTR(NULL, 0x3e65eebau, 10, "read_bytes"),
+  ROSTR(NULL, 0x756bce3du, 8, "readline"),
+  ROSTR(NULL, 0xbc56883eu, 9, "readvdd33"),
+  ROSTR(NULL, 0xac451851u, 6, "readxx"),
+  ROSTR(NULL, 0x12d3a0cfu, 5, "ready"),
+  ROSTR(NULL, 0x007835afu, 4, "recv"),
+  ROSTR(NULL, 0xa66264a3u, 8, "register"),
+  ROSTR(ROS(442), 0x4893da49u, 6, "remove"),
+  ROSTR(NULL, 0x4dc9263eu, 6, "rename"),
+  ROSTR(NULL, 0x00035616u, 3, "rep"),
+  ROSTR(NULL, 0x8ca2732cu, 7, "replace"),
+  ROSTR(NULL, 0x12db9d9fu, 5, "reset"),
+  ROSTR(ROS(478), 0xfb286419u, 12, "reset_search"),
+  ROSTR(NULL, 0x45af771du, 7, "resolve"),
+  ROSTR(NULL, 0x76653673u, 7, "restart"),
+  ROSTR(NULL, 0x4af2488eu, 7, "restore"),
+  ROSTR(ROS(468), 0x4dcbbb41u, 6, "resume"),
+  ROSTR(NULL, 0xb20b609bu, 7, "reverse"),
+  ROSTR(NULL, 0xdb906970u, 8, "romtable"),
+  ROSTR(NULL, 0x92fab402u, 6, "rshift"),
+  ROSTR(NULL, 0x7543d2dau, 7, "rtcfifo"),
+  ROSTR(NULL, 0x7f9ac91cu, 6, "rtcmem"),
+  ROSTR(ROS(397), 0x443346cfu, 7, "rtctime"),
+  ROSTR(NULL, 0xf4595fc9u, 7, "running"),
+  ROSTR(NULL, 0x6aea21bau, 6, "search"),
+  ROSTR(NULL, 0x6a0dc6cfu, 6, "seeall"),
+  ROSTR(NULL, 0x0075cdddu, 4, "seek"),
+  ROSTR(NULL, 0x866bd8f4u, 6, "select"),
+  ROSTR(NULL, 0x007ff8b0u, 4, "self"),
+  ROSTR(NULL, 0x007161c4u, 4, "send"),
+  ROSTR(NULL, 0x92902355u, 6, "serout"),
+  ROSTR(NULL, 0x00036753u, 3, "set"),
+  ROSTR(NULL, 0xc856f66du, 12, "setClipRange"),
+  ROSTR(NULL, 0x80d3f4dfu, 8, "setColor"),
+  ROSTR(NULL, 0xd528359du, 13, "setColorIndex"),
+  ROSTR(NULL, 0xad4c1036u, 25, "setDefaultBackgroundColor"),
+  ROSTR(NULL, 0xfda1029bu, 25, "setDefaultForegroundColor"),
+  ROSTR(NULL, 0x92bf5675u, 7, "setFont"),
+  ROSTR(ROS(489), 0x13034603u, 24, "setFontLineSpacingFactor"),
+  ROSTR(NULL, 0xba1a87ceu, 11, "setFontMode"),
+  ROSTR(NULL, 0xffe3a96cu, 18, "setFontPosBaseline"),
+  ROSTR(NULL, 0x29c4b83cu, 16, "setFontPosBottom"),
+  ROSTR(NULL, 0x9189df7cu, 16, "setFontPosCenter"),
+  ROSTR(NULL, 0xc956aeddu, 13, "setFontPosTop"),
+  ROSTR(NULL, 0x7a98a1e1u, 19, "setFontRefHeightAll"),
+  ROSTR(NULL, 0xc2d50ff2u, 28, "setFontRefHeightExtendedText"),
+  ROSTR(NULL, 0x3f95bb1cu, 20, "setFontRefHeightText"),
+  ROSTR(NULL, 0xfde5fc88u, 15, "setMaxClipRange"),
+  ROSTR(NULL, 0xa05fe90bu, 11, "setPrintDir"),
+  ROSTR(NULL, 0xfbdb4bfdu, 11, "setPrintPos"),
+  ROSTR(NULL, 0xc80b7437u, 9, "setRot180"),
+  ROSTR(NULL, 0x2650e2bbu, 9, "setRot270"),
+  ROSTR(ROS(488), 0x83f5ede5u, 8, "setRot90"),
+  ROSTR(NULL, 0x7395963bu, 12, "setRotate180"),
+  ROSTR(NULL, 0xe82c43acu, 12, "setRotate270"),
+  ROSTR(ROS(444), 0x4f63b2f9u, 11, "setRotate90"),
+  ROSTR(NULL, 0x95071e64u, 11, "setScale2x2"),
+  ROSTR(ROS(485), 0x5250fc17u, 8, "set_mosi"),
+  ROSTR(NULL, 0x48ec20a4u, 8, "setclock"),
+  ROSTR(NULL, 0x82360f22u, 10, "setcpufreq"),
+  ROSTR(NULL, 0x68f4f243u, 12, "setdnsserver"),
+  ROSTR(NULL, 0x638baf01u, 7, "setduty"),
+  ROSTR(NULL, 0x9ee792fbu, 7, "setfenv"),
+  ROSTR(NULL, 0x716c5a72u, 7, "sethook"),
+  ROSTR(NULL, 0x110d890au, 5, "setip"),
+  ROSTR(ROS(471), 0xea6af57bu, 8, "setlocal"),
+  ROSTR(NULL, 0x7b498e54u, 6, "setmac"),
+  ROSTR(NULL, 0x48bed5d2u, 12, "setmetatable"),
+  ROSTR(NULL, 0x5337cc15u, 7, "setmode"),
+  ROSTR(NULL, 0x0083b032u, 4, "setn"),
+  ROSTR(NULL, 0xfe9d1a49u, 10, "setphymode"),
+  ROSTR(NULL, 0xd6f6c3abu, 9, "settiming"),
+  ROSTR(NULL, 0x11f016f9u, 5, "setup"),
+  ROSTR(NULL, 0x4a55295cu, 10, "setupvalue"),
+  ROSTR(NULL, 0x87113440u, 7, "setvbuf"),
+  ROSTR(NULL, 0x00600a44u, 4, "sha1"),
+  ROSTR(ROS(509), 0x00037fbeu, 3, "sin"),
+  ROSTR(NULL, 0x007af5f6u, 4, "sinh"),
+  ROSTR(NULL, 0x007ef830u, 4, "skip"),
+  ROSTR(NULL, 0x110d7ce0u, 5, "sleep"),
+  ROSTR(NULL, 0x9e0cf24au, 8, "sleepOff"),
+  ROSTR(NULL, 0xeee313d9u, 7, "sleepOn"),
+  ROSTR(NULL, 0x305b5c16u, 9, "sleeptype"),
+  ROSTR(NULL, 0x007e84dcu, 4, "sntp"),
+  ROSTR(NULL, 0x56f11f5cu, 6, "softwd"),
+  ROSTR(ROS(517), 0x0078e0eau, 4, "sort"),
+  ROSTR(NULL, 0x00033295u, 3, "spi"),
+  ROSTR(NULL, 0x0078e115u, 4, "sqrt"),
+  ROSTR(NULL, 0x0003131au, 3, "sta"),
+  ROSTR(NULL, 0x11bcd3fcu, 5, "start"),
+  ROSTR(NULL, 0x34ec787fu, 10, "startsmart"),
+  ROSTR(NULL, 0x0079220eu, 4, "stat"),
+  ROSTR(NULL, 0x10ee0118u, 5, "state"),
+  ROSTR(NULL, 0x86b6a8ccu, 6, "status"),
+  ROSTR(NULL, 0x007f1fdau, 4, "stop"),
+  ROSTR(NULL, 0xaad8d35du, 9, "stopsmart"),
+  ROSTR(NULL, 0x81f98b41u, 6, "string"),
+  ROSTR(NULL, 0x569a86c9u, 10, "stripdebug"),
+  ROSTR(NULL, 0x00031ef0u, 3, "sub"),
+  ROSTR(NULL, 0x7e35517bu, 9, "subscribe"),
+  ROSTR(NULL, 0x0071e8fau, 4, "sync"),
+  ROSTR(ROS(502), 0x10f2114bu, 5, "table"),
+  ROSTR(NULL, 0x007494c5u, 4, "tail"),
+  ROSTR(ROS(514), 0x00037cabu, 3, "tan"),
+  ROSTR(NULL, 0x007af491u, 4, "tanh"),
+  ROSTR(NULL, 0x6741df6bu, 13, "target_search"),
+  ROSTR(NULL, 0x53664c19u, 11, "temperature"),
+  ROSTR(NULL, 0x70d04127u, 6, "thread"),
+  ROSTR(NULL, 0x0070fb6au, 4, "time"),
+  ROSTR(NULL, 0xaef9313fu, 7, "tmpfile"),
+  ROSTR(NULL, 0x000352e8u, 3, "tmr"),
+  ROSTR(NULL, 0xac9583a3u, 8, "toBase64"),
+  ROSTR(NULL, 0x13939a7fu, 5, "toHex"),
+  ROSTR(NULL, 0x09871c17u, 8, "tonumber"),
+  ROSTR(NULL, 0x787eb105u, 8, "tostring"),
+  ROSTR(NULL, 0xc2ea51a9u, 9, "traceback"),
+  ROSTR(NULL, 0x27a8d1e5u, 11, "transaction"),
+  ROSTR(NULL, 0x00830203u, 4, "trig"),
+  ROSTR(NULL, 0x120334c9u, 7, "tsl2561"),
+  ROSTR(NULL, 0x0070ef71u, 4, "type"),
+  ROSTR(NULL, 0x0003140du, 3, "u8g"),
+  ROSTR(NULL, 0x0078e33fu, 4, "uart"),
+  ROSTR(NULL, 0x00035939u, 3, "ucg"),
+  ROSTR(NULL, 0x76843369u, 13, "undoClipRange"),
+  ROSTR(NULL, 0x1bba4c39u, 10, "undoRotate"),
+  ROSTR(NULL, 0xb464a1f3u, 12, "undoRotation"),
+  ROSTR(NULL, 0x6c17cbb3u, 9, "undoScale"),
+  ROSTR(NULL, 0x552d453au, 6, "unhold"),
+  ROSTR(NULL, 0x5edba9cbu, 6, "unpack"),
+  ROSTR(NULL, 0x7dc9f902u, 10, "unregister"),
+  ROSTR(NULL, 0x1231f54bu, 5, "upper"),
+  ROSTR(NULL, 0x11326a58u, 5, "upval"),
+  ROSTR(NULL, 0x4e833baau, 8, "userdata"),
+  ROSTR(NULL, 0x12253810u, 5, "wdclr"),
+  ROSTR(NULL, 0x007a19ccu, 4, "wifi"),
+  ROSTR(NULL, 0x0080d7d5u, 4, "wrap"),
+  ROSTR(NULL, 0x10ee60d2u, 5, "write"),
+  ROSTR(NULL, 0x40f63bbeu, 7, "write32"),
+  ROSTR(NULL, 0x33ec51aau, 11, "write_bytes"),
+  ROSTR(NULL, 0xc66a0596u, 9, "writeline"),
+  ROSTR(NULL, 0x01bc789au, 8, "writergb"),
+  ROSTR(NULL, 0xa4c84934u, 10, "writestats"),
+  ROSTR(NULL, 0xe2aaccabu, 6, "ws2801"),
+  ROSTR(NULL, 0x08f601d8u, 6, "ws2812"),
+  ROSTR(NULL, 0x6a0aacc2u, 6, "xpcall"),
+  ROSTR(NULL, 0x10c250eau, 5, "yield"),
+};
+
+static const ROTString *const luaS_rostrt[LUAS_ROSTRTSIZE] = {
+  NULL,
+  NULL,
+  &luaS_rostr[391],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[21],
+  NULL,
+  &luaS_rostr[79],
+  NULL,
+  NULL,
+  &luaS_rostr[301],
+  NULL,
+  &luaS_rostr[492],
+  &luaS_rostr[240],
+  NULL,
+  &luaS_rostr[505],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[440],
+  &luaS_rostr[322],
+  &luaS_rostr[429],
+  NULL,
+  &luaS_rostr[353],
+  &luaS_rostr[149],
+  &luaS_rostr[368],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[184],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[8],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[27],
+  NULL,
+  &luaS_rostr[282],
+  &luaS_rostr[359],
+  &luaS_rostr[13],
+  NULL,
+  &luaS_rostr[82],
+  NULL,
+  &luaS_rostr[450],
+  &luaS_rostr[348],
+  &luaS_rostr[72],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[407],
+  &luaS_rostr[118],
+  NULL,
+  &luaS_rostr[208],
+  NULL,
+  NULL,
+  &luaS_rostr[248],
+  NULL,
+  &luaS_rostr[107],
+  &luaS_rostr[192],
+  &luaS_rostr[446],
+  &luaS_rostr[7],
+  NULL,
+  NULL,
+  &luaS_rostr[50],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[294],
+  NULL,
+  NULL,
+  &luaS_rostr[16],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[32],
+  &luaS_rostr[284],
+  &luaS_rostr[324],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[147],
+  NULL,
+  &luaS_rostr[2],
+  NULL,
+  NULL,
+  &luaS_rostr[343],
+  &luaS_rostr[20],
+  NULL,
+  &luaS_rostr[70],
+  &luaS_rostr[128],
+  &luaS_rostr[95],
+  &luaS_rostr[76],
+  &luaS_rostr[351],
+  &luaS_rostr[268],
+  NULL,
+  NULL,
+  &luaS_rostr[316],
+  &luaS_rostr[26],
+  &luaS_rostr[96],
+  NULL,
+  NULL,
+  &luaS_rostr[37],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[86],
+  NULL,
+  NULL,
+  &luaS_rostr[121],
+  NULL,
+  NULL,
+  &luaS_rostr[462],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[241],
+  NULL,
+  &luaS_rostr[419],
+  &luaS_rostr[68],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[58],
+  &luaS_rostr[387],
+  &luaS_rostr[326],
+  &luaS_rostr[220],
+  &luaS_rostr[109],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[40],
+  NULL,
+  &luaS_rostr[138],
+  &luaS_rostr[93],
+  &luaS_rostr[512],
+  &luaS_rostr[389],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[71],
+  NULL,
+  &luaS_rostr[112],
+  &luaS_rostr[378],
+  &luaS_rostr[430],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[256],
+  NULL,
+  &luaS_rostr[23],
+  &luaS_rostr[475],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[400],
+  &luaS_rostr[137],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[150],
+  NULL,
+  NULL,
+  &luaS_rostr[74],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[62],
+  &luaS_rostr[516],
+  NULL,
+  NULL,
+  &luaS_rostr[296],
+  &luaS_rostr[89],
+  NULL,
+  NULL,
+  &luaS_rostr[490],
+  &luaS_rostr[169],
+  NULL,
+  &luaS_rostr[465],
+  NULL,
+  &luaS_rostr[164],
+  &luaS_rostr[376],
+  NULL,
+  &luaS_rostr[244],
+  &luaS_rostr[508],
+  &luaS_rostr[329],
+  &luaS_rostr[98],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[56],
+  NULL,
+  NULL,
+  &luaS_rostr[405],
+  &luaS_rostr[451],
+  &luaS_rostr[300],
+  NULL,
+  &luaS_rostr[222],
+  NULL,
+  NULL,
+  &luaS_rostr[80],
+  NULL,
+  &luaS_rostr[142],
+  NULL,
+  &luaS_rostr[457],
+  NULL,
+  NULL,
+  &luaS_rostr[354],
+  NULL,
+  &luaS_rostr[59],
+  NULL,
+  &luaS_rostr[272],
+  NULL,
+  NULL,
+  &luaS_rostr[399],
+  NULL,
+  &luaS_rostr[6],
+  NULL,
+  &luaS_rostr[90],
+  NULL,
+  &luaS_rostr[472],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[226],
+  NULL,
+  NULL,
+  &luaS_rostr[501],
+  NULL,
+  NULL,
+  &luaS_rostr[486],
+  &luaS_rostr[108],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[436],
+  &luaS_rostr[420],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[119],
+  NULL,
+  NULL,
+  &luaS_rostr[48],
+  NULL,
+  &luaS_rostr[155],
+  NULL,
+  &luaS_rostr[393],
+  &luaS_rostr[84],
+  &luaS_rostr[263],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[136],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[18],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[194],
+  NULL,
+  NULL,
+  &luaS_rostr[171],
+  &luaS_rostr[223],
+  NULL,
+  &luaS_rostr[513],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[307],
+  &luaS_rostr[494],
+  &luaS_rostr[499],
+  NULL,
+  NULL,
+  &luaS_rostr[67],
+  &luaS_rostr[249],
+  &luaS_rostr[481],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[257],
+  NULL,
+  &luaS_rostr[197],
+  NULL,
+  NULL,
+  &luaS_rostr[297],
+  NULL,
+  &luaS_rostr[473],
+  &luaS_rostr[154],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[274],
+  &luaS_rostr[346],
+  &luaS_rostr[187],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[81],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[445],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[34],
+  NULL,
+  NULL,
+  &luaS_rostr[216],
+  NULL,
+  NULL,
+  &luaS_rostr[43],
+  NULL,
+  &luaS_rostr[239],
+  &luaS_rostr[123],
+  NULL,
+  NULL,
+  &luaS_rostr[36],
+  NULL,
+  NULL,
+  &luaS_rostr[264],
+  &luaS_rostr[390],
+  NULL,
+  &luaS_rostr[190],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[159],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[11],
+  &luaS_rostr[41],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[306],
+  &luaS_rostr[191],
+  NULL,
+  NULL,
+  &luaS_rostr[145],
+  NULL,
+  &luaS_rostr[182],
+  NULL,
+  &luaS_rostr[29],
+  NULL,
+  &luaS_rostr[61],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[1],
+  NULL,
+  &luaS_rostr[65],
+  &luaS_rostr[243],
+  NULL,
+  &luaS_rostr[289],
+  NULL,
+  NULL,
+  &luaS_rostr[511],
+  NULL,
+  &luaS_rostr[17],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[406],
+  NULL,
+  &luaS_rostr[383],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[162],
+  &luaS_rostr[87],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[487],
+  &luaS_rostr[510],
+  NULL,
+  &luaS_rostr[189],
+  NULL,
+  NULL,
+  &luaS_rostr[230],
+  &luaS_rostr[143],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[258],
+  NULL,
+  NULL,
+  &luaS_rostr[140],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[166],
+  &luaS_rostr[172],
+  NULL,
+  &luaS_rostr[323],
+  &luaS_rostr[401],
+  NULL,
+  NULL,
+  &luaS_rostr[44],
+  NULL,
+  &luaS_rostr[193],
+  NULL,
+  &luaS_rostr[500],
+  &luaS_rostr[506],
+  NULL,
+  &luaS_rostr[60],
+  NULL,
+  &luaS_rostr[345],
+  &luaS_rostr[358],
+  &luaS_rostr[439],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[30],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[398],
+  &luaS_rostr[267],
+  NULL,
+  NULL,
+  &luaS_rostr[416],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[181],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[51],
+  NULL,
+  NULL,
+  &luaS_rostr[370],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[497],
+  &luaS_rostr[110],
+  NULL,
+  &luaS_rostr[449],
+  &luaS_rostr[366],
+  NULL,
+  &luaS_rostr[312],
+  NULL,
+  &luaS_rostr[177],
+  &luaS_rostr[168],
+  &luaS_rostr[3],
+  NULL,
+  NULL,
+  &luaS_rostr[28],
+  NULL,
+  NULL,
+  &luaS_rostr[410],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[339],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[97],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[163],
+  &luaS_rostr[287],
+  NULL,
+  &luaS_rostr[100],
+  &luaS_rostr[381],
+  NULL,
+  &luaS_rostr[99],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[4],
+  NULL,
+  NULL,
+  &luaS_rostr[265],
+  NULL,
+  &luaS_rostr[135],
+  NULL,
+  &luaS_rostr[120],
+  &luaS_rostr[209],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[157],
+  NULL,
+  &luaS_rostr[321],
+  &luaS_rostr[332],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[186],
+  NULL,
+  &luaS_rostr[425],
+  NULL,
+  &luaS_rostr[373],
+  &luaS_rostr[129],
+  NULL,
+  NULL,
+  &luaS_rostr[195],
+  NULL,
+  &luaS_rostr[432],
+  &luaS_rostr[447],
+  NULL,
+  &luaS_rostr[261],
+  NULL,
+  NULL,
+  &luaS_rostr[379],
+  &luaS_rostr[452],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[47],
+  NULL,
+  NULL,
+  &luaS_rostr[77],
+  &luaS_rostr[438],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[318],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[271],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[428],
+  NULL,
+  NULL,
+  &luaS_rostr[9],
+  &luaS_rostr[42],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[45],
+  &luaS_rostr[404],
+  &luaS_rostr[344],
+  NULL,
+  &luaS_rostr[124],
+  NULL,
+  &luaS_rostr[435],
+  &luaS_rostr[285],
+  &luaS_rostr[275],
+  &luaS_rostr[409],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[369],
+  &luaS_rostr[233],
+  NULL,
+  &luaS_rostr[188],
+  &luaS_rostr[254],
+  NULL,
+  &luaS_rostr[116],
+  &luaS_rostr[15],
+  &luaS_rostr[308],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[52],
+  &luaS_rostr[39],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[260],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[199],
+  NULL,
+  &luaS_rostr[458],
+  NULL,
+  &luaS_rostr[371],
+  NULL,
+  &luaS_rostr[291],
+  &luaS_rostr[286],
+  &luaS_rostr[238],
+  &luaS_rostr[139],
+  &luaS_rostr[183],
+  NULL,
+  NULL,
+  &luaS_rostr[115],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[25],
+  &luaS_rostr[234],
+  NULL,
+  &luaS_rostr[313],
+  NULL,
+  NULL,
+  &luaS_rostr[10],
+  &luaS_rostr[333],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[38],
+  &luaS_rostr[352],
+  &luaS_rostr[337],
+  &luaS_rostr[53],
+  NULL,
+  &luaS_rostr[247],
+  &luaS_rostr[372],
+  &luaS_rostr[423],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[205],
+  NULL,
+  &luaS_rostr[342],
+  NULL,
+  NULL,
+  &luaS_rostr[302],
+  NULL,
+  &luaS_rostr[469],
+  NULL,
+  &luaS_rostr[105],
+  &luaS_rostr[278],
+  NULL,
+  NULL,
+  &luaS_rostr[394],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[63],
+  &luaS_rostr[320],
+  &luaS_rostr[365],
+  &luaS_rostr[127],
+  &luaS_rostr[133],
+  &luaS_rostr[224],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[94],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[151],
+  &luaS_rostr[482],
+  NULL,
+  &luaS_rostr[106],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[250],
+  &luaS_rostr[54],
+  &luaS_rostr[470],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[427],
+  &luaS_rostr[5],
+  &luaS_rostr[434],
+  &luaS_rostr[144],
+  &luaS_rostr[185],
+  &luaS_rostr[335],
+  NULL,
+  NULL,
+  &luaS_rostr[215],
+  &luaS_rostr[24],
+  NULL,
+  NULL,
+  &luaS_rostr[167],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[259],
+  NULL,
+  &luaS_rostr[75],
+  &luaS_rostr[237],
+  NULL,
+  &luaS_rostr[160],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[460],
+  &luaS_rostr[158],
+  &luaS_rostr[31],
+  &luaS_rostr[385],
+  &luaS_rostr[293],
+  &luaS_rostr[64],
+  NULL,
+  NULL,
+  &luaS_rostr[431],
+  &luaS_rostr[33],
+  &luaS_rostr[88],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[57],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[153],
+  NULL,
+  &luaS_rostr[152],
+  &luaS_rostr[146],
+  NULL,
+  &luaS_rostr[309],
+  &luaS_rostr[176],
+  NULL,
+  &luaS_rostr[131],
+  NULL,
+  NULL,
+  &luaS_rostr[202],
+  &luaS_rostr[55],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[19],
+  NULL,
+  NULL,
+  &luaS_rostr[493],
+  NULL,
+  &luaS_rostr[388],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[246],
+  &luaS_rostr[196],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[179],
+  NULL,
+  NULL,
+  &luaS_rostr[363],
+  NULL,
+  NULL,
+  &luaS_rostr[270],
+  &luaS_rostr[198],
+  &luaS_rostr[403],
+  &luaS_rostr[327],
+  &luaS_rostr[227],
+  &luaS_rostr[225],
+  &luaS_rostr[14],
+  &luaS_rostr[245],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[456],
+  &luaS_rostr[467],
+  NULL,
+  &luaS_rostr[242],
+  &luaS_rostr[336],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[495],
+  &luaS_rostr[480],
+  &luaS_rostr[305],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[491],
+  NULL,
+  &luaS_rostr[66],
+  NULL,
+  &luaS_rostr[204],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[414],
+  NULL,
+  NULL,
+  &luaS_rostr[214],
+  NULL,
+  &luaS_rostr[0],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[314],
+  NULL,
+  NULL,
+  &luaS_rostr[276],
+  &luaS_rostr[341],
+  NULL,
+  NULL,
+  &luaS_rostr[290],
+  NULL,
+  &luaS_rostr[281],
+  NULL,
+  &luaS_rostr[364],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[114],
+  &luaS_rostr[148],
+  NULL,
+  NULL,
+  &luaS_rostr[125],
+  NULL,
+  NULL,
+  &luaS_rostr[113],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[483],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[292],
+  &luaS_rostr[203],
+  &luaS_rostr[161],
+  &luaS_rostr[78],
+  &luaS_rostr[122],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[498],
+  &luaS_rostr[92],
+  &luaS_rostr[178],
+  NULL,
+  NULL,
+  &luaS_rostr[12],
+  NULL,
+  NULL,
+  &luaS_rostr[229],
+  &luaS_rostr[22],
+  NULL,
+  &luaS_rostr[170],
+  &luaS_rostr[73],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[126],
+  &luaS_rostr[103],
+  NULL,
+  NULL,
+  &luaS_rostr[331],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[104],
+  NULL,
+  &luaS_rostr[101],
+  NULL,
+  &luaS_rostr[221],
+  NULL,
+  NULL,
+  &luaS_rostr[507],
+  NULL,
+  &luaS_rostr[165],
+  &luaS_rostr[219],
+  &luaS_rostr[453],
+  &luaS_rostr[466],
+  &luaS_rostr[253],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[201],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[102],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[46],
+  NULL,
+  NULL,
+  &luaS_rostr[130],
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[91],
+  NULL,
+  NULL,
+  &luaS_rostr[85],
+  NULL,
+  &luaS_rostr[156],
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  NULL,
+  &luaS_rostr[461],
+  &luaS_rostr[421],
+  &luaS_rostr[218],
+  NULL,
+};
+
+#undef ROS
+
+#endif
@@ -108,7 +108,12 @@ void luaR_next(lua_State *L, void *data, TValue *key, TValue *val) {
       pstrkey = strkey;
     } else   
       numkey = (luaR_numkey)nvalue(key);
-    luaR_findentry(data, pstrkey, numkey, &keypos);
+    if (luaR_findentry(data, pstrkey, numkey, &keypos) == NULL) {
+      /* Not a key of this rotable, so there is no next one */
+      setnilvalue(key);
+      setnilvalue(val);
+      return;
+    }
     /* Advance to next key */
     keypos ++;    
     luaR_next_helper(L, pentries, keypos, key, val);
@@ -17,6 +17,7 @@
 #include "lgc.h"
 #include "llex.h"
 #include "lmem.h"
+#include "lprof.h"
 #include "lstate.h"
 #include "lstring.h"
 #include "ltable.h"
@@ -103,6 +104,9 @@ static void preinit_state (lua_State *L, global_State *g) {
 static void close_state (lua_State *L) {
   global_State *g = G(L);
   luaF_close(L, L->stack);  /* close all upvalues for this thread */
+#ifdef LUA_PROFILER
+  luaI_profstop(L);
+#endif
   luaC_freeall(L);  /* collect all objects */
   lua_assert(g->rootgc == obj2gco(L));
   lua_assert(g->strt.nuse == 0);
@@ -191,6 +195,13 @@ LUA_API lua_State *lua_newstate (lua_Alloc f, void *ud) {
   g->memlimit = EGC_INITIAL_MEMLIMIT;
 #else
   g->memlimit = 0;
+#endif
+#ifdef LUA_PROFILER
+  g->prof = NULL;
+#endif
+#ifdef LUA_LAZY_UNDUMP
+  g->lazymode = 0;
+  g->coldprotos = NULL;
 #endif
   for (i=0; i<NUM_TAGS; i++) g->mt[i] = NULL;
   if (luaD_rawrunprotected(L, f_luaopen, NULL) != 0) {
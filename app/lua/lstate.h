@@ -52,6 +52,11 @@ typedef struct CallInfo {
   const Instruction *savedpc;
   int nresults;  /* expected number of results from this function */
   int tailcalls;  /* number of tail calls lost under this entry */
+#ifdef LUA_PROFILER
+  lu_int32 profstart;  /* time the function was entered (see lprof.c) */
+  struct ProfEntry *proftail;  /* first caller lost to a tail call, or NULL */
+  lu_int32 proftailstart;  /* time `proftail' was entered */
+#endif
 } CallInfo;
 
 
@@ -88,6 +93,13 @@ typedef struct global_State {
   int gcpause;  /* size of pause between successive GCs */
   int gcstepmul;  /* GC `granularity' */
   int egcmode;    /* emergency garbage collection operation mode */
+#ifdef LUA_PROFILER
+  struct Profiler *prof;  /* active profiler or NULL */
+#endif
+#ifdef LUA_LAZY_UNDUMP
+  lu_byte lazymode;  /* lazy undump of binary chunks (LUA_LAZY_xxx) */
+  GCObject *coldprotos;  /* list of protos whose children may be unloaded */
+#endif
   lua_CFunction panic;  /* to be called in unprotected errors */
   TValue l_registry;
   struct lua_State *mainthread;
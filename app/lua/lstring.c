@@ -21,6 +21,12 @@
 #define LUAS_READONLY_STRING      1
 #define LUAS_REGULAR_STRING       0
 
+/* flash-resident strings: never white, fixed and read-only */
+#define ROSTRMARK  cast_byte(bitmask(FIXEDBIT) | bitmask(READONLYBIT))
+#define ROSTR(next, h, l, s)  {{.tsv = {next, LUA_TSTRING, ROSTRMARK, h, l}}, s}
+
+#include "lrostr.h"
+
 void luaS_resize (lua_State *L, int newsize) {
   stringtable *tb;
   int i;
@@ -81,17 +87,43 @@ static TString *newlstr (lua_State *L, const char *str, size_t l,
 }
 
 
-static TString *luaS_newlstr_helper (lua_State *L, const char *str, size_t l, int readonly) {
-  GCObject *o;
+/*
+** tools/make_rostr.py implements the same hash to prebuild lrostr.h
+*/
+unsigned int luaS_hash (const char *str, size_t l) {
   unsigned int h = cast(unsigned int, l);  /* seed */
   size_t step = (l>>5)+1;  /* if string is too long, don't hash all its chars */
   size_t l1;
   for (l1=l; l1>=step; l1-=step)  /* compute hash */
     h = h ^ ((h<<5)+(h>>2)+cast(unsigned char, str[l1-1]));
+  return h;
+}
+
+
+static TString *luaS_findrostr (const char *str, size_t l, unsigned int h) {
+  const ROTString *rs;
+  for (rs = luaS_rostrt[lmod(h, LUAS_ROSTRTSIZE)];
+       rs != NULL;
+       rs = cast(const ROTString *, rs->ts.tsv.next)) {
+    /* compare the hash first, the string itself is in flash */
+    if (rs->ts.tsv.hash == h && rs->ts.tsv.len == l &&
+        c_memcmp(str, rs->str, l) == 0)
+      return cast(TString *, &rs->ts);
+  }
+  return NULL;
+}
+
+
+static TString *luaS_newlstr_helper (lua_State *L, const char *str, size_t l, int readonly) {
+  GCObject *o;
+  TString *ts;
+  unsigned int h = luaS_hash(str, l);
+  if ((ts = luaS_findrostr(str, l, h)) != NULL)
+    return ts;
   for (o = G(L)->strt.hash[lmod(h, G(L)->strt.size)];
        o != NULL;
        o = o->gch.next) {
-    TString *ts = rawgco2ts(o);
+    ts = rawgco2ts(o);
     if (ts->tsv.len == l && (c_memcmp(str, getstr(ts), l) == 0)) {
       /* string may be dead */
       if (isdead(G(L), o)) changewhite(o);
@@ -22,10 +22,30 @@
 #define luaS_newliteral(L, s)  (luaS_newlstr(L, "" s, \
                                   (sizeof(s)/sizeof(char))-1))
 
-#define luaS_fix(s)	l_setbit((s)->tsv.marked, FIXEDBIT)
+#define luaS_fix(s)	{ TString *s_ = (s); \
+                          if (!luaS_isrostr(s_)) l_setbit(s_->tsv.marked, FIXEDBIT); }
 #define luaS_readonly(s) l_setbit((s)->tsv.marked, READONLYBIT)
 #define luaS_isreadonly(s) testbit((s)->marked, READONLYBIT)
 
+/*
+** Strings known at build time live in a flash-resident table which is
+** searched before the RAM string table (see lrostr.h). Their headers are
+** never white, so the collector does not mark or sweep them, and they must
+** never be written to.
+*/
+typedef struct ROTString {
+  TString ts;
+  const char *str;  /* getstr() of a read-only string */
+} ROTString;
+
+#include "lrostr.h"
+
+LUAI_DATA const ROTString luaS_rostr[LUAS_NROSTR];
+
+#define luaS_isrostr(s)	(cast(const ROTString *, (s)) >= luaS_rostr && \
+                          cast(const ROTString *, (s)) < luaS_rostr + LUAS_NROSTR)
+
+LUAI_FUNC unsigned int luaS_hash (const char *str, size_t l);
 LUAI_FUNC void luaS_resize (lua_State *L, int newsize);
 LUAI_FUNC Udata *luaS_newudata (lua_State *L, size_t s, Table *e);
 LUAI_FUNC TString *luaS_newlstr (lua_State *L, const char *str, size_t l);
@@ -29,10 +29,13 @@
 #define c_fread fread
 #define c_free free
 #define c_freopen freopen
+#define c_fseek fseek
+#define c_ftell ftell
 #define c_getc getc
 #define c_getenv getenv
 #define c_memcmp memcmp
 #define c_memcpy memcpy
+#define c_memset memset
 #define c_printf printf
 #define c_puts puts
 #define c_reader reader
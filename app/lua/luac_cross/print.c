@@ -122,6 +122,9 @@ static void PrintCode(const Proto* f)
    case OP_SELF:
     if (ISK(c)) { printf("\t; "); PrintConstant(f,INDEXK(c)); }
     break;
+   case OP_GETGFIELD:
+    printf("\t; %s ",svalue(&f->k[b])); PrintConstant(f,c);
+    break;
    case OP_SETTABLE:
    case OP_ADD:
    case OP_SUB:
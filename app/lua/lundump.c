@@ -9,13 +9,19 @@
 #define LUAC_CROSS_FILE
 
 #include "lua.h"
+#include C_HEADER_STDIO
 #include C_HEADER_STRING
+#if defined(LUA_LAZY_UNDUMP) && !defined(LUA_CROSS_COMPILER)
+#include "flash_fs.h"
+#endif
 
 #include "ldebug.h"
 #include "ldo.h"
 #include "lfunc.h"
+#include "lgc.h"
 #include "lmem.h"
 #include "lobject.h"
+#include "lstate.h"
 #include "lstring.h"
 #include "lundump.h"
 #include "lzio.h"
@@ -29,6 +35,9 @@ typedef struct {
  int numsize;
  int toflt;
  size_t total;
+#ifdef LUA_LAZY_UNDUMP
+ TString* chunkname;		/* non-NULL: leave nested functions as stubs */
+#endif
 } LoadState;
 
 #ifdef LUAC_TRUST_BINARIES
@@ -146,7 +155,7 @@ static lua_Number LoadNumber(LoadState* S)
     LoadVar(S,y);
     x = (lua_Number)y;
    } break;
-   default: lua_assert(0);
+   default: lua_assert(0); x = 0;
   }
  }
  else
@@ -192,6 +201,9 @@ static void LoadCode(LoadState* S, Proto* f)
 }
 
 static Proto* LoadFunction(LoadState* S, TString* p);
+#ifdef LUA_LAZY_UNDUMP
+static Proto* LoadStub(LoadState* S, TString* p);
+#endif
 
 static void LoadConstants(LoadState* S, Proto* f)
 {
@@ -227,6 +239,13 @@ static void LoadConstants(LoadState* S, Proto* f)
  f->p=luaM_newvector(S->L,n,Proto*);
  f->sizep=n;
  for (i=0; i<n; i++) f->p[i]=NULL;
+#ifdef LUA_LAZY_UNDUMP
+ if (S->chunkname!=NULL)
+ {
+  for (i=0; i<n; i++) f->p[i]=LoadStub(S,f->source);
+  return;
+ }
+#endif
  for (i=0; i<n; i++) f->p[i]=LoadFunction(S,f->source);
 }
 
@@ -275,13 +294,8 @@ static void LoadDebug(LoadState* S, Proto* f)
  for (i=0; i<n; i++) f->upvalues[i]=LoadString(S);
 }
 
-static Proto* LoadFunction(LoadState* S, TString* p)
+static void LoadFunctionHeader(LoadState* S, Proto* f, TString* p)
 {
- Proto* f;
- if (++S->L->nCcalls > LUAI_MAXCCALLS) error(S,"code too deep");
- f=luaF_newproto(S->L);
- if (luaZ_direct_mode(S->Z)) proto_readonly(f);
- setptvalue2s(S->L,S->L->top,f); incr_top(S->L);
  f->source=LoadString(S); if (f->source==NULL) f->source=p;
  f->linedefined=LoadInt(S);
  f->lastlinedefined=LoadInt(S);
@@ -289,14 +303,112 @@ static Proto* LoadFunction(LoadState* S, TString* p)
  f->numparams=LoadByte(S);
  f->is_vararg=LoadByte(S);
  f->maxstacksize=LoadByte(S);
+}
+
+static void LoadBody(LoadState* S, Proto* f)
+{
  LoadCode(S,f);
  LoadConstants(S,f);
  LoadDebug(S,f);
  IF (!luaG_checkcode(f), "bad code");
+}
+
+static Proto* LoadFunction(LoadState* S, TString* p)
+{
+ Proto* f;
+ if (++S->L->nCcalls > LUAI_MAXCCALLS) error(S,"code too deep");
+ f=luaF_newproto(S->L);
+ if (luaZ_direct_mode(S->Z)) proto_readonly(f);
+ setptvalue2s(S->L,S->L->top,f); incr_top(S->L);
+ LoadFunctionHeader(S,f,p);
+ LoadBody(S,f);
+ S->L->top--;
+ S->L->nCcalls--;
+ return f;
+}
+
+#ifdef LUA_LAZY_UNDUMP
+/*
+** Lazy undump: nested functions are created with their header only and
+** the rest of their dump is skipped.  The stub remembers where its body
+** starts, so luaU_loadstub can read it when a closure is first made.
+*/
+static void SkipString(LoadState* S)
+{
+ int32_t size;
+ LoadVar(S,size);
+ LoadBlock(S,NULL,size);
+}
+
+static void SkipBody(LoadState* S)
+{
+ int i,n;
+ if (++S->L->nCcalls > LUAI_MAXCCALLS) error(S,"code too deep");
+ n=LoadInt(S);					/* code */
+ Align4(S);
+ LoadVector(S,NULL,n,sizeof(Instruction));
+ n=LoadInt(S);					/* constants */
+ for (i=0; i<n; i++)
+ {
+  switch (LoadChar(S))
+  {
+   case LUA_TNIL:
+	break;
+   case LUA_TBOOLEAN:
+	LoadChar(S);
+	break;
+   case LUA_TNUMBER:
+	LoadNumber(S);
+	break;
+   case LUA_TSTRING:
+	SkipString(S);
+	break;
+   default:
+	error(S,"bad constant");
+	break;
+  }
+ }
+ n=LoadInt(S);					/* nested functions */
+ for (i=0; i<n; i++)
+ {
+  SkipString(S);
+  LoadInt(S); LoadInt(S);
+  LoadBlock(S,NULL,4);			/* nups ... maxstacksize */
+  SkipBody(S);
+ }
+ n=LoadInt(S);					/* line info */
+ Align4(S);
+#ifdef LUA_OPTIMIZE_DEBUG
+ LoadBlock(S,NULL,n);
+#else
+ LoadVector(S,NULL,n,sizeof(int));
+#endif
+ n=LoadInt(S);					/* local names */
+ for (i=0; i<n; i++)
+ {
+  SkipString(S);
+  LoadInt(S); LoadInt(S);
+ }
+ n=LoadInt(S);					/* upvalue names */
+ for (i=0; i<n; i++) SkipString(S);
+ S->L->nCcalls--;
+}
+
+static Proto* LoadStub(LoadState* S, TString* p)
+{
+ Proto* f;
+ if (++S->L->nCcalls > LUAI_MAXCCALLS) error(S,"code too deep");
+ f=luaF_newproto(S->L);
+ setptvalue2s(S->L,S->L->top,f); incr_top(S->L);
+ LoadFunctionHeader(S,f,p);
+ f->chunkname=S->chunkname;
+ f->bodyoffset=S->total;
+ SkipBody(S);
  S->L->top--;
  S->L->nCcalls--;
  return f;
 }
+#endif
 
 static void LoadHeader(LoadState* S)
 {
@@ -310,6 +422,7 @@ static void LoadHeader(LoadState* S)
  S->toflt=(s[11]>intck); /* check if conversion from int lua_Number to flt is needed */
  if(S->toflt) s[11]=h[11];
  IF (c_memcmp(h,s,LUAC_HEADERSIZE)!=0, "bad header");
+ IF (S->swap && luaZ_direct_mode(S->Z), "byte-swapped chunk in direct mode");
 }
 
 /*
@@ -327,11 +440,127 @@ Proto* luaU_undump (lua_State* L, ZIO* Z, Mbuffer* buff, const char* name)
  S.L=L;
  S.Z=Z;
  S.b=buff;
+#ifdef LUA_LAZY_UNDUMP
+ /* only chunks that can be read again from a file can be loaded lazily */
+ S.chunkname=NULL;
+ if (G(L)->lazymode!=LUA_LAZY_OFF && *name=='@' && !luaZ_direct_mode(Z))
+  S.chunkname=luaS_new(L,name);
+#endif
  LoadHeader(&S);
  S.total=0;
  return LoadFunction(&S,luaS_newliteral(L,"=?"));
 }
 
+#ifdef LUA_LAZY_UNDUMP
+/*
+** read the body of a stub from the chunk it was found in
+*/
+#ifdef LUA_CROSS_COMPILER
+typedef FILE* LazyFile;
+#define lazy_open(n)		c_fopen(n,"rb")
+#define lazy_isopen(f)		((f)!=NULL)
+#define lazy_close(f)		c_fclose(f)
+#define lazy_getc(f)		c_getc(f)
+#define lazy_tell(f)		c_ftell(f)
+#define lazy_seek(f,o)		c_fseek(f,o,SEEK_SET)
+#define lazy_read(f,b,n)	c_fread(b,1,n,f)
+#else
+typedef int LazyFile;
+#define lazy_open(n)		fs_open(n,FS_RDONLY)
+#define lazy_isopen(f)		((f)>=FS_OPEN_OK)
+#define lazy_close(f)		fs_close(f)
+#define lazy_getc(f)		fs_getc(f)
+#define lazy_tell(f)		fs_tell(f)
+#define lazy_seek(f,o)		fs_seek(f,o,FS_SEEK_SET)
+#define lazy_read(f,b,n)	fs_read(f,b,n)
+#endif
+
+/* read buffer, on the C stack of every lazy OP_CLOSURE; holds the header */
+#define LAZY_BUFFERSIZE		64
+
+typedef struct LoadLazy {
+ LazyFile f;
+ Proto* stub;
+ int header;			/* header still to be returned */
+ char buff[LAZY_BUFFERSIZE];
+} LoadLazy;
+
+static const char* getLazy (lua_State* L, void* ud, size_t* size)
+{
+ LoadLazy* ll=(LoadLazy*)ud;
+ int c;
+ long n;
+ if (L==NULL && size==NULL)		/* direct mode check */
+  return NULL;
+ if (ll->header)
+ {
+  /* skip eventual `#!...' like luaL_loadfsfile and return the header */
+  ll->header=0;
+  while ((c=lazy_getc(ll->f))!=EOF && c!=LUA_SIGNATURE[0]) ;
+  if (c==EOF) return NULL;
+  n=lazy_tell(ll->f)-1;
+  ll->buff[0]=(char)c;
+  *size=1+lazy_read(ll->f,ll->buff+1,LUAC_HEADERSIZE-1);
+  if (lazy_seek(ll->f,n+LUAC_HEADERSIZE+ll->stub->bodyoffset)<0) return NULL;
+  return ll->buff;
+ }
+ n=lazy_read(ll->f,ll->buff,sizeof(ll->buff));
+ if (n<=0) return NULL;
+ *size=n;
+ return ll->buff;
+}
+
+typedef struct SLazy {
+ LoadLazy* ll;
+ ZIO z;
+ Mbuffer b;
+} SLazy;
+
+static void f_lazy (lua_State* L, void* ud)
+{
+ SLazy* s=(SLazy*)ud;
+ Proto* f=s->ll->stub;
+ LoadState S;
+ S.name=getstr(f->chunkname)+1;
+ S.L=L;
+ S.Z=&s->z;
+ S.b=&s->b;
+ S.chunkname=f->chunkname;
+ set_block_gc(L);  /* stop collector while the body is incomplete */
+ LoadHeader(&S);
+ S.total=f->bodyoffset;
+ LoadBody(&S,f);
+ unset_block_gc(L);
+}
+
+void luaU_loadstub (lua_State* L, Proto* f)
+{
+ LoadLazy ll;
+ SLazy s;
+ int status;
+ lua_assert(proto_isstub(f) && LUAC_HEADERSIZE<=LAZY_BUFFERSIZE);
+ ll.f=lazy_open(getstr(f->chunkname)+1);
+ if (!lazy_isopen(ll.f))
+ {
+  luaO_pushfstring(L,"cannot reopen %s",getstr(f->chunkname)+1);
+  luaD_throw(L,LUA_ERRRUN);
+ }
+ ll.stub=f;
+ ll.header=1;
+ s.ll=&ll;
+ luaZ_init(L,&s.z,getLazy,&ll);
+ luaZ_initbuffer(L,&s.b);
+ status=luaD_pcall(L,f_lazy,&s,savestack(L,L->top),L->errfunc);
+ luaZ_freebuffer(L,&s.b);
+ lazy_close(ll.f);
+ if (status!=0)
+ {
+  luaF_unloadproto(L,f);		/* back to a clean stub */
+  luaD_throw(L,status);
+ }
+}
+#endif
+
 /*
 * make header
 */
@@ -34,6 +34,16 @@ LUAI_FUNC Proto* luaU_undump (lua_State* L, ZIO* Z, Mbuffer* buff, const char* n
 /* make header; from lundump.c */
 LUAI_FUNC void luaU_header (char* h);
 
+#ifdef LUA_LAZY_UNDUMP
+/* lazy undump modes, see lua_State.lazymode */
+#define LUA_LAZY_OFF   0  /* load every function when the chunk is loaded */
+#define LUA_LAZY_LOAD  1  /* load nested functions on first use */
+#define LUA_LAZY_DROP  2  /* also unload unused functions on memory pressure */
+
+/* load the body of a function stub; from lundump.c */
+LUAI_FUNC void luaU_loadstub (lua_State* L, Proto* f);
+#endif
+
 /* dump one chunk to a different target; from ldump.c */
 int luaU_dump_crosscompile (lua_State* L, const Proto* f, lua_Writer w, void* data, int strip, DumpTargetInfo target);
 
@@ -20,10 +20,12 @@
 #include "lgc.h"
 #include "lobject.h"
 #include "lopcodes.h"
+#include "lprof.h"
 #include "lstate.h"
 #include "lstring.h"
 #include "ltable.h"
 #include "ltm.h"
+#include "lundump.h"
 #include "lvm.h"
 #include "lrotable.h"
 
@@ -451,6 +453,9 @@ void luaV_execute (lua_State *L, int nexeccalls) {
       }
       base = L->base;
     }
+#ifdef LUA_PROFILER
+    luaI_profsample(L, cl->p, GET_OPCODE(i));
+#endif
     /* warning!! several calls may realloc the stack and invalidate `ra' */
     ra = RA(i);
     lua_assert(base == L->base && L->base == L->ci->base);
@@ -491,7 +496,27 @@ void luaV_execute (lua_State *L, int nexeccalls) {
         continue;
       }
       case OP_GETTABLE: {
-        Protect(luaV_gettable(L, RB(i), RKC(i), ra));
+        TValue *rb = RB(i);
+        TValue *rc = RKC(i);
+        if (ttistable(rb)) {  /* fast path: raw hit in a plain table */
+          const TValue *res = luaH_get(hvalue(rb), rc);
+          if (!ttisnil(res)) {
+            setobj2s(L, ra, res);
+            continue;
+          }
+        }
+        Protect(luaV_gettable(L, rb, rc, ra));
+        continue;
+      }
+      case OP_GETGFIELD: {
+        TValue g;
+        TValue *rb = k+GETARG_B(i);
+        TValue *rc = k+GETARG_C(i);
+        lua_assert(ttisstring(rb));
+        sethvalue(L, &g, cl->env);
+        Protect(luaV_gettable(L, &g, rb, ra));
+        ra = RA(i);  /* the first lookup may have reallocated the stack */
+        Protect(luaV_gettable(L, ra, rc, ra));
         continue;
       }
       case OP_SETGLOBAL: {
@@ -602,7 +627,11 @@ void luaV_execute (lua_State *L, int nexeccalls) {
       case OP_EQ: {
         TValue *rb = RKB(i);
         TValue *rc = RKC(i);
-        Protect(
+        if (ttisnumber(rb) && ttisnumber(rc)) {  /* no metamethods */
+          if (luai_numeq(nvalue(rb), nvalue(rc)) == GETARG_A(i))
+            dojump(L, pc, GETARG_sBx(*pc));
+        }
+        else Protect(
           if (equalobj(L, rb, rc) == GETARG_A(i))
             dojump(L, pc, GETARG_sBx(*pc));
         )
@@ -610,16 +639,28 @@ void luaV_execute (lua_State *L, int nexeccalls) {
         continue;
       }
       case OP_LT: {
-        Protect(
-          if (luaV_lessthan(L, RKB(i), RKC(i)) == GETARG_A(i))
+        TValue *rb = RKB(i);
+        TValue *rc = RKC(i);
+        if (ttisnumber(rb) && ttisnumber(rc)) {
+          if (luai_numlt(nvalue(rb), nvalue(rc)) == GETARG_A(i))
+            dojump(L, pc, GETARG_sBx(*pc));
+        }
+        else Protect(
+          if (luaV_lessthan(L, rb, rc) == GETARG_A(i))
             dojump(L, pc, GETARG_sBx(*pc));
         )
         pc++;
         continue;
       }
       case OP_LE: {
-        Protect(
-          if (lessequal(L, RKB(i), RKC(i)) == GETARG_A(i))
+        TValue *rb = RKB(i);
+        TValue *rc = RKC(i);
+        if (ttisnumber(rb) && ttisnumber(rc)) {
+          if (luai_numle(nvalue(rb), nvalue(rc)) == GETARG_A(i))
+            dojump(L, pc, GETARG_sBx(*pc));
+        }
+        else Protect(
+          if (lessequal(L, rb, rc) == GETARG_A(i))
             dojump(L, pc, GETARG_sBx(*pc));
         )
         pc++;
@@ -673,6 +714,9 @@ void luaV_execute (lua_State *L, int nexeccalls) {
             int aux;
             StkId func = ci->func;
             StkId pfunc = (ci+1)->func;  /* previous function index */
+#ifdef LUA_PROFILER
+            if (G(L)->prof) luaI_proftailcall(L, ci);
+#endif
             if (L->openupval) luaF_close(L, ci->base);
             L->base = ci->base = ci->func + ((ci+1)->base - pfunc);
             for (aux = 0; pfunc+aux < L->top; aux++)  /* move frame down */
@@ -798,6 +842,11 @@ void luaV_execute (lua_State *L, int nexeccalls) {
           }
         }
         unfixedstack(L);
+#ifdef LUA_LAZY_UNDUMP
+        /* load the body now that the new closure keeps the proto alive */
+        if (proto_isstub(p))
+          Protect(luaU_loadstub(L, p));
+#endif
         Protect(luaC_checkGC(L));
         continue;
       }
@@ -0,0 +1,760 @@
+// Module for CBOR (RFC 7049) encoding and decoding
+
+#include "module.h"
+#include "lauxlib.h"
+#include "c_types.h"
+#include "c_string.h"
+#include "c_math.h"
+#include "c_limits.h"
+
+#include "strbuf.h"
+#include "cjson_mem.h"
+
+/* Lua values map onto CBOR the same way cjson maps them onto JSON, with
+ * the same nesting limit and sparse array rule, so a table encodes to the
+ * same structure in either format:
+ *
+ *  - integral numbers become (negative) integers, other numbers the
+ *    shortest of half, single and double precision that is exact
+ *  - strings become text strings, or byte strings if not valid UTF-8
+ *  - tables become arrays or maps; map keys may be strings or numbers
+ *  - nil and cbor.null (== cjson.null) become null
+ *
+ * Decoding accepts definite and indefinite lengths, ignores tags and
+ * returns null and undefined as cbor.null. */
+
+#define CBOR_MAX_DEPTH      1000
+#define CBOR_SPARSE_RATIO   2
+#define CBOR_SPARSE_SAFE    10
+
+#define CBOR_UINT     0
+#define CBOR_NEGINT   1
+#define CBOR_BYTES    2
+#define CBOR_TEXT     3
+#define CBOR_ARRAY    4
+#define CBOR_MAP      5
+#define CBOR_TAG      6
+#define CBOR_SIMPLE   7
+
+#define CBOR_FALSE    0xf4
+#define CBOR_TRUE     0xf5
+#define CBOR_NULL     0xf6
+#define CBOR_HALF     0xf9
+#define CBOR_FLOAT    0xfa
+#define CBOR_DOUBLE   0xfb
+#define CBOR_BREAK    0xff
+
+typedef union {
+  float f;
+  uint32_t u;
+} cbor_float_t;
+
+typedef union {
+  double d;
+  uint64_t u;
+} cbor_double_t;
+
+/* ===== ENCODING ===== */
+
+static void cbor_encode_exception(lua_State *L, strbuf_t *b, int lindex, const char *reason)
+{
+  strbuf_free(b);
+  luaL_error(L, "Cannot serialise %s: %s",
+             lua_typename(L, lua_type(L, lindex)), reason);
+}
+
+static void cbor_append_uint(strbuf_t *b, int first, uint64_t v, int n)
+{
+  char *p;
+
+  strbuf_ensure_empty_length(b, n + 1);
+  p = strbuf_empty_ptr(b);
+  *p++ = first;
+  while (n--)
+    *p++ = (char)(v >> (n * 8));
+  strbuf_extend_length(b, p - strbuf_empty_ptr(b));
+}
+
+/* Append an initial byte and its argument in the shortest form */
+static void cbor_append_head(strbuf_t *b, int major, uint64_t v)
+{
+  major <<= 5;
+  if (v < 24)
+    strbuf_append_char(b, major | (int)v);
+  else if (v <= 0xff)
+    cbor_append_uint(b, major | 24, v, 1);
+  else if (v <= 0xffff)
+    cbor_append_uint(b, major | 25, v, 2);
+  else if (v <= 0xffffffffULL)
+    cbor_append_uint(b, major | 26, v, 4);
+  else
+    cbor_append_uint(b, major | 27, v, 8);
+}
+
+static void cbor_append_number(strbuf_t *b, lua_Number num)
+{
+#ifdef LUA_NUMBER_INTEGRAL
+  if (num < 0)
+    cbor_append_head(b, CBOR_NEGINT, (uint64_t)(-(num + 1)));
+  else
+    cbor_append_head(b, CBOR_UINT, (uint64_t)num);
+#else
+  double d = num;
+  cbor_double_t dv;
+  cbor_float_t fv;
+  int e;
+
+  dv.d = d;
+  if (d == floor(d) && d > -18446744073709551616.0 &&
+      d < 18446744073709551616.0 && !(d == 0 && (dv.u >> 63))) {
+    if (d < 0)
+      cbor_append_head(b, CBOR_NEGINT, (uint64_t)-d - 1);
+    else
+      cbor_append_head(b, CBOR_UINT, (uint64_t)d);
+    return;
+  }
+
+  if (d != d) {
+    cbor_append_uint(b, CBOR_HALF, 0x7e00, 2);
+    return;
+  }
+
+  fv.f = (float)d;
+  if ((double)fv.f != d) {
+    cbor_append_uint(b, CBOR_DOUBLE, dv.u, 8);
+    return;
+  }
+
+  /* Half precision holds normal numbers with 10 mantissa bits, zeros
+   * and infinities */
+  e = (int)((fv.u >> 23) & 0xff) - 127;
+  if ((e >= -14 && e <= 15 && !(fv.u & 0x1fff)) ||
+      (fv.u & 0x7fffffff) == 0 || (fv.u & 0x7fffffff) == 0x7f800000) {
+    uint32_t h = (fv.u >> 16) & 0x8000;
+    if (e == 128)
+      h |= 0x7c00;
+    else if (e > -127)
+      h |= ((e + 15) << 10) | ((fv.u >> 13) & 0x3ff);
+    cbor_append_uint(b, CBOR_HALF, h, 2);
+  } else {
+    cbor_append_uint(b, CBOR_FLOAT, fv.u, 4);
+  }
+#endif
+}
+
+static int cbor_is_utf8(const unsigned char *s, size_t len)
+{
+  size_t i = 0;
+  int n;
+
+  while (i < len) {
+    unsigned char c = s[i++];
+    if (c < 0x80)
+      continue;
+    else if (c >= 0xc2 && c <= 0xdf)
+      n = 1;
+    else if (c >= 0xe0 && c <= 0xef)
+      n = 2;
+    else if (c >= 0xf0 && c <= 0xf4)
+      n = 3;
+    else
+      return 0;
+    if (len - i < (size_t)n)
+      return 0;
+    while (n--)
+      if ((s[i++] & 0xc0) != 0x80)
+        return 0;
+  }
+  return 1;
+}
+
+static void cbor_append_string(lua_State *L, strbuf_t *b, int lindex)
+{
+  size_t len;
+  const char *s = lua_tolstring(L, lindex, &len);
+
+  cbor_append_head(b, cbor_is_utf8((const unsigned char *)s, len) ? CBOR_TEXT : CBOR_BYTES, len);
+  strbuf_append_mem(b, s, len);
+}
+
+/* Returns the array length of the table on top of the stack, or -1 if it
+ * must be encoded as a map. Same rule as cjson's lua_array_length() with
+ * sparse conversion enabled, since CBOR maps take integer keys as is. */
+static int cbor_array_length(lua_State *L)
+{
+  double k;
+  int max = 0, items = 0;
+
+  lua_pushnil(L);
+  while (lua_next(L, -2) != 0) {
+    if (lua_type(L, -2) == LUA_TNUMBER && (k = lua_tonumber(L, -2)) &&
+        floor(k) == k && k >= 1 && k <= INT_MAX) {
+      if (k > max)
+        max = k;
+      items++;
+      lua_pop(L, 1);
+      continue;
+    }
+    lua_pop(L, 2);
+    return -1;
+  }
+
+  if (max > items * CBOR_SPARSE_RATIO && max > CBOR_SPARSE_SAFE)
+    return -1;
+  return max;
+}
+
+static void cbor_append_data(lua_State *L, strbuf_t *b, int depth);
+
+static void cbor_append_table(lua_State *L, strbuf_t *b, int depth)
+{
+  int len, i;
+
+  if (depth > CBOR_MAX_DEPTH || !lua_checkstack(L, 3)) {
+    strbuf_free(b);
+    luaL_error(L, "Cannot serialise, excessive nesting (%d)", depth);
+  }
+
+  len = cbor_array_length(L);
+  if (len > 0) {
+    cbor_append_head(b, CBOR_ARRAY, len);
+    for (i = 1; i <= len; i++) {
+      lua_rawgeti(L, -1, i);
+      cbor_append_data(L, b, depth);
+      lua_pop(L, 1);
+    }
+    return;
+  }
+
+  len = 0;
+  lua_pushnil(L);
+  while (lua_next(L, -2) != 0) {
+    len++;
+    lua_pop(L, 1);
+  }
+  cbor_append_head(b, CBOR_MAP, len);
+
+  lua_pushnil(L);
+  while (lua_next(L, -2) != 0) {
+    switch (lua_type(L, -2)) {
+    case LUA_TSTRING:
+      cbor_append_string(L, b, -2);
+      break;
+    case LUA_TNUMBER:
+      cbor_append_number(b, lua_tonumber(L, -2));
+      break;
+    default:
+      cbor_encode_exception(L, b, -2, "table key must be a number or string");
+      /* never returns */
+    }
+    cbor_append_data(L, b, depth);
+    lua_pop(L, 1);
+  }
+}
+
+/* Encode the value on top of the stack */
+static void cbor_append_data(lua_State *L, strbuf_t *b, int depth)
+{
+  switch (lua_type(L, -1)) {
+  case LUA_TSTRING:
+    cbor_append_string(L, b, -1);
+    break;
+  case LUA_TNUMBER:
+    cbor_append_number(b, lua_tonumber(L, -1));
+    break;
+  case LUA_TBOOLEAN:
+    strbuf_append_char(b, lua_toboolean(L, -1) ? CBOR_TRUE : CBOR_FALSE);
+    break;
+  case LUA_TTABLE:
+    cbor_append_table(L, b, depth + 1);
+    break;
+  case LUA_TNIL:
+    strbuf_append_char(b, CBOR_NULL);
+    break;
+  case LUA_TLIGHTUSERDATA:
+    if (lua_touserdata(L, -1) == NULL) {
+      strbuf_append_char(b, CBOR_NULL);
+      break;
+    }
+  default:
+    cbor_encode_exception(L, b, -1, "type not supported");
+    /* never returns */
+  }
+}
+
+// Lua: cbor.encode(value)
+static int cbor_encode(lua_State *L)
+{
+  strbuf_t b;
+
+  luaL_argcheck(L, lua_gettop(L) == 1, 1, "expected 1 argument");
+  strbuf_init(&b, 0);
+  cbor_append_data(L, &b, 0);
+  lua_pushlstring(L, b.buf, strbuf_length(&b));
+  strbuf_free(&b);
+  return 1;
+}
+
+// Lua: cbor.encode_to(sink, value, ...)
+// Hands the encoded buffer to __sink(sink, payload, ...) as cjson.encode_to does
+static int cbor_encode_to(lua_State *L)
+{
+  strbuf_t b;
+  int top, err;
+
+  luaL_checkany(L, 2);
+  lua_getfield(L, 1, "__sink");
+  if (lua_type(L, -1) != LUA_TFUNCTION && lua_type(L, -1) != LUA_TLIGHTFUNCTION)
+    return luaL_argerror(L, 1, "sink expected");
+  lua_insert(L, 1);
+  lua_pushvalue(L, 3);
+  lua_remove(L, 3);
+
+  strbuf_init(&b, 0);
+  cbor_append_data(L, &b, 0);
+  lua_pop(L, 1);
+
+  top = lua_gettop(L);
+  err = luaL_pcallsink(L, top - 1, b.buf, strbuf_length(&b));
+  strbuf_free(&b);
+  if (err)
+    return lua_error(L);
+  return lua_gettop(L);
+}
+
+/* ===== DECODING ===== */
+
+typedef struct {
+  const unsigned char *data;
+  const unsigned char *ptr;
+  const unsigned char *end;
+} cbor_parse_t;
+
+static void cbor_decode_error(lua_State *L, cbor_parse_t *p, const char *msg)
+{
+  luaL_error(L, "Expected %s at byte %d", msg, (int)(p->ptr - p->data) + 1);
+}
+
+static void cbor_need(lua_State *L, cbor_parse_t *p, uint64_t n)
+{
+  if (n > (uint64_t)(p->end - p->ptr))
+    cbor_decode_error(L, p, "more data");
+}
+
+/* Read the argument of an initial byte with additional info ai */
+static uint64_t cbor_read_arg(lua_State *L, cbor_parse_t *p, int ai)
+{
+  uint64_t v = 0;
+  int n;
+
+  if (ai < 24)
+    return ai;
+  if (ai > 27)
+    cbor_decode_error(L, p, "valid length");
+  n = 1 << (ai - 24);
+  cbor_need(L, p, n);
+  while (n--)
+    v = (v << 8) | *p->ptr++;
+  return v;
+}
+
+static double cbor_half_to_double(uint32_t h)
+{
+  cbor_float_t fv;
+  int e = (h >> 10) & 0x1f;
+  uint32_t m = h & 0x3ff;
+
+  if (e == 0) {
+    fv.f = (float)m * 5.9604644775390625e-08f;    /* 2^-24 */
+    fv.u |= (h & 0x8000) << 16;
+    return fv.f;
+  }
+  if (e == 31)
+    fv.u = 0x7f800000 | (m << 13);
+  else
+    fv.u = ((e - 15 + 127) << 23) | (m << 13);
+  fv.u |= (h & 0x8000) << 16;
+  return fv.f;
+}
+
+static void cbor_decode_item(lua_State *L, cbor_parse_t *p, int depth);
+
+static void cbor_decode_string(lua_State *L, cbor_parse_t *p, int major, int ai)
+{
+  luaL_Buffer lb;
+  uint64_t len;
+  int ib;
+
+  if (ai != 31) {
+    len = cbor_read_arg(L, p, ai);
+    cbor_need(L, p, len);
+    lua_pushlstring(L, (const char *)p->ptr, (size_t)len);
+    p->ptr += len;
+    return;
+  }
+
+  /* Indefinite length: definite chunks of the same type up to a break */
+  luaL_buffinit(L, &lb);
+  for (;;) {
+    cbor_need(L, p, 1);
+    ib = *p->ptr++;
+    if (ib == CBOR_BREAK)
+      break;
+    if ((ib >> 5) != major || (ib & 31) == 31)
+      cbor_decode_error(L, p, "string chunk");
+    len = cbor_read_arg(L, p, ib & 31);
+    cbor_need(L, p, len);
+    luaL_addlstring(&lb, (const char *)p->ptr, (size_t)len);
+    p->ptr += len;
+  }
+  luaL_pushresult(&lb);
+}
+
+/* Whether an indefinite container continues, consuming its break */
+static int cbor_more(lua_State *L, cbor_parse_t *p)
+{
+  cbor_need(L, p, 1);
+  if (*p->ptr != CBOR_BREAK)
+    return 1;
+  p->ptr++;
+  return 0;
+}
+
+static void cbor_decode_container(lua_State *L, cbor_parse_t *p, int major, int ai, int depth)
+{
+  uint64_t n = 0, i;
+  int indefinite = ai == 31;
+
+  if (depth > CBOR_MAX_DEPTH)
+    luaL_error(L, "Found too many nested data structures (%d) at byte %d",
+               depth, (int)(p->ptr - p->data));
+  luaL_checkstack(L, 3, "too many nested data structures");
+
+  if (!indefinite) {
+    n = cbor_read_arg(L, p, ai);
+    /* Every item takes at least one byte */
+    cbor_need(L, p, major == CBOR_MAP ? n * 2 : n);
+  }
+
+  if (major == CBOR_ARRAY) {
+    lua_createtable(L, indefinite ? 0 : (int)n, 0);
+    for (i = 0; indefinite ? cbor_more(L, p) : i < n; i++) {
+      cbor_decode_item(L, p, depth);
+      lua_rawseti(L, -2, (int)i + 1);
+    }
+  } else {
+    lua_createtable(L, 0, indefinite ? 0 : (int)n);
+    for (i = 0; indefinite ? cbor_more(L, p) : i < n; i++) {
+      cbor_decode_item(L, p, depth);
+      cbor_decode_item(L, p, depth);
+      if (lua_isnil(L, -2) ||
+          (lua_type(L, -2) == LUA_TNUMBER && lua_tonumber(L, -2) != lua_tonumber(L, -2)))
+        cbor_decode_error(L, p, "valid map key");
+      lua_rawset(L, -3);
+    }
+  }
+}
+
+/* Decode one item and push it */
+static void cbor_decode_item(lua_State *L, cbor_parse_t *p, int depth)
+{
+  cbor_float_t fv;
+  cbor_double_t dv;
+  int ib, major, ai;
+
+  /* Tags are ignored; loop over them rather than recursing, so a long
+   * run of tag heads costs no stack */
+  do {
+    cbor_need(L, p, 1);
+    ib = *p->ptr++;
+    major = ib >> 5;
+    ai = ib & 31;
+    if (major == CBOR_TAG)
+      cbor_read_arg(L, p, ai);
+  } while (major == CBOR_TAG);
+
+  switch (major) {
+  case CBOR_UINT:
+    lua_pushnumber(L, (lua_Number)cbor_read_arg(L, p, ai));
+    break;
+  case CBOR_NEGINT:
+    lua_pushnumber(L, -1 - (lua_Number)cbor_read_arg(L, p, ai));
+    break;
+  case CBOR_BYTES:
+  case CBOR_TEXT:
+    cbor_decode_string(L, p, major, ai);
+    break;
+  case CBOR_ARRAY:
+  case CBOR_MAP:
+    cbor_decode_container(L, p, major, ai, depth + 1);
+    break;
+  default:
+    switch (ib) {
+    case CBOR_FALSE:
+    case CBOR_TRUE:
+      lua_pushboolean(L, ib == CBOR_TRUE);
+      break;
+    case CBOR_NULL:
+    case CBOR_NULL + 1:     /* undefined */
+      lua_pushlightuserdata(L, NULL);
+      break;
+    case CBOR_HALF:
+      lua_pushnumber(L, cbor_half_to_double((uint32_t)cbor_read_arg(L, p, ai)));
+      break;
+    case CBOR_FLOAT:
+      fv.u = (uint32_t)cbor_read_arg(L, p, ai);
+      lua_pushnumber(L, fv.f);
+      break;
+    case CBOR_DOUBLE:
+      dv.u = cbor_read_arg(L, p, ai);
+      lua_pushnumber(L, dv.d);
+      break;
+    default:
+      p->ptr--;
+      cbor_decode_error(L, p, "value");
+    }
+  }
+}
+
+static void cbor_decode_all(lua_State *L, const char *data, size_t len)
+{
+  cbor_parse_t p;
+
+  p.data = p.ptr = (const unsigned char *)data;
+  p.end = p.data + len;
+  cbor_decode_item(L, &p, 0);
+  if (p.ptr != p.end)
+    cbor_decode_error(L, &p, "the end of input");
+}
+
+// Lua: value = cbor.decode(string)
+static int cbor_decode(lua_State *L)
+{
+  size_t len;
+  const char *data = luaL_checklstring(L, 1, &len);
+
+  luaL_argcheck(L, lua_gettop(L) == 1, 1, "expected 1 argument");
+  cbor_decode_all(L, data, len);
+  return 1;
+}
+
+/* ===== STREAMING DECODING ===== */
+
+/* CBOR items carry their own lengths, so the streaming decoder only
+ * buffers chunks and follows the item structure, without building
+ * anything, to tell when a complete value has arrived. The scan keeps
+ * its place between writes: pos is the next item head to read and open
+ * holds the containers and indefinite strings still being filled, so
+ * each write only looks at new data. */
+
+typedef struct {
+  uint64_t left;      /* items still to come, unused if indefinite */
+  uint32_t major;
+  uint32_t indefinite;
+} cbor_open_t;
+
+typedef struct {
+  strbuf_t buf;
+  strbuf_t open;      /* stack of cbor_open_t */
+  size_t pos;
+  int complete;
+} cbor_decoder_t;
+
+static void cbor_decoder_reset(cbor_decoder_t *d)
+{
+  strbuf_reset(&d->buf);
+  strbuf_reset(&d->open);
+  d->pos = 0;
+  d->complete = 0;
+}
+
+static cbor_open_t *cbor_open_top(cbor_decoder_t *d)
+{
+  if (strbuf_length(&d->open) == 0)
+    return NULL;
+  return (cbor_open_t *)(d->open.buf + strbuf_length(&d->open)) - 1;
+}
+
+static void cbor_open_push(cbor_decoder_t *d, int major, int indefinite, uint64_t left)
+{
+  cbor_open_t o;
+
+  o.left = left;
+  o.major = major;
+  o.indefinite = indefinite;
+  strbuf_append_mem(&d->open, (const char *)&o, sizeof(o));
+}
+
+/* An item has ended: count it against the open containers, closing those
+ * it fills up, and note when the top level value is complete */
+static void cbor_item_done(cbor_decoder_t *d)
+{
+  cbor_open_t *o;
+
+  while ((o = cbor_open_top(d)) != NULL) {
+    if (o->indefinite || --o->left > 0)
+      return;
+    d->open.length -= sizeof(cbor_open_t);
+  }
+  d->complete = 1;
+}
+
+/* Scan the newly buffered data. Returns 1 once a complete value has been
+ * buffered, 0 if more data is needed and -1 if the data is not valid
+ * CBOR. */
+static int cbor_scan(cbor_decoder_t *d)
+{
+  const unsigned char *data = (const unsigned char *)d->buf.buf;
+  const unsigned char *end = data + strbuf_length(&d->buf);
+  const unsigned char *p;
+  cbor_open_t *o;
+  uint64_t v;
+  int ib, major, ai, n;
+
+  while (!d->complete) {
+    p = data + d->pos;
+    if (p >= end)
+      return 0;
+    ib = *p++;
+    major = ib >> 5;
+    ai = ib & 31;
+    o = cbor_open_top(d);
+
+    if (ib == CBOR_BREAK) {
+      if (o == NULL || !o->indefinite)
+        return -1;
+      d->pos++;
+      d->open.length -= sizeof(cbor_open_t);
+      cbor_item_done(d);
+      continue;
+    }
+    /* Chunks of an indefinite string are definite strings of its type */
+    if (o && o->indefinite && (o->major == CBOR_BYTES || o->major == CBOR_TEXT) &&
+        (major != (int)o->major || ai == 31))
+      return -1;
+
+    v = ai;
+    if (ai >= 24 && ai <= 27) {
+      n = 1 << (ai - 24);
+      if (end - p < n)
+        return 0;
+      v = 0;
+      while (n--)
+        v = (v << 8) | *p++;
+    } else if (ai > 27 && (ai != 31 || major < CBOR_BYTES || major > CBOR_MAP)) {
+      return -1;
+    }
+
+    if (ai == 31) {
+      if (major >= CBOR_ARRAY && strbuf_length(&d->open) >= CBOR_MAX_DEPTH * (int)sizeof(cbor_open_t))
+        return -1;
+      cbor_open_push(d, major, 1, 0);
+    } else if (major == CBOR_BYTES || major == CBOR_TEXT) {
+      if (v > (uint64_t)(end - p))
+        return 0;     /* read the head again once the string is all here */
+      p += v;
+      cbor_item_done(d);
+    } else if (major == CBOR_ARRAY || major == CBOR_MAP) {
+      if (strbuf_length(&d->open) >= CBOR_MAX_DEPTH * (int)sizeof(cbor_open_t))
+        return -1;
+      if (major == CBOR_MAP)
+        v *= 2;
+      if (v > 0)
+        cbor_open_push(d, major, 0, v);
+      else
+        cbor_item_done(d);
+    } else if (major != CBOR_TAG) {
+      cbor_item_done(d);
+    }
+    /* a tag head is followed by the item it tags */
+    d->pos = p - data;
+  }
+  return 1;
+}
+
+static cbor_decoder_t *cbor_check_decoder(lua_State *L)
+{
+  return (cbor_decoder_t *)luaL_checkudata(L, 1, "cbor.decoder");
+}
+
+// Lua: decoder = cbor.decoder()
+static int cbor_decoder_new(lua_State *L)
+{
+  cbor_decoder_t *d = (cbor_decoder_t *)lua_newuserdata(L, sizeof(*d));
+
+  c_memset(d, 0, sizeof(*d));
+  luaL_getmetatable(L, "cbor.decoder");
+  lua_setmetatable(L, -2);
+  strbuf_init(&d->buf, 0);
+  strbuf_init(&d->open, 4 * sizeof(cbor_open_t));
+  return 1;
+}
+
+// Lua: complete = decoder:write(chunk)
+// Returns whether a complete value has been buffered
+static int cbor_decoder_write(lua_State *L)
+{
+  cbor_decoder_t *d = cbor_check_decoder(L);
+  size_t len;
+  const char *chunk = luaL_checklstring(L, 2, &len);
+  int r;
+
+  strbuf_append_mem(&d->buf, chunk, len);
+  r = cbor_scan(d);
+  if (r < 0) {
+    cbor_decoder_reset(d);
+    return luaL_error(L, "Expected valid CBOR");
+  }
+  lua_pushboolean(L, r);
+  return 1;
+}
+
+// Lua: value = decoder:finish()
+// Decodes the buffered data and resets the decoder for the next value
+static int cbor_decoder_finish(lua_State *L)
+{
+  cbor_decoder_t *d = cbor_check_decoder(L);
+  size_t len = strbuf_length(&d->buf);
+
+  /* The data stays in place while decoding; resetting first means an
+   * error still leaves the decoder ready for the next value */
+  cbor_decoder_reset(d);
+  cbor_decode_all(L, d->buf.buf, len);
+  return 1;
+}
+
+static int cbor_decoder_gc(lua_State *L)
+{
+  cbor_decoder_t *d = cbor_check_decoder(L);
+
+  strbuf_free(&d->buf);
+  strbuf_free(&d->open);
+  return 0;
+}
+
+// Module function map
+static const LUA_REG_TYPE cbor_decoder_map[] = {
+  { LSTRKEY( "write" ),     LFUNCVAL( cbor_decoder_write ) },
+  { LSTRKEY( "finish" ),    LFUNCVAL( cbor_decoder_finish ) },
+  { LSTRKEY( "__gc" ),      LFUNCVAL( cbor_decoder_gc ) },
+  { LSTRKEY( "__index" ),   LROVAL( cbor_decoder_map ) },
+  { LNILKEY, LNILVAL }
+};
+
+static const LUA_REG_TYPE cbor_map[] = {
+  { LSTRKEY( "encode" ),    LFUNCVAL( cbor_encode ) },
+  { LSTRKEY( "encode_to" ), LFUNCVAL( cbor_encode_to ) },
+  { LSTRKEY( "decode" ),    LFUNCVAL( cbor_decode ) },
+  { LSTRKEY( "decoder" ),   LFUNCVAL( cbor_decoder_new ) },
+  { LSTRKEY( "null" ),      LUDATA( NULL ) },
+  { LNILKEY, LNILVAL }
+};
+
+int luaopen_cbor( lua_State *L )
+{
+  cjson_mem_setlua(L);
+  luaL_rometatable(L, "cbor.decoder", (void *)cbor_decoder_map);
+  return 0;
+}
+
+NODEMCU_MODULE(CBOR, "cbor", cbor_map, luaopen_cbor);
@@ -46,8 +46,8 @@
 
 #include "strbuf.h"
 #include "cjson_mem.h"
+#include "fpconv.h"
 
-#define FPCONV_G_FMT_BUFSIZE   32
 #define fpconv_strtod c_strtod
 #define fpconv_init() ((void)0)
 
@@ -71,7 +71,13 @@
 #define DEFAULT_DECODE_MAX_DEPTH 1000
 #define DEFAULT_ENCODE_INVALID_NUMBERS 0
 #define DEFAULT_DECODE_INVALID_NUMBERS 1
+#ifndef DEFAULT_ENCODE_KEEP_BUFFER
 #define DEFAULT_ENCODE_KEEP_BUFFER 0
+#endif
+#ifndef DEFAULT_DECODE_KEEP_BUFFER
+#define DEFAULT_DECODE_KEEP_BUFFER 0
+#endif
+#define DEFAULT_DECODE_SIZE_HINTS 1
 #define DEFAULT_ENCODE_NUMBER_PRECISION 14
 
 #ifdef DISABLE_INVALID_NUMBERS
@@ -147,16 +153,31 @@ typedef struct {
     int encode_number_precision;
     int encode_keep_buffer;
 
+    /* decode_buf is only allocated and used when
+     * decode_keep_buffer is set */
+    strbuf_t decode_buf;
+
     int decode_invalid_numbers;
     int decode_max_depth;
+    int decode_keep_buffer;
+    int decode_size_hints;
 } json_config_t;
 
+/* Element count of a container, found by json_count_elements() */
+typedef struct {
+    int count;
+    int parent;     /* Index of the enclosing container while counting */
+} json_hint_t;
+
 typedef struct {
     const char *data;
     const char *ptr;
     strbuf_t *tmp;    /* Temporary storage for strings */
     json_config_t *cfg;
     int current_depth;
+    json_hint_t *hint;  /* Container sizes in document order, or NULL */
+    int nhint;
+    int next_hint;
 } json_parse_t;
 
 typedef struct {
@@ -439,6 +460,29 @@ static int json_cfg_encode_keep_buffer(lua_State *l)
     return 1;
 }
 
+/* Configures JSON decoding buffer persistence */
+static int json_cfg_decode_keep_buffer(lua_State *l)
+{
+    json_config_t *cfg = json_arg_init(l, 1);
+    int old_value;
+
+    old_value = cfg->decode_keep_buffer;
+
+    json_enum_option(l, 1, &cfg->decode_keep_buffer, NULL, 1);
+
+    /* Init / free the buffer if the setting has changed */
+    if (old_value ^ cfg->decode_keep_buffer) {
+        if (cfg->decode_keep_buffer){
+            if(-1==strbuf_init(&cfg->decode_buf, 0))
+                return luaL_error(l, "not enough memory");
+        }
+        else
+            strbuf_free(&cfg->decode_buf);
+    }
+
+    return 1;
+}
+
 #if defined(DISABLE_INVALID_NUMBERS) && !defined(USE_INTERNAL_FPCONV)
 void json_verify_invalid_number_setting(lua_State *l, int *setting)
 {
@@ -479,8 +523,10 @@ static int json_destroy_config(lua_State *l)
     json_config_t *cfg;
 
     cfg = lua_touserdata(l, 1);
-    if (cfg)
+    if (cfg) {
         strbuf_free(&cfg->encode_buf);
+        strbuf_free(&cfg->decode_buf);
+    }
     cfg = NULL;
 
     return 0;
@@ -508,10 +554,15 @@ static void json_create_config(lua_State *l)
     cfg->decode_invalid_numbers = DEFAULT_DECODE_INVALID_NUMBERS;
     cfg->encode_keep_buffer = DEFAULT_ENCODE_KEEP_BUFFER;
     cfg->encode_number_precision = DEFAULT_ENCODE_NUMBER_PRECISION;
+    cfg->decode_keep_buffer = DEFAULT_DECODE_KEEP_BUFFER;
+    cfg->decode_size_hints = DEFAULT_DECODE_SIZE_HINTS;
 
 #if DEFAULT_ENCODE_KEEP_BUFFER > 0
     strbuf_init(&cfg->encode_buf, 0);
 #endif
+#if DEFAULT_DECODE_KEEP_BUFFER > 0
+    strbuf_init(&cfg->decode_buf, 0);
+#endif
 
     /* Decoding init */
 
@@ -577,6 +628,8 @@ static int cfg_init(json_config_t *cfg){
     cfg->decode_invalid_numbers = DEFAULT_DECODE_INVALID_NUMBERS;
     cfg->encode_keep_buffer = DEFAULT_ENCODE_KEEP_BUFFER;
     cfg->encode_number_precision = DEFAULT_ENCODE_NUMBER_PRECISION;
+    cfg->decode_keep_buffer = DEFAULT_DECODE_KEEP_BUFFER;
+    cfg->decode_size_hints = DEFAULT_DECODE_SIZE_HINTS;
 
 #if DEFAULT_ENCODE_KEEP_BUFFER > 0
     if(-1==strbuf_init(&cfg->encode_buf, 0)){
@@ -584,6 +637,12 @@ static int cfg_init(json_config_t *cfg){
         return -1;
     }
 #endif
+#if DEFAULT_DECODE_KEEP_BUFFER > 0
+    if(-1==strbuf_init(&cfg->decode_buf, 0)){
+        NODE_ERR("not enough memory\n");
+        return -1;
+    }
+#endif
 
     return 0;
 }
@@ -627,7 +686,7 @@ static void json_append_string(lua_State *l, strbuf_t *json, int lindex)
             char temp[8];  // for now, 8-bytes is enough.
             for (i=0; i < 8; ++i)
             {
-                temp[i] = byte_of_aligned_array(escstr, i);
+                temp[i] = byte_of_aligned_array((const uint8_t *)escstr, i);
                 if(temp[i]==0) break;
             }
             escstr = temp;
@@ -772,9 +831,7 @@ static void json_append_number(lua_State *l, json_config_t *cfg,
     }
 
     strbuf_ensure_empty_length(json, FPCONV_G_FMT_BUFSIZE);
-    // len = fpconv_g_fmt(strbuf_empty_ptr(json), num, cfg->encode_number_precision);
-    c_sprintf(strbuf_empty_ptr(json), LUA_NUMBER_FMT, (LUA_NUMBER)num);
-    len = c_strlen(strbuf_empty_ptr(json));
+    len = fpconv_g_fmt(strbuf_empty_ptr(json), num, cfg->encode_number_precision);
 
     strbuf_extend_length(json, len);
 }
@@ -896,6 +953,309 @@ static int json_encode(lua_State *l)
     return 1;
 }
 
+/* Lua: cjson.encode_to(sink, value, ...)
+ *
+ * Encodes value and hands the buffer straight to the sink's "__sink"
+ * entry as __sink(sink, payload, ...), where payload is a token for the
+ * buffer that only luaL_checkpayload() accepts, and only during the call.
+ * Net sockets, MQTT clients and the file module provide one, so the
+ * document is never turned into a Lua string. Returns whatever the sink
+ * returns. */
+static int json_encode_to(lua_State *l)
+{
+    json_config_t *cfg = json_fetch_config(l);
+    strbuf_t local_encode_buf;
+    strbuf_t *encode_buf;
+    char *json;
+    int len, top, err, keep;
+
+    luaL_checkany(l, 2);
+    lua_getfield(l, 1, "__sink");
+    if (lua_type(l, -1) != LUA_TFUNCTION && lua_type(l, -1) != LUA_TLIGHTFUNCTION)
+        return luaL_argerror(l, 1, "sink expected");
+    lua_insert(l, 1);
+    lua_pushvalue(l, 3);
+    lua_remove(l, 3);
+    /* Stack: __sink, sink, extra arguments..., value */
+
+    if (!cfg->encode_keep_buffer) {
+        encode_buf = &local_encode_buf;
+        if(-1==strbuf_init(encode_buf, 0))
+            return luaL_error(l, "not enough memory");
+    } else {
+        encode_buf = &cfg->encode_buf;
+        strbuf_reset(encode_buf);
+    }
+
+    json_append_data(l, cfg, 0, encode_buf);
+    json = strbuf_string(encode_buf, &len);
+    lua_pop(l, 1);
+
+    top = lua_gettop(l);
+
+    /* The sink may raise an error, which must not leak the buffer. Any
+     * encoding it does itself must not reuse a kept buffer either */
+    keep = cfg->encode_keep_buffer;
+    cfg->encode_keep_buffer = 0;
+    err = luaL_pcallsink(l, top - 1, json, len);
+    cfg->encode_keep_buffer = keep;
+    if (!keep)
+        strbuf_free(encode_buf);
+    if (err)
+        return lua_error(l);
+
+    return lua_gettop(l);
+}
+
+/* ===== COMPILED ENCODING ===== */
+
+/* cjson.compile(template) turns a table of a fixed shape into a program
+ * of literal runs and field fetches. Keys are escaped once and merged
+ * with the surrounding punctuation, so encoding a record only fetches
+ * each field by its interned key and appends the value. Nested tables
+ * with string keys compile to nested objects; any other field value is
+ * encoded with json_append_data() according to its type at run time. */
+
+typedef enum {
+    TPL_LITERAL,    /* append lit[arg .. arg+len) */
+    TPL_VALUE,      /* append the field keyed by env[arg] */
+    TPL_OBJECT,     /* enter the field keyed by env[arg], or skip to op len */
+    TPL_END         /* leave a TPL_OBJECT */
+} json_tpl_op_type_t;
+
+typedef struct {
+    unsigned short type;
+    unsigned short arg;
+    unsigned short len;
+} json_tpl_op_t;
+
+typedef struct {
+    int nops;
+    json_tpl_op_t op[1];
+    /* literal text follows op[nops] */
+} json_template_t;
+
+typedef struct {
+    strbuf_t ops;
+    strbuf_t lit;
+    int env;
+    int nkeys;
+} json_tpl_compile_t;
+
+static void json_tpl_fail(lua_State *l, json_tpl_compile_t *c, const char *msg)
+{
+    strbuf_free(&c->ops);
+    strbuf_free(&c->lit);
+    luaL_error(l, "Cannot compile template: %s", msg);
+}
+
+static int json_tpl_nops(json_tpl_compile_t *c)
+{
+    return strbuf_length(&c->ops) / sizeof(json_tpl_op_t);
+}
+
+static json_tpl_op_t *json_tpl_op(json_tpl_compile_t *c, int i)
+{
+    return (json_tpl_op_t *)c->ops.buf + i;
+}
+
+static void json_tpl_emit(json_tpl_compile_t *c, int type, int arg, int len)
+{
+    json_tpl_op_t op;
+
+    op.type = type;
+    op.arg = arg;
+    op.len = len;
+    strbuf_append_mem(&c->ops, (const char *)&op, sizeof(op));
+}
+
+/* Account for literal text appended to c->lit since offset start, merging
+ * it into the previous op when that is a literal too */
+static void json_tpl_literal(json_tpl_compile_t *c, int start)
+{
+    int n = json_tpl_nops(c);
+    int len = strbuf_length(&c->lit) - start;
+    json_tpl_op_t *last = n ? json_tpl_op(c, n - 1) : NULL;
+
+    if (last && last->type == TPL_LITERAL)
+        last->len += len;
+    else
+        json_tpl_emit(c, TPL_LITERAL, start, len);
+}
+
+/* Whether the value on top of the stack is a non-empty table with only
+ * string keys, and so compiles to a nested object */
+static int json_tpl_is_object(lua_State *l)
+{
+    int keys = 0;
+
+    if (lua_type(l, -1) != LUA_TTABLE)
+        return 0;
+    lua_pushnil(l);
+    while (lua_next(l, -2) != 0) {
+        if (lua_type(l, -2) != LUA_TSTRING) {
+            lua_pop(l, 2);
+            return 0;
+        }
+        keys++;
+        lua_pop(l, 1);
+    }
+    return keys > 0;
+}
+
+/* Compile the template table on top of the stack */
+static void json_tpl_compile_object(lua_State *l, json_config_t *cfg,
+                                    json_tpl_compile_t *c, int depth)
+{
+    int start, first = 1, obj;
+
+    if (depth > cfg->encode_max_depth || !lua_checkstack(l, 4))
+        json_tpl_fail(l, c, "excessive nesting");
+
+    start = strbuf_length(&c->lit);
+    strbuf_append_char(&c->lit, '{');
+    json_tpl_literal(c, start);
+
+    lua_pushnil(l);
+    while (lua_next(l, -2) != 0) {
+        if (lua_type(l, -2) != LUA_TSTRING)
+            json_tpl_fail(l, c, "keys must be strings");
+
+        start = strbuf_length(&c->lit);
+        if (!first)
+            strbuf_append_char(&c->lit, ',');
+        first = 0;
+        json_append_string(l, &c->lit, -2);
+        strbuf_append_char(&c->lit, ':');
+        json_tpl_literal(c, start);
+
+        if (c->nkeys >= 0xffff || strbuf_length(&c->lit) > 0xffff)
+            json_tpl_fail(l, c, "too large");
+        lua_pushvalue(l, -2);
+        lua_rawseti(l, c->env, ++c->nkeys);
+
+        if (json_tpl_is_object(l)) {
+            obj = json_tpl_nops(c);
+            json_tpl_emit(c, TPL_OBJECT, c->nkeys, 0);
+            json_tpl_compile_object(l, cfg, c, depth + 1);
+            json_tpl_emit(c, TPL_END, 0, 0);
+            json_tpl_op(c, obj)->len = json_tpl_nops(c);
+        } else {
+            json_tpl_emit(c, TPL_VALUE, c->nkeys, 0);
+        }
+        lua_pop(l, 1);
+    }
+
+    start = strbuf_length(&c->lit);
+    strbuf_append_char(&c->lit, '}');
+    json_tpl_literal(c, start);
+}
+
+/* Lua: encoder = cjson.compile(template) */
+static int json_compile(lua_State *l)
+{
+    json_config_t *cfg = json_fetch_config(l);
+    json_tpl_compile_t c;
+    json_template_t *tpl;
+    int ops_len, lit_len;
+
+    luaL_checktype(l, 1, LUA_TTABLE);
+    lua_settop(l, 1);
+    lua_newtable(l);
+    c.env = 2;
+    c.nkeys = 0;
+    strbuf_init(&c.ops, 16 * sizeof(json_tpl_op_t));
+    strbuf_init(&c.lit, 0);
+
+    lua_pushvalue(l, 1);
+    json_tpl_compile_object(l, cfg, &c, 1);
+    lua_pop(l, 1);
+
+    ops_len = strbuf_length(&c.ops);
+    lit_len = strbuf_length(&c.lit);
+    tpl = (json_template_t *)lua_newuserdata(l, sizeof(*tpl) + ops_len + lit_len);
+    tpl->nops = ops_len / sizeof(json_tpl_op_t);
+    c_memcpy(tpl->op, c.ops.buf, ops_len);
+    c_memcpy((char *)&tpl->op[tpl->nops], c.lit.buf, lit_len);
+    strbuf_free(&c.ops);
+    strbuf_free(&c.lit);
+
+    luaL_getmetatable(l, "cjson.template");
+    lua_setmetatable(l, -2);
+    lua_pushvalue(l, 2);
+    lua_setfenv(l, -2);
+
+    return 1;
+}
+
+/* Lua: json = encoder:encode(record)
+ * Fields missing from record encode as null, extra fields are ignored */
+static int json_template_encode(lua_State *l)
+{
+    json_config_t *cfg = json_fetch_config(l);
+    json_template_t *tpl = (json_template_t *)luaL_checkudata(l, 1, "cjson.template");
+    const char *lit = (const char *)&tpl->op[tpl->nops];
+    strbuf_t local_encode_buf;
+    strbuf_t *encode_buf;
+    json_tpl_op_t *op;
+    char *json;
+    int pc, len, depth = 1;
+
+    luaL_checktype(l, 2, LUA_TTABLE);
+    lua_settop(l, 2);
+    lua_getfenv(l, 1);
+    lua_pushvalue(l, 2);
+    /* Stack: encoder, record, keys, current table */
+
+    if (!cfg->encode_keep_buffer) {
+        encode_buf = &local_encode_buf;
+        if(-1==strbuf_init(encode_buf, 0))
+            return luaL_error(l, "not enough memory");
+    } else {
+        encode_buf = &cfg->encode_buf;
+        strbuf_reset(encode_buf);
+    }
+
+    for (pc = 0; pc < tpl->nops; pc++) {
+        op = &tpl->op[pc];
+        switch (op->type) {
+        case TPL_LITERAL:
+            strbuf_append_mem(encode_buf, lit + op->arg, op->len);
+            break;
+        case TPL_VALUE:
+            lua_rawgeti(l, 3, op->arg);
+            lua_rawget(l, -2);
+            json_append_data(l, cfg, depth, encode_buf);
+            lua_pop(l, 1);
+            break;
+        case TPL_OBJECT:
+            lua_rawgeti(l, 3, op->arg);
+            lua_rawget(l, -2);
+            if (lua_type(l, -1) == LUA_TTABLE) {
+                depth++;
+                json_check_encode_depth(l, cfg, depth, encode_buf);
+            } else {
+                lua_pop(l, 1);
+                strbuf_append_mem(encode_buf, "null", 4);
+                pc = op->len - 1;
+            }
+            break;
+        case TPL_END:
+            lua_pop(l, 1);
+            depth--;
+            break;
+        }
+    }
+
+    json = strbuf_string(encode_buf, &len);
+    lua_pushlstring(l, json, len);
+
+    if (!cfg->encode_keep_buffer)
+        strbuf_free(encode_buf);
+
+    return 1;
+}
+
 /* ===== DECODING ===== */
 
 static void json_process_value(lua_State *l, json_parse_t *json,
@@ -1171,9 +1531,27 @@ static int json_is_invalid_number(json_parse_t *json)
 
 static void json_next_number_token(json_parse_t *json, json_token_t *token)
 {
+    const char *p = json->ptr + (*json->ptr == '-');
     char *endptr;
+    uint32_t u = 0;
+    int n;
 
     token->type = T_NUMBER;
+
+    /* Fast path for plain integers of up to 9 digits, which are exact in
+     * 32 bits and make up most numbers in practice. Anything with a
+     * fraction, exponent or hex prefix is left to strtod(). */
+    for (n = 0; n < 10 && p[n] >= '0' && p[n] <= '9'; n++)
+        u = u * 10 + (p[n] - '0');
+    if (n > 0 && n < 10 && p[n] != '.' && (p[n] | 0x20) != 'e' &&
+        (p[n] | 0x20) != 'x') {
+        token->value.number = u;
+        if (*json->ptr == '-')
+            token->value.number = -token->value.number;
+        json->ptr = p + n;
+        return;
+    }
+
     token->value.number = fpconv_strtod(json->ptr, &endptr);
     if (json->ptr == endptr)
         json_set_token_error(token, json, "invalid number");
@@ -1272,14 +1650,12 @@ static void json_next_token(json_parse_t *json, json_token_t *token)
  * json->tmp struct.
  * json and token should exist on the stack somewhere.
  * luaL_error() will long_jmp and release the stack */
-static void json_throw_parse_error(lua_State *l, json_parse_t *json,
-                                   const char *exp, json_token_t *token)
+static void json_throw_token_error(lua_State *l, const char *exp,
+                                   json_token_t *token)
 {
     const char *found;
     char temp[16];  // for now, 16-bytes is enough.
 
-    strbuf_free(json->tmp);
-
     if (token->type == T_ERROR)
         found = token->value.string;
     else
@@ -1288,7 +1664,7 @@ static void json_throw_parse_error(lua_State *l, json_parse_t *json,
         int i;
         for (i=0; i < 16; ++i)
         {
-            temp[i] = byte_of_aligned_array(found, i);
+            temp[i] = byte_of_aligned_array((const uint8_t *)found, i);
             if(temp[i]==0) break;
         }
         found = temp;
@@ -1299,6 +1675,20 @@ static void json_throw_parse_error(lua_State *l, json_parse_t *json,
                exp, found, token->index + 1);
 }
 
+/* Frees json->tmp unless it is the persistent decode buffer */
+static void json_release_tmp(json_parse_t *json)
+{
+    if (json->tmp != &json->cfg->decode_buf)
+        strbuf_free(json->tmp);
+}
+
+static void json_throw_parse_error(lua_State *l, json_parse_t *json,
+                                   const char *exp, json_token_t *token)
+{
+    json_release_tmp(json);
+    json_throw_token_error(l, exp, token);
+}
+
 static inline void json_decode_ascend(json_parse_t *json)
 {
     json->current_depth--;
@@ -1313,11 +1703,91 @@ static void json_decode_descend(lua_State *l, json_parse_t *json, int slots)
         return;
     }
 
-    strbuf_free(json->tmp);
+    json_release_tmp(json);
     luaL_error(l, "Found too many nested data structures (%d) at character %d",
         json->current_depth, json->ptr - json->data);
 }
 
+/* ===== SIZE HINTS ===== */
+
+/* Building a table one element at a time rehashes it each time it
+ * doubles, which costs time and leaves a trail of freed blocks on the
+ * heap. A scan over the raw text ahead of parsing counts the elements of
+ * every object and array, in the order they open, so each table can be
+ * created at its final size. Hints live in json->tmp past the space the
+ * string decoder may use. Malformed input merely gives wrong hints, as
+ * the parser reports the error. */
+
+/* Offset of the hints within json->tmp */
+static int json_hint_offset(int json_len)
+{
+    return (json_len + 1 + sizeof(int) - 1) & ~(sizeof(int) - 1);
+}
+
+/* Upper bound on the number of containers */
+static int json_count_containers(const char *p, int json_len)
+{
+    const char *end = p + json_len;
+    int n = 0;
+
+    for (; p < end; p++)
+        n += (*p == '{' || *p == '[');
+
+    return n;
+}
+
+static void json_count_elements(json_parse_t *json, int json_len)
+{
+    const char *p = json->data;
+    const char *end = p + json_len;
+    json_hint_t *hint = (json_hint_t *)(json->tmp->buf + json_hint_offset(json_len));
+    int n = 0, cur = -1, empty = 1;
+
+    for (; p < end; p++) {
+        switch (*p) {
+        case ' ': case '\t': case '\n': case '\r': case ':':
+            break;
+        case ',':
+            if (cur >= 0)
+                hint[cur].count++;
+            break;
+        case '{': case '[':
+            hint[n].count = 0;
+            hint[n].parent = cur;
+            cur = n++;
+            empty = 1;
+            break;
+        case '}': case ']':
+            if (cur >= 0) {
+                hint[cur].count += !empty;
+                cur = hint[cur].parent;
+            }
+            empty = 0;
+            break;
+        case '"':
+            for (p++; p < end && *p != '"'; p++) {
+                if (*p == '\\' && p + 1 < end)
+                    p++;
+            }
+            empty = 0;
+            break;
+        default:
+            empty = 0;
+        }
+    }
+
+    json->hint = hint;
+    json->nhint = n;
+}
+
+/* Element count of the container being opened, 0 if unknown */
+static inline int json_next_hint(json_parse_t *json)
+{
+    if (json->next_hint < json->nhint)
+        return json->hint[json->next_hint++].count;
+    return 0;
+}
+
 static void json_parse_object_context(lua_State *l, json_parse_t *json)
 {
     json_token_t token;
@@ -1326,7 +1796,7 @@ static void json_parse_object_context(lua_State *l, json_parse_t *json)
      * .., table, key, value */
     json_decode_descend(l, json, 3);
 
-    lua_newtable(l);
+    lua_createtable(l, 0, json_next_hint(json));
 
     json_next_token(json, &token);
 
@@ -1378,7 +1848,7 @@ static void json_parse_array_context(lua_State *l, json_parse_t *json)
      * .., table, value */
     json_decode_descend(l, json, 2);
 
-    lua_newtable(l);
+    lua_createtable(l, json_next_hint(json), 0);
 
     json_next_token(json, &token);
 
@@ -1441,6 +1911,7 @@ static int json_decode(lua_State *l)
     json_parse_t json;
     json_token_t token;
     size_t json_len;
+    int tmp_len, ncontainers = 0;
 
     luaL_argcheck(l, lua_gettop(l) == 1, 1, "expected 1 argument");
 
@@ -1459,18 +1930,337 @@ static int json_decode(lua_State *l)
 
     /* Ensure the temporary buffer can hold the entire string.
      * This means we no longer need to do length checks since the decoded
-     * string must be smaller than the entire json string */
-    json.tmp = strbuf_new(json_len);
-    if(json.tmp == NULL){
-        return luaL_error(l, "not enough memory");
+     * string must be smaller than the entire json string.
+     * The size hints follow, if enabled */
+    tmp_len = json_len;
+    if (json.cfg->decode_size_hints) {
+        ncontainers = json_count_containers(json.data, json_len);
+        if (ncontainers > 0)
+            tmp_len = json_hint_offset(json_len) + ncontainers * sizeof(json_hint_t);
+    }
+
+    if (json.cfg->decode_keep_buffer) {
+        json.tmp = &json.cfg->decode_buf;
+        strbuf_reset(json.tmp);
+        strbuf_ensure_empty_length(json.tmp, tmp_len);
+    } else {
+        json.tmp = strbuf_new(tmp_len);
+        if(json.tmp == NULL){
+            return luaL_error(l, "not enough memory");
+        }
     }
 
+    json.hint = NULL;
+    json.nhint = json.next_hint = 0;
+    if (ncontainers > 0)
+        json_count_elements(&json, json_len);
+
     json_next_token(&json, &token);
     json_process_value(l, &json, &token);
 
     /* Ensure there is no more input left */
     json_next_token(&json, &token);
 
+    if (token.type != T_END)
+        json_throw_parse_error(l, &json, "the end", &token);
+
+    json_release_tmp(&json);
+
+    return 1;
+}
+
+/* ===== PATH EXTRACTION ===== */
+
+/* cjson.extract() walks the document with the lexer and only builds the
+ * values selected by a list of paths such as "config.interval" or
+ * "targets[*].id". A path has one segment per level of nesting, so the
+ * paths still alive at a given level are kept as a bit mask. Values no
+ * path leads into are checked for syntax, but not stored. */
+
+#define JSON_EXTRACT_MAX_PATHS 32
+
+typedef struct {
+    const char *key;    /* Object key, or NULL */
+    int len;
+    int index;          /* Array index if key is NULL, 0 for any */
+} json_path_seg_t;
+
+typedef struct {
+    json_path_seg_t *seg;
+    int nseg;
+    int wildcard;       /* Collect all matches in an array */
+} json_path_t;
+
+typedef struct {
+    json_parse_t *json;
+    json_path_t path[JSON_EXTRACT_MAX_PATHS];
+    int npath;
+    int paths;          /* Stack index of the path list */
+    int result;         /* Stack index of the result table */
+} json_extract_t;
+
+/* Splits path into segments, or counts them if seg is NULL */
+static int json_path_parse(lua_State *l, const char *path,
+                           json_path_seg_t *seg, int *wildcard)
+{
+    const char *p = path;
+    int n = 0;
+
+    while (*p) {
+        json_path_seg_t s = { NULL, 0, 0 };
+
+        if (*p == '[') {
+            p++;
+            if (*p == '*') {
+                p++;
+            } else {
+                while ('0' <= *p && *p <= '9')
+                    s.index = s.index * 10 + *p++ - '0';
+                if (s.index == 0)
+                    luaL_error(l, "invalid path '%s'", path);
+            }
+            if (*p++ != ']')
+                luaL_error(l, "invalid path '%s'", path);
+        } else {
+            if (*p == '.' && p != path)
+                p++;
+            s.key = p;
+            while (*p && *p != '.' && *p != '[')
+                p++;
+            s.len = p - s.key;
+            if (s.len == 0)
+                luaL_error(l, "invalid path '%s'", path);
+            if (s.len == 1 && *s.key == '*')
+                s.key = NULL;
+        }
+        if (s.key == NULL && s.index == 0)
+            *wildcard = 1;
+        if (seg)
+            seg[n] = s;
+        n++;
+    }
+    if (n == 0)
+        luaL_error(l, "invalid path '%s'", path);
+    return n;
+}
+
+static int json_path_match(json_path_seg_t *seg, const char *key,
+                           int len, int index)
+{
+    if (seg->key)
+        return key && seg->len == len && !c_memcmp(seg->key, key, len);
+    return seg->index == 0 || (!key && seg->index == index);
+}
+
+/* Records the value on top of the stack as a match of path q */
+static void json_extract_store(lua_State *l, json_extract_t *x, int q)
+{
+    lua_rawgeti(l, x->paths, q + 1);
+    if (x->path[q].wildcard) {
+        lua_rawget(l, x->result);
+        lua_pushvalue(l, -2);
+        lua_rawseti(l, -2, lua_objlen(l, -2) + 1);
+        lua_pop(l, 1);
+    } else {
+        lua_pushvalue(l, -2);
+        lua_rawset(l, x->result);
+    }
+}
+
+/* Follows the rest of path q through the value on top of the stack,
+ * when an earlier path has already built it */
+static void json_extract_built(lua_State *l, json_extract_t *x, int q,
+                               int depth)
+{
+    json_path_seg_t *seg = &x->path[q].seg[depth];
+
+    if (depth == x->path[q].nseg) {
+        json_extract_store(l, x, q);
+        return;
+    }
+    if (!lua_istable(l, -1) || !lua_checkstack(l, 3))
+        return;
+
+    if (seg->key) {
+        lua_pushlstring(l, seg->key, seg->len);
+        lua_rawget(l, -2);
+    } else if (seg->index) {
+        lua_rawgeti(l, -1, seg->index);
+    } else {
+        lua_pushnil(l);
+        while (lua_next(l, -2)) {
+            json_extract_built(l, x, q, depth + 1);
+            lua_pop(l, 1);
+        }
+        return;
+    }
+    if (!lua_isnil(l, -1))
+        json_extract_built(l, x, q, depth + 1);
+    lua_pop(l, 1);
+}
+
+static void json_extract_value(lua_State *l, json_extract_t *x,
+                               json_token_t *token, uint32_t mask, int depth);
+
+/* Handles the value of a member or element at depth + 1 */
+static void json_extract_child(lua_State *l, json_extract_t *x,
+                               json_token_t *token, uint32_t child, int depth)
+{
+    uint32_t done = 0;
+    int q;
+
+    for (q = 0; q < x->npath; q++) {
+        if ((child & (1u << q)) && x->path[q].nseg == depth + 1)
+            done |= 1u << q;
+    }
+    if (!done) {
+        json_extract_value(l, x, token, child, depth + 1);
+        return;
+    }
+
+    json_process_value(l, x->json, token);
+    for (q = 0; q < x->npath; q++) {
+        if (child & (1u << q))
+            json_extract_built(l, x, q, depth + 1);
+    }
+    lua_pop(l, 1);
+}
+
+static void json_extract_value(lua_State *l, json_extract_t *x,
+                               json_token_t *token, uint32_t mask, int depth)
+{
+    json_parse_t *json = x->json;
+    uint32_t child;
+    int i, q;
+
+    if (token->type == T_OBJ_BEGIN) {
+        json_decode_descend(l, json, 0);
+        json_next_token(json, token);
+        if (token->type == T_OBJ_END) {
+            json_decode_ascend(json);
+            return;
+        }
+        while (1) {
+            if (token->type != T_STRING)
+                json_throw_parse_error(l, json, "object key string", token);
+
+            child = 0;
+            for (q = 0; q < x->npath; q++) {
+                if ((mask & (1u << q)) &&
+                    json_path_match(&x->path[q].seg[depth], token->value.string,
+                                    token->string_len, 0))
+                    child |= 1u << q;
+            }
+
+            json_next_token(json, token);
+            if (token->type != T_COLON)
+                json_throw_parse_error(l, json, "colon", token);
+
+            json_next_token(json, token);
+            json_extract_child(l, x, token, child, depth);
+
+            json_next_token(json, token);
+            if (token->type == T_OBJ_END) {
+                json_decode_ascend(json);
+                return;
+            }
+            if (token->type != T_COMMA)
+                json_throw_parse_error(l, json, "comma or object end", token);
+            json_next_token(json, token);
+        }
+    } else if (token->type == T_ARR_BEGIN) {
+        json_decode_descend(l, json, 0);
+        json_next_token(json, token);
+        if (token->type == T_ARR_END) {
+            json_decode_ascend(json);
+            return;
+        }
+        for (i = 1; ; i++) {
+            child = 0;
+            for (q = 0; q < x->npath; q++) {
+                if ((mask & (1u << q)) &&
+                    json_path_match(&x->path[q].seg[depth], NULL, 0, i))
+                    child |= 1u << q;
+            }
+            json_extract_child(l, x, token, child, depth);
+
+            json_next_token(json, token);
+            if (token->type == T_ARR_END) {
+                json_decode_ascend(json);
+                return;
+            }
+            if (token->type != T_COMMA)
+                json_throw_parse_error(l, json, "comma or array end", token);
+            json_next_token(json, token);
+        }
+    } else if (token->type < T_STRING || token->type > T_NULL) {
+        json_throw_parse_error(l, json, "value", token);
+    }
+}
+
+/* Lua: result = cjson.extract(json_text, { path, ... })
+ * Returns a table mapping each path to the value found there. Paths
+ * containing a wildcard ("*" or "[*]") map to an array of all matches */
+static int json_extract(lua_State *l)
+{
+    json_extract_t x;
+    json_parse_t json;
+    json_token_t token;
+    json_path_seg_t *seg;
+    size_t json_len;
+    int i, n, total = 0;
+
+    json.data = luaL_checklstring(l, 1, &json_len);
+    luaL_checktype(l, 2, LUA_TTABLE);
+    lua_settop(l, 2);
+    x.json = &json;
+    x.paths = 2;
+    x.npath = lua_objlen(l, 2);
+    if (x.npath > JSON_EXTRACT_MAX_PATHS)
+        return luaL_error(l, "too many paths");
+
+    /* Parse the paths into one block of segments */
+    for (i = 0; i < x.npath; i++) {
+        lua_rawgeti(l, 2, i + 1);
+        x.path[i].wildcard = 0;
+        x.path[i].nseg = json_path_parse(l, luaL_checkstring(l, -1), NULL,
+                                         &x.path[i].wildcard);
+        total += x.path[i].nseg;
+        lua_pop(l, 1);
+    }
+    seg = (json_path_seg_t *)lua_newuserdata(l, (total ? total : 1) * sizeof(*seg));
+    lua_newtable(l);
+    x.result = 4;
+    for (i = 0, n = 0; i < x.npath; i++) {
+        lua_rawgeti(l, 2, i + 1);
+        x.path[i].seg = seg + n;
+        n += json_path_parse(l, lua_tostring(l, -1), seg + n, &x.path[i].wildcard);
+        if (x.path[i].wildcard) {
+            lua_newtable(l);
+            lua_rawset(l, x.result);
+        } else {
+            lua_pop(l, 1);
+        }
+    }
+
+    json.cfg = json_fetch_config(l);
+    json.current_depth = 0;
+    json.ptr = json.data;
+    json.hint = NULL;
+    json.nhint = json.next_hint = 0;
+
+    if (json_len >= 2 && (!json.data[0] || !json.data[1]))
+        luaL_error(l, "JSON parser does not support UTF-16 or UTF-32");
+
+    json.tmp = strbuf_new(json_len);
+    if(json.tmp == NULL){
+        return luaL_error(l, "not enough memory");
+    }
+
+    json_next_token(&json, &token);
+    json_extract_value(l, &x, &token, x.npath < 32 ? (1u << x.npath) - 1 : ~0u, 0);
+
+    json_next_token(&json, &token);
     if (token.type != T_END)
         json_throw_parse_error(l, &json, "the end", &token);
 
@@ -1479,6 +2269,424 @@ static int json_decode(lua_State *l)
     return 1;
 }
 
+/* ===== STREAMING DECODING ===== */
+
+/* A decoder takes the JSON text in chunks, as they arrive from a socket
+ * or a file. Tables under construction are kept in the environment table
+ * of the decoder userdata: env[2*i-1] holds the container at depth i,
+ * env[2*i] the number of array elements so far, or the pending object
+ * key (false if none). env[0] holds the decoded value.
+ *
+ * Tokens which lie completely within a chunk are parsed in place with
+ * json_next_token(). Only a token split between chunks is copied, so
+ * memory use is bounded by the longest token rather than the document. */
+
+typedef enum {
+    D_VALUE,            /* Expecting a value */
+    D_ARRAY_FIRST,      /* After '[': a value or ']' */
+    D_OBJECT_FIRST,     /* After '{': a key or '}' */
+    D_KEY,              /* After ',' in an object: a key */
+    D_COLON,            /* After an object key */
+    D_NEXT,             /* After a value in a container: ',' or its end */
+    D_DONE,             /* The top level value is complete */
+    D_FAILED            /* A previous chunk had an error */
+} json_decoder_state_t;
+
+typedef enum {
+    P_NONE,
+    P_STRING,           /* Unterminated string in token */
+    P_LITERAL           /* Number or true/false/null without delimiter */
+} json_partial_t;
+
+typedef struct {
+    strbuf_t token;     /* Raw text of a token split between chunks */
+    strbuf_t tmp;       /* Decoded strings, see json_parse_t */
+    json_decoder_state_t state;
+    json_partial_t partial;
+    int escaped;        /* Partial string ends in an unescaped '\' */
+    int depth;
+    int offset;         /* Characters of the document before this chunk */
+    int token_index;    /* Position of the partial token */
+} json_decoder_t;
+
+static const char *json_decoder_expected(lua_State *l, json_decoder_t *d)
+{
+    switch (d->state) {
+    case D_OBJECT_FIRST:
+    case D_KEY:
+        return "object key string";
+    case D_COLON:
+        return "colon";
+    case D_NEXT:
+        lua_rawgeti(l, 3, 2 * d->depth);
+        if (lua_type(l, -1) == LUA_TNUMBER) {
+            lua_pop(l, 1);
+            return "comma or array end";
+        }
+        lua_pop(l, 1);
+        return "comma or object end";
+    case D_DONE:
+        return "the end";
+    default:
+        return "value";
+    }
+}
+
+/* Does not return. The decoder refuses further input until finish() */
+static void json_decoder_error(lua_State *l, json_decoder_t *d,
+                               json_token_t *token)
+{
+    const char *exp = json_decoder_expected(l, d);
+
+    d->state = D_FAILED;
+    json_throw_token_error(l, exp, token);
+}
+
+/* Stores the value on top of the stack into the current container */
+static void json_decoder_store(lua_State *l, json_decoder_t *d)
+{
+    if (d->depth == 0) {
+        lua_rawseti(l, 3, 0);
+        d->state = D_DONE;
+        return;
+    }
+
+    lua_rawgeti(l, 3, 2 * d->depth - 1);
+    lua_rawgeti(l, 3, 2 * d->depth);
+    if (lua_type(l, -1) == LUA_TNUMBER) {
+        /* .., value, array, count */
+        int i = lua_tointeger(l, -1) + 1;
+        lua_pop(l, 1);
+        lua_insert(l, -2);
+        lua_rawseti(l, -2, i);
+        lua_pop(l, 1);
+        lua_pushinteger(l, i);
+    } else {
+        /* .., value, object, key */
+        lua_insert(l, -3);
+        lua_insert(l, -3);
+        lua_rawset(l, -3);
+        lua_pop(l, 1);
+        lua_pushboolean(l, 0);
+    }
+    lua_rawseti(l, 3, 2 * d->depth);
+    d->state = D_NEXT;
+}
+
+/* Advances the decoder by one complete token.
+ * The environment table of the decoder must be at stack index 3. */
+static void json_decoder_token(lua_State *l, json_decoder_t *d,
+                               json_token_t *token)
+{
+    json_config_t *cfg = json_fetch_config(l);
+
+    switch (token->type) {
+    case T_STRING:
+        if (d->state == D_OBJECT_FIRST || d->state == D_KEY) {
+            lua_pushlstring(l, token->value.string, token->string_len);
+            lua_rawseti(l, 3, 2 * d->depth);
+            d->state = D_COLON;
+            return;
+        }
+        /* Fall through */
+    case T_NUMBER:
+    case T_BOOLEAN:
+    case T_NULL:
+    case T_OBJ_BEGIN:
+    case T_ARR_BEGIN:
+        if (d->state != D_VALUE && d->state != D_ARRAY_FIRST)
+            break;
+        if (token->type == T_STRING) {
+            lua_pushlstring(l, token->value.string, token->string_len);
+        } else if (token->type == T_NUMBER) {
+            lua_pushnumber(l, token->value.number);
+        } else if (token->type == T_BOOLEAN) {
+            lua_pushboolean(l, token->value.boolean);
+        } else if (token->type == T_NULL) {
+            lua_pushlightuserdata(l, NULL);
+        } else {
+            if (d->depth >= cfg->decode_max_depth) {
+                d->state = D_FAILED;
+                luaL_error(l, "Found too many nested data structures (%d) at character %d",
+                    d->depth + 1, token->index + 1);
+            }
+            lua_newtable(l);
+            lua_pushvalue(l, -1);
+            json_decoder_store(l, d);
+            d->depth++;
+            lua_rawseti(l, 3, 2 * d->depth - 1);
+            if (token->type == T_ARR_BEGIN) {
+                lua_pushinteger(l, 0);
+                d->state = D_ARRAY_FIRST;
+            } else {
+                lua_pushboolean(l, 0);
+                d->state = D_OBJECT_FIRST;
+            }
+            lua_rawseti(l, 3, 2 * d->depth);
+            return;
+        }
+        json_decoder_store(l, d);
+        return;
+    case T_COLON:
+        if (d->state != D_COLON)
+            break;
+        d->state = D_VALUE;
+        return;
+    case T_COMMA:
+        if (d->state != D_NEXT)
+            break;
+        lua_rawgeti(l, 3, 2 * d->depth);
+        d->state = lua_type(l, -1) == LUA_TNUMBER ? D_VALUE : D_KEY;
+        lua_pop(l, 1);
+        return;
+    case T_OBJ_END:
+    case T_ARR_END:
+        if (d->state == D_NEXT) {
+            lua_rawgeti(l, 3, 2 * d->depth);
+            int array = lua_type(l, -1) == LUA_TNUMBER;
+            lua_pop(l, 1);
+            if (array != (token->type == T_ARR_END))
+                break;
+        } else if (d->state != (token->type == T_ARR_END ? D_ARRAY_FIRST : D_OBJECT_FIRST)) {
+            break;
+        }
+        lua_pushnil(l);
+        lua_rawseti(l, 3, 2 * d->depth - 1);
+        lua_pushnil(l);
+        lua_rawseti(l, 3, 2 * d->depth);
+        d->depth--;
+        d->state = d->depth ? D_NEXT : D_DONE;
+        return;
+    default:
+        break;
+    }
+    json_decoder_error(l, d, token);
+}
+
+/* Parses one complete token at json->ptr, which ends within the buffer */
+static void json_decoder_next(lua_State *l, json_decoder_t *d,
+                              json_parse_t *json, int len, int base)
+{
+    json_token_t token;
+
+    /* Strings decode to at most their raw length */
+    strbuf_reset(json->tmp);
+    strbuf_ensure_empty_length(json->tmp, len);
+
+    json_next_token(json, &token);
+    if (token.type == T_END)
+        json_set_token_error(&token, json, "invalid token");
+    token.index += base;
+    if (token.type == T_ERROR)
+        json_decoder_error(l, d, &token);
+    json_decoder_token(l, d, &token);
+}
+
+/* Whether c may continue a number or true/false/null */
+static int json_literal_char(unsigned char c)
+{
+    json_token_type_t type = ch2token(c);
+
+    return c != '"' && (type == T_UNKNOWN || type == T_ERROR);
+}
+
+/* Parses the token completed in d->token */
+static void json_decoder_flush(lua_State *l, json_decoder_t *d)
+{
+    json_parse_t json;
+    int len;
+
+    json.cfg = json_fetch_config(l);
+    json.tmp = &d->tmp;
+    strbuf_ensure_null(&d->token);
+    json.data = json.ptr = strbuf_string(&d->token, &len);
+    d->partial = P_NONE;
+    json_decoder_next(l, d, &json, len, d->token_index);
+
+    /* A literal ends at a delimiter, so it has to be used up */
+    if (json.ptr != json.data + len) {
+        json_token_t token;
+
+        json_set_token_error(&token, &json, "invalid token");
+        token.index += d->token_index;
+        json_decoder_error(l, d, &token);
+    }
+    strbuf_reset(&d->token);
+}
+
+static json_decoder_t *json_check_decoder(lua_State *l)
+{
+    return (json_decoder_t *)luaL_checkudata(l, 1, "cjson.decoder");
+}
+
+/* Lua: cjson.decoder() */
+static int json_decoder_new(lua_State *l)
+{
+    json_decoder_t *d = (json_decoder_t *)lua_newuserdata(l, sizeof(*d));
+
+    c_memset(d, 0, sizeof(*d));
+    luaL_getmetatable(l, "cjson.decoder");
+    lua_setmetatable(l, -2);
+    lua_newtable(l);
+    lua_setfenv(l, -2);
+
+    strbuf_init(&d->token, 31);
+    strbuf_init(&d->tmp, 31);
+
+    return 1;
+}
+
+/* Lua: complete = decoder:write(chunk)
+ * Returns whether a complete value has been seen */
+static int json_decoder_write(lua_State *l)
+{
+    json_decoder_t *d = json_check_decoder(l);
+    json_parse_t json;
+    size_t len;
+    const char *end, *p;
+
+    json.data = luaL_checklstring(l, 2, &len);
+    lua_settop(l, 2);
+    lua_getfenv(l, 1);
+    json.cfg = json_fetch_config(l);
+    json.tmp = &d->tmp;
+    end = json.data + len;
+    p = json.data;
+
+    if (d->state == D_FAILED)
+        return luaL_error(l, "decoder failed, call finish() to reset it");
+
+    /* Complete the token left over from the previous chunk */
+    if (d->partial == P_STRING) {
+        while (p < end && (d->escaped || *p != '"')) {
+            d->escaped = !d->escaped && *p == '\\';
+            p++;
+        }
+        if (p < end) {
+            p++;    /* Closing quote */
+            strbuf_append_mem(&d->token, json.data, p - json.data);
+            json_decoder_flush(l, d);
+        } else {
+            strbuf_append_mem(&d->token, json.data, len);
+        }
+    } else if (d->partial == P_LITERAL) {
+        while (p < end && json_literal_char(*p))
+            p++;
+        strbuf_append_mem(&d->token, json.data, p - json.data);
+        if (p < end)
+            json_decoder_flush(l, d);
+    }
+
+    while (p < end && d->partial == P_NONE) {
+        const char *q = p;
+        json_token_type_t type = ch2token(*p);
+
+        if (type == T_WHITESPACE) {
+            p++;
+            continue;
+        }
+
+        /* Find the end of the token */
+        if (*p == '"') {
+            int escaped = 0;
+
+            for (q++; q < end && (escaped || *q != '"'); q++)
+                escaped = !escaped && *q == '\\';
+            if (q == end) {
+                d->partial = P_STRING;
+                d->escaped = escaped;
+            }
+        } else if (type == T_UNKNOWN) {
+            while (q < end && json_literal_char(*q))
+                q++;
+            if (q == end)
+                d->partial = P_LITERAL;
+        }
+
+        if (d->partial != P_NONE) {
+            d->token_index = d->offset + (p - json.data);
+            strbuf_reset(&d->token);
+            strbuf_append_mem(&d->token, p, end - p);
+            break;
+        }
+
+        json.ptr = p;
+        json_decoder_next(l, d, &json, q - p + 1, d->offset);
+        p = json.ptr;
+    }
+
+    d->offset += len;
+    lua_pushboolean(l, d->state == D_DONE);
+    return 1;
+}
+
+/* Ends the document, run protected by json_decoder_finish() */
+static int json_decoder_complete(lua_State *l)
+{
+    json_decoder_t *d = (json_decoder_t *)lua_touserdata(l, 1);
+
+    lua_settop(l, 1);
+    lua_pushnil(l);
+    lua_getfenv(l, 1);
+
+    /* A number at the very end has no delimiter after it */
+    if (d->state != D_FAILED && d->partial != P_NONE)
+        json_decoder_flush(l, d);
+
+    if (d->state != D_FAILED && d->state != D_DONE) {
+        json_token_t token;
+
+        token.type = T_END;
+        token.index = d->offset;
+        json_decoder_error(l, d, &token);
+    }
+
+    if (d->state == D_DONE) {
+        lua_rawgeti(l, 3, 0);
+        lua_replace(l, 2);
+    }
+
+    lua_settop(l, 2);
+    return 1;
+}
+
+/* Lua: value = decoder:finish()
+ * Returns the decoded value and resets the decoder for another document,
+ * also when it raises an error for this one */
+static int json_decoder_finish(lua_State *l)
+{
+    json_decoder_t *d = json_check_decoder(l);
+    int status;
+
+    lua_settop(l, 1);
+    lua_pushcfunction(l, json_decoder_complete);
+    lua_pushvalue(l, 1);
+    status = lua_pcall(l, 1, 1, 0);
+
+    /* Reset */
+    lua_newtable(l);
+    lua_setfenv(l, 1);
+    d->state = D_VALUE;
+    d->partial = P_NONE;
+    d->depth = 0;
+    d->offset = 0;
+    strbuf_reset(&d->token);
+
+    if (status)
+        return lua_error(l);
+    return 1;
+}
+
+static int json_decoder_gc(lua_State *l)
+{
+    json_decoder_t *d = json_check_decoder(l);
+
+    strbuf_free(&d->token);
+    strbuf_free(&d->tmp);
+
+    return 0;
+}
+
 /* ===== INITIALISATION ===== */
 #if 0
 #if !defined(LUA_VERSION_NUM) || LUA_VERSION_NUM < 502
@@ -1599,15 +2807,34 @@ int luaopen_cjson_safe(lua_State *l)
 }
 #endif
 
+static const LUA_REG_TYPE cjson_decoder_map[] = {
+  { LSTRKEY( "write" ),                   LFUNCVAL( json_decoder_write ) },
+  { LSTRKEY( "finish" ),                  LFUNCVAL( json_decoder_finish ) },
+  { LSTRKEY( "__gc" ),                    LFUNCVAL( json_decoder_gc ) },
+  { LSTRKEY( "__index" ),                 LROVAL( cjson_decoder_map ) },
+  { LNILKEY, LNILVAL }
+};
+
+static const LUA_REG_TYPE cjson_template_map[] = {
+  { LSTRKEY( "encode" ),                  LFUNCVAL( json_template_encode ) },
+  { LSTRKEY( "__index" ),                 LROVAL( cjson_template_map ) },
+  { LNILKEY, LNILVAL }
+};
+
 // Module function map
 static const LUA_REG_TYPE cjson_map[] = {
   { LSTRKEY( "encode" ),                  LFUNCVAL( json_encode ) },
+  { LSTRKEY( "encode_to" ),               LFUNCVAL( json_encode_to ) },
+  { LSTRKEY( "compile" ),                 LFUNCVAL( json_compile ) },
   { LSTRKEY( "decode" ),                  LFUNCVAL( json_decode ) },
+  { LSTRKEY( "decoder" ),                 LFUNCVAL( json_decoder_new ) },
+  { LSTRKEY( "extract" ),                 LFUNCVAL( json_extract ) },
 //{ LSTRKEY( "encode_sparse_array" ),     LFUNCVAL( json_cfg_encode_sparse_array ) },
 //{ LSTRKEY( "encode_max_depth" ),        LFUNCVAL( json_cfg_encode_max_depth ) },
 //{ LSTRKEY( "decode_max_depth" ),        LFUNCVAL( json_cfg_decode_max_depth ) },
 //{ LSTRKEY( "encode_number_precision" ), LFUNCVAL( json_cfg_encode_number_precision ) },
 //{ LSTRKEY( "encode_keep_buffer" ),      LFUNCVAL( json_cfg_encode_keep_buffer ) },
+//{ LSTRKEY( "decode_keep_buffer" ),      LFUNCVAL( json_cfg_decode_keep_buffer ) },
 //{ LSTRKEY( "encode_invalid_numbers" ),  LFUNCVAL( json_cfg_encode_invalid_numbers ) },
 //{ LSTRKEY( "decode_invalid_numbers" ),  LFUNCVAL( json_cfg_decode_invalid_numbers ) },
 //{ LSTRKEY( "new" ),                     LFUNCVAL( lua_cjson_new ) },
@@ -1617,6 +2844,8 @@ static const LUA_REG_TYPE cjson_map[] = {
 int luaopen_cjson( lua_State *L )
 {
   cjson_mem_setlua (L);
+  luaL_rometatable(L, "cjson.decoder", (void *)cjson_decoder_map);
+  luaL_rometatable(L, "cjson.template", (void *)cjson_template_map);
 
   /* Initialise number conversions */
   // fpconv_init();         // not needed for a specific cpu.
@@ -9,15 +9,80 @@
 #include "c_string.h"
 
 static volatile int file_fd = FS_OPEN_OK - 1;
+// whether the open file was written to, so close() records its mtime
+static int file_written;
+#if defined(BUILD_SPIFFS)
+extern spiffs fs;
 
-// Lua: open(filename, mode)
-static int file_open( lua_State* L )
+// set while the open file is the replacement of this file, see replace()
+static char file_replace_name[FS_NAME_MAX_LENGTH + 1];
+#endif
+
+#if defined(BUILD_SPIFFS) && SPIFFS_OBJ_META_LEN >= 4 && defined(LUA_USE_MODULES_RTCTIME)
+#include "rtc/rtctime.h"
+#define FILE_MTIME
+
+// Records the current time as mtime of fd, if the time is known. The first
+// four metadata bytes hold it in seconds since the epoch, the rest stay 0xff
+static void file_stamp( int fd )
 {
-  size_t len;
+  struct rtc_timeval tv;
+  u8_t meta[SPIFFS_OBJ_META_LEN];
+  if(file_written && rtctime_have_time()){
+    rtctime_gettimeofday(&tv);
+    c_memset(meta, 0xff, sizeof(meta));
+    c_memcpy(meta, &tv.tv_sec, sizeof(tv.tv_sec));
+    SPIFFS_fupdate_meta(&fs, fd, meta);
+  }
+  file_written = 0;
+}
+#else
+#define file_stamp(fd)
+#endif
+
+// Closes the open file. If replace() opened it, what was written is put in
+// place of the old content only with commit set, else thrown away.
+// Returns 0 if a replacement did not take its place, else 1
+static int file_end( int commit )
+{
+  int ok = 1;
   if((FS_OPEN_OK - 1)!=file_fd){
+    file_stamp(file_fd);
+#if defined(BUILD_SPIFFS)
+    if(file_replace_name[0]){
+      ok = fs_replace_close(file_fd, file_replace_name, commit) && commit;
+      file_replace_name[0] = '\0';
+      file_fd = FS_OPEN_OK - 1;
+      return ok;
+    }
+#endif
     fs_close(file_fd);
     file_fd = FS_OPEN_OK - 1;
   }
+  return ok;
+}
+
+// Lua: close()
+// Returns whether the replacement took its place if the file was opened by
+// replace(), else nothing. Any other call that closes the open file throws
+// such a replacement away
+static int file_close( lua_State* L )
+{
+#if defined(BUILD_SPIFFS)
+  if((FS_OPEN_OK - 1)!=file_fd && file_replace_name[0]){
+    lua_pushboolean(L, file_end(1));
+    return 1;
+  }
+#endif
+  file_end(1);
+  return 0;
+}
+
+// Lua: open(filename, mode)
+static int file_open( lua_State* L )
+{
+  size_t len;
+  file_end(0);
 
   const char *fname = luaL_checklstring( L, 1, &len );
   if( len > FS_NAME_MAX_LENGTH )
@@ -35,21 +100,11 @@ static int file_open( lua_State* L )
   return 1; 
 }
 
-// Lua: close()
-static int file_close( lua_State* L )
-{
-  if((FS_OPEN_OK - 1)!=file_fd){
-    fs_close(file_fd);
-    file_fd = FS_OPEN_OK - 1;
-  }
-  return 0;  
-}
-
 // Lua: format()
 static int file_format( lua_State* L )
 {
   size_t len;
-  file_close(L);
+  file_end(0);
   if( !fs_format() )
   {
     NODE_ERR( "\ni*** ERROR ***: unable to format. FS might be compromised.\n" );
@@ -78,18 +133,17 @@ static int file_list( lua_State* L )
 
 #elif defined(BUILD_SPIFFS)
 
-extern spiffs fs;
-
-// Lua: list()
+// Lua: list([prefix])
 static int file_list( lua_State* L )
 {
   spiffs_DIR d;
   struct spiffs_dirent e;
   struct spiffs_dirent *pe = &e;
+  const char *prefix = luaL_optstring( L, 1, "" );
 
   lua_newtable( L );
   SPIFFS_opendir(&fs, "/", &d);
-  while ((pe = SPIFFS_readdir(&d, pe))) {
+  while ((pe = myspiffs_readdir(&d, prefix, pe))) {
     // NODE_ERR("  %s size:%i\n", pe->name, pe->size);
     lua_pushinteger(L, pe->size);
     lua_setfield( L, -2, pe->name );
@@ -98,6 +152,64 @@ static int file_list( lua_State* L )
   return 1;
 }
 
+// iterator returned by entries()
+static int file_entries_next( lua_State* L )
+{
+  spiffs_DIR *d = (spiffs_DIR *)lua_touserdata( L, lua_upvalueindex(1) );
+  const char *prefix = lua_tostring( L, lua_upvalueindex(2) );
+  struct spiffs_dirent e;
+
+  if (!myspiffs_readdir(d, prefix, &e))
+    return 0;
+  lua_pushstring(L, (char *)e.name);
+  lua_pushinteger(L, e.size);
+  return 2;
+}
+
+// Lua: for name, size in entries([prefix]) do ... end
+// Like list(), but returns the files one at a time instead of building a table
+static int file_entries( lua_State* L )
+{
+  const char *prefix = luaL_optstring( L, 1, "" );
+  spiffs_DIR *d = (spiffs_DIR *)lua_newuserdata( L, sizeof(spiffs_DIR) );
+  if (!SPIFFS_opendir(&fs, "/", d))
+    return luaL_error(L, "file system error");
+  lua_pushstring( L, prefix );
+  lua_pushcclosure( L, file_entries_next, 2 );
+  return 1;
+}
+
+// Lua: stat(filename)
+// Returns a table with name, size and, if known, mtime of the file, or nil
+static int file_stat( lua_State* L )
+{
+  size_t len;
+  spiffs_stat s;
+  const char *fname = luaL_checklstring( L, 1, &len );
+  if( len > FS_NAME_MAX_LENGTH )
+    return luaL_error(L, "filename too long");
+
+  if (SPIFFS_stat(&fs, (char *)fname, &s) != SPIFFS_OK) {
+    SPIFFS_clearerr(&fs);
+    lua_pushnil(L);
+    return 1;
+  }
+  lua_createtable(L, 0, 3);
+  lua_pushstring(L, (char *)s.name);
+  lua_setfield(L, -2, "name");
+  lua_pushinteger(L, s.size);
+  lua_setfield(L, -2, "size");
+#ifdef FILE_MTIME
+  uint32_t mtime;
+  c_memcpy(&mtime, s.meta, sizeof(mtime));
+  if (mtime != 0xffffffff) {
+    lua_pushinteger(L, mtime);
+    lua_setfield(L, -2, "mtime");
+  }
+#endif
+  return 1;
+}
+
 static int file_seek (lua_State *L) 
 {
   static const int mode[] = {FS_SEEK_SET, FS_SEEK_CUR, FS_SEEK_END};
@@ -121,8 +233,9 @@ static int file_remove( lua_State* L )
   const char *fname = luaL_checklstring( L, 1, &len );
   if( len > FS_NAME_MAX_LENGTH )
     return luaL_error(L, "filename too long");
-  file_close(L);
+  file_end(0);
   SPIFFS_remove(&fs, (char *)fname);
+  fs_gc_kick();
   return 0;  
 }
 
@@ -141,7 +254,7 @@ static int file_flush( lua_State* L )
 // Lua: check()
 static int file_check( lua_State* L )
 {
-  file_close(L);
+  file_end(0);
   lua_pushinteger(L, fs_check());
   return 1;
 }
@@ -151,10 +264,7 @@ static int file_check( lua_State* L )
 static int file_rename( lua_State* L )
 {
   size_t len;
-  if((FS_OPEN_OK - 1)!=file_fd){
-    fs_close(file_fd);
-    file_fd = FS_OPEN_OK - 1;
-  }
+  file_end(0);
 
   const char *oldname = luaL_checklstring( L, 1, &len );
   if( len > FS_NAME_MAX_LENGTH )
@@ -172,6 +282,40 @@ static int file_rename( lua_State* L )
   return 1;
 }
 
+// Lua: replace(filename[, data])
+// Gives filename the content data such that a reset at any point leaves
+// either the old or the new content. Without data the replacement is opened
+// for write() and writeline(), and close() puts it in place
+static int file_replace( lua_State* L )
+{
+  size_t len, dlen;
+  const char *fname = luaL_checklstring( L, 1, &len );
+  if( len > FS_NAME_MAX_LENGTH - 2 )
+    return luaL_error(L, "filename too long");
+  const char *data = luaL_optlstring( L, 2, NULL, &dlen );
+  file_end(0);
+
+  int fd = fs_replace_open(fname);
+  if(fd < FS_OPEN_OK){
+    lua_pushnil(L);
+    return 1;
+  }
+  if(data == NULL){
+    file_fd = fd;
+    c_strcpy(file_replace_name, fname);
+    lua_pushboolean(L, 1);
+    return 1;
+  }
+  int ok = fs_write(fd, data, dlen) == dlen;
+  file_written = 1;
+  file_stamp(fd);
+  if(fs_replace_close(fd, fname, ok))
+    lua_pushboolean(L, 1);
+  else
+    lua_pushnil(L);
+  return 1;
+}
+
 // Lua: fsinfo()
 static int file_fsinfo( lua_State* L )
 {
@@ -188,6 +332,70 @@ static int file_fsinfo( lua_State* L )
   return 3;
 }
 
+// Lua: pages = cachesize([pages])
+// Changing the size remounts the file system, which closes the open file
+static int file_cachesize( lua_State* L )
+{
+  uint32_t hits, misses, evictions;
+  if( lua_isnoneornil(L, 1) ){
+    lua_pushinteger(L, fs_cachestats(&hits, &misses, &evictions));
+    return 1;
+  }
+  int pages = luaL_checkinteger( L, 1 );
+  file_end(0);
+  lua_pushinteger(L, fs_cachesize(pages));
+  return 1;
+}
+
+// Lua: hits, misses, evictions, pages = cachestats()
+static int file_cachestats( lua_State* L )
+{
+  uint32_t hits, misses, evictions;
+  int pages = fs_cachestats(&hits, &misses, &evictions);
+  lua_pushinteger(L, hits);
+  lua_pushinteger(L, misses);
+  lua_pushinteger(L, evictions);
+  lua_pushinteger(L, pages);
+  return 4;
+}
+
+// Lua: written, programmed, erased = writestats()
+// Bytes written to files and bytes programmed to flash for them, and the
+// number of sectors erased, since boot
+static int file_writestats( lua_State* L )
+{
+  uint32_t written, programmed, erased;
+  fs_writestats(&written, &programmed, &erased);
+  lua_pushinteger(L, written);
+  lua_pushinteger(L, programmed);
+  lua_pushinteger(L, erased);
+  return 3;
+}
+
+// Lua: erased, ready = gc([budget])
+// One garbage collection step: erases a block that holds only deleted data,
+// or moves at most budget pages (default 16) out of a block and erases it.
+// Returns whether a block was erased and how many erased blocks are ready
+static int file_gc( lua_State* L )
+{
+  uint32_t ready;
+  int budget = luaL_optinteger( L, 1, 16 );
+  lua_pushboolean(L, fs_gc(budget, &ready));
+  lua_pushinteger(L, ready);
+  return 2;
+}
+
+// Lua: autogc(reserve[, budget])
+// Keep reserve erased blocks ready by running gc steps of budget pages
+// whenever the system is idle, autogc(0) turns it off
+static int file_autogc( lua_State* L )
+{
+  int reserve = luaL_checkinteger( L, 1 );
+  int budget = luaL_optinteger( L, 2, 16 );
+  fs_autogc(reserve, budget);
+  return 0;
+}
+
 #endif
 
 // g_read()
@@ -204,22 +412,22 @@ static int file_g_read( lua_State* L, int n, int16_t end_char )
 
   luaL_buffinit(L, &b);
   char *p = luaL_prepbuffer(&b);
-  int i;
-
-  n = fs_read(file_fd, p, n);
-  for (i = 0; i < n; ++i)
-    if (p[i] == end_char)
-    {
-      ++i;
-      break;
-    }
+  int i, c;
+
+  if (end_char == EOF) {
+    i = fs_read(file_fd, p, n);
+  } else {
+    /* served from the read-ahead buffer, so nothing to seek back over */
+    for (i = 0; i < n && (c = fs_getc(file_fd)) != EOF; )
+      if ((p[i++] = (char)c) == end_char)
+        break;
+  }
 
   if(i==0){
     luaL_pushresult(&b);  /* close buffer */
     return (lua_objlen(L, -1) > 0);  /* check whether read something */
   }
 
-  fs_seek(file_fd, -(n - i), SEEK_CUR);
   luaL_addsize(&b, i);
   luaL_pushresult(&b);  /* close buffer */
   return 1;  /* read at least an `eol' */ 
@@ -267,6 +475,24 @@ static int file_write( lua_State* L )
   size_t l, rl;
   const char *s = luaL_checklstring(L, 1, &l);
   rl = fs_write(file_fd, s, l);
+  file_written = 1;
+  if(rl==l)
+    lua_pushboolean(L, 1);
+  else
+    lua_pushnil(L);
+  return 1;
+}
+
+// Lua: cjson.encode_to(file, value)
+// Invoked as __sink(file, payload), writes the payload to the open file
+static int file_sink( lua_State* L )
+{
+  if((FS_OPEN_OK - 1)==file_fd)
+    return luaL_error(L, "open a file first");
+  size_t l, rl;
+  const char *s = luaL_checkpayload(L, 2, &l);
+  rl = fs_write(file_fd, s, l);
+  file_written = 1;
   if(rl==l)
     lua_pushboolean(L, 1);
   else
@@ -282,6 +508,7 @@ static int file_writeline( lua_State* L )
   size_t l, rl;
   const char *s = luaL_checklstring(L, 1, &l);
   rl = fs_write(file_fd, s, l);
+  file_written = 1;
   if(rl==l){
     rl = fs_write(file_fd, "\n", 1);
     if(rl==1)
@@ -305,13 +532,22 @@ static const LUA_REG_TYPE file_map[] = {
   { LSTRKEY( "read" ),      LFUNCVAL( file_read ) },
   { LSTRKEY( "readline" ),  LFUNCVAL( file_readline ) },
   { LSTRKEY( "format" ),    LFUNCVAL( file_format ) },
+  { LSTRKEY( "__sink" ),    LFUNCVAL( file_sink ) },
 #if defined(BUILD_SPIFFS) && !defined(BUILD_WOFS)
   { LSTRKEY( "remove" ),    LFUNCVAL( file_remove ) },
   { LSTRKEY( "seek" ),      LFUNCVAL( file_seek ) },
   { LSTRKEY( "flush" ),     LFUNCVAL( file_flush ) },
 //{ LSTRKEY( "check" ),     LFUNCVAL( file_check ) },
+  { LSTRKEY( "entries" ),   LFUNCVAL( file_entries ) },
+  { LSTRKEY( "stat" ),      LFUNCVAL( file_stat ) },
   { LSTRKEY( "rename" ),    LFUNCVAL( file_rename ) },
+  { LSTRKEY( "replace" ),   LFUNCVAL( file_replace ) },
   { LSTRKEY( "fsinfo" ),    LFUNCVAL( file_fsinfo ) },
+  { LSTRKEY( "cachesize" ), LFUNCVAL( file_cachesize ) },
+  { LSTRKEY( "cachestats" ),LFUNCVAL( file_cachestats ) },
+  { LSTRKEY( "writestats" ),LFUNCVAL( file_writestats ) },
+  { LSTRKEY( "gc" ),        LFUNCVAL( file_gc ) },
+  { LSTRKEY( "autogc" ),    LFUNCVAL( file_autogc ) },
 #endif
   { LNILKEY, LNILVAL }
 };
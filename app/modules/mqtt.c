@@ -1221,8 +1221,9 @@ static int mqtt_socket_subscribe( lua_State* L ) {
 	return 1;
 }
 
-// Lua: bool = mqtt:publish( topic, payload, qos, retain, function() )
-static int mqtt_socket_publish( lua_State* L )
+// sink is set when called from __sink, where the payload may be a
+// luaL_pcallsink() token rather than a string
+static int mqtt_publish( lua_State* L, int sink )
 {
   NODE_DBG("enter mqtt_socket_publish.\n");
   struct espconn *pesp_conn = NULL;
@@ -1259,7 +1260,8 @@ static int mqtt_socket_publish( lua_State* L )
     return 1;
   }
 
-  const char *payload = luaL_checklstring( L, stack, &l );
+  const char *payload = sink ? luaL_checkpayload( L, stack, &l ) :
+                               luaL_checklstring( L, stack, &l );
   stack ++;
   uint8_t qos = luaL_checkinteger( L, stack);
   stack ++;
@@ -1310,6 +1312,22 @@ static int mqtt_socket_publish( lua_State* L )
   return 1;
 }
 
+// Lua: bool = mqtt:publish( topic, payload, qos, retain, function() )
+static int mqtt_socket_publish( lua_State* L )
+{
+  return mqtt_publish(L, 0);
+}
+
+// Lua: cjson.encode_to( client, value, topic, qos, retain, function() )
+// Invoked as __sink( client, payload, topic, ... ), publishes the payload
+static int mqtt_socket_sink( lua_State* L )
+{
+  lua_pushvalue(L, 3);  // move the topic in front of the payload
+  lua_insert(L, 2);
+  lua_remove(L, 4);
+  return mqtt_publish(L, 1);
+}
+
 // Lua: mqtt:lwt( topic, message, qos, retain, function(client) )
 static int mqtt_socket_lwt( lua_State* L )
 {
@@ -1396,6 +1414,7 @@ static const LUA_REG_TYPE mqtt_socket_map[] = {
   { LSTRKEY( "subscribe" ), LFUNCVAL( mqtt_socket_subscribe ) },
   { LSTRKEY( "lwt" ),       LFUNCVAL( mqtt_socket_lwt ) },
   { LSTRKEY( "on" ),        LFUNCVAL( mqtt_socket_on ) },
+  { LSTRKEY( "__sink" ),    LFUNCVAL( mqtt_socket_sink ) },
   { LSTRKEY( "__gc" ),      LFUNCVAL( mqtt_delete ) },
   { LSTRKEY( "__index" ),   LROVAL( mqtt_socket_map ) },
   { LNILKEY, LNILVAL }
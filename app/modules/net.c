@@ -39,6 +39,30 @@ static uint16_t tcp_server_timeover = 30;
 static struct espconn *pTcpServer = NULL;
 static struct espconn *pUdpServer = NULL;
 
+// A TCP payload waiting to be sent. A string is referenced until its
+// last segment has been acknowledged by the sent callback; a sink payload
+// is copied in after the entry instead.
+typedef struct net_send_entry
+{
+  struct net_send_entry *next;
+  int ref;        // the string, or LUA_NOREF if the data follows the entry
+  int cb_ref;     // sent() given with this payload, or LUA_NOREF
+  const char *data;
+  size_t len;
+  size_t off;     // bytes handed to espconn so far
+} net_send_entry;
+
+// espconn takes one segment of at most one MSS at a time
+#define NET_SEND_SEGMENT 1460
+
+// A segment espconn refuses for lack of buffers is retried from a timer,
+// up to NET_SEND_RETRIES times; any other refusal fails the payload
+#define NET_SEND_RETRY_MS 20
+#define NET_SEND_RETRIES  50
+// send_err of an empty payload, which the timer completes, so that its sent
+// callback does not run inside send()
+#define NET_SEND_EMPTY    1
+
 typedef struct lnet_userdata
 {
   struct espconn *pesp_conn;
@@ -49,11 +73,140 @@ typedef struct lnet_userdata
   int cb_receive_ref;
   int cb_send_ref;
   int cb_dns_found_ref;
+  net_send_entry *send_head;
+  net_send_entry *send_tail;
+  uint16_t send_inflight;   // length of the segment in flight, 0 if none
+  os_timer_t send_timer;    // retries a refused segment
+  sint8 send_err;           // why it was refused, ESPCONN_OK if it was not
+  uint8_t send_retries;
+  uint8_t connected;        // espconn takes data only once this is set
+  int rx_buf_ref;   // net.buffer handed to the receive callback, if enabled
 #ifdef CLIENT_SSL_ENABLE
   uint8_t secure;
 #endif
 }lnet_userdata;
 
+// A view of received data, valid only during the receive callback.
+// It points straight at the SDK's buffer, so nothing is copied or interned
+// unless the callback asks for a string.
+typedef struct lnet_buffer
+{
+  const char *data;   // NULL outside the callback
+  size_t len;
+} lnet_buffer;
+
+static void net_send_retry(void *arg);
+
+// Hands the next segment of the send queue to espconn, if the connection is
+// up, none is in flight and no retry is pending
+static void net_send_next(lnet_userdata *nud)
+{
+  net_send_entry *e = nud->send_head;
+  size_t n;
+  sint8 res;
+
+  if(e == NULL || nud->send_inflight || nud->send_err != ESPCONN_OK ||
+     nud->pesp_conn == NULL || !nud->connected)
+    return;
+  n = e->len - e->off;
+  if(n > NET_SEND_SEGMENT)
+    n = NET_SEND_SEGMENT;
+  if(n == 0){
+    res = NET_SEND_EMPTY;
+  } else {
+#ifdef CLIENT_SSL_ENABLE
+    if(nud->secure)
+      res = espconn_secure_sent(nud->pesp_conn, (unsigned char *)e->data + e->off, n);
+    else
+#endif
+      res = espconn_sent(nud->pesp_conn, (unsigned char *)e->data + e->off, n);
+    if(res == ESPCONN_OK){
+      nud->send_inflight = n;
+      nud->send_retries = 0;
+      return;
+    }
+    NODE_DBG("espconn_sent failed: %d\n", res);
+  }
+  // no sent callback will come for this segment, so don't wait for one
+  nud->send_err = res;
+  os_timer_disarm(&nud->send_timer);
+  os_timer_setfn(&nud->send_timer, net_send_retry, nud);
+  os_timer_arm(&nud->send_timer, NET_SEND_RETRY_MS, 0);
+}
+
+// Removes the queue head, which has gone out or failed with err, and calls
+// its sent callback as sent(socket), or sent(socket, err) on failure
+static void net_send_done(lnet_userdata *nud, sint8 err)
+{
+  net_send_entry *e = nud->send_head;
+  int cb_ref = e->cb_ref != LUA_NOREF ? e->cb_ref : nud->cb_send_ref;
+  int call = cb_ref != LUA_NOREF && nud->self_ref != LUA_NOREF;
+
+  nud->send_head = e->next;
+  if(nud->send_head == NULL)
+    nud->send_tail = NULL;
+  if(call)
+    lua_rawgeti(gL, LUA_REGISTRYINDEX, cb_ref);
+  if(e->ref != LUA_NOREF)
+    luaL_unref(gL, LUA_REGISTRYINDEX, e->ref);
+  if(e->cb_ref != LUA_NOREF)
+    luaL_unref(gL, LUA_REGISTRYINDEX, e->cb_ref);
+  c_free(e);
+  net_send_next(nud);   // keep the link busy while lua runs
+  if(!call)
+    return;
+  lua_rawgeti(gL, LUA_REGISTRYINDEX, nud->self_ref);  // pass the userdata(socket) to callback func in lua
+  if(err == ESPCONN_OK){
+    lua_call(gL, 1, 0);
+  }else{
+    lua_pushinteger(gL, err);
+    lua_call(gL, 2, 0);
+  }
+}
+
+// send_timer: offers a refused segment again, gives up on its payload, or
+// completes an empty payload
+static void net_send_retry(void *arg)
+{
+  lnet_userdata *nud = (lnet_userdata *)arg;
+  sint8 err = nud->send_err;
+
+  nud->send_err = ESPCONN_OK;
+  if(nud->send_head == NULL)
+    return;
+  if(err == NET_SEND_EMPTY){
+    net_send_done(nud, ESPCONN_OK);
+    return;
+  }
+  if((err == ESPCONN_MEM || err == ESPCONN_MAXNUM) &&
+     ++nud->send_retries < NET_SEND_RETRIES){
+    net_send_next(nud);
+    return;
+  }
+  nud->send_retries = 0;
+  net_send_done(nud, err);
+}
+
+// Drops the pending sends, once the connection is gone
+static void net_send_clear(lua_State *L, lnet_userdata *nud)
+{
+  net_send_entry *e;
+
+  os_timer_disarm(&nud->send_timer);
+  while((e = nud->send_head) != NULL){
+    nud->send_head = e->next;
+    if(e->ref != LUA_NOREF)
+      luaL_unref(L, LUA_REGISTRYINDEX, e->ref);
+    if(e->cb_ref != LUA_NOREF)
+      luaL_unref(L, LUA_REGISTRYINDEX, e->cb_ref);
+    c_free(e);
+  }
+  nud->send_tail = NULL;
+  nud->send_inflight = 0;
+  nud->send_err = ESPCONN_OK;
+  nud->send_retries = 0;
+}
+
 static void net_server_disconnected(void *arg)    // for tcp server only
 {
   NODE_DBG("net_server_disconnected is called.\n");
@@ -63,6 +216,7 @@ static void net_server_disconnected(void *arg)    // for tcp server only
   lnet_userdata *nud = (lnet_userdata *)pesp_conn->reverse;
   if(nud == NULL)
     return;
+  nud->connected = 0;
   if(gL == NULL)
     return;
 #if 0
@@ -80,6 +234,7 @@ static void net_server_disconnected(void *arg)    // for tcp server only
     lua_rawgeti(gL, LUA_REGISTRYINDEX, nud->self_ref);  // pass the userdata(client) to callback func in lua
     lua_call(gL, 1, 0);
   }
+  net_send_clear(gL, nud);
   int i;
   lua_gc(gL, LUA_GCSTOP, 0);
   for(i=0;i<MAX_SOCKET;i++){
@@ -106,12 +261,14 @@ static void net_socket_disconnected(void *arg)    // tcp only
   lnet_userdata *nud = (lnet_userdata *)pesp_conn->reverse;
   if(nud == NULL)
     return;
+  nud->connected = 0;
   if(nud->cb_disconnect_ref != LUA_NOREF && nud->self_ref != LUA_NOREF)
   {
     lua_rawgeti(gL, LUA_REGISTRYINDEX, nud->cb_disconnect_ref);
     lua_rawgeti(gL, LUA_REGISTRYINDEX, nud->self_ref);  // pass the userdata(client) to callback func in lua
     lua_call(gL, 1, 0);
   }
+  net_send_clear(gL, nud);
 
   if(pesp_conn->proto.tcp)
     c_free(pesp_conn->proto.tcp);
@@ -158,6 +315,16 @@ static void net_socket_received(void *arg, char *pdata, unsigned short len)
   // *(pdata+len) = 0;
   // NODE_DBG(pdata);
   // NODE_DBG("\n");
+  if(nud->rx_buf_ref != LUA_NOREF){
+    lua_rawgeti(gL, LUA_REGISTRYINDEX, nud->rx_buf_ref);
+    lnet_buffer *buf = (lnet_buffer *)lua_touserdata(gL, -1);
+    buf->data = pdata;
+    buf->len = len;
+    lua_call(gL, 2, 0);
+    buf->data = NULL;   // pdata is gone once we return
+    buf->len = 0;
+    return;
+  }
   lua_pushlstring(gL, pdata, len);
   // lua_pushinteger(gL, len);
   lua_call(gL, 2, 0);
@@ -172,6 +339,16 @@ static void net_socket_sent(void *arg)
   lnet_userdata *nud = (lnet_userdata *)pesp_conn->reverse;
   if(nud == NULL)
     return;
+  if(nud->send_inflight){   // tcp, a segment of the queue head went out
+    net_send_entry *e = nud->send_head;
+    e->off += nud->send_inflight;
+    nud->send_inflight = 0;
+    if(e->off < e->len)
+      net_send_next(nud);   // one callback per send, not per segment
+    else
+      net_send_done(nud, ESPCONN_OK);
+    return;
+  }
   if(nud->cb_send_ref == LUA_NOREF)
     return;
   if(nud->self_ref == LUA_NOREF)
@@ -321,6 +498,13 @@ static void net_server_connected(void *arg) // for tcp only
   skt->cb_receive_ref = LUA_NOREF;
   skt->cb_send_ref = LUA_NOREF;
   skt->cb_dns_found_ref = LUA_NOREF;
+  skt->send_head = skt->send_tail = NULL;
+  skt->send_inflight = 0;
+  c_memset(&skt->send_timer, 0, sizeof(os_timer_t));
+  skt->send_err = ESPCONN_OK;
+  skt->send_retries = 0;
+  skt->connected = 1;   // accepted connections are up already
+  skt->rx_buf_ref = LUA_NOREF;
 
 #ifdef CLIENT_SSL_ENABLE
   skt->secure = 0;    // as a server SSL is not supported.
@@ -351,6 +535,8 @@ static void net_socket_connected(void *arg)
   espconn_regist_recvcb(pesp_conn, net_socket_received);
   espconn_regist_sentcb(pesp_conn, net_socket_sent);
   espconn_regist_disconcb(pesp_conn, net_socket_disconnected);
+  nud->connected = 1;
+  net_send_next(nud);   // anything queued before the connection was up
 
   if(nud->cb_connect_ref == LUA_NOREF)
     return;
@@ -427,6 +613,13 @@ static int net_create( lua_State* L, const char* mt )
   nud->cb_receive_ref = LUA_NOREF;
   nud->cb_send_ref = LUA_NOREF;
   nud->cb_dns_found_ref = LUA_NOREF;
+  nud->send_head = nud->send_tail = NULL;
+  nud->send_inflight = 0;
+  c_memset(&nud->send_timer, 0, sizeof(os_timer_t));
+  nud->send_err = ESPCONN_OK;
+  nud->send_retries = 0;
+  nud->connected = 0;
+  nud->rx_buf_ref = LUA_NOREF;
   nud->pesp_conn = NULL;
 #ifdef CLIENT_SSL_ENABLE
   nud->secure = secure;
@@ -530,6 +723,7 @@ static int net_delete( lua_State* L, const char* mt )
   	NODE_DBG("userdata is nil.\n");
   	return 0;
   }
+  net_send_clear(L, nud);
   if(nud->pesp_conn){     // for client connected to tcp server, this should set NULL in disconnect cb
   	nud->pesp_conn->reverse = NULL;
     if(!isserver)   // socket is freed here
@@ -573,6 +767,10 @@ static int net_delete( lua_State* L, const char* mt )
     luaL_unref(L, LUA_REGISTRYINDEX, nud->cb_dns_found_ref);
     nud->cb_dns_found_ref = LUA_NOREF;
   }
+  if(LUA_NOREF!=nud->rx_buf_ref){
+    luaL_unref(L, LUA_REGISTRYINDEX, nud->rx_buf_ref);
+    nud->rx_buf_ref = LUA_NOREF;
+  }
   lua_gc(gL, LUA_GCSTOP, 0);
   if(LUA_NOREF!=nud->self_ref){
     luaL_unref(L, LUA_REGISTRYINDEX, nud->self_ref);
@@ -610,7 +808,7 @@ static void socket_connect(struct espconn *pesp_conn)
 }
 
 static void socket_dns_found(const char *name, ip_addr_t *ipaddr, void *arg);
-static dns_reconn_count = 0;
+static int dns_reconn_count = 0;
 static void socket_dns_found(const char *name, ip_addr_t *ipaddr, void *arg)
 {
   NODE_DBG("socket_dns_found is called.\n");
@@ -799,6 +997,7 @@ static int net_start( lua_State* L, const char* mt )
         espconn_regist_time(pesp_conn, tcp_server_timeover, 0);
     }
     else{
+      nud->connected = 0;   // sends wait for the new connection
       espconn_regist_connectcb(pesp_conn, net_socket_connected);
       espconn_regist_reconcb(pesp_conn, net_socket_reconnected);
 #ifdef CLIENT_SSL_ENABLE
@@ -955,6 +1154,8 @@ static int net_close( lua_State* L, const char* mt )
 }
 
 // Lua: socket/udpserver:on( "method", function(s) )
+// Lua: socket/udpserver:on( "receive", function(s, buf), "buffer" )
+//      delivers a net.buffer view instead of a string
 static int net_on( lua_State* L, const char* mt )
 {
   NODE_DBG("net_on is called.\n");
@@ -999,9 +1200,25 @@ static int net_on( lua_State* L, const char* mt )
       luaL_unref(L, LUA_REGISTRYINDEX, nud->cb_disconnect_ref);
     nud->cb_disconnect_ref = luaL_ref(L, LUA_REGISTRYINDEX);
   }else if((!isserver || nud->pesp_conn->type == ESPCONN_UDP) && sl == 7 && c_strcmp(method, "receive") == 0){
+    bool buffered = !lua_isnoneornil(L, 4);
+    if(buffered && c_strcmp(luaL_checkstring(L, 4), "buffer") != 0){
+      lua_pop(L, 1);
+      return luaL_argerror(L, 4, "receive mode must be \"buffer\"");
+    }
     if(nud->cb_receive_ref != LUA_NOREF)
       luaL_unref(L, LUA_REGISTRYINDEX, nud->cb_receive_ref);
     nud->cb_receive_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    if(buffered && nud->rx_buf_ref == LUA_NOREF){
+      lnet_buffer *buf = (lnet_buffer *)lua_newuserdata(L, sizeof(lnet_buffer));
+      buf->data = NULL;
+      buf->len = 0;
+      luaL_getmetatable(L, "net.buffer");
+      lua_setmetatable(L, -2);
+      nud->rx_buf_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    }else if(!buffered && nud->rx_buf_ref != LUA_NOREF){
+      luaL_unref(L, LUA_REGISTRYINDEX, nud->rx_buf_ref);
+      nud->rx_buf_ref = LUA_NOREF;
+    }
   }else if((!isserver || nud->pesp_conn->type == ESPCONN_UDP) && sl == 4 && c_strcmp(method, "sent") == 0){
     if(nud->cb_send_ref != LUA_NOREF)
       luaL_unref(L, LUA_REGISTRYINDEX, nud->cb_send_ref);
@@ -1019,7 +1236,14 @@ static int net_on( lua_State* L, const char* mt )
 }
 
 // Lua: server/socket:send( string, function(sent) )
-static int net_send( lua_State* L, const char* mt )
+// tcp payloads of any size are queued and sent one segment at a time,
+// sent(socket) is called once the whole string has gone out, or
+// sent(socket, err) with the espconn error if it could not be sent;
+// payloads sent before the connection is up wait for it, and an empty
+// one still gets its sent() call, from a timer
+// sink is set when called from __sink, where the payload may be a
+// luaL_pcallsink() token rather than a string
+static int net_send( lua_State* L, const char* mt, int sink )
 {
   // NODE_DBG("net_send is called.\n");
   bool isserver = false;
@@ -1064,11 +1288,56 @@ static int net_send( lua_State* L, const char* mt )
   NODE_DBG(" sending data.\n");
 #endif
 
-  const char *payload = luaL_checklstring( L, 2, &l );
-  if (l>1460 || payload == NULL)
+  const char *payload = sink ? luaL_checkpayload( L, 2, &l ) :
+                               luaL_checklstring( L, 2, &l );
+  if (payload == NULL || (pesp_conn->type != ESPCONN_TCP && l>1460))
     return luaL_error( L, "need <1460 payload" );
 
-  if (lua_type(L, 3) == LUA_TFUNCTION || lua_type(L, 3) == LUA_TLIGHTFUNCTION){
+  bool has_cb = lua_type(L, 3) == LUA_TFUNCTION || lua_type(L, 3) == LUA_TLIGHTFUNCTION;
+
+  if (pesp_conn->type == ESPCONN_TCP)
+  {
+    // each queued payload keeps its own sent callback
+    net_send_entry *e;
+    int ref = LUA_NOREF, cb_ref = LUA_NOREF;
+    if (has_cb){
+      lua_pushvalue(L, 3);
+      cb_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+    // a sink payload only lives for this call, so it is copied in after
+    // the entry rather than interned as a string
+    if (lua_type(L, 2) == LUA_TSTRING){
+      lua_pushvalue(L, 2);
+      ref = luaL_ref(L, LUA_REGISTRYINDEX);
+      e = (net_send_entry *)c_zalloc(sizeof(net_send_entry));
+    } else {
+      e = (net_send_entry *)c_zalloc(sizeof(net_send_entry) + l);
+    }
+    if (e == NULL){
+      if (ref != LUA_NOREF)
+        luaL_unref(L, LUA_REGISTRYINDEX, ref);
+      if (cb_ref != LUA_NOREF)
+        luaL_unref(L, LUA_REGISTRYINDEX, cb_ref);
+      return luaL_error( L, "not enough memory" );
+    }
+    if (ref == LUA_NOREF){
+      c_memcpy(e + 1, payload, l);
+      payload = (const char *)(e + 1);
+    }
+    e->ref = ref;
+    e->cb_ref = cb_ref;
+    e->data = payload;
+    e->len = l;
+    if (nud->send_tail)
+      nud->send_tail->next = e;
+    else
+      nud->send_head = e;
+    nud->send_tail = e;
+    net_send_next(nud);
+    return 0;
+  }
+
+  if (has_cb){
     lua_pushvalue(L, 3);  // copy argument (func) to the top of stack
     if(nud->cb_send_ref != LUA_NOREF)
       luaL_unref(L, LUA_REGISTRYINDEX, nud->cb_send_ref);
@@ -1258,7 +1527,7 @@ static int net_udpserver_on( lua_State* L )
 static int net_udpserver_send( lua_State* L )
 {
   const char *mt = "net.server";
-  return net_send(L, mt);;
+  return net_send(L, mt, 0);
 }
 
 // Lua: s = net.createConnection(type, function(conn))
@@ -1300,7 +1569,15 @@ static int net_socket_on( lua_State* L )
 static int net_socket_send( lua_State* L )
 {
   const char *mt = "net.socket";
-  return net_send(L, mt);
+  return net_send(L, mt, 0);
+}
+
+// Lua: cjson.encode_to( socket, value, function() )
+// Invoked as __sink( socket, payload, function() ), sends the payload
+static int net_socket_sink( lua_State* L )
+{
+  const char *mt = "net.socket";
+  return net_send(L, mt, 1);
 }
 
 static int net_socket_hold( lua_State* L )
@@ -1504,6 +1781,111 @@ static int expose_array(lua_State* L, char *array, unsigned short len) {
 }
 #endif
 
+static lnet_buffer *net_check_buffer( lua_State* L )
+{
+  lnet_buffer *buf = (lnet_buffer *)luaL_checkudata(L, 1, "net.buffer");
+  if(buf->data == NULL)
+    luaL_error( L, "buffer used outside its receive callback" );
+  return buf;
+}
+
+// string.sub() style position: negative counts from the end
+static ptrdiff_t net_buffer_pos( ptrdiff_t pos, size_t len )
+{
+  if(pos < 0)
+    pos += (ptrdiff_t)len + 1;
+  return pos >= 0 ? pos : 0;
+}
+
+// Lua: buf:tostring(), tostring(buf)
+static int net_buffer_tostring( lua_State* L )
+{
+  lnet_buffer *buf = net_check_buffer(L);
+  lua_pushlstring(L, buf->data, buf->len);
+  return 1;
+}
+
+// Lua: #buf
+static int net_buffer_len( lua_State* L )
+{
+  lnet_buffer *buf = net_check_buffer(L);
+  lua_pushinteger(L, buf->len);
+  return 1;
+}
+
+// Lua: buf:sub( i [, j] ), as string.sub()
+static int net_buffer_sub( lua_State* L )
+{
+  lnet_buffer *buf = net_check_buffer(L);
+  ptrdiff_t start = net_buffer_pos(luaL_checkinteger(L, 2), buf->len);
+  ptrdiff_t end = net_buffer_pos(luaL_optinteger(L, 3, -1), buf->len);
+  if(start < 1)
+    start = 1;
+  if(end > (ptrdiff_t)buf->len)
+    end = (ptrdiff_t)buf->len;
+  if(start <= end)
+    lua_pushlstring(L, buf->data + start - 1, end - start + 1);
+  else
+    lua_pushliteral(L, "");
+  return 1;
+}
+
+// Lua: buf:byte( [i [, j]] ), as string.byte()
+static int net_buffer_byte( lua_State* L )
+{
+  lnet_buffer *buf = net_check_buffer(L);
+  ptrdiff_t posi = net_buffer_pos(luaL_optinteger(L, 2, 1), buf->len);
+  ptrdiff_t pose = net_buffer_pos(luaL_optinteger(L, 3, posi), buf->len);
+  int n, i;
+  if(posi < 1)
+    posi = 1;
+  if(pose > (ptrdiff_t)buf->len)
+    pose = (ptrdiff_t)buf->len;
+  if(posi > pose)
+    return 0;
+  n = (int)(pose - posi + 1);
+  luaL_checkstack(L, n, "buffer slice too long");
+  for(i = 0; i < n; i++)
+    lua_pushinteger(L, (unsigned char)buf->data[posi + i - 1]);
+  return n;
+}
+
+// Lua: start, end = buf:find( text [, init] )
+// plain text search, patterns are not supported; init as string.find()
+static int net_buffer_find( lua_State* L )
+{
+  lnet_buffer *buf = net_check_buffer(L);
+  size_t sl;
+  const char *s = luaL_checklstring(L, 2, &sl);
+  ptrdiff_t init = net_buffer_pos(luaL_optinteger(L, 3, 1), buf->len) - 1;
+  const char *p, *last;
+  if(init < 0)
+    init = 0;
+  else if(init > (ptrdiff_t)buf->len)
+    init = (ptrdiff_t)buf->len;
+  if(sl > buf->len - init){
+    lua_pushnil(L);
+    return 1;
+  }
+  if(sl == 0){
+    lua_pushinteger(L, init + 1);
+    lua_pushinteger(L, init);
+    return 2;
+  }
+  last = buf->data + buf->len - sl;
+  for(p = buf->data + init; p <= last; p++){
+    if(*p == *s && c_memcmp(p, s, sl) == 0){
+      lua_pushinteger(L, p - buf->data + 1);
+      lua_pushinteger(L, p - buf->data + sl);
+      return 2;
+    }
+  }
+  lua_pushnil(L);
+  return 1;
+}
+
+static int net_buffer_index( lua_State* L );
+
 // Module function map
 static const LUA_REG_TYPE net_server_map[] = {
   { LSTRKEY( "listen" ),  LFUNCVAL( net_server_listen ) },
@@ -1525,11 +1907,40 @@ static const LUA_REG_TYPE net_socket_map[] = {
   { LSTRKEY( "unhold" ),  LFUNCVAL( net_socket_unhold ) },
   { LSTRKEY( "dns" ),     LFUNCVAL( net_socket_dns ) },
   { LSTRKEY( "getpeer" ), LFUNCVAL( net_socket_getpeer ) },
+  { LSTRKEY( "__sink" ),  LFUNCVAL( net_socket_sink ) },
 //{ LSTRKEY( "delete" ),  LFUNCVAL( net_socket_delete ) },
   { LSTRKEY( "__gc" ),    LFUNCVAL( net_socket_delete ) },
   { LSTRKEY( "__index" ), LROVAL( net_socket_map ) },
   { LNILKEY, LNILVAL }
 };
+static const LUA_REG_TYPE net_buffer_map[] = {
+  { LSTRKEY( "tostring" ),   LFUNCVAL( net_buffer_tostring ) },
+  { LSTRKEY( "sub" ),        LFUNCVAL( net_buffer_sub ) },
+  { LSTRKEY( "byte" ),       LFUNCVAL( net_buffer_byte ) },
+  { LSTRKEY( "find" ),       LFUNCVAL( net_buffer_find ) },
+  { LSTRKEY( "__tostring" ), LFUNCVAL( net_buffer_tostring ) },
+  { LSTRKEY( "__len" ),      LFUNCVAL( net_buffer_len ) },
+  { LSTRKEY( "__index" ),    LFUNCVAL( net_buffer_index ) },
+  { LNILKEY, LNILVAL }
+};
+
+// Lua: buf[i] gives the byte at i, other keys the methods
+static int net_buffer_index( lua_State* L )
+{
+  if(lua_type(L, 2) == LUA_TNUMBER){
+    lnet_buffer *buf = net_check_buffer(L);
+    ptrdiff_t i = net_buffer_pos(lua_tointeger(L, 2), buf->len);
+    if(i < 1 || i > (ptrdiff_t)buf->len)
+      return 0;
+    lua_pushinteger(L, (unsigned char)buf->data[i - 1]);
+    return 1;
+  }
+  lua_pushrotable(L, (void *)net_buffer_map);
+  lua_pushvalue(L, 2);
+  lua_rawget(L, -2);
+  return 1;
+}
+
 #if 0
 static const LUA_REG_TYPE net_array_map[] = {
   { LSTRKEY( "__index" ),    LFUNCVAL( net_array_index ) },
@@ -1566,6 +1977,7 @@ int luaopen_net( lua_State *L ) {
 
   luaL_rometatable(L, "net.server", (void *)net_server_map);  // create metatable for net.server
   luaL_rometatable(L, "net.socket", (void *)net_socket_map);  // create metatable for net.socket
+  luaL_rometatable(L, "net.buffer", (void *)net_buffer_map);  // create metatable for net.buffer
   #if 0
   luaL_rometatable(L, "net.array", (void *)net_array_map);    // create metatable for net.array
   #endif
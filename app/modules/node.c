@@ -450,6 +450,61 @@ static int node_compile( lua_State* L )
   return 0;
 }
 
+#ifdef LUA_XIP_AREA_SIZE
+// Lua: used = flashimage("a.lc", "b.lc", ...)
+// Replaces the execute-in-place area with copies of the given .lc files.
+// Later dofile()/require() of these files run their code from flash.
+static int node_flashimage( lua_State* L )
+{
+  int i, n = lua_gettop(L);
+  int used = 0, res;
+
+  for (i = 1; i <= n; i++)
+    luaL_checkstring( L, i );
+  if (fs_xip_in_use())
+    return luaL_error(L, "flash image in use, restart first");
+  if (!fs_xip_erase())
+    return luaL_error(L, "cannot erase flash image area");
+  for (i = 1; i <= n; i++) {
+    const char *fname = lua_tostring( L, i );
+    res = fs_xip_add( fname );
+    switch (res) {
+      case FS_XIP_ERR_OPEN:
+        return luaL_error(L, "cannot open %s", fname);
+      case FS_XIP_ERR_FORMAT:
+        return luaL_error(L, "%s is not a precompiled chunk", fname);
+      case FS_XIP_ERR_FULL:
+        return luaL_error(L, "flash image area full at %s", fname);
+      case FS_XIP_ERR_FLASH:
+        return luaL_error(L, "flash write failed at %s", fname);
+    }
+    used += res;
+  }
+  lua_pushinteger(L, used);
+  return 1;
+}
+#endif
+
+#ifdef LUA_LAZY_UNDUMP
+// Lua: previous = lazyload([mode])
+// mode 0 loads every function of a .lc file at once (default),
+// 1 loads nested functions on their first use, 2 also lets the collector
+// unload unused functions again when memory runs low.
+static int node_lazyload( lua_State* L )
+{
+  global_State *g = G(L);
+  int prev = g->lazymode;
+
+  if (lua_gettop(L) >= 1) {
+    int mode = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, mode >= LUA_LAZY_OFF && mode <= LUA_LAZY_DROP, 1, "invalid mode");
+    g->lazymode = mode;
+  }
+  lua_pushinteger(L, prev);
+  return 1;
+}
+#endif
+
 // Lua: setcpufreq(mhz)
 // mhz is either CPU80MHZ od CPU160MHZ
 static int node_setcpufreq(lua_State* L)
@@ -566,6 +621,12 @@ static const LUA_REG_TYPE node_map[] =
 // Moved to adc module, use adc.readvdd33()
 // { LSTRKEY( "readvdd33" ), LFUNCVAL( node_readvdd33) },
   { LSTRKEY( "compile" ), LFUNCVAL( node_compile) },
+#ifdef LUA_XIP_AREA_SIZE
+  { LSTRKEY( "flashimage" ), LFUNCVAL( node_flashimage) },
+#endif
+#ifdef LUA_LAZY_UNDUMP
+  { LSTRKEY( "lazyload" ), LFUNCVAL( node_lazyload) },
+#endif
   { LSTRKEY( "CPU80MHZ" ), LNUMVAL( CPU80MHZ ) },
   { LSTRKEY( "CPU160MHZ" ), LNUMVAL( CPU160MHZ ) },
   { LSTRKEY( "setcpufreq" ), LFUNCVAL( node_setcpufreq) },
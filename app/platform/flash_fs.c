@@ -15,6 +15,8 @@ int fs_mode2flag(const char *mode){
   	  return FS_RDONLY;
   	else if(c_strcmp(mode, "a")==0)
   	  return FS_WRONLY|FS_CREAT|FS_APPEND;
+  	else if(c_strcmp(mode, "l")==0)
+  	  return FS_WRONLY|FS_CREAT|FS_APPEND|FS_LOG;
   	else
   	  return FS_RDONLY;
   } else if (c_strlen(mode)==2){
@@ -30,3 +32,164 @@ int fs_mode2flag(const char *mode){
   	return FS_RDONLY;
   }
 }
+
+#ifdef LUA_XIP_AREA_SIZE
+#include "platform.h"
+#include "lua.h"
+
+/*
+ * Execute-in-place area for precompiled Lua chunks.
+ *
+ * The area starts at the first free flash block after the firmware and
+ * holds a sequence of entries, each a header followed by a verbatim copy of
+ * a .lc file, padded to 4 bytes. An erased magic word ends the list.
+ * Chunks mapped from here are undumped in "direct mode" by lundump.c: their
+ * code, line info and string characters are used straight from flash.
+ */
+
+#define FS_XIP_MAGIC  0x5058494cUL  /* "LIXP" */
+
+typedef struct {
+  uint32_t magic;
+  uint32_t size;
+  char name[FS_NAME_MAX_LENGTH + 4];
+} fs_xip_header;
+
+#define FS_XIP_ALIGN(n)  (((n) + 3) & ~3)
+
+static uint32_t xip_used = 0;   // bytes in use, 0 if not scanned yet
+static int xip_mapped = 0;      // set once a chunk has been executed from flash
+
+uint32_t fs_xip_area_address( void )
+{
+  uint32_t addr = platform_flash_get_first_free_block_address( NULL );
+  addr += 0x3FFF;
+  addr &= 0xFFFFC000;  // same alignment as the SPIFFS start
+  return addr;
+}
+
+static uint32_t xip_next_free( void )
+{
+  uint32_t base = fs_xip_area_address();
+  fs_xip_header h;
+  if (xip_used == 0) {
+    while (xip_used + sizeof(h) <= LUA_XIP_AREA_SIZE) {
+      platform_flash_read( &h, base + xip_used, sizeof(h) );
+      if (h.magic != FS_XIP_MAGIC)
+        break;
+      xip_used += sizeof(h) + FS_XIP_ALIGN(h.size);
+    }
+  }
+  return base + xip_used;
+}
+
+// Returns 1 if OK, 0 for error
+int fs_xip_erase( void )
+{
+  uint32_t sect = platform_flash_get_sector_of_address( fs_xip_area_address() );
+  uint32_t n = LUA_XIP_AREA_SIZE / INTERNAL_FLASH_SECTOR_SIZE;
+  while (n--)
+    if (platform_flash_erase_sector( sect++ ) == PLATFORM_ERR)
+      return 0;
+  xip_used = 0;
+  return 1;
+}
+
+int fs_xip_in_use( void )
+{
+  return xip_mapped;
+}
+
+// Copies a .lc file to the end of the area.
+// Returns the number of bytes appended or a FS_XIP_ERR_ code.
+int fs_xip_add( const char *name )
+{
+  fs_xip_header h;
+  uint32_t wbuf[64];
+  char *buf = (char *)wbuf;
+  uint32_t addr = xip_next_free();
+  uint32_t end = fs_xip_area_address() + LUA_XIP_AREA_SIZE;
+  size_t n, total = 0;
+  int fd = fs_open( name, FS_RDONLY );
+
+  if (fd < FS_OPEN_OK)
+    return FS_XIP_ERR_OPEN;
+  c_memset( &h, 0, sizeof(h) );
+  h.magic = FS_XIP_MAGIC;
+  h.size = fs_size( fd );
+  c_strncpy( h.name, name, FS_NAME_MAX_LENGTH );
+  n = fs_read( fd, buf, sizeof(wbuf) );
+  if (n < sizeof(LUA_SIGNATURE) - 1 ||
+      c_memcmp( buf, LUA_SIGNATURE, sizeof(LUA_SIGNATURE) - 1 ) != 0) {
+    fs_close( fd );
+    return FS_XIP_ERR_FORMAT;  // only precompiled chunks run in place
+  }
+  if (addr + sizeof(h) + FS_XIP_ALIGN(h.size) > end ||
+      platform_flash_phys2mapped( end - 1 ) == (uint32_t)-1) {
+    fs_close( fd );
+    return FS_XIP_ERR_FULL;
+  }
+  // the header goes last, so an interrupted copy is never seen as an entry
+  while (n > 0) {
+    c_memset( buf + n, 0xff, FS_XIP_ALIGN(n) - n );
+    if (platform_flash_write( buf, addr + sizeof(h) + total, FS_XIP_ALIGN(n) ) == 0) {
+      fs_close( fd );
+      return FS_XIP_ERR_FLASH;
+    }
+    total += n;
+    n = fs_read( fd, buf, sizeof(wbuf) );
+  }
+  fs_close( fd );
+  if (total != h.size ||
+      platform_flash_write( &h, addr, sizeof(h) ) != sizeof(h))
+    return FS_XIP_ERR_FLASH;
+  xip_used += sizeof(h) + FS_XIP_ALIGN(h.size);
+  return (int)(sizeof(h) + FS_XIP_ALIGN(h.size));
+}
+
+// Whether the copy at `addr` holds the same bytes as the open file `fd`.
+// A file rewritten with the same name and size must not run stale code.
+static int xip_same_content( uint32_t addr, int fd, size_t size )
+{
+  uint32_t fbuf[32], xbuf[32];
+  size_t n, done = 0;
+
+  if (fs_seek( fd, 0, FS_SEEK_SET ) < 0)
+    return 0;
+  while (done < size) {
+    n = size - done < sizeof(fbuf) ? size - done : sizeof(fbuf);
+    if (fs_read( fd, fbuf, n ) != n)
+      return 0;
+    platform_flash_read( xbuf, addr + done, FS_XIP_ALIGN(n) );
+    if (c_memcmp( fbuf, xbuf, n ) != 0)
+      return 0;
+    done += n;
+  }
+  return 1;
+}
+
+// Returns the mapped address of the copy of file `name`, open as `fd`, or
+// NULL if there is none or the file has changed since it was copied.
+const char *fs_xip_map( const char *name, int fd, size_t size )
+{
+  uint32_t base = fs_xip_area_address();
+  uint32_t end = xip_next_free();
+  uint32_t mapped;
+  fs_xip_header h;
+
+  while (base < end) {
+    platform_flash_read( &h, base, sizeof(h) );
+    if (h.size == size && c_strncmp( h.name, name, FS_NAME_MAX_LENGTH ) == 0) {
+      if (!xip_same_content( base + sizeof(h), fd, size ))
+        return NULL;
+      mapped = platform_flash_phys2mapped( base + sizeof(h) );
+      if (mapped == (uint32_t)-1)
+        return NULL;
+      xip_mapped = 1;
+      return (const char *)mapped;
+    }
+    base += sizeof(h) + FS_XIP_ALIGN(h.size);
+  }
+  return NULL;
+}
+#endif
@@ -16,6 +16,7 @@
 #define FS_TRUNC O_TRUNC
 #define FS_CREAT O_CREAT
 #define FS_EXCL O_EXCL
+#define FS_LOG 0
 
 #define FS_SEEK_SET SEEK_SET
 #define FS_SEEK_CUR SEEK_CUR
@@ -48,6 +49,7 @@
 #define FS_TRUNC SPIFFS_TRUNC
 #define FS_CREAT SPIFFS_CREAT
 #define FS_EXCL SPIFFS_EXCL
+#define FS_LOG SPIFFS_LOG
 
 #define FS_SEEK_SET SPIFFS_SEEK_SET
 #define FS_SEEK_CUR SPIFFS_SEEK_CUR
@@ -69,7 +71,16 @@
 #define fs_format myspiffs_format
 #define fs_check myspiffs_check
 #define fs_rename myspiffs_rename
+#define fs_replace_open myspiffs_replace_open
+#define fs_replace_close myspiffs_replace_close
 #define fs_size myspiffs_size
+#define fs_map myspiffs_map
+#define fs_cachesize myspiffs_cachesize
+#define fs_cachestats myspiffs_cachestats
+#define fs_writestats myspiffs_writestats
+#define fs_gc myspiffs_gc
+#define fs_autogc myspiffs_autogc
+#define fs_gc_kick myspiffs_gc_kick
 
 #define fs_mount myspiffs_mount
 #define fs_unmount myspiffs_unmount
@@ -80,4 +91,18 @@
 
 int fs_mode2flag(const char *mode);
 
+#ifdef LUA_XIP_AREA_SIZE
+// Errors returned by fs_xip_add()
+#define FS_XIP_ERR_OPEN    -1
+#define FS_XIP_ERR_FORMAT  -2
+#define FS_XIP_ERR_FULL    -3
+#define FS_XIP_ERR_FLASH   -4
+
+uint32_t fs_xip_area_address( void );
+int fs_xip_erase( void );
+int fs_xip_add( const char *name );
+int fs_xip_in_use( void );
+const char *fs_xip_map( const char *name, int fd, size_t size );
+#endif
+
 #endif // #ifndef __FLASH_FS_H__
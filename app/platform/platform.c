@@ -593,3 +593,16 @@ uint32_t platform_flash_mapped2phys (uint32_t mapped_addr)
   uint32_t meg = (b1 << 1) | b0;
   return mapped_addr - INTERNAL_FLASH_MAPPED_ADDRESS + meg * 0x100000;
 }
+
+uint32_t platform_flash_phys2mapped (uint32_t phys_addr)
+{
+  uint32_t cache_ctrl = READ_PERI_REG(CACHE_FLASH_CTRL_REG);
+  if (!(cache_ctrl & CACHE_FLASH_ACTIVE))
+    return -1;
+  bool b0 = (cache_ctrl & CACHE_FLASH_MAPPED0) ? 1 : 0;
+  bool b1 = (cache_ctrl & CACHE_FLASH_MAPPED1) ? 1 : 0;
+  uint32_t meg = (b1 << 1) | b0;
+  if (phys_addr < meg * 0x100000 || phys_addr >= (meg + 1) * 0x100000)
+    return -1;  /* outside the 1MB window currently mapped by the cache */
+  return phys_addr - meg * 0x100000 + INTERNAL_FLASH_MAPPED_ADDRESS;
+}
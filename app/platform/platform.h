@@ -247,6 +247,15 @@ int platform_flash_erase_sector( uint32_t sector_id );
  */
 uint32_t platform_flash_mapped2phys (uint32_t mapped_addr);
 
+/**
+ * Translate a physical flash address to the address it is readable at
+ * through the flash cache, the inverse of platform_flash_mapped2phys().
+ * @param phys_addr Physical flash address to translate
+ * @return the corresponding mapped address, or -1 if the flash cache is not
+ *  active or the address lies outside the currently mapped megabyte.
+ */
+uint32_t platform_flash_phys2mapped (uint32_t phys_addr);
+
 // *****************************************************************************
 // Allocator support
 
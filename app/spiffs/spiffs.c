@@ -1,15 +1,127 @@
 #include "c_stdio.h"
+#include "c_stdlib.h"
 #include "platform.h"
+#include "user_interface.h"
 #include "spiffs.h"
+#include "spiffs_nucleus.h"
   
 spiffs fs;
 
 #define LOG_PAGE_SIZE       256
   
 static u8_t spiffs_work_buf[LOG_PAGE_SIZE*2];
-static u8_t spiffs_fds[32*4];
+#ifndef SPIFFS_FDS
+#define SPIFFS_FDS  4  // files open at a time
+#endif
+static u8_t spiffs_fds[SPIFFS_FDS*sizeof(spiffs_fd)];
+// bytes handed to myspiffs_write, bytes programmed and sectors erased
+static u32_t spiffs_bytes_written, spiffs_bytes_programmed, spiffs_sectors_erased;
 #if SPIFFS_CACHE
-static u8_t spiffs_cache[(LOG_PAGE_SIZE+32)*2];
+#ifndef SPIFFS_CACHE_PAGES
+#define SPIFFS_CACHE_PAGES  2
+#endif
+// the mount clamps the cache to 32 log pages, headers included
+#define SPIFFS_CACHE_PAGES_MAX  28
+// bytes for n cache pages, plus slack for the alignment done by the mount
+#define SPIFFS_CACHE_BYTES(n) \
+  (sizeof(spiffs_cache) + (n)*(sizeof(spiffs_cache_page)+LOG_PAGE_SIZE) + 4)
+
+static u8_t spiffs_cache_static[SPIFFS_CACHE_BYTES(SPIFFS_CACHE_PAGES)];
+// set by myspiffs_cachesize() when a size other than the built in one is used
+static u8_t *spiffs_cache_heap = NULL;
+static int spiffs_cache_pages = SPIFFS_CACHE_PAGES;
+#endif
+#if SPIFFS_LU_INDEX
+#ifndef SPIFFS_LU_INDEX_ENTRIES
+#define SPIFFS_LU_INDEX_ENTRIES  32
+#endif
+static spiffs_lu_index_entry spiffs_lu_index[SPIFFS_LU_INDEX_ENTRIES];
+#endif
+
+#ifndef SPIFFS_GC_BUDGET
+#define SPIFFS_GC_BUDGET  16  // pages an idle time gc step may move
+#endif
+static u32_t spiffs_gc_reserve;
+static u16_t spiffs_gc_budget = SPIFFS_GC_BUDGET;
+static u8_t spiffs_gc_posted;
+
+#ifdef SPIFFS_READAHEAD
+// Read-ahead buffer of an fd. While it holds data the SPIFFS offset of the
+// fd is pos+len, the position seen by callers is pos+ix.
+typedef struct {
+  int fd;
+  u32_t pos;
+  u16_t len;
+  u16_t ix;
+  u8_t buf[SPIFFS_READAHEAD];
+} spiffs_readahead;
+
+#define SPIFFS_READAHEAD_FDS  4
+static spiffs_readahead *spiffs_ra[SPIFFS_READAHEAD_FDS];
+
+// returns the read-ahead buffer of fd, allocating one if asked to and
+// there is room; reads go straight to SPIFFS when this returns NULL
+static spiffs_readahead *readahead_get( int fd, int alloc ){
+  int i, free = -1;
+  for (i = 0; i < SPIFFS_READAHEAD_FDS; i++) {
+    if (spiffs_ra[i] && spiffs_ra[i]->fd == fd)
+      return spiffs_ra[i];
+    if (!spiffs_ra[i] && free < 0)
+      free = i;
+  }
+  if (!alloc || free < 0)
+    return NULL;
+  s32_t pos = SPIFFS_tell(&fs, (spiffs_file)fd);
+  if (pos < 0)
+    return NULL;
+  spiffs_readahead *ra = (spiffs_readahead *)c_malloc(sizeof(spiffs_readahead));
+  if (ra) {
+    ra->fd = fd;
+    ra->pos = pos;
+    ra->len = ra->ix = 0;
+    spiffs_ra[free] = ra;
+  }
+  return ra;
+}
+
+// moves the SPIFFS offset of fd back to where the caller thinks it is and
+// empties the buffer, before anything that uses or changes the offset
+static void readahead_sync( int fd ){
+  spiffs_readahead *ra = readahead_get(fd, 0);
+  if (ra && ra->ix < ra->len)
+    SPIFFS_lseek(&fs, (spiffs_file)fd, ra->pos + ra->ix, SPIFFS_SEEK_SET);
+  if (ra) {
+    ra->pos += ra->ix;
+    ra->len = ra->ix = 0;
+  }
+}
+
+static int readahead_fill( spiffs_readahead *ra ){
+  ra->pos += ra->len;
+  ra->ix = 0;
+  s32_t res = SPIFFS_read(&fs, (spiffs_file)ra->fd, ra->buf, SPIFFS_READAHEAD);
+  ra->len = res > 0 ? res : 0;
+  return ra->len;
+}
+
+static void readahead_free( int fd ){
+  int i;
+  for (i = 0; i < SPIFFS_READAHEAD_FDS; i++) {
+    if (spiffs_ra[i] && (fd < 0 || spiffs_ra[i]->fd == fd)) {
+      c_free(spiffs_ra[i]);
+      spiffs_ra[i] = NULL;
+    }
+  }
+}
+
+// gives up the buffer of fd, leaving the SPIFFS offset where it should be
+static void readahead_drop( int fd ){
+  readahead_sync(fd);
+  readahead_free(fd);
+}
+#else
+#define readahead_drop(fd)
+#define readahead_free(fd)
 #endif
 
 static s32_t my_spiffs_read(u32_t addr, u32_t size, u8_t *dst) {
@@ -18,6 +130,7 @@ static s32_t my_spiffs_read(u32_t addr, u32_t size, u8_t *dst) {
 }
 
 static s32_t my_spiffs_write(u32_t addr, u32_t size, u8_t *src) {
+  spiffs_bytes_programmed += size;
   platform_flash_write(src, addr, size);
   return SPIFFS_OK;
 }
@@ -25,9 +138,11 @@ static s32_t my_spiffs_write(u32_t addr, u32_t size, u8_t *src) {
 static s32_t my_spiffs_erase(u32_t addr, u32_t size) {
   u32_t sect_first = platform_flash_get_sector_of_address(addr);
   u32_t sect_last = sect_first;
-  while( sect_first <= sect_last )
+  while( sect_first <= sect_last ){
+    spiffs_sectors_erased++;
     if( platform_flash_erase_sector( sect_first ++ ) == PLATFORM_ERR )
       return SPIFFS_ERR_INTERNAL;
+  }
   return SPIFFS_OK;
 } 
 
@@ -44,6 +159,8 @@ The small 4KB sectors allow for greater flexibility in applications th
 
 ********************/
 
+static void myspiffs_replace_recover( void );
+
 void myspiffs_mount() {
   spiffs_config cfg;
 #ifdef SPIFFS_FIXED_LOCATION
@@ -53,6 +170,9 @@ void myspiffs_mount() {
 #endif
   cfg.phys_addr += 0x3FFF;
   cfg.phys_addr &= 0xFFFFC000;  // align to 4 sector.
+#if defined(LUA_XIP_AREA_SIZE) && !defined(SPIFFS_FIXED_LOCATION)
+  cfg.phys_addr += LUA_XIP_AREA_SIZE;  // skip the .lc execute-in-place area
+#endif
   cfg.phys_size = INTERNAL_FLASH_SIZE - ( ( u32_t )cfg.phys_addr );
   cfg.phys_erase_block = INTERNAL_FLASH_SECTOR_SIZE; // according to datasheet
   cfg.log_block_size = INTERNAL_FLASH_SECTOR_SIZE; // let us not complicate things
@@ -69,17 +189,24 @@ void myspiffs_mount() {
     spiffs_fds,
     sizeof(spiffs_fds),
 #if SPIFFS_CACHE
-    spiffs_cache,
-    sizeof(spiffs_cache),
+    spiffs_cache_heap ? spiffs_cache_heap : spiffs_cache_static,
+    SPIFFS_CACHE_BYTES(spiffs_cache_pages),
 #else
     0, 0,
 #endif
     // myspiffs_check_callback);
     0);
   NODE_DBG("mount res: %i\n", res);
+#if SPIFFS_LU_INDEX
+  if (res == SPIFFS_OK)
+    SPIFFS_lu_index(&fs, spiffs_lu_index, sizeof(spiffs_lu_index));
+#endif
+  if (res == SPIFFS_OK)
+    myspiffs_replace_recover();
 }
 
 void myspiffs_unmount() {
+  readahead_free(-1);
   SPIFFS_unmount(&fs);
 }
 
@@ -87,7 +214,7 @@ void myspiffs_unmount() {
 // Returns 1 if OK, 0 for error
 int myspiffs_format( void )
 {
-  SPIFFS_unmount(&fs);
+  myspiffs_unmount();
   u32_t sect_first, sect_last;
 #ifdef SPIFFS_FIXED_LOCATION
   sect_first = SPIFFS_FIXED_LOCATION;
@@ -96,6 +223,9 @@ int myspiffs_format( void )
 #endif
   sect_first += 0x3FFF;
   sect_first &= 0xFFFFC000;  // align to 4 sector.
+#if defined(LUA_XIP_AREA_SIZE) && !defined(SPIFFS_FIXED_LOCATION)
+  sect_first += LUA_XIP_AREA_SIZE;
+#endif
   sect_first = platform_flash_get_sector_of_address(sect_first);
   sect_last = INTERNAL_FLASH_SIZE - SYS_PARAM_SEC_NUM;
   sect_last = platform_flash_get_sector_of_address(sect_last);
@@ -120,7 +250,9 @@ int myspiffs_open(const char *name, int flags){
 }
 
 int myspiffs_close( int fd ){
+  readahead_free(fd);
   SPIFFS_close(&fs, (spiffs_file)fd);
+  myspiffs_gc_kick();
   return 0;
 }
 size_t myspiffs_write( int fd, const void* ptr, size_t len ){
@@ -130,14 +262,50 @@ size_t myspiffs_write( int fd, const void* ptr, size_t len ){
     return len;
   }
 #endif
+  readahead_drop(fd);
   int res = SPIFFS_write(&fs, (spiffs_file)fd, (void *)ptr, len);
   if (res < 0) {
     NODE_DBG("write errno %i\n", SPIFFS_errno(&fs));
     return 0;
   }
+  spiffs_bytes_written += res;
+  myspiffs_gc_kick();
   return res;
 }
 size_t myspiffs_read( int fd, void* ptr, size_t len){
+#ifdef SPIFFS_READAHEAD
+  // small reads are served from the read-ahead buffer, large ones take
+  // what is buffered and read the rest directly
+  spiffs_readahead *ra = readahead_get(fd, len < SPIFFS_READAHEAD);
+  if (ra) {
+    size_t done = 0;
+    while (done < len) {
+      if (ra->ix == ra->len) {
+        if (len - done >= SPIFFS_READAHEAD)
+          break;
+        if (readahead_fill(ra) == 0)
+          return done;
+      }
+      size_t n = ra->len - ra->ix;
+      if (n > len - done)
+        n = len - done;
+      c_memcpy((u8_t *)ptr + done, ra->buf + ra->ix, n);
+      ra->ix += n;
+      done += n;
+    }
+    if (done == len)
+      return done;
+    // buffer is empty, so the SPIFFS offset is where the caller expects it
+    ra->pos += ra->len;
+    ra->len = ra->ix = 0;
+    int res = SPIFFS_read(&fs, (spiffs_file)fd, (u8_t *)ptr + done, len - done);
+    if (res > 0) {
+      ra->pos += res;
+      done += res;
+    }
+    return done;
+  }
+#endif
   int res = SPIFFS_read(&fs, (spiffs_file)fd, ptr, len);
   if (res < 0) {
     NODE_DBG("read errno %i\n", SPIFFS_errno(&fs));
@@ -146,17 +314,52 @@ size_t myspiffs_read( int fd, void* ptr, size_t len){
   return res;
 }
 int myspiffs_lseek( int fd, int off, int whence ){
+#ifdef SPIFFS_READAHEAD
+  spiffs_readahead *ra = readahead_get(fd, 0);
+  if (ra && whence != SPIFFS_SEEK_END) {
+    // seeking within the buffer costs nothing
+    s32_t target = whence == SPIFFS_SEEK_CUR ? (s32_t)(ra->pos + ra->ix) + off : off;
+    if (target >= (s32_t)ra->pos && target <= (s32_t)(ra->pos + ra->len)) {
+      ra->ix = target - ra->pos;
+      return target;
+    }
+  }
+  readahead_sync(fd);
+  s32_t res = SPIFFS_lseek(&fs, (spiffs_file)fd, off, whence);
+  if (ra && res >= 0)
+    ra->pos = res;
+  return res;
+#else
   return SPIFFS_lseek(&fs, (spiffs_file)fd, off, whence);
+#endif
 }
 int myspiffs_eof( int fd ){
+#ifdef SPIFFS_READAHEAD
+  spiffs_readahead *ra = readahead_get(fd, 0);
+  if (ra && ra->ix < ra->len)
+    return 0;
+#endif
   return SPIFFS_eof(&fs, (spiffs_file)fd);
 }
 int myspiffs_tell( int fd ){
+#ifdef SPIFFS_READAHEAD
+  spiffs_readahead *ra = readahead_get(fd, 0);
+  if (ra)
+    return ra->pos + ra->ix;
+#endif
   return SPIFFS_tell(&fs, (spiffs_file)fd);
 }
 int myspiffs_getc( int fd ){
   unsigned char c = 0xFF;
   int res;
+#ifdef SPIFFS_READAHEAD
+  spiffs_readahead *ra = readahead_get(fd, 1);
+  if (ra) {
+    if (ra->ix == ra->len && readahead_fill(ra) == 0)
+      return (int)EOF;
+    return (int)ra->buf[ra->ix++];
+  }
+#endif
   if(!myspiffs_eof(fd)){
     res = SPIFFS_read(&fs, (spiffs_file)fd, &c, 1);
     if (res != 1) {
@@ -169,7 +372,14 @@ int myspiffs_getc( int fd ){
   return (int)EOF;
 }
 int myspiffs_ungetc( int c, int fd ){
-  return SPIFFS_lseek(&fs, (spiffs_file)fd, -1, SEEK_CUR);
+#ifdef SPIFFS_READAHEAD
+  spiffs_readahead *ra = readahead_get(fd, 0);
+  if (ra && ra->ix > 0) {
+    ra->ix--;
+    return c;
+  }
+#endif
+  return myspiffs_lseek(fd, -1, SEEK_CUR);
 }
 int myspiffs_flush( int fd ){
   return SPIFFS_fflush(&fs, (spiffs_file)fd);
@@ -183,9 +393,220 @@ void myspiffs_clearerr( int fd ){
 int myspiffs_rename( const char *old, const char *newname ){
   return SPIFFS_rename(&fs, (char *)old, (char *)newname);
 }
+
+// File replacement. The new content is written to "name" plus
+// SPIFFS_REPLACE_TMP, which is renamed to "name" plus SPIFFS_REPLACE_NEW
+// once it is complete on flash. Only then is the old file removed and the
+// new one given its name. A power loss at any point leaves either the old
+// or the new content, which myspiffs_replace_recover() sorts out at mount.
+#define SPIFFS_REPLACE_TMP  '\x01'
+#define SPIFFS_REPLACE_NEW  '\x02'
+
+static int replace_name( char *dst, const char *name, char suffix ){
+  size_t len = c_strlen(name);
+  if (len + 2 > SPIFFS_OBJ_NAME_LEN)
+    return 0;
+  c_memcpy(dst, name, len);
+  dst[len] = suffix;
+  dst[len + 1] = '\0';
+  return 1;
+}
+
+// Opens the file the new content of name is written to
+int myspiffs_replace_open( const char *name ){
+  char tmp[SPIFFS_OBJ_NAME_LEN];
+  if (!replace_name(tmp, name, SPIFFS_REPLACE_TMP))
+    return SPIFFS_ERR_NOT_FOUND;
+  return (int)SPIFFS_open(&fs, tmp, SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_WRONLY, 0);
+}
+
+// Closes fd from myspiffs_replace_open(), putting what was written in
+// place of name if commit is set, else throwing it away.
+// Returns 1 if OK, 0 for error
+int myspiffs_replace_close( int fd, const char *name, int commit ){
+  char tmp[SPIFFS_OBJ_NAME_LEN];
+  int ok = 0;
+  readahead_free(fd);
+  if (commit && replace_name(tmp, name, SPIFFS_REPLACE_NEW) &&
+      SPIFFS_frename(&fs, (spiffs_file)fd, tmp) >= 0) {
+    // from here on the new content wins, even after a power loss
+    if (SPIFFS_remove(&fs, (char *)name) < 0 && SPIFFS_errno(&fs) != SPIFFS_ERR_NOT_FOUND) {
+      NODE_DBG("replace: remove errno %i\n", SPIFFS_errno(&fs));
+    }
+    ok = SPIFFS_frename(&fs, (spiffs_file)fd, (char *)name) >= 0;
+    SPIFFS_close(&fs, (spiffs_file)fd);
+  } else {
+    SPIFFS_fremove(&fs, (spiffs_file)fd);
+    SPIFFS_close(&fs, (spiffs_file)fd);
+  }
+  myspiffs_gc_kick();
+  return ok;
+}
+
+// Whether the index header at pix belongs to the file called name. Goes by
+// the page header, as a delete cut short leaves the lookup entry of pix
+// half programmed
+static int replace_same_object( const char *name, spiffs_page_ix pix ){
+  spiffs_stat st;
+  spiffs_page_header ph;
+  if (SPIFFS_stat(&fs, (char *)name, &st) < 0 ||
+      _spiffs_rd(&fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ, 0,
+          SPIFFS_PAGE_TO_PADDR(&fs, pix), sizeof(ph), (u8_t *)&ph) != SPIFFS_OK)
+    return 0;
+  return (ph.obj_id | SPIFFS_OBJ_ID_IX_FLAG) == st.obj_id;
+}
+
+// Finishes or rolls back replacements cut short by a reset
+static void myspiffs_replace_recover( void ){
+  spiffs_DIR d;
+  struct spiffs_dirent e;
+  struct spiffs_dirent *pe = &e;
+  char name[SPIFFS_OBJ_NAME_LEN];
+  char committed[SPIFFS_OBJ_NAME_LEN];
+  SPIFFS_opendir(&fs, "/", &d);
+  while ((pe = SPIFFS_readdir(&d, pe))) {
+    size_t len = c_strlen((char *)pe->name);
+    char suffix = len > 1 ? pe->name[len - 1] : 0;
+    if (suffix != SPIFFS_REPLACE_TMP && suffix != SPIFFS_REPLACE_NEW)
+      continue;
+    c_memcpy(name, pe->name, len - 1);
+    name[len - 1] = '\0';
+    replace_name(committed, name, SPIFFS_REPLACE_NEW);
+    if (replace_same_object(name, pe->pix) ||
+        (suffix == SPIFFS_REPLACE_TMP && replace_same_object(committed, pe->pix))) {
+      // a rename was cut short after writing the renamed index header but
+      // before deleting the old one, which is all that is left to do
+      spiffs_page_delete(&fs, pe->pix);
+    } else if (suffix == SPIFFS_REPLACE_TMP) {
+      SPIFFS_remove(&fs, (char *)pe->name);
+    } else {
+      SPIFFS_remove(&fs, name);
+      SPIFFS_rename(&fs, (char *)pe->name, name);
+    }
+  }
+  SPIFFS_closedir(&d);
+  SPIFFS_clearerr(&fs);
+}
 size_t myspiffs_size( int fd ){
   return SPIFFS_size(&fs, (spiffs_file)fd);
 }
+
+// Returns the next entry of d whose name starts with prefix, read into e, or
+// NULL once there is none left
+struct spiffs_dirent *myspiffs_readdir( spiffs_DIR *d, const char *prefix, struct spiffs_dirent *e ){
+  size_t len = c_strlen(prefix);
+  while (SPIFFS_readdir(d, e)) {
+    if (c_strncmp((char *)e->name, prefix, len) == 0)
+      return e;
+  }
+  return NULL;
+}
+
+// Returns the address the file data at offset can be read at through the
+// flash cache, and in *len how many bytes of it are there, at most the rest
+// of a data page. Returns NULL at the end of the file, on error, or if the
+// page lies outside the mapped megabyte of flash. The pointer is good until
+// the next write, remove or garbage collection.
+const void *myspiffs_map( int fd, size_t offset, size_t *len ){
+  u32_t addr, mapped;
+  s32_t res = SPIFFS_map(&fs, (spiffs_file)fd, offset, &addr);
+  if (res <= 0)
+    return NULL;
+  mapped = platform_flash_phys2mapped(addr);
+  if (mapped == (u32_t)-1)
+    return NULL;
+  *len = res;
+  return (const void *)(size_t)mapped;
+}
+
+// Remounts the file system with a cache of the given number of pages, which
+// closes all open files. Returns the number of pages in use afterwards.
+int myspiffs_cachesize( int pages ){
+#if SPIFFS_CACHE
+  if (pages < 1) pages = 1;
+  if (pages > SPIFFS_CACHE_PAGES_MAX) pages = SPIFFS_CACHE_PAGES_MAX;
+  if (pages == spiffs_cache_pages)
+    return pages;
+
+  u8_t *heap = NULL;
+  if (pages != SPIFFS_CACHE_PAGES) {
+    heap = (u8_t *)c_malloc(SPIFFS_CACHE_BYTES(pages));
+    if (heap == NULL)
+      return spiffs_cache_pages;  // keep what we have
+  }
+  myspiffs_unmount();
+  if (spiffs_cache_heap)
+    c_free(spiffs_cache_heap);
+  spiffs_cache_heap = heap;
+  spiffs_cache_pages = pages;
+  myspiffs_mount();
+  return spiffs_cache_pages;
+#else
+  return 0;
+#endif
+}
+
+// Returns the number of cache pages, and the cache statistics since mount
+int myspiffs_cachestats( u32_t *hits, u32_t *misses, u32_t *evictions ){
+#if SPIFFS_CACHE && SPIFFS_CACHE_STATS
+  *hits = fs.cache_hits;
+  *misses = fs.cache_misses;
+  *evictions = fs.cache_evictions;
+#else
+  *hits = *misses = *evictions = 0;
+#endif
+#if SPIFFS_CACHE
+  return spiffs_cache_pages;
+#else
+  return 0;
+#endif
+}
+// Returns the bytes written through myspiffs_write, the bytes programmed to
+// flash for them and the sectors erased, all since boot
+void myspiffs_writestats( u32_t *written, u32_t *programmed, u32_t *erased ){
+  *written = spiffs_bytes_written;
+  *programmed = spiffs_bytes_programmed;
+  *erased = spiffs_sectors_erased;
+}
+
+// Does one garbage collection step that moves at most budget pages. Returns
+// 1 if a block was erased, and the number of erased blocks ready in *ready
+int myspiffs_gc( int budget, u32_t *ready ){
+  if (budget < 0) budget = 0;
+  if (budget > 0xffff) budget = 0xffff;
+  int res = SPIFFS_gc_step(&fs, (u16_t)budget) == SPIFFS_OK;
+  *ready = fs.free_blocks;
+  return res;
+}
+
+// Keeps reserve erased blocks ready by garbage collecting in steps of at most
+// budget moved pages from the Lua task whenever it is idle, a reserve of 0
+// turns this off. Writes only stall for garbage collection when they use up
+// the reserve faster than the idle time refills it.
+void myspiffs_autogc( int reserve, int budget ){
+  spiffs_gc_reserve = reserve < 0 ? 0 : reserve;
+  spiffs_gc_budget = budget < 0 ? 0 : budget > 0xffff ? 0xffff : budget;
+  myspiffs_gc_kick();
+}
+
+// Queues an idle time gc step if there are fewer erased blocks than wanted
+void myspiffs_gc_kick( void ){
+  if (spiffs_gc_posted || fs.free_blocks >= spiffs_gc_reserve || !SPIFFS_mounted(&fs))
+    return;
+  // the Lua task has the lowest priority, so this runs once everything
+  // else queued has been handled
+  if (system_os_post(LUA_TASK_PRIO, LUA_FS_GC_SIG, 0))
+    spiffs_gc_posted = 1;
+}
+
+// The queued step, queues the next one until the reserve is reached or
+// there is nothing left that fits the budget
+void myspiffs_gc_task( void ){
+  spiffs_gc_posted = 0;
+  if (fs.free_blocks < spiffs_gc_reserve &&
+      SPIFFS_gc_step(&fs, spiffs_gc_budget) == SPIFFS_OK)
+    myspiffs_gc_kick();
+}
 #if 0
 void test_spiffs() {
   char buf[12];
@@ -120,6 +120,12 @@ typedef void (*spiffs_check_callback)(spiffs_check_type type, spiffs_check_repor
 #define SPIFFS_RDWR                     (SPIFFS_RDONLY | SPIFFS_WRONLY)
 /* Any writes to the filehandle will never be cached */
 #define SPIFFS_DIRECT                   (1<<5)
+/* Appends are collected into whole data pages and the file size is only
+   written on flush and close, see SPIFFS_LOG_COMMIT_PAGES. Implies
+   SPIFFS_APPEND and needs SPIFFS_CACHE_WR. Full pages appended after the
+   last written size are taken back in when the file is next opened with
+   SPIFFS_LOG or otherwise writable */
+#define SPIFFS_LOG                      (1<<6)
 
 #define SPIFFS_SEEK_SET                 (0)
 #define SPIFFS_SEEK_CUR                 (1)
@@ -217,9 +223,17 @@ typedef struct {
 #if SPIFFS_CACHE_STATS
   u32_t cache_hits;
   u32_t cache_misses;
+  u32_t cache_evictions;
 #endif
 #endif
 
+#if SPIFFS_LU_INDEX
+  // object index page index, see SPIFFS_lu_index
+  void *lu_index;
+  u32_t lu_index_entries;
+  u32_t lu_index_victim;
+#endif
+
   // check callback function
   spiffs_check_callback check_cb_f;
 
@@ -235,6 +249,9 @@ typedef struct {
   u32_t size;
   spiffs_obj_type type;
   u8_t name[SPIFFS_OBJ_NAME_LEN];
+#if SPIFFS_OBJ_META_LEN
+  u8_t meta[SPIFFS_OBJ_META_LEN];
+#endif
 } spiffs_stat;
 
 struct spiffs_dirent {
@@ -243,6 +260,9 @@ struct spiffs_dirent {
   spiffs_obj_type type;
   u32_t size;
   spiffs_page_ix pix;
+#if SPIFFS_OBJ_META_LEN
+  u8_t meta[SPIFFS_OBJ_META_LEN];
+#endif
 };
 
 typedef struct {
@@ -294,7 +314,7 @@ s32_t SPIFFS_creat(spiffs *fs, char *path, spiffs_mode mode);
  * @param path          the path of the new file
  * @param flags         the flags for the open command, can be combinations of
  *                      SPIFFS_APPEND, SPIFFS_TRUNC, SPIFFS_CREAT, SPIFFS_RD_ONLY,
- *                      SPIFFS_WR_ONLY, SPIFFS_RDWR, SPIFFS_DIRECT
+ *                      SPIFFS_WR_ONLY, SPIFFS_RDWR, SPIFFS_DIRECT, SPIFFS_LOG
  * @param mode          ignored, for posix compliance
  */
 spiffs_file SPIFFS_open(spiffs *fs, char *path, spiffs_flags flags, spiffs_mode mode);
@@ -309,7 +329,7 @@ spiffs_file SPIFFS_open(spiffs *fs, char *path, spiffs_flags flags, spiffs_mode
  * @param path          the dir entry to the file
  * @param flags         the flags for the open command, can be combinations of
  *                      SPIFFS_APPEND, SPIFFS_TRUNC, SPIFFS_CREAT, SPIFFS_RD_ONLY,
- *                      SPIFFS_WR_ONLY, SPIFFS_RDWR, SPIFFS_DIRECT.
+ *                      SPIFFS_WR_ONLY, SPIFFS_RDWR, SPIFFS_DIRECT, SPIFFS_LOG.
  *                      SPIFFS_CREAT will have no effect in this case.
  * @param mode          ignored, for posix compliance
  */
@@ -325,6 +345,22 @@ spiffs_file SPIFFS_open_by_dirent(spiffs *fs, struct spiffs_dirent *e, spiffs_fl
  */
 s32_t SPIFFS_read(spiffs *fs, spiffs_file fh, void *buf, s32_t len);
 
+/**
+ * Finds where the data at offset of given filehandle lies in flash, so it
+ * can be read in place. Every data page starts with a page header, so this
+ * covers at most the rest of one data page; call again with offset plus the
+ * returned length for the next part. The file position is not changed.
+ * The address stays valid until the file system is next written to or
+ * garbage collected. It has no particular alignment: data starts right after
+ * the page header, so file offset 0 is never word aligned.
+ * @param fs            the file system struct
+ * @param fh            the filehandle
+ * @param offset        offset in the file
+ * @param addr          receives the physical flash address of the data
+ * @returns number of bytes at addr, or -1 if error
+ */
+s32_t SPIFFS_map(spiffs *fs, spiffs_file fh, u32_t offset, u32_t *addr);
+
 /**
  * Writes to given filehandle.
  * @param fs            the file system struct
@@ -398,6 +434,27 @@ void SPIFFS_close(spiffs *fs, spiffs_file fh);
  */
 s32_t SPIFFS_rename(spiffs *fs, char *old, char *newPath);
 
+/**
+ * Renames an open file. Pending writes are flushed first, so when this
+ * returns the file is complete on flash under its new name.
+ * @param fs            the file system struct
+ * @param fh            the filehandle of the file to rename
+ * @param newPath       new path of file
+ */
+s32_t SPIFFS_frename(spiffs *fs, spiffs_file fh, char *newPath);
+
+#if SPIFFS_OBJ_META_LEN
+/**
+ * Sets the metadata of an open file. The first time this only programs the
+ * still erased metadata bytes of the object index header, later it moves
+ * the header like a rename does.
+ * @param fs            the file system struct
+ * @param fh            the filehandle of the file
+ * @param meta          SPIFFS_OBJ_META_LEN bytes of metadata
+ */
+s32_t SPIFFS_fupdate_meta(spiffs *fs, spiffs_file fh, const void *meta);
+#endif
+
 /**
  * Returns last error of last file operation.
  * @param fs            the file system struct
@@ -508,6 +565,25 @@ u8_t SPIFFS_mounted(spiffs *fs);
  */
 s32_t SPIFFS_gc_quick(spiffs *fs, u16_t max_free_pages);
 
+/**
+ * Does one bounded step of garbage collection: erases a block with only
+ * deleted pages if there is one, else moves the used pages out of the best
+ * candidate block and erases it, provided that is no more than max_pages
+ * pages. Blocks that still have free pages are left alone.
+ *
+ * NB: meant to be called repeatedly when the system is idle, so that erased
+ * blocks are ready when writes need them and the automatic garbage collector
+ * does not have to stall a write to erase.
+ *
+ * Will set err_no to SPIFFS_OK if a block was erased,
+ * SPIFFS_ERR_NO_DELETED_BLOCKS if there was nothing to do within the budget,
+ * or other error.
+ *
+ * @param fs            the file system struct
+ * @param max_pages     maximum number of pages to move
+ */
+s32_t SPIFFS_gc_step(spiffs *fs, u16_t max_pages);
+
 /**
  * Will try to make room for given amount of bytes in the filesystem by moving
  * pages and erasing blocks.
@@ -526,7 +602,6 @@ s32_t SPIFFS_gc_quick(spiffs *fs, u16_t max_free_pages);
  * @param size          amount of bytes that should be freed
  */
 s32_t SPIFFS_gc(spiffs *fs, u32_t size);
-
 #if SPIFFS_TEST_VISUALISATION
 /**
  * Prints out a visualization of the filesystem.
@@ -535,6 +610,21 @@ s32_t SPIFFS_gc(spiffs *fs, u32_t size);
 s32_t SPIFFS_vis(spiffs *fs);
 #endif
 
+#if SPIFFS_LU_INDEX
+/**
+ * Gives a mounted file system memory for a RAM index of object index pages,
+ * and fills it with the index header pages of as many files as fit. Opening
+ * a file by name and finding the index pages of an open file are looked up
+ * there first, falling back to scanning the object lookup pages.
+ * Must be called again after each mount, call with a null buffer to stop
+ * using the index.
+ * @param fs            the file system struct
+ * @param buf           memory for the index, 16 bit aligned
+ * @param size          size of buf, 8 bytes per entry
+ */
+s32_t SPIFFS_lu_index(spiffs *fs, void *buf, u32_t size);
+#endif
+
 #if SPIFFS_BUFFER_HELP
 /**
  * Returns number of bytes needed for the filedescriptor buffer given
@@ -556,6 +646,7 @@ u32_t SPIFFS_buffer_bytes_for_cache(spiffs *fs, u32_t num_pages);
 
 void myspiffs_mount();
 void myspiffs_unmount();
+int myspiffs_format( void );
 int myspiffs_open(const char *name, int flags);
 int myspiffs_close( int fd );
 size_t myspiffs_write( int fd, const void* ptr, size_t len );
@@ -570,7 +661,22 @@ int myspiffs_error( int fd );
 void myspiffs_clearerr( int fd );
 int myspiffs_check( void );
 int myspiffs_rename( const char *old, const char *newname );
+int myspiffs_replace_open( const char *name );
+int myspiffs_replace_close( int fd, const char *name, int commit );
 size_t myspiffs_size( int fd );
+struct spiffs_dirent *myspiffs_readdir( spiffs_DIR *d, const char *prefix, struct spiffs_dirent *e );
+// The returned pointer is only byte aligned, but the ESP8266 can only read
+// mapped flash with aligned 32-bit loads. Read it with byte_of_aligned_array()
+// from flash_api.h: pass the pointer rounded down to a word, and the bytes
+// it was rounded by plus the offset as index. Never read it directly.
+const void *myspiffs_map( int fd, size_t offset, size_t *len );
+int myspiffs_cachesize( int pages );
+int myspiffs_cachestats( u32_t *hits, u32_t *misses, u32_t *evictions );
+void myspiffs_writestats( u32_t *written, u32_t *programmed, u32_t *erased );
+int myspiffs_gc( int budget, u32_t *ready );
+void myspiffs_autogc( int reserve, int budget );
+void myspiffs_gc_kick( void );
+void myspiffs_gc_task( void );
 
 s32_t SPIFFS_eof(spiffs *fs, spiffs_file fh);
 s32_t SPIFFS_tell(spiffs *fs, spiffs_file fh);
@@ -14,21 +14,44 @@
 static spiffs_cache_page *spiffs_cache_page_get(spiffs *fs, spiffs_page_ix pix) {
   spiffs_cache *cache = spiffs_get_cache(fs);
   if ((cache->cpage_use_map & cache->cpage_use_mask) == 0) return 0;
-  int i;
-  for (i = 0; i < cache->cpage_count; i++) {
+  // only read cache pages are hashed, but the use map may have been cleared
+  // behind our back, see spiffs_cache_page_allocate
+  u8_t i = cache->pix_hash[spiffs_cache_hash(pix)];
+  while (i != SPIFFS_CACHE_NONE) {
     spiffs_cache_page *cp = spiffs_get_cache_page_hdr(fs, cache, i);
-    if ((cache->cpage_use_map & (1<<i)) &&
-        (cp->flags & SPIFFS_CACHE_FLAG_TYPE_WR) == 0 &&
-        cp->pix == pix ) {
+    if ((cache->cpage_use_map & (1<<i)) && cp->pix == pix) {
       SPIFFS_CACHE_DBG("CACHE_GET: have cache page %i for %04x\n", i, pix);
       cp->last_access = cache->last_access;
       return cp;
     }
+    i = cp->hash_next;
   }
   //SPIFFS_CACHE_DBG("CACHE_GET: no cache for %04x\n", pix);
   return 0;
 }
 
+// enters a read cache page into the pix hash
+static void spiffs_cache_page_hash(spiffs *fs, spiffs_cache_page *cp) {
+  spiffs_cache *cache = spiffs_get_cache(fs);
+  u8_t *bucket = &cache->pix_hash[spiffs_cache_hash(cp->pix)];
+  cp->hash_next = *bucket;
+  *bucket = cp->ix;
+}
+
+// removes a read cache page from the pix hash
+static void spiffs_cache_page_unhash(spiffs *fs, spiffs_cache_page *cp) {
+  spiffs_cache *cache = spiffs_get_cache(fs);
+  u8_t *link = &cache->pix_hash[spiffs_cache_hash(cp->pix)];
+  while (*link != SPIFFS_CACHE_NONE) {
+    if (*link == cp->ix) {
+      *link = cp->hash_next;
+      break;
+    }
+    link = &spiffs_get_cache_page_hdr(fs, cache, *link)->hash_next;
+  }
+  cp->hash_next = SPIFFS_CACHE_NONE;
+}
+
 // frees cached page
 static s32_t spiffs_cache_page_free(spiffs *fs, int ix, u8_t write_back) {
   s32_t res = SPIFFS_OK;
@@ -42,14 +65,15 @@ static s32_t spiffs_cache_page_free(spiffs *fs, int ix, u8_t write_back) {
       res = fs->cfg.hal_write_f(SPIFFS_PAGE_TO_PADDR(fs, cp->pix), SPIFFS_CFG_LOG_PAGE_SZ(fs), mem);
     }
 
-    cp->flags = 0;
-    cache->cpage_use_map &= ~(1 << ix);
-
     if (cp->flags & SPIFFS_CACHE_FLAG_TYPE_WR) {
       SPIFFS_CACHE_DBG("CACHE_FREE: free cache page %i objid %04x\n", ix, cp->obj_id);
     } else {
       SPIFFS_CACHE_DBG("CACHE_FREE: free cache page %i pix %04x\n", ix, cp->pix);
+      spiffs_cache_page_unhash(fs, cp);
     }
+
+    cp->flags = 0;
+    cache->cpage_use_map &= ~(1 << ix);
   }
 
   return res;
@@ -79,6 +103,9 @@ static s32_t spiffs_cache_page_remove_oldest(spiffs *fs, u8_t flag_mask, u8_t fl
   }
 
   if (cand_ix >= 0) {
+#if SPIFFS_CACHE_STATS
+    fs->cache_evictions++;
+#endif
     res = spiffs_cache_page_free(fs, cand_ix, 1);
   }
 
@@ -96,6 +123,11 @@ static spiffs_cache_page *spiffs_cache_page_allocate(spiffs *fs) {
   for (i = 0; i < cache->cpage_count; i++) {
     if ((cache->cpage_use_map & (1<<i)) == 0) {
       spiffs_cache_page *cp = spiffs_get_cache_page_hdr(fs, cache, i);
+      if (cp->flags != 0 && (cp->flags & SPIFFS_CACHE_FLAG_TYPE_WR) == 0) {
+        // released without spiffs_cache_page_free, still hashed
+        spiffs_cache_page_unhash(fs, cp);
+      }
+      cp->flags = 0;
       cache->cpage_use_map |= (1<<i);
       cp->last_access = cache->last_access;
       SPIFFS_CACHE_DBG("CACHE_ALLO: allocated cache page %i\n", i);
@@ -126,6 +158,11 @@ s32_t spiffs_phys_rd(
     u8_t *dst) {
   (void)fh;
   s32_t res = SPIFFS_OK;
+  if (SPIFFS_PADDR_TO_PAGE_OFFSET(fs, addr) + len > SPIFFS_CFG_LOG_PAGE_SZ(fs)) {
+    // runs of pages go straight to flash, which read cache pages never
+    // run ahead of as they are write through
+    return fs->cfg.hal_read_f(addr, len, dst);
+  }
   spiffs_cache *cache = spiffs_get_cache(fs);
   spiffs_cache_page *cp =  spiffs_cache_page_get(fs, SPIFFS_PADDR_TO_PAGE(fs, addr));
   cache->last_access++;
@@ -147,10 +184,13 @@ s32_t spiffs_phys_rd(
 #endif
     res = spiffs_cache_page_remove_oldest(fs, SPIFFS_CACHE_FLAG_TYPE_WR, 0);
     cp = spiffs_cache_page_allocate(fs);
-    if (cp) {
-      cp->flags = SPIFFS_CACHE_FLAG_WRTHRU;
-      cp->pix = SPIFFS_PADDR_TO_PAGE(fs, addr);
+    if (cp == 0) {
+      // all cache pages hold write caches, read directly
+      return fs->cfg.hal_read_f(addr, len, dst);
     }
+    cp->flags = SPIFFS_CACHE_FLAG_WRTHRU;
+    cp->pix = SPIFFS_PADDR_TO_PAGE(fs, addr);
+    spiffs_cache_page_hash(fs, cp);
 
     s32_t res2 = fs->cfg.hal_read_f(
         addr - SPIFFS_PADDR_TO_PAGE_OFFSET(fs, addr),
@@ -288,6 +328,7 @@ void spiffs_cache_init(spiffs *fs) {
 
   cache.cpage_use_map = 0xffffffff;
   cache.cpage_use_mask = cache_mask;
+  c_memset(cache.pix_hash, SPIFFS_CACHE_NONE, sizeof(cache.pix_hash));
   c_memcpy(fs->cache, &cache, sizeof(spiffs_cache));
 
   spiffs_cache *c = spiffs_get_cache(fs);
@@ -297,6 +338,7 @@ void spiffs_cache_init(spiffs *fs) {
   c->cpage_use_map &= ~(c->cpage_use_mask);
   for (i = 0; i < cache.cpage_count; i++) {
     spiffs_get_cache_page_hdr(fs, c, i)->ix = i;
+    spiffs_get_cache_page_hdr(fs, c, i)->hash_next = SPIFFS_CACHE_NONE;
   }
 }
 
@@ -57,14 +57,26 @@ typedef uint8_t u8_t;
 #define SPIFFS_CACHE_WR                 1
 #endif
 
-// Enable/disable statistics on caching. Debug/test purpose only.
+// Enable/disable statistics on caching, see file.cachestats().
 #ifndef  SPIFFS_CACHE_STATS
-#define SPIFFS_CACHE_STATS              0
+#define SPIFFS_CACHE_STATS              1
+#endif
+
+// Files opened with SPIFFS_LOG only get their size written to the object
+// index header on flush, close, and every this many appended data pages.
+#ifndef  SPIFFS_LOG_COMMIT_PAGES
+#define SPIFFS_LOG_COMMIT_PAGES         16
 #endif
 #else
 #define SPIFFS_CACHE_WR                 0
 #endif
 
+// Enables an optional RAM index of object index pages, see SPIFFS_lu_index.
+// Saves scanning the object lookup pages when opening files and seeking.
+#ifndef SPIFFS_LU_INDEX
+#define SPIFFS_LU_INDEX                 1
+#endif
+
 // Always check header of each accessed page to ensure consistent state.
 // If enabled it will increase number of reads, will increase flash.
 #ifndef SPIFFS_PAGE_CHECK
@@ -108,6 +120,13 @@ typedef uint8_t u8_t;
 #define SPIFFS_OBJ_NAME_LEN             (32)
 #endif
 
+// Length of the opaque metadata kept in each object index header, see
+// SPIFFS_fupdate_meta. Changing it changes the layout on flash, so the
+// filesystem has to be formatted afterwards.
+#ifndef SPIFFS_OBJ_META_LEN
+#define SPIFFS_OBJ_META_LEN             (0)
+#endif
+
 // Size of buffer allocated on stack used when copying data.
 // Lower value generates more read/writes. No meaning having it bigger
 // than logical page size.
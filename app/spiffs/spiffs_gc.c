@@ -102,6 +102,103 @@ s32_t spiffs_gc_quick(
   return res;
 }
 
+// Moves the pages still in use out of given block and erases it
+static s32_t spiffs_gc_clean_and_erase(
+    spiffs *fs,
+    spiffs_block_ix bix) {
+  s32_t res;
+#if SPIFFS_GC_STATS
+  fs->stats_gc_runs++;
+#endif
+  fs->cleaning = 1;
+  res = spiffs_gc_clean(fs, bix);
+  fs->cleaning = 0;
+  SPIFFS_GC_DBG("gc: cleaning block %i, result %i\n", bix, res);
+  SPIFFS_CHECK_RES(res);
+
+  res = spiffs_gc_erase_page_stats(fs, bix);
+  SPIFFS_CHECK_RES(res);
+
+  return spiffs_gc_erase_block(fs, bix);
+}
+
+// Counts the used and free pages of a block
+static s32_t spiffs_gc_block_usage(
+    spiffs *fs,
+    spiffs_block_ix bix,
+    u16_t *used,
+    u16_t *free) {
+  s32_t res = SPIFFS_OK;
+  int obj_lookup_page = 0;
+  int entries_per_page = (SPIFFS_CFG_LOG_PAGE_SZ(fs) / sizeof(spiffs_obj_id));
+  spiffs_obj_id *obj_lu_buf = (spiffs_obj_id *)fs->lu_work;
+  int cur_entry = 0;
+
+  *used = *free = 0;
+  while (res == SPIFFS_OK && obj_lookup_page < (int)SPIFFS_OBJ_LOOKUP_PAGES(fs)) {
+    int entry_offset = obj_lookup_page * entries_per_page;
+    res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_READ,
+        0, bix * SPIFFS_CFG_LOG_BLOCK_SZ(fs) + SPIFFS_PAGE_TO_PADDR(fs, obj_lookup_page), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->lu_work);
+    while (res == SPIFFS_OK &&
+        cur_entry - entry_offset < entries_per_page && cur_entry < (int)(SPIFFS_PAGES_PER_BLOCK(fs)-SPIFFS_OBJ_LOOKUP_PAGES(fs))) {
+      spiffs_obj_id obj_id = obj_lu_buf[cur_entry-entry_offset];
+      if (obj_id == SPIFFS_OBJ_ID_FREE) {
+        (*free)++;
+      } else if (obj_id != SPIFFS_OBJ_ID_DELETED) {
+        (*used)++;
+      }
+      cur_entry++;
+    } // per entry
+    obj_lookup_page++;
+  } // per object lookup page
+  return res;
+}
+
+// Does one bounded step of garbage collection, meant to be called when the
+// system is idle so that writes later find erased blocks ready. Erases a
+// block holding only deleted pages if there is one, else cleans and erases
+// the best candidate block that has no free pages left and no more than
+// max_pages pages in use.
+// Returns SPIFFS_OK if a block was erased, SPIFFS_ERR_NO_DELETED_BLOCKS if
+// there was nothing to do within the budget.
+s32_t spiffs_gc_step(
+    spiffs *fs,
+    u16_t max_pages) {
+  s32_t res;
+  s32_t free_pages =
+      (SPIFFS_PAGES_PER_BLOCK(fs) - SPIFFS_OBJ_LOOKUP_PAGES(fs)) * (fs->block_count-2)
+      - fs->stats_p_allocated - fs->stats_p_deleted;
+
+  if (fs->stats_p_deleted == 0) {
+    return SPIFFS_ERR_NO_DELETED_BLOCKS;
+  }
+
+  res = spiffs_gc_quick(fs, 0);
+  if (res != SPIFFS_ERR_NO_DELETED_BLOCKS) {
+    return res;
+  }
+
+  spiffs_block_ix *cands;
+  int count;
+  int i;
+  res = spiffs_gc_find_candidate(fs, &cands, &count, 0);
+  SPIFFS_CHECK_RES(res);
+  for (i = 0; i < count; i++) {
+    u16_t used, free;
+    spiffs_block_ix cand = cands[i];
+    res = spiffs_gc_block_usage(fs, cand, &used, &free);
+    SPIFFS_CHECK_RES(res);
+    // leave the block being filled alone, and never move pages into the
+    // last free ones
+    if (free > 0 || used > max_pages || (s32_t)used >= free_pages) {
+      continue;
+    }
+    SPIFFS_GC_DBG("gc_step: block %i, moving %i pages\n", cand, used);
+    return spiffs_gc_clean_and_erase(fs, cand);
+  }
+  return SPIFFS_ERR_NO_DELETED_BLOCKS;
+}
+
 // Checks if garbage collecting is necessary. If so a candidate block is found,
 // cleansed and erased
 s32_t spiffs_gc_check(
@@ -145,25 +242,8 @@ s32_t spiffs_gc_check(
       SPIFFS_GC_DBG("gc_check: no candidates, return\n");
       return (s32_t)needed_pages < free_pages ? SPIFFS_OK : SPIFFS_ERR_FULL;
     }
-#if SPIFFS_GC_STATS
-    fs->stats_gc_runs++;
-#endif
     cand = cands[0];
-    fs->cleaning = 1;
-    //printf("gcing: cleaning block %i\n", cand);
-    res = spiffs_gc_clean(fs, cand);
-    fs->cleaning = 0;
-    if (res < 0) {
-      SPIFFS_GC_DBG("gc_check: cleaning block %i, result %i\n", cand, res);
-    } else {
-      SPIFFS_GC_DBG("gc_check: cleaning block %i, result %i\n", cand, res);
-    }
-    SPIFFS_CHECK_RES(res);
-
-    res = spiffs_gc_erase_page_stats(fs, cand);
-    SPIFFS_CHECK_RES(res);
-
-    res = spiffs_gc_erase_block(fs, cand);
+    res = spiffs_gc_clean_and_erase(fs, cand);
     SPIFFS_CHECK_RES(res);
 
     free_pages =
@@ -329,7 +409,10 @@ s32_t spiffs_gc_find_candidate(
         }
         cand_ix++;
       }
-      (*candidate_count)++;
+      // the table only keeps the best max_candidates
+      if (*candidate_count < max_candidates) {
+        (*candidate_count)++;
+      }
     }
 
     cur_entry = 0;
@@ -305,6 +305,35 @@ s32_t SPIFFS_read(spiffs *fs, spiffs_file fh, void *buf, s32_t len) {
   return len;
 }
 
+s32_t SPIFFS_map(spiffs *fs, spiffs_file fh, u32_t offset, u32_t *addr) {
+  SPIFFS_API_CHECK_CFG(fs);
+  SPIFFS_API_CHECK_MOUNT(fs);
+  SPIFFS_LOCK(fs);
+
+  spiffs_fd *fd;
+  s32_t res;
+  u32_t len;
+
+  res = spiffs_fd_get(fs, fh, &fd);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+
+  if ((fd->flags & SPIFFS_RDONLY) == 0) {
+    res = SPIFFS_ERR_NOT_READABLE;
+    SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+  }
+
+#if SPIFFS_CACHE_WR
+  // what is mapped must be in flash
+  spiffs_fflush_cache(fs, fh);
+#endif
+
+  res = spiffs_object_map(fd, offset, addr, &len);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+
+  SPIFFS_UNLOCK(fs);
+  return len;
+}
+
 static s32_t spiffs_hydro_write(spiffs *fs, spiffs_fd *fd, void *buf, u32_t offset, s32_t len) {
   (void)fs;
   s32_t res = SPIFFS_OK;
@@ -327,6 +356,51 @@ static s32_t spiffs_hydro_write(spiffs *fs, spiffs_fd *fd, void *buf, u32_t offs
 
 }
 
+#if SPIFFS_CACHE_WR
+// Appends to an fd opened with SPIFFS_LOG. Data is collected in the write
+// cache page until it reaches the end of a data page, so each data page is
+// programmed once and the object index once per data page rather than once
+// per write.
+static s32_t spiffs_log_write(spiffs *fs, spiffs_fd *fd, u8_t *buf, u32_t offset, u32_t len) {
+  s32_t res = SPIFFS_OK;
+  while (len > 0) {
+    if (fd->cache_page == 0) {
+      fd->cache_page = spiffs_cache_page_allocate_by_fd(fs, fd);
+      if (fd->cache_page == 0) {
+        // no cache page to spare, write through; a size within a page is
+        // written right away, as recovery only takes in full pages
+        res = spiffs_hydro_write(fs, fd, buf, offset, len);
+        SPIFFS_CHECK_RES(res);
+        return spiffs_object_log_commit(fd, (offset + len) % SPIFFS_DATA_PAGE_SIZE(fs) != 0);
+      }
+      fd->cache_page->offset = offset;
+      fd->cache_page->size = 0;
+      SPIFFS_CACHE_DBG("CACHE_WR_ALLO: allocating log cache page %i for fd %i:%04x\n",
+          fd->cache_page->ix, fd->file_nbr, fd->obj_id);
+    }
+    u8_t *cpage_data = spiffs_get_cache_page(fs, spiffs_get_cache(fs), fd->cache_page->ix);
+    // end of the data page the cache page starts in
+    u32_t page_end = (fd->cache_page->offset / SPIFFS_DATA_PAGE_SIZE(fs) + 1) * SPIFFS_DATA_PAGE_SIZE(fs);
+    u32_t n = MIN(len, page_end - offset);
+    c_memcpy(&cpage_data[offset - fd->cache_page->offset], buf, n);
+    fd->cache_page->size += n;
+    offset += n;
+    buf += n;
+    len -= n;
+    if (offset == page_end) {
+      SPIFFS_CACHE_DBG("CACHE_WR_DUMP: dumping log cache page %i for fd %i:%04x, page full, offs:%i size:%i\n",
+          fd->cache_page->ix, fd->file_nbr, fd->obj_id, fd->cache_page->offset, fd->cache_page->size);
+      res = spiffs_hydro_write(fs, fd, cpage_data, fd->cache_page->offset, fd->cache_page->size);
+      spiffs_cache_fd_release(fs, fd->cache_page);
+      SPIFFS_CHECK_RES(res);
+      res = spiffs_object_log_commit(fd, 0);
+      SPIFFS_CHECK_RES(res);
+    }
+  }
+  return res;
+}
+#endif
+
 s32_t SPIFFS_write(spiffs *fs, spiffs_file fh, void *buf, s32_t len) {
   SPIFFS_API_CHECK_CFG(fs);
   SPIFFS_API_CHECK_MOUNT(fs);
@@ -366,6 +440,14 @@ s32_t SPIFFS_write(spiffs *fs, spiffs_file fh, void *buf, s32_t len) {
   }
 
 #if SPIFFS_CACHE_WR
+  if (fd->flags & SPIFFS_LOG) {
+    res = spiffs_log_write(fs, fd, (u8_t *)buf, offset, len);
+    SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+    fd->fdoffset += len;
+    SPIFFS_UNLOCK(fs);
+    return len;
+  }
+
   if ((fd->flags & SPIFFS_DIRECT) == 0) {
     if (len < (s32_t)SPIFFS_CFG_LOG_PAGE_SZ(fs)) {
       // small write, try to cache it
@@ -570,6 +652,9 @@ static s32_t spiffs_stat_pix(spiffs *fs, spiffs_page_ix pix, spiffs_file fh, spi
   s->type = objix_hdr.type;
   s->size = objix_hdr.size == SPIFFS_UNDEFINED_LEN ? 0 : objix_hdr.size;
   strncpy((char *)s->name, (char *)objix_hdr.name, SPIFFS_OBJ_NAME_LEN);
+#if SPIFFS_OBJ_META_LEN
+  memcpy(s->meta, objix_hdr.meta, SPIFFS_OBJ_META_LEN);
+#endif
 
   return res;
 }
@@ -641,6 +726,12 @@ static s32_t spiffs_fflush_cache(spiffs *fs, spiffs_file fh) {
       spiffs_cache_fd_release(fs, fd->cache_page);
     }
   }
+  if (res >= SPIFFS_OK && (fd->flags & SPIFFS_LOG)) {
+    res = spiffs_object_log_commit(fd, 1);
+    if (res < SPIFFS_OK) {
+      fs->err_code = res;
+    }
+  }
 #endif
 
   return res;
@@ -720,6 +811,81 @@ s32_t SPIFFS_rename(spiffs *fs, char *old, char *new) {
   return res;
 }
 
+s32_t SPIFFS_frename(spiffs *fs, spiffs_file fh, char *new) {
+  SPIFFS_API_CHECK_CFG(fs);
+  SPIFFS_API_CHECK_MOUNT(fs);
+  SPIFFS_LOCK(fs);
+
+  spiffs_page_ix pix_dummy;
+  spiffs_fd *fd;
+
+  s32_t res = spiffs_fd_get(fs, fh, &fd);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+
+  res = spiffs_object_find_object_index_header_by_name(fs, (u8_t*)new, &pix_dummy);
+  if (res == SPIFFS_ERR_NOT_FOUND) {
+    res = SPIFFS_OK;
+  } else if (res == SPIFFS_OK) {
+    res = SPIFFS_ERR_CONFLICTING_NAME;
+  }
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+
+#if SPIFFS_CACHE_WR
+  res = spiffs_fflush_cache(fs, fh);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+#endif
+
+  res = spiffs_object_update_index_hdr(fs, fd, fd->obj_id, fd->objix_hdr_pix, 0, (u8_t*)new,
+      0, &pix_dummy);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+
+  SPIFFS_UNLOCK(fs);
+
+  return res;
+}
+
+#if SPIFFS_OBJ_META_LEN
+s32_t SPIFFS_fupdate_meta(spiffs *fs, spiffs_file fh, const void *meta) {
+  SPIFFS_API_CHECK_CFG(fs);
+  SPIFFS_API_CHECK_MOUNT(fs);
+  SPIFFS_LOCK(fs);
+
+  spiffs_page_ix pix_dummy;
+  spiffs_fd *fd;
+  u32_t i;
+
+  s32_t res = spiffs_fd_get(fs, fh, &fd);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+
+#if SPIFFS_CACHE_WR
+  res = spiffs_fflush_cache(fs, fh);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+#endif
+
+  res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ, fd->file_nbr,
+      SPIFFS_PAGE_TO_PADDR(fs, fd->objix_hdr_pix), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->work);
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+  spiffs_page_object_ix_header *objix_hdr = (spiffs_page_object_ix_header *)fs->work;
+
+  for (i = 0; i < SPIFFS_OBJ_META_LEN && objix_hdr->meta[i] == 0xff; i++);
+  if (i == SPIFFS_OBJ_META_LEN) {
+    // never set, program it in place
+    res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_UPDT, fd->file_nbr,
+        SPIFFS_PAGE_TO_PADDR(fs, fd->objix_hdr_pix) + (objix_hdr->meta - fs->work),
+        SPIFFS_OBJ_META_LEN, (u8_t *)meta);
+  } else {
+    memcpy(objix_hdr->meta, meta, SPIFFS_OBJ_META_LEN);
+    res = spiffs_object_update_index_hdr(fs, fd, fd->obj_id, fd->objix_hdr_pix, fs->work, 0,
+        0, &pix_dummy);
+  }
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+
+  SPIFFS_UNLOCK(fs);
+
+  return res;
+}
+#endif
+
 spiffs_DIR *SPIFFS_opendir(spiffs *fs, char *name, spiffs_DIR *d) {
   (void)name;
 
@@ -763,11 +929,20 @@ static s32_t spiffs_read_dir_v(
       (objix_hdr.p_hdr.flags& (SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_FINAL | SPIFFS_PH_FLAG_IXDELE)) ==
           (SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_IXDELE)) {
     struct spiffs_dirent *e = (struct spiffs_dirent *)user_p;
+    u32_t len = 0;
+    while (len < SPIFFS_OBJ_NAME_LEN && objix_hdr.name[len]) len++;
+    if (len == SPIFFS_OBJ_NAME_LEN) {
+      // power lost while the header was written, before its name ended
+      return SPIFFS_VIS_COUNTINUE;
+    }
     e->obj_id = obj_id;
     strcpy((char *)e->name, (char *)objix_hdr.name);
     e->type = objix_hdr.type;
     e->size = objix_hdr.size == SPIFFS_UNDEFINED_LEN ? 0 : objix_hdr.size;
     e->pix = pix;
+#if SPIFFS_OBJ_META_LEN
+    memcpy(e->meta, objix_hdr.meta, SPIFFS_OBJ_META_LEN);
+#endif
     return SPIFFS_OK;
   }
 
@@ -819,6 +994,12 @@ s32_t SPIFFS_check(spiffs *fs) {
   SPIFFS_API_CHECK_MOUNT(fs);
   SPIFFS_LOCK(fs);
 
+#if SPIFFS_LU_INDEX
+  // the checks must see every copy of a page, not the one that is indexed
+  void *lu_index = fs->lu_index;
+  fs->lu_index = 0;
+#endif
+
   res = spiffs_lookup_consistency_check(fs, 0);
 
   res = spiffs_object_index_consistency_check(fs);
@@ -827,6 +1008,10 @@ s32_t SPIFFS_check(spiffs *fs) {
 
   res = spiffs_obj_lu_scan(fs);
 
+#if SPIFFS_LU_INDEX
+  fs->lu_index = lu_index;
+#endif
+
   SPIFFS_UNLOCK(fs);
   return res;
 }
@@ -926,6 +1111,20 @@ s32_t SPIFFS_gc_quick(spiffs *fs, u16_t max_free_pages) {
 }
 
 
+s32_t SPIFFS_gc_step(spiffs *fs, u16_t max_pages) {
+  s32_t res;
+  SPIFFS_API_CHECK_CFG(fs);
+  SPIFFS_API_CHECK_MOUNT(fs);
+  SPIFFS_LOCK(fs);
+
+  res = spiffs_gc_step(fs, max_pages);
+
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+  SPIFFS_UNLOCK(fs);
+  return 0;
+}
+
+
 s32_t SPIFFS_gc(spiffs *fs, u32_t size) {
   s32_t res;
   SPIFFS_API_CHECK_CFG(fs);
@@ -0,0 +1,222 @@
+/*
+ * spiffs_index.c
+ *
+ * RAM index of object index pages, so that opening a file by name and
+ * finding the index pages of an open file do not have to read the object
+ * lookup pages of every block.
+ *
+ * The index is only a hint: every hit is verified against the page header
+ * in flash, and anything that does not verify is dropped and looked up the
+ * slow way. This keeps it correct whatever the garbage collector or the
+ * consistency check do behind its back.
+ */
+
+#include "spiffs.h"
+#include "spiffs_nucleus.h"
+
+#if SPIFFS_LU_INDEX
+
+#define spiffs_get_lu_index(fs) \
+  ((spiffs_lu_index_entry *)((fs)->lu_index))
+
+static u16_t spiffs_lu_index_name_hash(const u8_t *name) {
+  u32_t h = 5381;
+  int i;
+  for (i = 0; i < SPIFFS_OBJ_NAME_LEN && name[i]; i++) {
+    h = (h << 5) + h + name[i];
+  }
+  h ^= h >> 16;
+  // zero is kept for entries whose name is not known
+  return (u16_t)h ? (u16_t)h : 1;
+}
+
+static void spiffs_lu_index_drop_entry(spiffs_lu_index_entry *e) {
+  e->obj_id = SPIFFS_OBJ_ID_FREE;
+  e->name_hash = 0;
+}
+
+// checks that pix still holds a valid object index page for obj_id and spix
+static s32_t spiffs_lu_index_verify(spiffs *fs, spiffs_obj_id obj_id,
+    spiffs_span_ix spix, spiffs_page_ix pix, const u8_t *name) {
+  spiffs_page_object_ix_header objix_hdr;
+  // the caller reads this page next, so let it go through the page cache
+  s32_t res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ, 0,
+      SPIFFS_PAGE_TO_PADDR(fs, pix),
+      name ? sizeof(spiffs_page_object_ix_header) : sizeof(spiffs_page_header),
+      (u8_t *)&objix_hdr);
+  SPIFFS_CHECK_RES(res);
+  if (objix_hdr.p_hdr.obj_id != obj_id ||
+      objix_hdr.p_hdr.span_ix != spix ||
+      (objix_hdr.p_hdr.flags & (SPIFFS_PH_FLAG_FINAL | SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_USED |
+          SPIFFS_PH_FLAG_INDEX)) != SPIFFS_PH_FLAG_DELET) {
+    return SPIFFS_ERR_NOT_FOUND;
+  }
+  if (spix == 0 && (objix_hdr.p_hdr.flags & SPIFFS_PH_FLAG_IXDELE) == 0) {
+    return SPIFFS_ERR_NOT_FOUND;
+  }
+  if (name && strncmp((char *)name, (char *)objix_hdr.name, SPIFFS_OBJ_NAME_LEN) != 0) {
+    return SPIFFS_ERR_NOT_FOUND;
+  }
+  return SPIFFS_OK;
+}
+
+// finds the object index page obj_id:spix, returns SPIFFS_ERR_NOT_FOUND if
+// it has to be searched for in the object lookup pages
+s32_t spiffs_lu_index_find(spiffs *fs, spiffs_obj_id obj_id, spiffs_span_ix spix,
+    spiffs_page_ix *pix) {
+  spiffs_lu_index_entry *ix = spiffs_get_lu_index(fs);
+  u32_t i;
+  if (ix == 0 || (obj_id & SPIFFS_OBJ_ID_IX_FLAG) == 0) return SPIFFS_ERR_NOT_FOUND;
+  for (i = 0; i < fs->lu_index_entries; i++) {
+    spiffs_lu_index_entry *e = &ix[i];
+    if (e->obj_id != obj_id || e->spix != spix) continue;
+    s32_t res = spiffs_lu_index_verify(fs, obj_id, spix, e->pix, 0);
+    if (res == SPIFFS_OK) {
+      if (pix) *pix = e->pix;
+      return SPIFFS_OK;
+    }
+    spiffs_lu_index_drop_entry(e);
+    if (res != SPIFFS_ERR_NOT_FOUND) return res;
+  }
+  return SPIFFS_ERR_NOT_FOUND;
+}
+
+// finds the object index header page of the object called name
+s32_t spiffs_lu_index_find_name(spiffs *fs, const u8_t *name, spiffs_page_ix *pix) {
+  spiffs_lu_index_entry *ix = spiffs_get_lu_index(fs);
+  u32_t i;
+  if (ix == 0) return SPIFFS_ERR_NOT_FOUND;
+  u16_t h = spiffs_lu_index_name_hash(name);
+  for (i = 0; i < fs->lu_index_entries; i++) {
+    spiffs_lu_index_entry *e = &ix[i];
+    if (e->obj_id == SPIFFS_OBJ_ID_FREE || e->name_hash != h) continue;
+    s32_t res = spiffs_lu_index_verify(fs, e->obj_id, 0, e->pix, name);
+    if (res == SPIFFS_OK) {
+      if (pix) *pix = e->pix;
+      return SPIFFS_OK;
+    }
+    // renamed, moved or deleted
+    spiffs_lu_index_drop_entry(e);
+    if (res != SPIFFS_ERR_NOT_FOUND) return res;
+  }
+  return SPIFFS_ERR_NOT_FOUND;
+}
+
+// enters or updates the page of object index obj_id:spix, name may be null
+// if it is not known or did not change
+void spiffs_lu_index_put(spiffs *fs, spiffs_obj_id obj_id, spiffs_span_ix spix,
+    spiffs_page_ix pix, const u8_t *name) {
+  spiffs_lu_index_entry *ix = spiffs_get_lu_index(fs);
+  spiffs_lu_index_entry *e = 0;
+  u32_t i;
+  if (ix == 0 || fs->lu_index_entries == 0) return;
+  obj_id |= SPIFFS_OBJ_ID_IX_FLAG;
+  for (i = 0; i < fs->lu_index_entries; i++) {
+    if (ix[i].obj_id == obj_id && ix[i].spix == spix) {
+      e = &ix[i];
+      break;
+    }
+    if (e == 0 && ix[i].obj_id == SPIFFS_OBJ_ID_FREE) {
+      e = &ix[i];
+    }
+  }
+  if (e == 0) {
+    // full, replace round robin but keep headers of files we know the name of
+    for (i = 0; i < fs->lu_index_entries && e == 0; i++) {
+      spiffs_lu_index_entry *cand = &ix[fs->lu_index_victim];
+      fs->lu_index_victim = (fs->lu_index_victim + 1) % fs->lu_index_entries;
+      if (cand->name_hash == 0 || i == fs->lu_index_entries - 1) e = cand;
+    }
+    e->name_hash = 0;
+  } else if (e->obj_id != obj_id || e->spix != spix) {
+    e->name_hash = 0;
+  }
+  e->obj_id = obj_id;
+  e->spix = spix;
+  e->pix = pix;
+  if (name) {
+    e->name_hash = spix == 0 ? spiffs_lu_index_name_hash(name) : 0;
+  }
+}
+
+// forgets object index obj_id:spix, or all index pages of obj_id if spix is 0
+void spiffs_lu_index_drop(spiffs *fs, spiffs_obj_id obj_id, spiffs_span_ix spix) {
+  spiffs_lu_index_entry *ix = spiffs_get_lu_index(fs);
+  u32_t i;
+  if (ix == 0) return;
+  obj_id |= SPIFFS_OBJ_ID_IX_FLAG;
+  for (i = 0; i < fs->lu_index_entries; i++) {
+    if (ix[i].obj_id == obj_id && (spix == 0 || ix[i].spix == spix)) {
+      spiffs_lu_index_drop_entry(&ix[i]);
+    }
+  }
+}
+
+// forgets whatever is indexed at page pix
+void spiffs_lu_index_drop_page(spiffs *fs, spiffs_page_ix pix) {
+  spiffs_lu_index_entry *ix = spiffs_get_lu_index(fs);
+  u32_t i;
+  if (ix == 0) return;
+  for (i = 0; i < fs->lu_index_entries; i++) {
+    if (ix[i].obj_id != SPIFFS_OBJ_ID_FREE && ix[i].pix == pix) {
+      spiffs_lu_index_drop_entry(&ix[i]);
+    }
+  }
+}
+
+static s32_t spiffs_lu_index_build_v(
+    spiffs *fs,
+    spiffs_obj_id obj_id,
+    spiffs_block_ix bix,
+    int ix_entry,
+    u32_t user_data,
+    void *user_p) {
+  (void)user_data;
+  u32_t *left = (u32_t *)user_p;
+  spiffs_page_object_ix_header objix_hdr;
+  spiffs_page_ix pix = SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, ix_entry);
+  if (obj_id == SPIFFS_OBJ_ID_FREE || obj_id == SPIFFS_OBJ_ID_DELETED ||
+      (obj_id & SPIFFS_OBJ_ID_IX_FLAG) == 0) {
+    return SPIFFS_VIS_COUNTINUE;
+  }
+  s32_t res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU2 | SPIFFS_OP_C_READ,
+      0, SPIFFS_PAGE_TO_PADDR(fs, pix), sizeof(spiffs_page_object_ix_header), (u8_t *)&objix_hdr);
+  SPIFFS_CHECK_RES(res);
+  if (objix_hdr.p_hdr.obj_id == obj_id && objix_hdr.p_hdr.span_ix == 0 &&
+      (objix_hdr.p_hdr.flags & (SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_FINAL | SPIFFS_PH_FLAG_IXDELE)) ==
+          (SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_IXDELE)) {
+    spiffs_lu_index_put(fs, obj_id, 0, pix, objix_hdr.name);
+    if (--(*left) == 0) {
+      return SPIFFS_OK;  // full, stop here
+    }
+  }
+  return SPIFFS_VIS_COUNTINUE;
+}
+
+s32_t SPIFFS_lu_index(spiffs *fs, void *buf, u32_t size) {
+  u32_t i;
+  SPIFFS_API_CHECK_CFG(fs);
+  SPIFFS_API_CHECK_MOUNT(fs);
+  SPIFFS_LOCK(fs);
+
+  fs->lu_index = buf;
+  fs->lu_index_entries = buf ? size / sizeof(spiffs_lu_index_entry) : 0;
+  fs->lu_index_victim = 0;
+  for (i = 0; i < fs->lu_index_entries; i++) {
+    spiffs_lu_index_drop_entry(&spiffs_get_lu_index(fs)[i]);
+  }
+
+  s32_t res = SPIFFS_OK;
+  if (fs->lu_index_entries > 0) {
+    // start out with the header of every file, as far as there is room
+    u32_t left = fs->lu_index_entries;
+    res = spiffs_obj_lu_find_entry_visitor(fs, 0, 0, SPIFFS_VIS_NO_WRAP, 0,
+        spiffs_lu_index_build_v, 0, &left, 0, 0);
+    if (res == SPIFFS_VIS_END) res = SPIFFS_OK;
+  }
+  SPIFFS_API_CHECK_RES_UNLOCK(fs, res);
+  SPIFFS_UNLOCK(fs);
+  return SPIFFS_OK;
+}
+
+#endif // SPIFFS_LU_INDEX
@@ -468,6 +468,15 @@ s32_t spiffs_obj_lu_find_id_and_span(
   spiffs_block_ix bix;
   int entry;
 
+#if SPIFFS_LU_INDEX
+  if (exclusion_pix == 0) {
+    res = spiffs_lu_index_find(fs, obj_id, spix, pix);
+    if (res != SPIFFS_ERR_NOT_FOUND) {
+      return res;
+    }
+  }
+#endif
+
   res = spiffs_obj_lu_find_entry_visitor(fs,
       fs->cursor_block_ix,
       fs->cursor_obj_lu_entry,
@@ -492,6 +501,12 @@ s32_t spiffs_obj_lu_find_id_and_span(
   fs->cursor_block_ix = bix;
   fs->cursor_obj_lu_entry = entry;
 
+#if SPIFFS_LU_INDEX
+  if (exclusion_pix == 0 && (obj_id & SPIFFS_OBJ_ID_IX_FLAG)) {
+    spiffs_lu_index_put(fs, obj_id, spix, SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry), 0);
+  }
+#endif
+
   return res;
 }
 
@@ -616,30 +631,36 @@ s32_t spiffs_page_move(
 
   if (dst_pix) *dst_pix = free_pix;
 
+  // mark entry in destination object lookup first, as when allocating, so
+  // that a power loss never leaves a programmed page that looks free
+  res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_UPDT,
+      0, SPIFFS_BLOCK_TO_PADDR(fs, SPIFFS_BLOCK_FOR_PAGE(fs, free_pix)) + SPIFFS_OBJ_LOOKUP_ENTRY_FOR_PAGE(fs, free_pix) * sizeof(spiffs_page_ix),
+      sizeof(spiffs_obj_id),
+      (u8_t *)&obj_id);
+  SPIFFS_CHECK_RES(res);
+
+  fs->stats_p_allocated++;
+
   p_hdr = page_data ? (spiffs_page_header *)page_data : page_hdr;
+  was_final = (p_hdr->flags & SPIFFS_PH_FLAG_FINAL) == 0;
+  // write unfinalized page, it is not found until finalized below
+  p_hdr->flags |= SPIFFS_PH_FLAG_FINAL;
+  p_hdr->flags &= ~SPIFFS_PH_FLAG_USED;
   if (page_data) {
     // got page data
-    was_final = (p_hdr->flags & SPIFFS_PH_FLAG_FINAL) == 0;
-    // write unfinalized page
-    p_hdr->flags |= SPIFFS_PH_FLAG_FINAL;
-    p_hdr->flags &= ~SPIFFS_PH_FLAG_USED;
     res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_UPDT,
         0, SPIFFS_PAGE_TO_PADDR(fs, free_pix), SPIFFS_CFG_LOG_PAGE_SZ(fs), page_data);
   } else {
-    // copy page data
-    res = spiffs_phys_cpy(fs, fh, SPIFFS_PAGE_TO_PADDR(fs, free_pix), SPIFFS_PAGE_TO_PADDR(fs, src_pix), SPIFFS_CFG_LOG_PAGE_SZ(fs));
+    // write header, copy page data
+    res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_UPDT,
+        fh, SPIFFS_PAGE_TO_PADDR(fs, free_pix), sizeof(spiffs_page_header), (u8_t *)p_hdr);
+    SPIFFS_CHECK_RES(res);
+    res = spiffs_phys_cpy(fs, fh, SPIFFS_PAGE_TO_PADDR(fs, free_pix) + sizeof(spiffs_page_header),
+        SPIFFS_PAGE_TO_PADDR(fs, src_pix) + sizeof(spiffs_page_header),
+        SPIFFS_DATA_PAGE_SIZE(fs));
   }
   SPIFFS_CHECK_RES(res);
 
-  // mark entry in destination object lookup
-  res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_UPDT,
-      0, SPIFFS_BLOCK_TO_PADDR(fs, SPIFFS_BLOCK_FOR_PAGE(fs, free_pix)) + SPIFFS_OBJ_LOOKUP_ENTRY_FOR_PAGE(fs, free_pix) * sizeof(spiffs_page_ix),
-      sizeof(spiffs_obj_id),
-      (u8_t *)&obj_id);
-  SPIFFS_CHECK_RES(res);
-
-  fs->stats_p_allocated++;
-
   if (was_final) {
     // mark finalized in destination page
     p_hdr->flags &= ~(SPIFFS_PH_FLAG_FINAL | SPIFFS_PH_FLAG_USED);
@@ -671,6 +692,10 @@ s32_t spiffs_page_delete(
       (u8_t *)&d_obj_id);
   SPIFFS_CHECK_RES(res);
 
+#if SPIFFS_LU_INDEX
+  spiffs_lu_index_drop_page(fs, pix);
+#endif
+
   fs->stats_p_deleted++;
   fs->stats_p_allocated--;
 
@@ -720,7 +745,9 @@ s32_t spiffs_object_create(
   oix_hdr.type = type;
   oix_hdr.size = SPIFFS_UNDEFINED_LEN; // keep ones so we can update later without wasting this page
   strncpy((char *)&oix_hdr.name, (char *)name, SPIFFS_OBJ_NAME_LEN);
-
+#if SPIFFS_OBJ_META_LEN
+  memset(oix_hdr.meta, 0xff, SPIFFS_OBJ_META_LEN);
+#endif
 
   // update page
   res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_UPDT,
@@ -728,6 +755,9 @@ s32_t spiffs_object_create(
 
   SPIFFS_CHECK_RES(res);
   spiffs_cb_object_event(fs, 0, SPIFFS_EV_IX_NEW, obj_id, 0, SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry), SPIFFS_UNDEFINED_LEN);
+#if SPIFFS_LU_INDEX
+  spiffs_lu_index_put(fs, obj_id, 0, SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry), name);
+#endif
 
   if (objix_hdr_pix) {
     *objix_hdr_pix = SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry);
@@ -786,6 +816,9 @@ s32_t spiffs_object_update_index_hdr(
     // callback on object index update
     spiffs_cb_object_event(fs, fd, SPIFFS_EV_IX_UPD, obj_id, objix_hdr->p_hdr.span_ix, new_objix_hdr_pix, objix_hdr->size);
     if (fd) fd->objix_hdr_pix = new_objix_hdr_pix; // if this is not in the registered cluster
+#if SPIFFS_LU_INDEX
+    if (name) spiffs_lu_index_put(fs, obj_id, 0, new_objix_hdr_pix, name);
+#endif
   }
 
   return res;
@@ -800,6 +833,14 @@ void spiffs_cb_object_event(
     spiffs_page_ix new_pix,
     u32_t new_size) {
   (void)fd;
+#if SPIFFS_LU_INDEX
+  // update the RAM index
+  if (ev == SPIFFS_EV_IX_NEW || ev == SPIFFS_EV_IX_UPD) {
+    spiffs_lu_index_put(fs, obj_id, spix, new_pix, 0);
+  } else if (ev == SPIFFS_EV_IX_DEL) {
+    spiffs_lu_index_drop(fs, obj_id, spix);
+  }
+#endif
   // update index caches in all file descriptors
   obj_id &= ~SPIFFS_OBJ_ID_IX_FLAG;
   u32_t i;
@@ -811,8 +852,17 @@ void spiffs_cb_object_event(
       if (ev == SPIFFS_EV_IX_NEW || ev == SPIFFS_EV_IX_UPD) {
         SPIFFS_DBG("       callback: setting fd %i:%04x objix_hdr_pix to %04x, size:%i\n", cur_fd->file_nbr, cur_fd->obj_id, new_pix, new_size);
         cur_fd->objix_hdr_pix = new_pix;
-        if (new_size != 0) {
-          cur_fd->size = new_size;
+        u32_t fd_size = new_size;
+#if SPIFFS_CACHE_WR
+        // moving the header of an object appended to with SPIFFS_LOG brings
+        // along the size last written, which may lag behind what was appended
+        if ((cur_fd->flags & SPIFFS_LOG) && cur_fd->size != SPIFFS_UNDEFINED_LEN &&
+            (new_size == SPIFFS_UNDEFINED_LEN || new_size < cur_fd->size)) {
+          fd_size = 0;
+        }
+#endif
+        if (fd_size != 0) {
+          cur_fd->size = fd_size;
         }
       } else if (ev == SPIFFS_EV_IX_DEL) {
         cur_fd->file_nbr = 0;
@@ -881,17 +931,54 @@ s32_t spiffs_object_open_by_page(
 
   SPIFFS_VALIDATE_OBJIX(oix_hdr.p_hdr, fd->obj_id, 0);
 
+#if SPIFFS_CACHE_WR
+  if (flags & SPIFFS_LOG) {
+    fd->flags |= SPIFFS_APPEND;
+  }
+  // writing at a size that lags behind the data would program the same
+  // flash twice, reading alone is fine with the stored size
+  if (flags & SPIFFS_WRONLY) {
+    res = spiffs_object_log_recover(fd);
+    SPIFFS_CHECK_RES(res);
+  }
+#else
+  fd->flags &= ~SPIFFS_LOG;
+#endif
+
   SPIFFS_DBG("open: fd %i is obj id %04x\n", fd->file_nbr, fd->obj_id);
 
   return res;
 }
 
+// programs bytes lo..hi of the object index page in fs->work in place, where
+// only erased entries were filled in
+static s32_t spiffs_object_index_wr_entries(spiffs *fs, spiffs_fd *fd,
+    spiffs_page_ix pix, spiffs_span_ix spix, u32_t lo, u32_t hi) {
+  if (lo >= hi) return SPIFFS_OK;
+  s32_t res = spiffs_page_index_check(fs, fd, pix, spix);
+  SPIFFS_CHECK_RES(res);
+  return _spiffs_wr(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_UPDT,
+      fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, pix) + lo, hi - lo, fs->work + lo);
+}
+
 // Append to object
 // keep current object index (header) page in fs->work buffer
 s32_t spiffs_object_append(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
   spiffs *fs = fd->fs;
   s32_t res = SPIFFS_OK;
   u32_t written = 0;
+#if SPIFFS_CACHE_WR
+  // for SPIFFS_LOG, only the new entries of object index pages are programmed,
+  // in place, and the size in the object index header is left as it is
+  u8_t defer_size = (fd->flags & SPIFFS_LOG) != 0;
+#else
+  u8_t defer_size = 0;
+#endif
+  // range of entries changed in the object index page in fs->work
+  u32_t ix_lo = SPIFFS_CFG_LOG_PAGE_SZ(fs), ix_hi = 0;
+#if SPIFFS_CACHE_WR
+  if (defer_size) fd->log_pages++;
+#endif
 
   SPIFFS_DBG("append: %i bytes @ offs %i of size %i\n", len, offset, fd->size);
 
@@ -932,7 +1019,10 @@ s32_t spiffs_object_append(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
         // store previous object index page, unless first pass
         SPIFFS_DBG("append: %04x store objix %04x:%04x, written %i\n", fd->obj_id,
             cur_objix_pix, prev_objix_spix, written);
-        if (prev_objix_spix == 0) {
+        if (defer_size) {
+          res = spiffs_object_index_wr_entries(fs, fd, cur_objix_pix, prev_objix_spix, ix_lo, ix_hi);
+          SPIFFS_CHECK_RES(res);
+        } else if (prev_objix_spix == 0) {
           // this is an update to object index header page
           objix_hdr->size = offset+written;
           if (offset == 0) {
@@ -1017,15 +1107,21 @@ s32_t spiffs_object_append(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
         fd->size = offset+written;
       }
       prev_objix_spix = cur_objix_spix;
+      ix_lo = SPIFFS_CFG_LOG_PAGE_SZ(fs);
+      ix_hi = 0;
     }
 
     // write data
     u32_t to_write = MIN(len-written, SPIFFS_DATA_PAGE_SIZE(fs) - page_offs);
+    // log pages are marked once full, the mark tells recovery how far
+    // the data goes
+    u8_t mark_full = defer_size && page_offs + to_write == SPIFFS_DATA_PAGE_SIZE(fs);
     if (page_offs == 0) {
       // at beginning of a page, allocate and write a new page of data
       p_hdr.obj_id = fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
       p_hdr.span_ix = data_spix;
       p_hdr.flags = 0xff & ~(SPIFFS_PH_FLAG_FINAL);  // finalize immediately
+      if (mark_full) p_hdr.flags &= ~SPIFFS_PH_FLAG_FULL;
       res = spiffs_page_allocate_data(fs, fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG,
           &p_hdr, &data[written], to_write, page_offs, 1, &data_page);
       SPIFFS_DBG("append: %04x store new data page, %04x:%04x offset:%i, len %i, written %i\n", fd->obj_id,
@@ -1047,23 +1143,40 @@ s32_t spiffs_object_append(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
           fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, data_page) + sizeof(spiffs_page_header) + page_offs, to_write, &data[written]);
       SPIFFS_DBG("append: %04x store to existing data page, %04x:%04x offset:%i, len %i, written %i\n", fd->obj_id
           , data_page, data_spix, page_offs, to_write, written);
+      if (res == SPIFFS_OK && mark_full) {
+        // only after the data, programmed in place
+        res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_READ,
+            fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, data_page), sizeof(spiffs_page_header), (u8_t *)&p_hdr);
+        if (res == SPIFFS_OK) {
+          p_hdr.flags &= ~SPIFFS_PH_FLAG_FULL;
+          res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_UPDT,
+              fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, data_page) + offsetof(spiffs_page_header, flags),
+              sizeof(u8_t), &p_hdr.flags);
+        }
+      }
     }
 
     if (res != SPIFFS_OK) break;
 
     // update memory representation of object index page with new data page
+    spiffs_page_ix *entry;
     if (cur_objix_spix == 0) {
       // update object index header page
-      ((spiffs_page_ix*)((u8_t *)objix_hdr + sizeof(spiffs_page_object_ix_header)))[data_spix] = data_page;
+      entry = &((spiffs_page_ix*)((u8_t *)objix_hdr + sizeof(spiffs_page_object_ix_header)))[data_spix];
       SPIFFS_DBG("append: %04x wrote page %04x to objix_hdr entry %02x in mem\n", fd->obj_id
           , data_page, data_spix);
       objix_hdr->size = offset+written;
     } else {
       // update object index page
-      ((spiffs_page_ix*)((u8_t *)objix + sizeof(spiffs_page_object_ix)))[SPIFFS_OBJ_IX_ENTRY(fs, data_spix)] = data_page;
+      entry = &((spiffs_page_ix*)((u8_t *)objix + sizeof(spiffs_page_object_ix)))[SPIFFS_OBJ_IX_ENTRY(fs, data_spix)];
       SPIFFS_DBG("append: %04x wrote page %04x to objix entry %02x in mem\n", fd->obj_id
           , data_page, SPIFFS_OBJ_IX_ENTRY(fs, data_spix));
     }
+    if (*entry != data_page) {
+      *entry = data_page;
+      ix_lo = MIN(ix_lo, (u32_t)((u8_t *)entry - fs->work));
+      ix_hi = MAX(ix_hi, (u32_t)((u8_t *)entry - fs->work) + sizeof(spiffs_page_ix));
+    }
 
     // update internals
     page_offs = 0;
@@ -1078,7 +1191,10 @@ s32_t spiffs_object_append(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
 
   // finalize updated object indices
   s32_t res2 = SPIFFS_OK;
-  if (cur_objix_spix != 0) {
+  if (defer_size) {
+    res2 = spiffs_object_index_wr_entries(fs, fd, cur_objix_pix, cur_objix_spix, ix_lo, ix_hi);
+    SPIFFS_CHECK_RES(res2);
+  } else if (cur_objix_spix != 0) {
     // wrote beyond object index header page
     // write last modified object index page, unless object header index page
     SPIFFS_DBG("append: %04x store objix page, %04x:%04x, written %i\n", fd->obj_id,
@@ -1113,7 +1229,7 @@ s32_t spiffs_object_append(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
           fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, cur_objix_pix), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->work);
       SPIFFS_CHECK_RES(res2);
       // callback on object index update
-      spiffs_cb_object_event(fs, fd, SPIFFS_EV_IX_UPD, fd->obj_id, objix_hdr->p_hdr.span_ix, cur_objix_pix, objix_hdr->size);
+      spiffs_cb_object_event(fs, fd, SPIFFS_EV_IX_UPD, fd->obj_id, objix_hdr->p_hdr.span_ix, cur_objix_pix, offset+written);
     } else {
       // modifying object index header page, update size and make new copy
       res2 = spiffs_object_update_index_hdr(fs, fd, fd->obj_id,
@@ -1127,6 +1243,137 @@ s32_t spiffs_object_append(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
   return res;
 }
 
+#if SPIFFS_CACHE_WR
+// Write the size of an object appended to with SPIFFS_LOG to its object index
+// header. Unless forced, this only happens every SPIFFS_LOG_COMMIT_PAGES
+// appends, which are whole data pages but for flushes.
+s32_t spiffs_object_log_commit(spiffs_fd *fd, u8_t force) {
+  spiffs *fs = fd->fs;
+  s32_t res = SPIFFS_OK;
+  u32_t size = fd->size == SPIFFS_UNDEFINED_LEN ? 0 : fd->size;
+
+  if (fd->log_pages == 0 || (!force && fd->log_pages < SPIFFS_LOG_COMMIT_PAGES)) {
+    return SPIFFS_OK;
+  }
+
+  res = spiffs_gc_check(fs, SPIFFS_DATA_PAGE_SIZE(fs));
+  SPIFFS_CHECK_RES(res);
+
+  spiffs_page_object_ix_header *objix_hdr = (spiffs_page_object_ix_header *)fs->work;
+  res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ,
+      fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, fd->objix_hdr_pix), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->work);
+  SPIFFS_CHECK_RES(res);
+  SPIFFS_VALIDATE_OBJIX(objix_hdr->p_hdr, fd->obj_id, 0);
+
+  SPIFFS_DBG("log commit: %04x size %i, was %i\n", fd->obj_id, size, objix_hdr->size);
+  if (objix_hdr->size == SPIFFS_UNDEFINED_LEN) {
+    // size was never written, program it in place
+    objix_hdr->size = size;
+    res = _spiffs_wr(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_UPDT,
+        fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, fd->objix_hdr_pix) +
+        ((u8_t *)&objix_hdr->size - (u8_t *)objix_hdr),
+        sizeof(objix_hdr->size), (u8_t *)&objix_hdr->size);
+    SPIFFS_CHECK_RES(res);
+    spiffs_cb_object_event(fs, fd, SPIFFS_EV_IX_UPD, fd->obj_id, 0, fd->objix_hdr_pix, size);
+  } else if (objix_hdr->size != size) {
+    res = spiffs_object_update_index_hdr(fs, fd, fd->obj_id,
+        fd->objix_hdr_pix, fs->work, 0, size, 0);
+    SPIFFS_CHECK_RES(res);
+  }
+  fd->log_pages = 0;
+
+  return res;
+}
+
+// An object appended to with SPIFFS_LOG that was never flushed or closed may
+// have data pages beyond the size in its object index header, referenced from
+// the object index already. Take them into the object, so that they can be
+// read and later writes do not program the same flash again. Appends that
+// end within a page always write the size, so such pages are full of data;
+// their index entry is programmed after the data, and SPIFFS_PH_FLAG_FULL
+// tells when a page the size ends in was filled up afterwards. A page cut
+// off before it was marked full is truncated away. Only for writable fds.
+s32_t spiffs_object_log_recover(spiffs_fd *fd) {
+  spiffs *fs = fd->fs;
+  s32_t res = SPIFFS_OK;
+  u32_t size = fd->size == SPIFFS_UNDEFINED_LEN ? 0 : fd->size;
+  u32_t end = size;
+  u8_t stale = 0;
+  spiffs_span_ix data_spix = size / SPIFFS_DATA_PAGE_SIZE(fs);
+  spiffs_span_ix objix_spix = 0;
+  spiffs_page_ix objix_pix = fd->objix_hdr_pix;
+
+  fd->log_pages = 0;
+
+  while (1) {
+    spiffs_span_ix cur_objix_spix = SPIFFS_OBJ_IX_ENTRY_SPAN_IX(fs, data_spix);
+    spiffs_page_ix data_pix;
+    spiffs_page_header p_hdr;
+    u32_t entry_addr;
+
+    if (cur_objix_spix != objix_spix) {
+      res = spiffs_obj_lu_find_id_and_span(fs, fd->obj_id | SPIFFS_OBJ_ID_IX_FLAG, cur_objix_spix, 0, &objix_pix);
+      if (res == SPIFFS_ERR_NOT_FOUND) break;
+      SPIFFS_CHECK_RES(res);
+      objix_spix = cur_objix_spix;
+    }
+    if (objix_spix == 0) {
+      entry_addr = SPIFFS_PAGE_TO_PADDR(fs, objix_pix) + sizeof(spiffs_page_object_ix_header) +
+          data_spix * sizeof(spiffs_page_ix);
+    } else {
+      entry_addr = SPIFFS_PAGE_TO_PADDR(fs, objix_pix) + sizeof(spiffs_page_object_ix) +
+          SPIFFS_OBJ_IX_ENTRY(fs, data_spix) * sizeof(spiffs_page_ix);
+    }
+    res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ,
+        fd->file_nbr, entry_addr, sizeof(spiffs_page_ix), (u8_t *)&data_pix);
+    SPIFFS_CHECK_RES(res);
+    if (data_pix == (spiffs_page_ix)-1) break;
+
+    res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_READ,
+        fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, data_pix), sizeof(spiffs_page_header), (u8_t *)&p_hdr);
+    SPIFFS_CHECK_RES(res);
+    if (p_hdr.obj_id != (fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG) || p_hdr.span_ix != data_spix ||
+        (p_hdr.flags & (SPIFFS_PH_FLAG_USED | SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_FINAL |
+            SPIFFS_PH_FLAG_INDEX | SPIFFS_PH_FLAG_FULL)) !=
+            (SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_INDEX)) {
+      u32_t offs = end % SPIFFS_DATA_PAGE_SIZE(fs);
+      if (offs == 0) {
+        stale = 1;
+      } else {
+        // the page the size ends in, is anything programmed after the size
+        u32_t i;
+        res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_READ,
+            fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, data_pix) + sizeof(spiffs_page_header) + offs,
+            SPIFFS_DATA_PAGE_SIZE(fs) - offs, fs->work);
+        SPIFFS_CHECK_RES(res);
+        for (i = 0; i < SPIFFS_DATA_PAGE_SIZE(fs) - offs && !stale; i++) {
+          stale = fs->work[i] != 0xff;
+        }
+      }
+      break;
+    }
+
+    data_spix++;
+    end = data_spix * SPIFFS_DATA_PAGE_SIZE(fs);
+  }
+
+  res = SPIFFS_OK;
+  if (stale) {
+    SPIFFS_DBG("log recover: %04x size %i -> %i, truncating page %04x\n", fd->obj_id, size, end, data_spix);
+    fd->size = (data_spix + 1) * SPIFFS_DATA_PAGE_SIZE(fs);
+    res = spiffs_object_truncate(fd, end, 0);
+    fd->offset = 0;
+  } else if (end > size) {
+    SPIFFS_DBG("log recover: %04x size %i -> %i\n", fd->obj_id, size, end);
+    fd->size = end;
+    fd->log_pages = 1;
+    res = spiffs_object_log_commit(fd, 1);
+  }
+
+  return res;
+}
+#endif
+
 // Modify object
 // keep current object index (header) page in fs->work buffer
 s32_t spiffs_object_modify(spiffs_fd *fd, u32_t offset, u8_t *data, u32_t len) {
@@ -1366,6 +1613,13 @@ s32_t spiffs_object_find_object_index_header_by_name(
   spiffs_block_ix bix;
   int entry;
 
+#if SPIFFS_LU_INDEX
+  res = spiffs_lu_index_find_name(fs, name, pix);
+  if (res != SPIFFS_ERR_NOT_FOUND) {
+    return res;
+  }
+#endif
+
   res = spiffs_obj_lu_find_entry_visitor(fs,
       fs->cursor_block_ix,
       fs->cursor_obj_lu_entry,
@@ -1389,6 +1643,16 @@ s32_t spiffs_object_find_object_index_header_by_name(
   fs->cursor_block_ix = bix;
   fs->cursor_obj_lu_entry = entry;
 
+#if SPIFFS_LU_INDEX
+  if (fs->lu_index) {
+    spiffs_page_header p_hdr;
+    res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ, 0,
+        SPIFFS_OBJ_LOOKUP_ENTRY_TO_PADDR(fs, bix, entry), sizeof(spiffs_page_header), (u8_t *)&p_hdr);
+    SPIFFS_CHECK_RES(res);
+    spiffs_lu_index_put(fs, p_hdr.obj_id, 0, SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry), name);
+  }
+#endif
+
   return res;
 }
 
@@ -1613,6 +1877,68 @@ s32_t spiffs_object_truncate(
   return res;
 }
 
+// Number of data pages, from data_pix on and up to SPIFFS_READ_RUN_PAGES,
+// that hold consecutive spans, follow each other in flash and are wholly
+// wanted by a read of len bytes. Only the entries of the object index page
+// at hand are looked at. Anything out of the ordinary is left to the page by
+// page path, which reports it.
+static u32_t spiffs_object_read_run(
+    spiffs *fs,
+    spiffs_page_ix *entries,
+    u32_t entry,
+    u32_t entry_count,
+    spiffs_page_ix data_pix,
+    u32_t len) {
+  u32_t max_run = MIN(len / SPIFFS_DATA_PAGE_SIZE(fs), SPIFFS_READ_RUN_PAGES(fs));
+  u32_t run = 1;
+  if (max_run < 2 || data_pix == (spiffs_page_ix)-1 ||
+      data_pix % SPIFFS_PAGES_PER_BLOCK(fs) < SPIFFS_OBJ_LOOKUP_PAGES(fs)) {
+    return 0;
+  }
+  while (run < max_run && entry + run < entry_count) {
+    spiffs_page_ix pix = data_pix + run;
+    if (pix >= SPIFFS_MAX_PAGES(fs) ||
+        pix % SPIFFS_PAGES_PER_BLOCK(fs) < SPIFFS_OBJ_LOOKUP_PAGES(fs) ||
+        entries[entry + run] != pix) {
+      break;
+    }
+    run++;
+  }
+  return run > 1 ? run : 0;
+}
+
+// Reads the run pages from data_pix on in one flash transaction straight
+// into dst, page headers and all, then checks the headers and squeezes them
+// out. The headers take the room of the tail of the last page, so this
+// returns the number of data bytes now in dst, a little short of the run.
+static s32_t spiffs_object_read_pages(
+    spiffs_fd *fd,
+    spiffs_page_ix data_pix,
+    spiffs_span_ix data_spix,
+    u32_t run,
+    u32_t len,
+    u8_t *dst) {
+  spiffs *fs = fd->fs;
+  u32_t raw = MIN(len, run * SPIFFS_CFG_LOG_PAGE_SZ(fs));
+  u32_t got = 0;
+  u32_t i;
+  s32_t res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_DA | SPIFFS_OP_C_READ, fd->file_nbr,
+      SPIFFS_PAGE_TO_PADDR(fs, data_pix), raw, dst);
+  SPIFFS_CHECK_RES(res);
+  for (i = 0; i < run; i++) {
+    u8_t *page = dst + i * SPIFFS_CFG_LOG_PAGE_SZ(fs);
+    u32_t n = MIN(SPIFFS_DATA_PAGE_SIZE(fs), (u32_t)(dst + raw - page) - sizeof(spiffs_page_header));
+#if SPIFFS_PAGE_CHECK
+    spiffs_page_header ph;
+    c_memcpy(&ph, page, sizeof(spiffs_page_header));
+    SPIFFS_VALIDATE_DATA(ph, fd->obj_id & ~SPIFFS_OBJ_ID_IX_FLAG, data_spix + i);
+#endif
+    c_memmove(dst + got, page + sizeof(spiffs_page_header), n);
+    got += n;
+  }
+  return got;
+}
+
 s32_t spiffs_object_read(
     spiffs_fd *fd,
     u32_t offset,
@@ -1635,6 +1961,9 @@ s32_t spiffs_object_read(
       // load current object index (header) page
       if (cur_objix_spix == 0) {
         objix_pix = fd->objix_hdr_pix;
+      } else if (fd->cursor_objix_spix == cur_objix_spix && fd->cursor_objix_pix != 0) {
+        // where the last read or write on this fd left off
+        objix_pix = fd->cursor_objix_pix;
       } else {
         SPIFFS_DBG("read: find objix %04x:%04x\n", fd->obj_id, cur_objix_spix);
         res = spiffs_obj_lu_find_id_and_span(fs, fd->obj_id | SPIFFS_OBJ_ID_IX_FLAG, cur_objix_spix, 0, &objix_pix);
@@ -1653,16 +1982,37 @@ s32_t spiffs_object_read(
       prev_objix_spix = cur_objix_spix;
     }
 
+    spiffs_page_ix *entries;
+    u32_t entry, entry_count;
     if (cur_objix_spix == 0) {
       // get data page from object index header page
-      data_pix = ((spiffs_page_ix*)((u8_t *)objix_hdr + sizeof(spiffs_page_object_ix_header)))[data_spix];
+      entries = (spiffs_page_ix*)((u8_t *)objix_hdr + sizeof(spiffs_page_object_ix_header));
+      entry = data_spix;
+      entry_count = SPIFFS_OBJ_HDR_IX_LEN(fs);
     } else {
       // get data page from object index page
-      data_pix = ((spiffs_page_ix*)((u8_t *)objix + sizeof(spiffs_page_object_ix)))[SPIFFS_OBJ_IX_ENTRY(fs, data_spix)];
+      entries = (spiffs_page_ix*)((u8_t *)objix + sizeof(spiffs_page_object_ix));
+      entry = SPIFFS_OBJ_IX_ENTRY(fs, data_spix);
+      entry_count = SPIFFS_OBJ_IX_LEN(fs);
     }
+    data_pix = entries[entry];
 
     // all remaining data
     u32_t len_to_read = offset + len - cur_offset;
+    u32_t run = 0;
+    if (cur_offset % SPIFFS_DATA_PAGE_SIZE(fs) == 0) {
+      // whole pages that follow each other in flash are read in one go
+      run = spiffs_object_read_run(fs, entries, entry, entry_count, data_pix, len_to_read);
+    }
+    if (run > 0) {
+      res = spiffs_object_read_pages(fd, data_pix, data_spix, run, len_to_read, dst);
+      SPIFFS_CHECK_RES(res);
+      dst += res;
+      cur_offset += res;
+      fd->offset = cur_offset;
+      data_spix = cur_offset / SPIFFS_DATA_PAGE_SIZE(fs);
+      continue;
+    }
     // remaining data in page
     len_to_read = MIN(len_to_read, SPIFFS_DATA_PAGE_SIZE(fs) - (cur_offset % SPIFFS_DATA_PAGE_SIZE(fs)));
     // remaining data in file
@@ -1691,6 +2041,59 @@ s32_t spiffs_object_read(
   return res;
 }
 
+// finds the flash address of the file data at offset, and how many bytes
+// of it follow there before the end of the data page or of the file
+s32_t spiffs_object_map(
+    spiffs_fd *fd,
+    u32_t offset,
+    u32_t *addr,
+    u32_t *len) {
+  s32_t res;
+  spiffs *fs = fd->fs;
+  spiffs_page_ix objix_pix;
+  spiffs_page_ix data_pix;
+  spiffs_page_header p_hdr;
+  spiffs_span_ix data_spix = offset / SPIFFS_DATA_PAGE_SIZE(fs);
+  spiffs_span_ix objix_spix = SPIFFS_OBJ_IX_ENTRY_SPAN_IX(fs, data_spix);
+  u32_t entry_offs;
+
+  if (fd->size == SPIFFS_UNDEFINED_LEN || offset >= fd->size) {
+    return SPIFFS_ERR_END_OF_OBJECT;
+  }
+
+  if (objix_spix == 0) {
+    objix_pix = fd->objix_hdr_pix;
+    entry_offs = sizeof(spiffs_page_object_ix_header) + data_spix * sizeof(spiffs_page_ix);
+  } else {
+    if (fd->cursor_objix_spix == objix_spix && fd->cursor_objix_pix != 0) {
+      objix_pix = fd->cursor_objix_pix;
+    } else {
+      res = spiffs_obj_lu_find_id_and_span(fs, fd->obj_id | SPIFFS_OBJ_ID_IX_FLAG, objix_spix, 0, &objix_pix);
+      SPIFFS_CHECK_RES(res);
+    }
+    entry_offs = sizeof(spiffs_page_object_ix) + SPIFFS_OBJ_IX_ENTRY(fs, data_spix) * sizeof(spiffs_page_ix);
+  }
+  // only the header and the one entry are needed, not the whole index page
+  res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ,
+      fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, objix_pix), sizeof(spiffs_page_header), (u8_t *)&p_hdr);
+  SPIFFS_CHECK_RES(res);
+  SPIFFS_VALIDATE_OBJIX(p_hdr, fd->obj_id, objix_spix);
+  res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_IX | SPIFFS_OP_C_READ,
+      fd->file_nbr, SPIFFS_PAGE_TO_PADDR(fs, objix_pix) + entry_offs, sizeof(spiffs_page_ix), (u8_t *)&data_pix);
+  SPIFFS_CHECK_RES(res);
+  if (objix_spix != 0) {
+    fd->cursor_objix_pix = objix_pix;
+    fd->cursor_objix_spix = objix_spix;
+  }
+
+  res = spiffs_page_data_check(fs, fd, data_pix, data_spix);
+  SPIFFS_CHECK_RES(res);
+
+  *addr = SPIFFS_PAGE_TO_PADDR(fs, data_pix) + sizeof(spiffs_page_header) + (offset % SPIFFS_DATA_PAGE_SIZE(fs));
+  *len = MIN(SPIFFS_DATA_PAGE_SIZE(fs) - (offset % SPIFFS_DATA_PAGE_SIZE(fs)), fd->size - offset);
+  return SPIFFS_OK;
+}
+
 typedef struct {
   spiffs_obj_id min_obj_id;
   spiffs_obj_id max_obj_id;
@@ -193,6 +193,10 @@
 // returns data size in a data page
 #define SPIFFS_DATA_PAGE_SIZE(fs) \
     ( SPIFFS_CFG_LOG_PAGE_SZ(fs) - sizeof(spiffs_page_header) )
+// most data pages read in one go, so that the page headers read along
+// never take more room than the data of the last page
+#define SPIFFS_READ_RUN_PAGES(fs) \
+    ( SPIFFS_CFG_LOG_PAGE_SZ(fs) / sizeof(spiffs_page_header) - 1 )
 // returns physical address for block's erase count,
 // always in the physical last entry of the last object lookup page
 #define SPIFFS_ERASE_COUNT_PADDR(fs, bix) \
@@ -244,6 +248,8 @@
 #define SPIFFS_PH_FLAG_FINAL  (1<<1)
 // if 0, this is an index page, else a data page
 #define SPIFFS_PH_FLAG_INDEX  (1<<2)
+// if 0, this data page was appended to with SPIFFS_LOG up to its end
+#define SPIFFS_PH_FLAG_FULL   (1<<3)
 // if 0, page is deleted, else valid
 #define SPIFFS_PH_FLAG_DELET  (1<<7)
 // if 0, this index header is being deleted
@@ -332,12 +338,20 @@
 #define spiffs_get_cache_page(fs, c, ix) \
   ((u8_t *)(&((c)->cpages[(ix) * SPIFFS_CACHE_PAGE_SIZE(fs)])) + sizeof(spiffs_cache_page))
 
+// number of buckets in the page index -> read cache page hash, power of 2
+#define SPIFFS_CACHE_HASH_SIZE        32
+#define SPIFFS_CACHE_NONE             0xff
+#define spiffs_cache_hash(pix) \
+  ((pix) & (SPIFFS_CACHE_HASH_SIZE-1))
+
 // cache page struct
 typedef struct {
   // cache flags
   u8_t flags;
   // cache page index
   u8_t ix;
+  // next read cache page in the same pix hash bucket, or SPIFFS_CACHE_NONE
+  u8_t hash_next;
   // last access of this cache page
   u32_t last_access;
   union {
@@ -367,10 +381,25 @@ typedef struct {
   u32_t cpage_use_map;
   u32_t cpage_use_mask;
   u8_t *cpages;
+  // first read cache page for each pix hash bucket, or SPIFFS_CACHE_NONE
+  u8_t pix_hash[SPIFFS_CACHE_HASH_SIZE];
 } spiffs_cache;
 
 #endif
 
+#if SPIFFS_LU_INDEX
+// object index page index entry
+typedef struct {
+  // object id with index flag, or SPIFFS_OBJ_ID_FREE
+  spiffs_obj_id obj_id;
+  // object index span index
+  spiffs_span_ix spix;
+  // object index page index
+  spiffs_page_ix pix;
+  // hash of the name for index headers, or zero if not known
+  u16_t name_hash;
+} spiffs_lu_index_entry;
+#endif
 
 // spiffs nucleus file descriptor
 typedef struct {
@@ -395,6 +424,8 @@ typedef struct {
   // fd flags
   spiffs_flags flags;
 #if SPIFFS_CACHE_WR
+  // appends since the size was last written, for SPIFFS_LOG
+  u16_t log_pages;
   spiffs_cache_page *cache_page;
 #endif
 } spiffs_fd;
@@ -425,6 +456,10 @@ typedef struct __attribute(( packed ))
   spiffs_obj_type type;
   // name of object
   u8_t name[SPIFFS_OBJ_NAME_LEN];
+#if SPIFFS_OBJ_META_LEN
+  // metadata, all ones until first set
+  u8_t meta[SPIFFS_OBJ_META_LEN];
+#endif
 } spiffs_page_object_ix_header;
 
 // object index page header
@@ -628,11 +663,26 @@ s32_t spiffs_object_read(
     u32_t len,
     u8_t *dst);
 
+s32_t spiffs_object_map(
+    spiffs_fd *fd,
+    u32_t offset,
+    u32_t *addr,
+    u32_t *len);
+
 s32_t spiffs_object_truncate(
     spiffs_fd *fd,
     u32_t new_len,
     u8_t remove_object);
 
+#if SPIFFS_CACHE_WR
+s32_t spiffs_object_log_commit(
+    spiffs_fd *fd,
+    u8_t force);
+
+s32_t spiffs_object_log_recover(
+    spiffs_fd *fd);
+#endif
+
 s32_t spiffs_object_find_object_index_header_by_name(
     spiffs *fs,
     u8_t name[SPIFFS_OBJ_NAME_LEN],
@@ -661,6 +711,9 @@ s32_t spiffs_gc_clean(
 s32_t spiffs_gc_quick(
     spiffs *fs, u16_t max_free_pages);
 
+s32_t spiffs_gc_step(
+    spiffs *fs, u16_t max_pages);
+
 // ---------------
 
 s32_t spiffs_fd_find_new(
@@ -699,6 +752,35 @@ spiffs_cache_page *spiffs_cache_page_get_by_fd(
 #endif
 #endif
 
+#if SPIFFS_LU_INDEX
+s32_t spiffs_lu_index_find(
+    spiffs *fs,
+    spiffs_obj_id obj_id,
+    spiffs_span_ix spix,
+    spiffs_page_ix *pix);
+
+s32_t spiffs_lu_index_find_name(
+    spiffs *fs,
+    const u8_t *name,
+    spiffs_page_ix *pix);
+
+void spiffs_lu_index_put(
+    spiffs *fs,
+    spiffs_obj_id obj_id,
+    spiffs_span_ix spix,
+    spiffs_page_ix pix,
+    const u8_t *name);
+
+void spiffs_lu_index_drop(
+    spiffs *fs,
+    spiffs_obj_id obj_id,
+    spiffs_span_ix spix);
+
+void spiffs_lu_index_drop_page(
+    spiffs *fs,
+    spiffs_page_ix pix);
+#endif
+
 s32_t spiffs_lookup_consistency_check(
     spiffs *fs,
     u8_t check_all_objects);
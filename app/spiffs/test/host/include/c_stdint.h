@@ -0,0 +1,11 @@
+/* Host stand-in for the SDK's fixed width types */
+#ifndef _C_STDINT_H_
+#define _C_STDINT_H_
+
+#include <stdint.h>
+
+typedef int32_t  sint32_t;
+typedef int16_t  sint16_t;
+typedef int8_t   sint8_t;
+
+#endif
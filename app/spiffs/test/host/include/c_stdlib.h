@@ -0,0 +1,3 @@
+#include <stdlib.h>
+#define c_malloc malloc
+#define c_free free
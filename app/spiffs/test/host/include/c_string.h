@@ -0,0 +1,10 @@
+#include <string.h>
+#define c_memcmp memcmp
+#define c_memcpy memcpy
+#define c_memmove memmove
+#define c_memset memset
+#define c_strcmp strcmp
+#define c_strcpy strcpy
+#define c_strlen strlen
+#define c_strncmp strncmp
+#define c_strncpy strncpy
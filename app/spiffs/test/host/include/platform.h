@@ -0,0 +1,26 @@
+/* Host stand-in for app/platform/platform.h, the flash is emulated in RAM
+ * by test_glue.c */
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+#include "c_stdint.h"
+
+enum
+{
+  PLATFORM_OK,
+  PLATFORM_ERR,
+  PLATFORM_UNDERFLOW = -1
+};
+
+#define INTERNAL_FLASH_SECTOR_SIZE  4096
+#define INTERNAL_FLASH_SIZE         (64*INTERNAL_FLASH_SECTOR_SIZE)
+#define SYS_PARAM_SEC_NUM           4
+
+uint32_t platform_flash_get_first_free_block_address( uint32_t *psect );
+uint32_t platform_flash_get_sector_of_address( uint32_t addr );
+uint32_t platform_flash_write( const void *from, uint32_t toaddr, uint32_t size );
+uint32_t platform_flash_read( void *to, uint32_t fromaddr, uint32_t size );
+int platform_flash_erase_sector( uint32_t sector_id );
+uint32_t platform_flash_phys2mapped( uint32_t phys_addr );
+
+#endif
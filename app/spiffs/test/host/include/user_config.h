@@ -0,0 +1,15 @@
+/* Host stand-in for app/include/user_config.h */
+#ifndef __USER_CONFIG_H__
+#define __USER_CONFIG_H__
+
+#include <stddef.h>
+#include "params_test.h"
+
+#define NODE_DBG(...)
+
+/* as in the firmware, for the myspiffs_* glue in spiffs.c */
+#define SPIFFS_FIXED_LOCATION 0
+#define SPIFFS_CACHE_PAGES 4
+#define SPIFFS_READAHEAD 128
+
+#endif
@@ -0,0 +1,12 @@
+/* Host stand-in for the SDK's user_interface.h */
+#ifndef __USER_INTERFACE_H__
+#define __USER_INTERFACE_H__
+
+#include "c_stdint.h"
+
+#define LUA_TASK_PRIO 0
+#define LUA_FS_GC_SIG 3
+
+int system_os_post( uint8_t prio, uint32_t sig, uint32_t par );
+
+#endif
@@ -0,0 +1,365 @@
+/*
+ * test_bench.c
+ *
+ * Flash operation benchmark and wear simulator. Replays typical firmware
+ * workloads on the emulated flash with the geometry myspiffs_mount() uses
+ * (256 byte pages, 4 KB blocks and erase sectors), and reports the flash
+ * traffic per logical byte, an estimated throughput and how the erases are
+ * spread over the blocks.
+ *
+ * Not part of the regular test run, build the test runner with
+ * -DSPIFFS_BENCH to run these instead of the other suites. Geometry and
+ * file system size can be changed with BENCH_PAGE_SIZE, BENCH_BLOCK_SIZE
+ * and BENCH_FS_SIZE, gc heuristics with the usual SPIFFS_GC_HEUR_* defines.
+ */
+
+#include "testrunner.h"
+#include "test_spiffs.h"
+#include "spiffs_nucleus.h"
+#include "spiffs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef BENCH_PAGE_SIZE
+#define BENCH_PAGE_SIZE     256
+#endif
+#ifndef BENCH_BLOCK_SIZE
+#define BENCH_BLOCK_SIZE    4096
+#endif
+#ifndef BENCH_FS_SIZE
+#define BENCH_FS_SIZE       (1024*1024)
+#endif
+#ifndef BENCH_FULL_PERCENT
+#define BENCH_FULL_PERCENT  90    // fill level of the nearly full workload
+#endif
+#define BENCH_PHYS_ADDR     SPIFFS_PHYS_ADDR
+
+// Flash timing used to estimate throughput, typical figures for the
+// W25Q32 class of chips on an ESP8266 at 40 MHz
+#define BENCH_READ_OP_NS    5000      // per read command
+#define BENCH_READ_BYTE_NS  100
+#define BENCH_PROG_OP_NS    30000     // first byte of a page program
+#define BENCH_PROG_BYTE_NS  2500      // each further byte
+#define BENCH_ERASE_NS      45000000  // 4 KB sector erase
+
+#define BENCH_CACHE_PAGES_MAX 8
+#define BENCH_FDS           4
+
+static u8_t bench_work[BENCH_PAGE_SIZE*2];
+static u8_t bench_fds[BENCH_FDS*sizeof(spiffs_fd)];
+static u8_t bench_cache[sizeof(spiffs_cache) +
+    BENCH_CACHE_PAGES_MAX*(sizeof(spiffs_cache_page) + BENCH_PAGE_SIZE) + 4];
+
+static const int bench_cache_pages[] = { 1, 2, 4, 8 };
+#define BENCH_CACHE_SIZES   (sizeof(bench_cache_pages)/sizeof(bench_cache_pages[0]))
+
+typedef struct {
+  u32_t rd_ops, rd_bytes;
+  u32_t wr_ops, wr_bytes;
+  u32_t erases;
+  clock_t cpu;
+} bench_stats;
+
+// erases a fresh file system and mounts it with given number of cache pages
+static void bench_mount(int cache_pages) {
+  fs_reset_specific(BENCH_PHYS_ADDR, BENCH_FS_SIZE, BENCH_BLOCK_SIZE,
+      BENCH_BLOCK_SIZE, BENCH_PAGE_SIZE);
+  spiffs_config c = __fs.cfg;
+  SPIFFS_unmount(FS);
+  memset(bench_cache, 0, sizeof(bench_cache));
+  SPIFFS_mount(FS, &c, bench_work, bench_fds, sizeof(bench_fds),
+      bench_cache, sizeof(spiffs_cache) +
+      cache_pages*(sizeof(spiffs_cache_page) + BENCH_PAGE_SIZE) + 4, 0);
+  clear_flash_ops_log();
+}
+
+static u32_t bench_total_erases() {
+  u32_t i, n = 0;
+  for (i = 0; i < BENCH_FS_SIZE / BENCH_BLOCK_SIZE; i++) {
+    n += get_flash_erase_count(i);
+  }
+  return n;
+}
+
+static void bench_begin(bench_stats *s) {
+  clear_flash_ops_log();
+  memset(s, 0, sizeof(*s));
+  s->erases = bench_total_erases();
+  s->cpu = clock();
+}
+
+static void bench_end(bench_stats *s) {
+  s->cpu = clock() - s->cpu;
+  s->erases = bench_total_erases() - s->erases;
+  s->rd_ops = get_flash_ops_log_reads();
+  s->rd_bytes = get_flash_ops_log_read_bytes();
+  s->wr_ops = get_flash_ops_log_writes();
+  s->wr_bytes = get_flash_ops_log_write_bytes();
+}
+
+static void bench_header(const char *title) {
+  printf("  %s\n", title);
+  printf("  %-14s %5s %8s %7s %7s %7s %7s %8s %8s  %s\n",
+      "workload", "cache", "bytes", "rd/B", "wr/B", "wrops/K", "ers/MB",
+      "est KB/s", "host ms", "erases min/avg/max");
+}
+
+// one line of results for logical bytes moved by the workload
+static void bench_report(const char *name, int cache_pages, u32_t logical, bench_stats *s) {
+  u32_t i, blocks = BENCH_FS_SIZE / BENCH_BLOCK_SIZE;
+  int emin = -1, emax = 0;
+  u32_t etot = 0;
+  for (i = 0; i < blocks; i++) {
+    int e = get_flash_erase_count(i);
+    if (emin < 0 || e < emin) emin = e;
+    if (e > emax) emax = e;
+    etot += e;
+  }
+  double ns =
+      (double)s->rd_ops * BENCH_READ_OP_NS + (double)s->rd_bytes * BENCH_READ_BYTE_NS +
+      (double)s->wr_ops * (BENCH_PROG_OP_NS - BENCH_PROG_BYTE_NS) +
+      (double)s->wr_bytes * BENCH_PROG_BYTE_NS + (double)s->erases * BENCH_ERASE_NS;
+  printf("  %-14s %5i %8u %7.2f %7.2f %7.2f %7.1f %8.1f %8.1f  %i/%.1f/%i\n",
+      name, cache_pages, logical,
+      (double)s->rd_bytes / logical,
+      (double)s->wr_bytes / logical,
+      (double)s->wr_ops * 1024 / logical,
+      (double)s->erases * 1024 * 1024 / logical,
+      ns > 0 ? (double)logical / 1024 / (ns / 1e9) : 0.0,
+      (double)s->cpu * 1000 / CLOCKS_PER_SEC,
+      emin, (double)etot / blocks, emax);
+}
+
+// erase count histogram over all blocks of the file system
+static void bench_erase_histogram() {
+  u32_t i, blocks = BENCH_FS_SIZE / BENCH_BLOCK_SIZE;
+  int emax = 0, width;
+  int bins[10];
+  for (i = 0; i < blocks; i++) {
+    if (get_flash_erase_count(i) > emax) emax = get_flash_erase_count(i);
+  }
+  width = emax / 10 + 1;
+  memset(bins, 0, sizeof(bins));
+  for (i = 0; i < blocks; i++) {
+    bins[get_flash_erase_count(i) / width]++;
+  }
+  printf("  erase count histogram, %i blocks:\n", blocks);
+  for (i = 0; i < 10 && (int)i * width <= emax; i++) {
+    printf("    %5i - %5i : %i\n", (int)i * width, ((int)i + 1) * width - 1, bins[i]);
+  }
+}
+
+static int bench_verify(const char *name, u8_t *expect, u32_t len, u32_t chunk) {
+  u8_t buf[1024];
+  u32_t offs = 0;
+  spiffs_file fd = SPIFFS_open(FS, (char *)name, SPIFFS_RDONLY, 0);
+  if (fd < 0) return -1;
+  while (offs < len) {
+    u32_t n = MIN(chunk, len - offs);
+    if (SPIFFS_read(FS, fd, buf, n) != (s32_t)n || memcmp(buf, expect + offs, n) != 0) {
+      printf("  mismatch in %s at %i\n", name, offs);
+      SPIFFS_close(FS, fd);
+      return -1;
+    }
+    offs += n;
+  }
+  SPIFFS_close(FS, fd);
+  return 0;
+}
+
+
+SUITE(bench_tests)
+void setup() {
+  _setup_test_only();
+}
+void teardown() {
+  SPIFFS_unmount(FS);
+}
+
+// Sensor logging: 24 to 64 byte records appended to one file, which is
+// closed and opened again every 100 records, plain and in SPIFFS_LOG mode
+TEST(bench_small_appends) {
+  const u32_t total = 128*1024;
+  u8_t *data = malloc(total);
+  int mode, c;
+  memrand(data, total);
+  bench_header("small appends, 128 KB of 24-64 byte records");
+  for (mode = 0; mode < 2; mode++) {
+    for (c = 0; c < BENCH_CACHE_SIZES; c++) {
+      bench_stats s;
+      u32_t len = 0;
+      int recs = 0;
+      spiffs_flags flags = SPIFFS_CREAT | SPIFFS_WRONLY | SPIFFS_APPEND | (mode ? SPIFFS_LOG : 0);
+      bench_mount(bench_cache_pages[c]);
+      srand(1);
+      bench_begin(&s);
+      spiffs_file fd = SPIFFS_open(FS, "log", flags, 0);
+      TEST_CHECK(fd >= 0);
+      while (len < total) {
+        u32_t n = MIN(24 + rand() % 41, total - len);
+        TEST_CHECK(SPIFFS_write(FS, fd, data + len, n) == (s32_t)n);
+        len += n;
+        if (++recs % 100 == 0) {
+          SPIFFS_close(FS, fd);
+          fd = SPIFFS_open(FS, "log", flags, 0);
+          TEST_CHECK(fd >= 0);
+        }
+      }
+      SPIFFS_close(FS, fd);
+      bench_end(&s);
+      bench_report(mode ? "append log" : "append", bench_cache_pages[c], total, &s);
+      TEST_CHECK(bench_verify("log", data, total, 256) == 0);
+    }
+  }
+  free(data);
+  return TEST_RES_OK;
+} TEST_END(bench_small_appends)
+
+// Settings: a 512 byte file opened with "w" and rewritten 2000 times
+TEST(bench_config_rewrite) {
+  const u32_t size = 512;
+  const int rewrites = 2000;
+  u8_t data[512];
+  int c, i;
+  bench_header("config rewrite, 512 byte file written 2000 times");
+  for (c = 0; c < BENCH_CACHE_SIZES; c++) {
+    bench_stats s;
+    bench_mount(bench_cache_pages[c]);
+    bench_begin(&s);
+    for (i = 0; i < rewrites; i++) {
+      memrand(data, size);
+      spiffs_file fd = SPIFFS_open(FS, "config", SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_WRONLY, 0);
+      TEST_CHECK(fd >= 0);
+      TEST_CHECK(SPIFFS_write(FS, fd, data, size) == (s32_t)size);
+      SPIFFS_close(FS, fd);
+    }
+    bench_end(&s);
+    bench_report("rewrite", bench_cache_pages[c], size * rewrites, &s);
+    TEST_CHECK(bench_verify("config", data, size, size) == 0);
+  }
+  return TEST_RES_OK;
+} TEST_END(bench_config_rewrite)
+
+// Large files: 256 KB written in 1 KB chunks, read back in 1 KB chunks and
+// in 64 byte chunks
+TEST(bench_stream) {
+  const u32_t total = 256*1024;
+  u8_t *data = malloc(total);
+  int c;
+  memrand(data, total);
+  bench_header("streaming, 256 KB file");
+  for (c = 0; c < BENCH_CACHE_SIZES; c++) {
+    bench_stats s;
+    u32_t offs;
+    bench_mount(bench_cache_pages[c]);
+    bench_begin(&s);
+    spiffs_file fd = SPIFFS_open(FS, "stream", SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_WRONLY, 0);
+    TEST_CHECK(fd >= 0);
+    for (offs = 0; offs < total; offs += 1024) {
+      TEST_CHECK(SPIFFS_write(FS, fd, data + offs, 1024) == 1024);
+    }
+    SPIFFS_close(FS, fd);
+    bench_end(&s);
+    bench_report("write 1K", bench_cache_pages[c], total, &s);
+
+    bench_begin(&s);
+    TEST_CHECK(bench_verify("stream", data, total, 1024) == 0);
+    bench_end(&s);
+    bench_report("read 1K", bench_cache_pages[c], total, &s);
+
+    bench_begin(&s);
+    TEST_CHECK(bench_verify("stream", data, total, 64) == 0);
+    bench_end(&s);
+    bench_report("read 64", bench_cache_pages[c], total, &s);
+  }
+  free(data);
+  return TEST_RES_OK;
+} TEST_END(bench_stream)
+
+// Wear: the file system is filled with files that never change, so that
+// with the files below it is BENCH_FULL_PERCENT full, then a 4 KB file is rewritten and a
+// log of up to 32 KB appended to until 16 times the file system size has
+// been offered. Writes that fail are counted rather than fatal, as how
+// often the gc can not make room in time depends on its heuristics
+TEST(bench_nearly_full) {
+  const u32_t static_size = 16*1024;
+  u8_t data[4096];
+  u8_t state[4096];
+  u32_t total, written, full, i;
+  int c, state_ok, fails;
+  char title[80];
+  sprintf(title, "nearly full, %i%% used, 4 KB rewrites and 64 byte appends", BENCH_FULL_PERCENT);
+  bench_header(title);
+  for (c = 0; c < BENCH_CACHE_SIZES; c++) {
+    bench_stats s;
+    char name[32];
+    u32_t room, used;
+    spiffs_file fd;
+    bench_mount(bench_cache_pages[c]);
+    SPIFFS_info(FS, &room, &used);
+    // leave room for the log and two copies of the rewritten file
+    room = room / 100 * BENCH_FULL_PERCENT - 32*1024 - 2*sizeof(data);
+    set_flash_ops_log(0);
+    for (i = 0; (i + 1) * static_size <= room; i++) {
+      u32_t offs;
+      sprintf(name, "static%i", i);
+      fd = SPIFFS_open(FS, name, SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_WRONLY, 0);
+      TEST_CHECK(fd >= 0);
+      for (offs = 0; offs < static_size; offs += sizeof(data)) {
+        memrand(data, sizeof(data));
+        TEST_CHECK(SPIFFS_write(FS, fd, data, sizeof(data)) == sizeof(data));
+      }
+      SPIFFS_close(FS, fd);
+    }
+    set_flash_ops_log(1);
+
+    total = 16 * BENCH_FS_SIZE;
+    written = full = 0;
+    state_ok = fails = 0;
+    bench_begin(&s);
+    while (written + full < total) {
+      memrand(data, sizeof(data));
+      fd = SPIFFS_open(FS, "state", SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_WRONLY, 0);
+      state_ok = fd >= 0 && SPIFFS_write(FS, fd, data, sizeof(data)) == sizeof(data);
+      if (fd >= 0) SPIFFS_close(FS, fd);
+      if (state_ok) {
+        memcpy(state, data, sizeof(data));
+        written += sizeof(data);
+        fails = 0;
+      } else {
+        full += sizeof(data);
+        if (++fails >= 100) {
+          printf("  %-14s %5i gave up after 100 failed rewrites in a row\n", "", bench_cache_pages[c]);
+          break;
+        }
+      }
+      fd = SPIFFS_open(FS, "log", SPIFFS_CREAT | SPIFFS_WRONLY | SPIFFS_APPEND, 0);
+      for (i = 0; i < 16; i++) {
+        if (fd < 0 || SPIFFS_write(FS, fd, data + i * 64, 64) != 64) {
+          full += (16 - i) * 64;
+          break;
+        }
+        written += 64;
+      }
+      if (fd >= 0) SPIFFS_close(FS, fd);
+      spiffs_stat st;
+      if (SPIFFS_stat(FS, "log", &st) == SPIFFS_OK && st.size >= 32*1024) {
+        TEST_CHECK(SPIFFS_remove(FS, "log") >= 0);
+      }
+    }
+    bench_end(&s);
+    bench_report("churn", bench_cache_pages[c], written, &s);
+    if (full > 0) {
+      printf("  %-14s %5i %8u bytes failed to write\n", "", bench_cache_pages[c], full);
+    }
+    if (state_ok) {
+      TEST_CHECK(bench_verify("state", state, sizeof(state), 256) == 0);
+    }
+  }
+  bench_erase_histogram();
+  return TEST_RES_OK;
+} TEST_END(bench_nearly_full)
+
+SUITE_END(bench_tests)
@@ -10,6 +10,7 @@
 #include "test_spiffs.h"
 #include "spiffs_nucleus.h"
 #include "spiffs.h"
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -0,0 +1,629 @@
+/*
+ * test_glue.c
+ *
+ * Tests of the myspiffs_* glue in spiffs.c that the firmware's fs_* calls
+ * map to, run on a RAM flash behind the platform_flash_* calls it uses.
+ */
+
+#include "testrunner.h"
+#include "test_spiffs.h"
+#include "spiffs_nucleus.h"
+#include "spiffs.h"
+#include "platform.h"
+#include "user_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+extern spiffs fs;
+
+static u8_t glue_flash[INTERNAL_FLASH_SIZE];
+// bytes that can still be programmed before the power goes, -1 for no limit;
+// then the next flash operation jumps to glue_power_cut instead
+static int glue_power_left = -1;
+static jmp_buf glue_power_cut;
+
+uint32_t platform_flash_get_first_free_block_address( uint32_t *psect ) {
+  if (psect) *psect = 0;
+  return 0;
+}
+
+uint32_t platform_flash_get_sector_of_address( uint32_t addr ) {
+  return addr / INTERNAL_FLASH_SECTOR_SIZE;
+}
+
+// programming can only clear bits, as on NOR flash
+uint32_t platform_flash_write( const void *from, uint32_t toaddr, uint32_t size ) {
+  const u8_t *src = (const u8_t *)from;
+  uint32_t i;
+  for (i = 0; i < size; i++) {
+    if (glue_power_left == 0) longjmp(glue_power_cut, 1);
+    glue_flash[toaddr + i] &= src[i];
+    if (glue_power_left > 0) glue_power_left--;
+  }
+  return size;
+}
+
+uint32_t platform_flash_read( void *to, uint32_t fromaddr, uint32_t size ) {
+  memcpy(to, &glue_flash[fromaddr], size);
+  return size;
+}
+
+int platform_flash_erase_sector( uint32_t sector_id ) {
+  if (glue_power_left == 0) longjmp(glue_power_cut, 1);
+  memset(&glue_flash[sector_id * INTERNAL_FLASH_SECTOR_SIZE], 0xff,
+      INTERNAL_FLASH_SECTOR_SIZE);
+  return PLATFORM_OK;
+}
+
+uint32_t platform_flash_phys2mapped( uint32_t phys_addr ) {
+  return (uint32_t)-1;
+}
+
+int system_os_post( uint8_t prio, uint32_t sig, uint32_t par ) {
+  return 1;
+}
+
+// formats and mounts the emulated flash through the glue
+static void glue_reset() {
+  memset(glue_flash, 0xff, sizeof(glue_flash));
+  myspiffs_format();
+}
+
+// power comes back after a cut, what was in RAM is gone and mounting
+// recovers what was cut short
+static void glue_reboot() {
+  fs.mounted = 0;
+  myspiffs_unmount();
+  glue_power_left = -1;
+  myspiffs_mount();
+}
+
+// the number of files, and whether name is one of them
+static int glue_files(const char *name, int *found) {
+  spiffs_DIR d;
+  struct spiffs_dirent e;
+  int n = 0;
+  *found = 0;
+  SPIFFS_opendir(&fs, "/", &d);
+  while (SPIFFS_readdir(&d, &e)) {
+    n++;
+    if (strcmp((char *)e.name, name) == 0) *found = 1;
+  }
+  SPIFFS_closedir(&d);
+  return n;
+}
+
+// how many entries myspiffs_readdir() gives for prefix, each checked to
+// start with it and to have the size the file was created with
+static int glue_count(const char *prefix, int size) {
+  spiffs_DIR d;
+  struct spiffs_dirent e;
+  int n = 0;
+  SPIFFS_opendir(&fs, "/", &d);
+  while (myspiffs_readdir(&d, prefix, &e)) {
+    if (strncmp((char *)e.name, prefix, strlen(prefix)) || e.size != size)
+      n = -1000;
+    n++;
+  }
+  SPIFFS_closedir(&d);
+  return n;
+}
+
+// the directory entry of name, 0 if found
+static int glue_entry(const char *name, struct spiffs_dirent *e) {
+  spiffs_DIR d;
+  int res = -1;
+  SPIFFS_opendir(&fs, "/", &d);
+  while (res && myspiffs_readdir(&d, name, e))
+    if (strcmp((char *)e->name, name) == 0) res = 0;
+  SPIFFS_closedir(&d);
+  return res;
+}
+
+static int glue_create(const char *name, const u8_t *data, int len) {
+  int fd = myspiffs_open(name, SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR);
+  if (fd < 0) return -1;
+  if (myspiffs_write(fd, data, len) != len) return -1;
+  myspiffs_close(fd);
+  return 0;
+}
+
+// compares the whole of a file with data
+static int glue_verify(const char *name, const u8_t *data, int len) {
+  u8_t buf[256];
+  int fd = myspiffs_open(name, SPIFFS_RDONLY);
+  int pos = 0;
+  if (fd < 0) return -1;
+  while (pos < len) {
+    int n = len - pos < sizeof(buf) ? len - pos : sizeof(buf);
+    if (myspiffs_read(fd, buf, n) != n || memcmp(buf, data + pos, n)) {
+      myspiffs_close(fd);
+      return -1;
+    }
+    pos += n;
+  }
+  if (myspiffs_getc(fd) != EOF) pos = -1;
+  myspiffs_close(fd);
+  return pos == len ? 0 : -1;
+}
+
+
+SUITE(glue_tests)
+void setup() {
+  _setup_test_only();
+}
+void teardown() {
+  glue_power_left = -1;
+  myspiffs_unmount();
+  _teardown();
+}
+
+// getc, ungetc, small reads, seeks and writes on one fd, each checked
+// against the file contents
+TEST(readahead_mixed) {
+#define RA_LEN  1000
+  u8_t data[RA_LEN + 4];
+  u8_t buf[40];
+  int i;
+  glue_reset();
+  for (i = 0; i < RA_LEN; i++) data[i] = i * 7 + (i >> 8);
+  TEST_CHECK(glue_create("ra", data, RA_LEN) == 0);
+
+  int fd = myspiffs_open("ra", SPIFFS_RDWR);
+  TEST_CHECK(fd >= 0);
+  for (i = 0; i < 10; i++)
+    TEST_CHECK(myspiffs_getc(fd) == data[i]);
+  TEST_CHECK(myspiffs_tell(fd) == 10);
+
+  // back into the buffer, and write over what it holds
+  TEST_CHECK(myspiffs_lseek(fd, 5, SPIFFS_SEEK_SET) == 5);
+  TEST_CHECK(myspiffs_getc(fd) == data[5]);
+  TEST_CHECK(myspiffs_write(fd, "XYZ", 3) == 3);
+  memcpy(&data[6], "XYZ", 3);
+  TEST_CHECK(myspiffs_tell(fd) == 9);
+  TEST_CHECK(myspiffs_getc(fd) == data[9]);
+  TEST_CHECK(myspiffs_lseek(fd, 4, SPIFFS_SEEK_SET) == 4);
+  TEST_CHECK(myspiffs_read(fd, buf, 8) == 8);
+  TEST_CHECK(memcmp(buf, &data[4], 8) == 0);
+
+  // ungetc steps back over the last byte read
+  TEST_CHECK(myspiffs_getc(fd) == data[12]);
+  TEST_CHECK(myspiffs_ungetc(data[12], fd) == data[12]);
+  TEST_CHECK(myspiffs_tell(fd) == 12);
+  TEST_CHECK(myspiffs_getc(fd) == data[12]);
+
+  // relative seeks in and past the buffer, then reads across its end
+  TEST_CHECK(myspiffs_lseek(fd, 100, SPIFFS_SEEK_CUR) == 113);
+  TEST_CHECK(myspiffs_read(fd, buf, sizeof(buf)) == sizeof(buf));
+  TEST_CHECK(memcmp(buf, &data[113], sizeof(buf)) == 0);
+  TEST_CHECK(myspiffs_lseek(fd, -30, SPIFFS_SEEK_CUR) == 123);
+  for (i = 123; i < 400; i++)
+    TEST_CHECK(myspiffs_getc(fd) == data[i]);
+
+  // a write past the buffered data, then reading what lies before it
+  TEST_CHECK(myspiffs_lseek(fd, 600, SPIFFS_SEEK_SET) == 600);
+  TEST_CHECK(myspiffs_write(fd, "0123456789", 10) == 10);
+  memcpy(&data[600], "0123456789", 10);
+  TEST_CHECK(myspiffs_lseek(fd, 590, SPIFFS_SEEK_SET) == 590);
+  TEST_CHECK(myspiffs_read(fd, buf, 30) == 30);
+  TEST_CHECK(memcmp(buf, &data[590], 30) == 0);
+
+  // the end of the file
+  TEST_CHECK(myspiffs_lseek(fd, -3, SPIFFS_SEEK_END) == RA_LEN - 3);
+  TEST_CHECK(!myspiffs_eof(fd));
+  for (i = RA_LEN - 3; i < RA_LEN; i++)
+    TEST_CHECK(myspiffs_getc(fd) == data[i]);
+  TEST_CHECK(myspiffs_getc(fd) == EOF);
+  TEST_CHECK(myspiffs_eof(fd));
+  TEST_CHECK(myspiffs_tell(fd) == RA_LEN);
+
+  // appending at the end, then reading it back through the same fd
+  TEST_CHECK(myspiffs_write(fd, "tail", 4) == 4);
+  memcpy(&data[RA_LEN], "tail", 4);
+  TEST_CHECK(myspiffs_lseek(fd, RA_LEN - 2, SPIFFS_SEEK_SET) == RA_LEN - 2);
+  TEST_CHECK(myspiffs_read(fd, buf, 10) == 6);
+  TEST_CHECK(memcmp(buf, &data[RA_LEN - 2], 6) == 0);
+  myspiffs_close(fd);
+
+  TEST_CHECK(glue_verify("ra", data, sizeof(data)) == 0);
+  return TEST_RES_OK;
+} TEST_END(readahead_mixed)
+
+// lines read with getc as file.readline() does, crossing buffer
+// boundaries, with seeks back to the start of a line and rewrites of it
+TEST(readahead_readline) {
+  char text[3000];
+  int starts[200];
+  int lines = 0, len = 0, i;
+  glue_reset();
+  while (len < sizeof(text) - 300) {
+    int n = (lines * 37) % 290;
+    starts[lines++] = len;
+    for (i = 0; i < n; i++) text[len++] = 'a' + (lines + i) % 26;
+    text[len++] = '\n';
+  }
+  TEST_CHECK(glue_create("lines", (u8_t *)text, len) == 0);
+
+  int fd = myspiffs_open("lines", SPIFFS_RDWR);
+  TEST_CHECK(fd >= 0);
+  for (i = 0; i < lines; i++) {
+    int c, pos = starts[i];
+    TEST_CHECK(myspiffs_tell(fd) == pos);
+    while ((c = myspiffs_getc(fd)) != '\n') {
+      TEST_CHECK(c == (u8_t)text[pos]);
+      pos++;
+    }
+    if (i % 5 == 4) {
+      // read the line once more, and overwrite its first byte
+      TEST_CHECK(myspiffs_lseek(fd, starts[i], SPIFFS_SEEK_SET) == starts[i]);
+      if (text[starts[i]] != '\n') {
+        TEST_CHECK(myspiffs_write(fd, "#", 1) == 1);
+        text[starts[i]] = '#';
+      }
+      TEST_CHECK(myspiffs_lseek(fd, starts[i], SPIFFS_SEEK_SET) == starts[i]);
+      pos = starts[i];
+      while ((c = myspiffs_getc(fd)) != '\n') {
+        TEST_CHECK(c == (u8_t)text[pos]);
+        pos++;
+      }
+    }
+  }
+  TEST_CHECK(myspiffs_getc(fd) == EOF);
+  myspiffs_close(fd);
+
+  TEST_CHECK(glue_verify("lines", (u8_t *)text, len) == 0);
+  return TEST_RES_OK;
+} TEST_END(readahead_readline)
+
+// random getc, ungetc, read, seek, tell, eof and write on one fd against
+// a model of the file, with more fds open than there are buffers
+TEST(readahead_random) {
+#define RA_FILES  6
+#define RA_SIZE   1500
+  static u8_t model[RA_FILES][RA_SIZE + 512];
+  int size[RA_FILES], pos[RA_FILES], fd[RA_FILES];
+  u8_t buf[300];
+  int f, op;
+  glue_reset();
+  srand(0x5eed);
+  for (f = 0; f < RA_FILES; f++) {
+    char name[8];
+    sprintf(name, "r%d", f);
+    memrand(model[f], RA_SIZE);
+    TEST_CHECK(glue_create(name, model[f], RA_SIZE) == 0);
+    fd[f] = myspiffs_open(name, SPIFFS_RDWR);
+    TEST_CHECK(fd[f] >= 0);
+    size[f] = RA_SIZE;
+    pos[f] = 0;
+  }
+
+  for (op = 0; op < 40000; op++) {
+    int i, n, res;
+    f = rand() % RA_FILES;
+    switch (rand() % 9) {
+    case 0:
+    case 1:
+      res = myspiffs_getc(fd[f]);
+      TEST_CHECK(res == (pos[f] < size[f] ? model[f][pos[f]++] : EOF));
+      break;
+    case 2:
+      if (pos[f] > 0 && pos[f] <= size[f]) {
+        TEST_CHECK(myspiffs_ungetc(model[f][pos[f] - 1], fd[f]) >= 0);
+        pos[f]--;
+      }
+      break;
+    case 3:
+      n = rand() % 2 ? rand() % 16 : rand() % sizeof(buf);
+      res = myspiffs_read(fd[f], buf, n);
+      i = size[f] - pos[f] < n ? size[f] - pos[f] : n;
+      TEST_CHECK(res == i);
+      TEST_CHECK(memcmp(buf, &model[f][pos[f]], res) == 0);
+      pos[f] += res;
+      break;
+    case 4:
+      n = rand() % 3;
+      i = rand() % 200 - 100;
+      if (n == SPIFFS_SEEK_SET) i = rand() % size[f];
+      else if (n == SPIFFS_SEEK_END) i = -(rand() % size[f]);
+      else if (pos[f] + i < 0 || pos[f] + i > size[f]) i = 0;
+      res = myspiffs_lseek(fd[f], i, n);
+      pos[f] = (n == SPIFFS_SEEK_SET ? 0 : n == SPIFFS_SEEK_CUR ? pos[f] : size[f]) + i;
+      TEST_CHECK(res == pos[f]);
+      break;
+    case 5:
+      TEST_CHECK(myspiffs_tell(fd[f]) == pos[f]);
+      TEST_CHECK(!myspiffs_eof(fd[f]) == (pos[f] < size[f]));
+      break;
+    case 6:
+      n = 1 + rand() % 64;
+      if (pos[f] + n > RA_SIZE + 512) break;
+      memrand(buf, n);
+      TEST_CHECK(myspiffs_write(fd[f], buf, n) == n);
+      memcpy(&model[f][pos[f]], buf, n);
+      pos[f] += n;
+      if (pos[f] > size[f]) size[f] = pos[f];
+      break;
+    case 7:
+      TEST_CHECK(myspiffs_size(fd[f]) == size[f]);
+      break;
+    case 8:
+      // reopening drops the buffer
+      if (rand() % 20 == 0) {
+        char name[8];
+        sprintf(name, "r%d", f);
+        myspiffs_close(fd[f]);
+        fd[f] = myspiffs_open(name, SPIFFS_RDWR);
+        TEST_CHECK(fd[f] >= 0);
+        pos[f] = 0;
+      }
+      break;
+    }
+  }
+
+  for (f = 0; f < RA_FILES; f++) {
+    char name[8];
+    sprintf(name, "r%d", f);
+    myspiffs_close(fd[f]);
+    TEST_CHECK(glue_verify(name, model[f], size[f]) == 0);
+  }
+  return TEST_RES_OK;
+} TEST_END(readahead_random)
+
+// replacements put in place or thrown away, leaving no other files
+TEST(replace) {
+  u8_t old[700], new[900];
+  int fd, found;
+  glue_reset();
+  memrand(old, sizeof(old));
+  memrand(new, sizeof(new));
+  TEST_CHECK(glue_create("cfg", old, sizeof(old)) == 0);
+
+  fd = myspiffs_replace_open("cfg");
+  TEST_CHECK(fd >= 0);
+  TEST_CHECK(myspiffs_write(fd, new, 100) == 100);
+  TEST_CHECK(myspiffs_replace_close(fd, "cfg", 0) == 0);
+  TEST_CHECK(glue_verify("cfg", old, sizeof(old)) == 0);
+  TEST_CHECK(glue_files("cfg", &found) == 1 && found);
+
+  fd = myspiffs_replace_open("cfg");
+  TEST_CHECK(fd >= 0);
+  TEST_CHECK(myspiffs_write(fd, new, sizeof(new)) == sizeof(new));
+  TEST_CHECK(myspiffs_replace_close(fd, "cfg", 1) == 1);
+  TEST_CHECK(glue_verify("cfg", new, sizeof(new)) == 0);
+  TEST_CHECK(glue_files("cfg", &found) == 1 && found);
+
+  // a file that did not exist before
+  fd = myspiffs_replace_open("other");
+  TEST_CHECK(fd >= 0);
+  TEST_CHECK(myspiffs_write(fd, old, sizeof(old)) == sizeof(old));
+  TEST_CHECK(myspiffs_replace_close(fd, "other", 1) == 1);
+  TEST_CHECK(glue_verify("other", old, sizeof(old)) == 0);
+  TEST_CHECK(glue_files("other", &found) == 2 && found);
+  return TEST_RES_OK;
+} TEST_END(replace)
+
+// renaming an open file keeps the fd writing to it
+TEST(frename) {
+  u8_t data[600];
+  int found;
+  glue_reset();
+  memrand(data, sizeof(data));
+  TEST_CHECK(glue_create("taken", data, 10) == 0);
+
+  int fd = myspiffs_open("a", SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR);
+  TEST_CHECK(fd >= 0);
+  TEST_CHECK(myspiffs_write(fd, data, 300) == 300);
+  TEST_CHECK(SPIFFS_frename(&fs, fd, "taken") < 0);
+  TEST_CHECK(SPIFFS_errno(&fs) == SPIFFS_ERR_CONFLICTING_NAME);
+  TEST_CHECK(SPIFFS_frename(&fs, fd, "b") == SPIFFS_OK);
+  TEST_CHECK(myspiffs_write(fd, data + 300, 300) == 300);
+  myspiffs_close(fd);
+
+  TEST_CHECK(glue_verify("b", data, sizeof(data)) == 0);
+  TEST_CHECK(glue_verify("taken", data, 10) == 0);
+  TEST_CHECK(glue_files("a", &found) == 2 && !found);
+  return TEST_RES_OK;
+} TEST_END(frename)
+
+// what a reset leaves of a replacement is sorted out at mount
+TEST(replace_recover) {
+  u8_t old[300], new[500];
+  int found;
+  glue_reset();
+  memrand(old, sizeof(old));
+  memrand(new, sizeof(new));
+
+  // cut short while writing the new content
+  TEST_CHECK(glue_create("cfg", old, sizeof(old)) == 0);
+  TEST_CHECK(glue_create("cfg\x01", new, 100) == 0);
+  glue_reboot();
+  TEST_CHECK(glue_verify("cfg", old, sizeof(old)) == 0);
+  TEST_CHECK(glue_files("cfg", &found) == 1 && found);
+
+  // cut short after the new content was complete
+  TEST_CHECK(glue_create("cfg\x02", new, sizeof(new)) == 0);
+  glue_reboot();
+  TEST_CHECK(glue_verify("cfg", new, sizeof(new)) == 0);
+  TEST_CHECK(glue_files("cfg", &found) == 1 && found);
+
+  // same, with the old file already removed
+  TEST_CHECK(SPIFFS_remove(&fs, "cfg") == SPIFFS_OK);
+  TEST_CHECK(glue_create("cfg\x02", old, sizeof(old)) == 0);
+  glue_reboot();
+  TEST_CHECK(glue_verify("cfg", old, sizeof(old)) == 0);
+  TEST_CHECK(glue_files("cfg", &found) == 1 && found);
+  return TEST_RES_OK;
+} TEST_END(replace_recover)
+
+// a power cut at every byte programmed during a replacement, including
+// between writing a renamed index header and deleting the old one, leaves
+// either the old or the new content under the name, and nothing else
+TEST(replace_power_cut) {
+  u8_t old[700], new[900];
+  int total, cut, found, fd;
+  int saw_old = 0, saw_new = 0;
+  memrand(old, sizeof(old));
+  memrand(new, sizeof(new));
+
+  for (cut = 0; ; cut++) {
+    glue_reset();
+    TEST_CHECK(glue_create("cfg", old, sizeof(old)) == 0);
+    glue_power_left = cut;
+    if (!setjmp(glue_power_cut)) {
+      fd = myspiffs_replace_open("cfg");
+      TEST_CHECK(fd >= 0);
+      TEST_CHECK(myspiffs_write(fd, new, sizeof(new)) == sizeof(new));
+      TEST_CHECK(myspiffs_replace_close(fd, "cfg", 1) == 1);
+      break;  // all of it went through
+    }
+    glue_reboot();
+
+    if (glue_verify("cfg", old, sizeof(old)) == 0) {
+      saw_old++;
+    } else {
+      TEST_CHECK(glue_verify("cfg", new, sizeof(new)) == 0);
+      saw_new++;
+    }
+    TEST_CHECK(glue_files("cfg", &found) == 1 && found);
+
+    // and the next replacement goes through
+    fd = myspiffs_replace_open("cfg");
+    TEST_CHECK(fd >= 0);
+    TEST_CHECK(myspiffs_write(fd, old, 10) == 10);
+    TEST_CHECK(myspiffs_replace_close(fd, "cfg", 1) == 1);
+    TEST_CHECK(glue_verify("cfg", old, 10) == 0);
+  }
+  total = cut;
+  printf("  %i cuts, old content after %i, new after %i\n", total, saw_old, saw_new);
+  TEST_CHECK(saw_old > 0 && saw_new > 0);
+  return TEST_RES_OK;
+} TEST_END(replace_power_cut)
+
+// listing by prefix, over more files than fit on one lookup page
+TEST(readdir_prefix) {
+  u8_t data[20];
+  char name[16];
+  int i;
+  glue_reset();
+  memrand(data, sizeof(data));
+  for (i = 0; i < 60; i++) {
+    sprintf(name, "%s%d", i % 3 ? "log/" : "cfg.", i);
+    TEST_CHECK(glue_create(name, data, 7) == 0);
+  }
+  TEST_CHECK(glue_count("", 7) == 60);
+  TEST_CHECK(glue_count("cfg.", 7) == 20);
+  TEST_CHECK(glue_count("log/", 7) == 40);
+  TEST_CHECK(glue_count("log/1", 7) == 8);
+  TEST_CHECK(glue_count("cfg.0", 7) == 1);
+  TEST_CHECK(glue_count("cfg.00", 7) == 0);
+  TEST_CHECK(glue_count("x", 7) == 0);
+  return TEST_RES_OK;
+} TEST_END(readdir_prefix)
+
+// entries are read one at a time as file.entries() does, with other file
+// system calls in between, and each file comes up once
+TEST(readdir_entries) {
+  u8_t data[300];
+  u8_t seen[30];
+  char name[16];
+  spiffs_DIR d;
+  struct spiffs_dirent e;
+  int i, n = 0;
+  glue_reset();
+  memrand(data, sizeof(data));
+  memset(seen, 0, sizeof(seen));
+  for (i = 0; i < 30; i++) {
+    sprintf(name, "e%d", i);
+    TEST_CHECK(glue_create(name, data, i * 10) == 0);
+  }
+  TEST_CHECK(glue_create("other", data, sizeof(data)) == 0);
+
+  SPIFFS_opendir(&fs, "/", &d);
+  while (myspiffs_readdir(&d, "e", &e)) {
+    TEST_CHECK(sscanf((char *)e.name, "e%d", &i) == 1 && i >= 0 && i < 30);
+    TEST_CHECK(!seen[i] && e.size == i * 10);
+    seen[i] = 1;
+    n++;
+    TEST_CHECK(glue_verify("other", data, sizeof(data)) == 0);
+  }
+  SPIFFS_closedir(&d);
+  TEST_CHECK(n == 30);
+  return TEST_RES_OK;
+} TEST_END(readdir_entries)
+
+// what file.stat() returns
+TEST(stat) {
+  u8_t data[700];
+  spiffs_stat st;
+  glue_reset();
+  memrand(data, sizeof(data));
+  TEST_CHECK(glue_create("big", data, sizeof(data)) == 0);
+  TEST_CHECK(glue_create("empty", data, 0) == 0);
+
+  TEST_CHECK(SPIFFS_stat(&fs, "big", &st) == SPIFFS_OK);
+  TEST_CHECK(strcmp((char *)st.name, "big") == 0);
+  TEST_CHECK(st.size == sizeof(data) && st.type == SPIFFS_TYPE_FILE);
+  TEST_CHECK(SPIFFS_stat(&fs, "empty", &st) == SPIFFS_OK);
+  TEST_CHECK(strcmp((char *)st.name, "empty") == 0 && st.size == 0);
+#if SPIFFS_OBJ_META_LEN
+  // not stamped yet
+  int i;
+  for (i = 0; i < SPIFFS_OBJ_META_LEN; i++)
+    TEST_CHECK(st.meta[i] == 0xff);
+#endif
+  TEST_CHECK(SPIFFS_stat(&fs, "none", &st) < 0);
+  TEST_CHECK(SPIFFS_errno(&fs) == SPIFFS_ERR_NOT_FOUND);
+  SPIFFS_clearerr(&fs);
+  return TEST_RES_OK;
+} TEST_END(stat)
+
+#if SPIFFS_OBJ_META_LEN
+// the first update programs the erased metadata of the index header in
+// place, later ones move the header to a new page
+TEST(fupdate_meta) {
+  u8_t data[600], meta[SPIFFS_OBJ_META_LEN];
+  u32_t written, programmed, before;
+  struct spiffs_dirent e;
+  spiffs_page_ix hdr;
+  spiffs_stat st;
+  int fd, found;
+  glue_reset();
+  memrand(data, sizeof(data));
+  fd = myspiffs_open("f", SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR);
+  TEST_CHECK(fd >= 0);
+  TEST_CHECK(myspiffs_write(fd, data, sizeof(data)) == sizeof(data));
+  TEST_CHECK(myspiffs_flush(fd) >= 0);
+  TEST_CHECK(glue_entry("f", &e) == 0);
+  hdr = e.pix;
+
+  // in place
+  memset(meta, 0xff, sizeof(meta));
+  meta[0] = 0x12;
+  myspiffs_writestats(&written, &before, &written);
+  TEST_CHECK(SPIFFS_fupdate_meta(&fs, fd, meta) == SPIFFS_OK);
+  myspiffs_writestats(&written, &programmed, &written);
+  TEST_CHECK(programmed - before == SPIFFS_OBJ_META_LEN);
+  TEST_CHECK(glue_entry("f", &e) == 0 && e.pix == hdr);
+  TEST_CHECK(memcmp(e.meta, meta, sizeof(meta)) == 0);
+
+  // moved
+  memset(meta, 0x5a, sizeof(meta));
+  TEST_CHECK(SPIFFS_fupdate_meta(&fs, fd, meta) == SPIFFS_OK);
+  TEST_CHECK(glue_entry("f", &e) == 0 && e.pix != hdr);
+  TEST_CHECK(memcmp(e.meta, meta, sizeof(meta)) == 0);
+
+  // the fd follows the header
+  TEST_CHECK(myspiffs_write(fd, data, 10) == 10);
+  myspiffs_close(fd);
+  glue_reboot();
+  TEST_CHECK(SPIFFS_stat(&fs, "f", &st) == SPIFFS_OK);
+  TEST_CHECK(st.size == sizeof(data) + 10);
+  TEST_CHECK(memcmp(st.meta, meta, sizeof(meta)) == 0);
+  TEST_CHECK(glue_files("f", &found) == 1 && found);
+  return TEST_RES_OK;
+} TEST_END(fupdate_meta)
+#endif
+
+SUITE_END(glue_tests)
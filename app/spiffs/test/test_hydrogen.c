@@ -10,12 +10,40 @@
 #include "test_spiffs.h"
 #include "spiffs_nucleus.h"
 #include "spiffs.h"
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <dirent.h>
 #include <unistd.h>
 
+// log records with plenty of 0xff, which must not be taken for unwritten flash
+static void log_record(u8_t *b, int len) {
+  int i;
+  memrand(b, len);
+  for (i = 0; i < len; i++) {
+    if (b[i] & 1) b[i] = 0xff;
+  }
+}
+
+static int log_verify(char *name, u8_t *data, u32_t len) {
+  u8_t buf[512];
+  spiffs_stat s;
+  u32_t offs = 0;
+  spiffs_file fd = SPIFFS_open(FS, name, SPIFFS_RDONLY, 0);
+  CHECK(fd >= 0);
+  CHECK(SPIFFS_fstat(FS, fd, &s) >= 0);
+  CHECK(s.size == len);
+  while (offs < len) {
+    s32_t chunk = MIN(len - offs, sizeof(buf));
+    CHECK(SPIFFS_read(FS, fd, buf, chunk) == chunk);
+    CHECK(memcmp(buf, &data[offs], chunk) == 0);
+    offs += chunk;
+  }
+  SPIFFS_close(FS, fd);
+  return 0;
+}
+
 SUITE(hydrogen_tests)
 void setup() {
   _setup();
@@ -905,6 +933,48 @@ TEST(lseek_simple_modification) {
 TEST_END(lseek_simple_modification)
 
 
+TEST(map_read) {
+  int res;
+  spiffs_file fd;
+  char *fname = "mapfile";
+  int len = 40000;
+  u32_t offs, addr;
+  u8_t *buf = malloc(len);
+  u8_t *rd = malloc(len);
+  memrand(buf, len);
+  fd = SPIFFS_open(FS, fname, SPIFFS_TRUNC | SPIFFS_CREAT | SPIFFS_RDWR, 0);
+  TEST_CHECK(fd > 0);
+  res = SPIFFS_write(FS, fd, buf, len - 100);
+  TEST_CHECK(res >= 0);
+  // the tail is still in the write cache, mapping has to flush it
+  res = SPIFFS_write(FS, fd, buf + len - 100, 100);
+  TEST_CHECK(res >= 0);
+  res = SPIFFS_lseek(FS, fd, 1234, SPIFFS_SEEK_SET);
+  TEST_CHECK(res >= 0);
+
+  for (offs = 0; offs < len; offs += res) {
+    res = SPIFFS_map(FS, fd, offs, &addr);
+    TEST_CHECK(res > 0);
+    TEST_CHECK(res <= SPIFFS_DATA_PAGE_SIZE(FS));
+    (FS)->cfg.hal_read_f(addr, res, rd + offs);
+  }
+  TEST_CHECK(offs == len);
+  TEST_CHECK(memcmp(buf, rd, len) == 0);
+  res = SPIFFS_map(FS, fd, len, &addr);
+  TEST_CHECK(res < 0);
+  TEST_CHECK(SPIFFS_errno(FS) == SPIFFS_ERR_END_OF_OBJECT);
+  // mapping leaves the file position alone
+  TEST_CHECK(SPIFFS_tell(FS, fd) == 1234);
+
+  SPIFFS_close(FS, fd);
+  free(buf);
+  free(rd);
+
+  return TEST_RES_OK;
+}
+TEST_END(map_read)
+
+
 TEST(lseek_modification_append) {
   int res;
   spiffs_file fd;
@@ -1161,6 +1231,135 @@ TEST(long_run_config_many_small_one_long)
 }
 TEST_END(long_run_config_many_small_one_long)
 
+TEST(log_append)
+{
+  u8_t data[3*256+300];
+  u32_t dps = SPIFFS_DATA_PAGE_SIZE(FS);
+  u32_t len = 0;
+  int res;
+  log_record(data, sizeof(data));
+
+  spiffs_file fd = SPIFFS_open(FS, "log", SPIFFS_CREAT | SPIFFS_WRONLY | SPIFFS_LOG, 0);
+  TEST_CHECK(fd >= 0);
+  while (len < dps + dps/2) {
+    res = SPIFFS_write(FS, fd, &data[len], 37);
+    TEST_CHECK(res == 37);
+    len += 37;
+  }
+  // size within a page, then finish that page from a new fd
+  TEST_CHECK(SPIFFS_fflush(FS, fd) >= 0);
+  TEST_CHECK(log_verify("log", data, len) >= 0);
+  SPIFFS_close(FS, fd);
+
+  fd = SPIFFS_open(FS, "log", SPIFFS_WRONLY | SPIFFS_LOG, 0);
+  TEST_CHECK(fd >= 0);
+  while (len + 19 <= 3*dps) {
+    res = SPIFFS_write(FS, fd, &data[len], 19);
+    TEST_CHECK(res == 19);
+    len += 19;
+  }
+  res = SPIFFS_write(FS, fd, &data[len], 3*dps - len);
+  TEST_CHECK(res == 3*dps - len);
+  len = 3*dps;
+  SPIFFS_close(FS, fd);
+  TEST_CHECK(log_verify("log", data, len) >= 0);
+
+  res = SPIFFS_check(FS);
+  TEST_CHECK(res >= 0);
+  return TEST_RES_OK;
+}
+TEST_END(log_append)
+
+TEST(log_recover)
+{
+  u8_t data[3*256];
+  u32_t dps = SPIFFS_DATA_PAGE_SIZE(FS);
+  u32_t len = 0;
+  spiffs_stat s;
+  int res;
+  log_record(data, sizeof(data));
+  data[3*dps-1] = 0xff;
+
+  spiffs_file fd = SPIFFS_open(FS, "log", SPIFFS_CREAT | SPIFFS_WRONLY | SPIFFS_LOG, 0);
+  TEST_CHECK(fd >= 0);
+  while (len < 3*dps) {
+    res = SPIFFS_write(FS, fd, &data[len], MIN(41, 3*dps - len));
+    TEST_CHECK(res == MIN(41, 3*dps - len));
+    len += res;
+  }
+  // never flushed nor closed
+  fs_remount();
+
+  // reading goes by the stored size, and leaves it be
+  fd = SPIFFS_open(FS, "log", SPIFFS_RDONLY, 0);
+  TEST_CHECK(fd >= 0);
+  TEST_CHECK(SPIFFS_fstat(FS, fd, &s) >= 0);
+  TEST_CHECK(s.size < 3*dps);
+  SPIFFS_close(FS, fd);
+
+  fd = SPIFFS_open(FS, "log", SPIFFS_WRONLY | SPIFFS_LOG, 0);
+  TEST_CHECK(fd >= 0);
+  TEST_CHECK(SPIFFS_fstat(FS, fd, &s) >= 0);
+  TEST_CHECK(s.size == 3*dps);
+  SPIFFS_close(FS, fd);
+  TEST_CHECK(log_verify("log", data, len) >= 0);
+
+  res = SPIFFS_check(FS);
+  TEST_CHECK(res >= 0);
+  return TEST_RES_OK;
+}
+TEST_END(log_recover)
+
+TEST(log_recover_power_cut)
+{
+  u8_t data[12*256];
+  u32_t dps = SPIFFS_DATA_PAGE_SIZE(FS);
+  u32_t cut;
+  int res;
+  log_record(data, sizeof(data));
+
+  for (cut = 1; cut < 8*256; cut += 23) {
+    u32_t len = 0, committed = 0, rec = 0;
+    spiffs_stat s;
+    fs_reset();
+    spiffs_file fd = SPIFFS_open(FS, "log", SPIFFS_CREAT | SPIFFS_WRONLY | SPIFFS_LOG, 0);
+    TEST_CHECK(fd >= 0);
+
+    invoke_error_after_write_bytes(cut, 0);
+    while (len + 29 <= 6*dps) {
+      if (SPIFFS_write(FS, fd, &data[len], 29) != 29) break;
+      len += 29;
+      if ((++rec % 7) == 0) {
+        if (SPIFFS_fflush(FS, fd) < 0) break;
+        committed = len;
+      }
+    }
+    // power comes back
+    invoke_error_after_write_bytes(0, 0);
+    fs_remount();
+    TEST_CHECK(SPIFFS_check(FS) >= 0);
+
+    fd = SPIFFS_open(FS, "log", SPIFFS_WRONLY | SPIFFS_LOG, 0);
+    TEST_CHECK(fd >= 0);
+    TEST_CHECK(SPIFFS_fstat(FS, fd, &s) >= 0);
+    TEST_CHECK(s.size >= committed);
+    TEST_CHECK(s.size <= len);
+    TEST_CHECK(s.size == committed || s.size % dps == 0);
+    // appending again must not program over what is there
+    len = s.size;
+    res = SPIFFS_write(FS, fd, &data[len], 2*dps + 17);
+    TEST_CHECK(res == 2*dps + 17);
+    len += res;
+    SPIFFS_close(FS, fd);
+    TEST_CHECK(log_verify("log", data, len) >= 0);
+
+    res = SPIFFS_check(FS);
+    TEST_CHECK(res >= 0);
+  }
+  return TEST_RES_OK;
+}
+TEST_END(log_recover_power_cut)
+
 TEST(long_run_config_many_medium)
 {
   tfile_conf cfgs[] = {
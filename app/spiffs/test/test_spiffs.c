@@ -26,7 +26,7 @@
 
 static unsigned char area[PHYS_FLASH_SIZE];
 
-static int erases[256];
+static int erases[1024];
 static char _path[256];
 static u32_t bytes_rd = 0;
 static u32_t bytes_wr = 0;
@@ -333,6 +333,13 @@ void fs_reset_specific(u32_t phys_addr, u32_t phys_size,
   memset(_cache,0,sizeof(_cache));
 
   SPIFFS_mount(&__fs, &c, _work, _fds, sizeof(_fds), _cache, sizeof(_cache), spiffs_check_cb_f);
+#ifdef TEST_LU_INDEX
+  // run every test with a lookup index, TEST_LU_INDEX entries
+  {
+    static u16_t _lu_index[4*TEST_LU_INDEX];
+    SPIFFS_lu_index(&__fs, _lu_index, sizeof(_lu_index));
+  }
+#endif
 
   clear_flash_ops_log();
   log_flash_ops = 1;
@@ -343,6 +350,24 @@ void fs_reset() {
   fs_reset_specific(SPIFFS_PHYS_ADDR, SPIFFS_FLASH_SIZE, SECTOR_SIZE, LOG_BLOCK, LOG_PAGE);
 }
 
+// mount the emulated flash as it is, dropping file descriptors and cache like
+// a reset would
+void fs_remount() {
+  spiffs_config c = __fs.cfg;
+
+  memset(&__fs,0,sizeof(__fs));
+  memset(_fds,0,sizeof(_fds));
+  memset(_cache,0,sizeof(_cache));
+
+  SPIFFS_mount(&__fs, &c, _work, _fds, sizeof(_fds), _cache, sizeof(_cache), spiffs_check_cb_f);
+#ifdef TEST_LU_INDEX
+  {
+    static u16_t _lu_index[4*TEST_LU_INDEX];
+    SPIFFS_lu_index(&__fs, _lu_index, sizeof(_lu_index));
+  }
+#endif
+}
+
 void set_flash_ops_log(int enable) {
   log_flash_ops = enable;
 }
@@ -364,6 +389,18 @@ u32_t get_flash_ops_log_write_bytes() {
   return bytes_wr;
 }
 
+u32_t get_flash_ops_log_reads() {
+  return reads;
+}
+
+u32_t get_flash_ops_log_writes() {
+  return writes;
+}
+
+int get_flash_erase_count(u32_t sector) {
+  return sector < sizeof(erases)/sizeof(erases[0]) ? erases[sector] : 0;
+}
+
 void invoke_error_after_read_bytes(u32_t b, char once_only) {
   error_after_bytes_read = b;
   error_after_bytes_read_once_only = once_only;
@@ -57,6 +57,8 @@ typedef struct  {
 
 
 void fs_reset();
+void fs_remount();
+void fs_set_validate_flashing(int i);
 void fs_reset_specific(u32_t phys_addr, u32_t phys_size,
     u32_t phys_sector_size,
     u32_t log_block_size, u32_t log_page_size);
@@ -74,6 +76,9 @@ void set_flash_ops_log(int enable);
 void clear_flash_ops_log();
 u32_t get_flash_ops_log_read_bytes();
 u32_t get_flash_ops_log_write_bytes();
+u32_t get_flash_ops_log_reads();
+u32_t get_flash_ops_log_writes();
+int get_flash_erase_count(u32_t sector);
 void invoke_error_after_read_bytes(u32_t b, char once_only);
 void invoke_error_after_write_bytes(u32_t b, char once_only);
 
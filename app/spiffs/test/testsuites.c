@@ -7,9 +7,20 @@
 
 #include "testrunner.h"
 
+void __suite_check_tests();
+void __suite_hydrogen_tests();
+void __suite_bug_tests();
+void __suite_glue_tests();
+void __suite_bench_tests();
+
 void add_suites() {
+#ifdef SPIFFS_BENCH
+  ADD_SUITE(bench_tests)
+#else
   //ADD_SUITE(dev_tests);
   ADD_SUITE(check_tests);
   ADD_SUITE(hydrogen_tests)
   ADD_SUITE(bug_tests)
+  ADD_SUITE(glue_tests)
+#endif
 }
@@ -111,6 +111,11 @@ void task_lua(os_event_t *e){
         case LUA_PROCESS_LINE_SIG:
             lua_handle_input (true);
             break;
+#if defined(BUILD_SPIFFS)
+        case LUA_FS_GC_SIG:
+            myspiffs_gc_task ();
+            break;
+#endif
         default:
             break;
     }
@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+#
+# Generate app/lua/lrostr.h, the flash-resident table of strings that are
+# known at build time (module names, rotable keys, metamethod names and a
+# few common library strings).
+#
+# The table holds complete TString headers with the hash already computed,
+# chained into a power-of-two bucket array, so luaS_newlstr() can return
+# them without allocating anything in RAM.  The hash below MUST be kept in
+# sync with luaS_hash() in app/lua/lstring.c.
+#
+# Usage (from the top of the tree):
+#   python tools/make_rostr.py [-o app/lua/lrostr.h]
+#
+
+import glob
+import os
+import re
+import sys
+
+SCAN = [ 'app/modules/*.c', 'app/lua/*.c' ]
+
+# Strings which are created at startup or by almost every script, but which
+# can not be found by scanning the sources for rotable keys
+EXTRA = [
+  # ltm.c event names (ORDER TM)
+  '__index', '__newindex', '__gc', '__mode', '__eq', '__add', '__sub',
+  '__mul', '__div', '__mod', '__pow', '__unm', '__len', '__lt', '__le',
+  '__concat', '__call',
+  # lmem.h MEMERRMSG
+  'not enough memory',
+  # ltm.c luaT_typenames
+  'nil', 'boolean', 'romtable', 'lightfunction', 'userdata', 'number',
+  'string', 'table', 'function', 'thread', 'proto', 'upval',
+  # lualib.h library names
+  'coroutine', 'io', 'os', 'math', 'debug', 'package',
+  # base and package library fields
+  '_G', '_VERSION', '__metatable', '__tostring', '_LOADED', 'loaded',
+  'preload', 'path', 'cpath', 'loaders', 'seeall', 'self', 'n',
+  '?', '=?', '=stdin', 'main chunk', 'tail',
+]
+
+STRKEY = re.compile(r'LSTRKEY\(\s*"((?:[^"\\]|\\.)*)"\s*\)')
+MODULE = re.compile(r'NODEMCU_MODULE\(\s*\w+\s*,\s*"((?:[^"\\]|\\.)*)"')
+
+MASK = 0xffffffff
+
+def unescape(s):
+  return s.encode('latin-1').decode('unicode_escape').encode('latin-1')
+
+def luaS_hash(s):
+  l = len(s)
+  h = l
+  step = (l >> 5) + 1
+  l1 = l
+  while l1 >= step:
+    c = s[l1 - 1] if isinstance(s[l1 - 1], int) else ord(s[l1 - 1])
+    h = (h ^ ((((h << 5) & MASK) + (h >> 2) + c) & MASK)) & MASK
+    l1 -= step
+  return h
+
+def c_literal(s):
+  out = []
+  for c in bytearray(s):
+    ch = chr(c)
+    if ch in '"\\':
+      out.append('\\' + ch)
+    elif 32 <= c < 127:
+      out.append(ch)
+    else:
+      out.append('\\%03o' % c)
+  return '"' + ''.join(out) + '"'
+
+def collect(top):
+  names = set(s.encode('latin-1') for s in EXTRA)
+  for pattern in SCAN:
+    for fname in sorted(glob.glob(os.path.join(top, pattern))):
+      with open(fname) as f:
+        src = f.read()
+      for rx in (STRKEY, MODULE):
+        for m in rx.finditer(src):
+          names.add(unescape(m.group(1)))
+  return sorted(names)
+
+def generate(strings):
+  size = 1
+  while size < len(strings):
+    size <<= 1
+  buckets = [ [] for i in range(size) ]
+  for i, s in enumerate(strings):
+    buckets[luaS_hash(s) & (size - 1)].append(i)
+  # chain every bucket through tsv.next, like the RAM string table does
+  nxt = [ None ] * len(strings)
+  for b in buckets:
+    for a, c in zip(b, b[1:]):
+      nxt[a] = c
+
+  out = []
+  out.append('/*')
+  out.append('** Flash-resident table of build-time strings')
+  out.append('** Generated by tools/make_rostr.py -- DO NOT EDIT')
+  out.append('*/')
+  out.append('')
+  out.append('#ifndef lrostr_h')
+  out.append('#define lrostr_h')
+  out.append('')
+  out.append('#define LUAS_NROSTR       %d' % len(strings))
+  out.append('#define LUAS_ROSTRTSIZE   %d' % size)
+  out.append('')
+  out.append('#endif')
+  out.append('')
+  out.append('/* the tables themselves are only expanded by lstring.c */')
+  out.append('#if defined(ROSTR) && !defined(lrostr_data)')
+  out.append('#define lrostr_data')
+  out.append('')
+  out.append('#define ROS(n)  cast(GCObject *, &luaS_rostr[n])')
+  out.append('')
+  out.append('const ROTString luaS_rostr[LUAS_NROSTR] = {')
+  for i, s in enumerate(strings):
+    link = 'ROS(%d)' % nxt[i] if nxt[i] is not None else 'NULL'
+    out.append('  ROSTR(%s, 0x%08xu, %d, %s),' %
+               (link, luaS_hash(s), len(s), c_literal(s)))
+  out.append('};')
+  out.append('')
+  out.append('static const ROTString *const luaS_rostrt[LUAS_ROSTRTSIZE] = {')
+  for b in buckets:
+    out.append('  %s,' % ('&luaS_rostr[%d]' % b[0] if b else 'NULL'))
+  out.append('};')
+  out.append('')
+  out.append('#undef ROS')
+  out.append('')
+  out.append('#endif')
+  return '\n'.join(out) + '\n'
+
+def main(argv):
+  top = os.path.normpath(os.path.join(os.path.dirname(__file__), '..'))
+  output = os.path.join(top, 'app', 'lua', 'lrostr.h')
+  if len(argv) == 3 and argv[1] == '-o':
+    output = argv[2]
+  elif len(argv) != 1:
+    sys.stderr.write('usage: %s [-o lrostr.h]\n' % argv[0])
+    return 1
+  with open(output, 'w') as f:
+    f.write(generate(collect(top)))
+  return 0
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv))